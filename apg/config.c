@@ -70,6 +70,7 @@ typedef struct {
     abool bVersion; /**< \brief the version flag, if set the version number is printed and processing stops */
     abool bStrict; /**< \brief if set, the grammar is treated as strict ABNF */
     abool bNoPppt; /**< \brief if set, skip the PPPT calculation */
+    abool bPppt2; /**< \brief if set, add the second-level, two-character PPPT maps */
     abool bDc; /**< \brief display the complete configuration as found on command line or configuration file */
     abool bDv; /**< \brief verbose display of information during processing - sets uiDg, uiDa, uiDr and uiDc */
     abool bDg; /**< \brief display an annotated version of the input grammar */
@@ -234,6 +235,7 @@ void vConfigHelp(void){
         printf("--version             : display version information\n");
         printf("--strict              : only ABNF as strictly defined in RFC 5234 allowed\n");
         printf("--no-pppt             : do not produce Partially-Predictive Parsing Tables (PPPTs)\n");
+        printf("--pppt2               : also produce second-level, two-character PPPT maps (see note 11.)\n");
         printf("\n");
         printf("display flags\n");
         printf("-dv                   : verbose - sets flags -dc, -dg, dr, -dp and -da\n");
@@ -259,6 +261,8 @@ void vConfigHelp(void){
         printf("   Rule names are case insensitive. The argument may be a comma-delimited list with no spaces allowed.\n");
         printf("   Multiple instances of the --p-rules flag will accumulate rule names in the list.\n");
         printf("10. No command line arguments generates this help screen.\n");
+        printf("11. Two-character PPPT maps hide more rules under predictive PPPT-mapped nodes than single-character maps.\n");
+        printf("    Rules with callback functions that may reject a phrase or must always be called must be protected with --p-rules.\n");
         printf("\n");
 }
 
@@ -371,6 +375,12 @@ void vConfigDefault(void* vpCtx, char* cpFileName) {
     fprintf(spFile, "#\n");
     fprintf(spFile, "#--no-pppt\n");
     fprintf(spFile, "#\n");
+    fprintf(spFile, "# TWO-CHARACTER PPPT\n");
+    fprintf(spFile, "# If this flag is set, second-level maps refine the PPPT predictions with the following character.\n");
+    fprintf(spFile, "# More rules are hidden under PPPT-mapped nodes. Protect any rules whose callback functions must be called.\n");
+    fprintf(spFile, "#\n");
+    fprintf(spFile, "#--pppt2\n");
+    fprintf(spFile, "#\n");
     fprintf(spFile, "# PROTECTED RULES\n");
     fprintf(spFile, "# This option allows for a list of rule names to be protected from being hidden under fully-predictive\n");
     fprintf(spFile, "# PPPT-mapped nodes in the parse tree. The argument may be a comma-delimited list.\n");
@@ -499,6 +509,7 @@ void vConfigDisplay(const config* spConfig, int iArgCount, char** cppArgs){
     printf("             --version: %s\n", (spConfig->bVersion ? cpTrue : cpFalse));
     printf("              --strict: %s\n", (spConfig->bStrict ? cpTrue : cpFalse));
     printf("             --no-pppt: %s\n", (spConfig->bNoPppt? cpTrue : cpFalse));
+    printf("               --pppt2: %s\n", (spConfig->bPppt2? cpTrue : cpFalse));
     printf("                   -dv: %s\n", (spConfig->bDv ? cpTrue : cpFalse));
     printf("                   -dc: %s\n", (spConfig->bDc ? cpTrue : cpFalse));
     printf("                   -dg: %s\n", (spConfig->bDg ? cpTrue : cpFalse));
@@ -694,6 +705,10 @@ static void vExtractArgOptions(config_ctx* spCtx, char* cpParams) {
             spCtx->bNoPppt = APG_TRUE;
             uiStrLen = (aint) (strlen(cpParams) + 1);
             cpParams += uiStrLen;
+        } else if (strcmp(cpParams, "--pppt2") == 0) {
+            spCtx->bPppt2 = APG_TRUE;
+            uiStrLen = (aint) (strlen(cpParams) + 1);
+            cpParams += uiStrLen;
         } else if (strcmp(cpParams, "-dra") == 0) {
             spCtx->bDra = APG_TRUE;
             uiStrLen = (aint) (strlen(cpParams) + 1);
@@ -875,6 +890,9 @@ static void vExtractFileOptions(config_ctx* spCtx){
             if(strcmp(cpOption, "--no-pppt") == 0){
                 break;
             }
+            if(strcmp(cpOption, "--pppt2") == 0){
+                break;
+            }
             if(strcmp(cpOption, "-dc") == 0){
                 break;
             }
@@ -926,6 +944,7 @@ static config* spGetConfig(config_ctx* spCtx){
     spConfig->bVersion = spCtx->bVersion;
     spConfig->bStrict = spCtx->bStrict;
     spConfig->bNoPppt = spCtx->bNoPppt;
+    spConfig->bPppt2 = spCtx->bPppt2;
     spConfig->bDc = spCtx->bDc;
     spConfig->bDv = spCtx->bDv;
     spConfig->bDo = spCtx->bDo;
@@ -60,6 +60,7 @@ flags: true if present, otherwise false
 --strict              : only ABNF as strictly defined in RFC 5234 allowed
 --ignore-attributes   : attribute information will not be computed, proceed at your own risk
 --no-pppt             : do not produce Partially-Predictive Parsing Tables (PPPTs)
+--pppt2               : also produce second-level, two-character PPPT maps (see note 11.)
 
 display flags
 -dv                   : verbose - sets flags -dc, -dg, dr, -dp and -da
@@ -85,6 +86,8 @@ NOTES:
    Rule names are case insensitive. The argument may be a comma-delimited list with no spaces allowed.
    Multiple instances of the --p-rules flag will accumulate rule names in the list.
 10. No command line arguments generates this help screen.
+11. Two-character PPPT maps hide more rules under predictive PPPT-mapped nodes than single-character maps.
+    Rules with callback functions that may reject a phrase or must always be called must be protected with --p-rules.
  * </pre>
  */
 #ifndef APG_CONFIG_H_
@@ -120,6 +123,7 @@ typedef struct {
     abool bVersion; /**< \brief the version flag, if set the version number is printed and processing stops */
     abool bStrict; /**< \brief if set, the grammar is treated as strict ABNF */
     abool bNoPppt; /**< \brief if set, Partially-Predictive Parsing Tables (PPPTs) will not be produced */
+    abool bPppt2; /**< \brief if set, second-level, two-character PPPT maps are also produced */
     abool bDv; /**< \brief verobose - sets options -dc, -dg, -dr, and -da  */
     abool bDc; /**< \brief display the complete configuration as found on command line or configuration file */
     abool bDg; /**< \brief display an annotated version of the input grammar */
@@ -194,6 +194,9 @@ int main(int argc, char **argv) {
         // PPPT
         if(!spConfig->bNoPppt){
             vApiPppt(vpApi, spConfig->cppPRules, spConfig->uiPRules);
+            if(spConfig->bPppt2){
+                vApiPppt2(vpApi);
+            }
         }
 
         // output the parser files
@@ -35,6 +35,8 @@
  * If the trace flag, "t" or "th", is set (see vApgexPattern()), then the macro APG_TRACE must also be defined.
  */
 
+#include <pthread.h>
+#include <unistd.h>
 #include "./apgex.h"
 #include "../library/parserp.h"
 #include "../library/tracep.h"
@@ -95,6 +97,32 @@ typedef struct{
     abool bEnabled; ///< \brief True if this UDT has been enabled for phrase capture.
 } udt_r;
 
+/** \struct prefix_r
+ * \brief For internal object use only. One character of the literal prefix that every pattern match must begin with.
+ */
+typedef struct{
+    achar acChar; ///< \brief The prefix character, lower case if bFold is true.
+    abool bFold; ///< \brief True if the character is from a case-insensitive literal string (TLS).
+} prefix_r;
+
+/** \struct cache_entry
+ * \brief For internal object use only. One compiled pattern in the process-wide pattern cache.
+ *
+ * The parser initialization data is shared, read only, by the parsers of all apgex objects using the pattern.
+ * It is freed when it has been evicted from the cache and the last of these parsers has been destroyed.
+ */
+typedef struct cache_entry_tag{
+    struct cache_entry_tag* spNext; ///< \brief The next, less recently used, entry.
+    struct cache_entry_tag* spPrev; ///< \brief The previous, more recently used, entry.
+    char* cpPattern; ///< \brief The pattern text, allocated with the entry.
+    size_t uiPatternLength; ///< \brief The length of the pattern text.
+    luint luiHash; ///< \brief Hash of the pattern text.
+    abool bPppt; ///< \brief True if the pattern was compiled with PPPTs.
+    abool bCached; ///< \brief True while the entry is in the cache list.
+    aint uiRefCount; ///< \brief The number of apgex objects with parsers constructed from this entry.
+    void* vpParserInit; ///< \brief The parser initialization data from vpApiOutputParserInit().
+} cache_entry;
+
 /** \struct result_r
  * \brief For internal object use only. The phrase matching result in relative phrases.
  */
@@ -154,20 +182,172 @@ typedef struct{
     abool bGlobalMode; ///< \brief True if in global mode.
     abool bPpptMode; ///< \brief True if PPPTs are used.
     abool bStickyMode; ///< \brief True if in sticky mode.
+    abool bParserInput; ///< \brief True if the parser holds a copy of the current source and need not copy it again.
+    abool bAstDeferred; ///< \brief True if the last match was made with the AST detached. It is rebuilt on demand.
+    aint uiAstOffset; ///< \brief Offset of the last match made with the AST detached. APG_UNDEFINED if none.
+    cache_entry* spCacheEntry; ///< \brief The cached compiled pattern the parser was constructed from, if any.
+    void* vpVecStreamBytes; ///< \brief Staging area for the bytes read from a stream file.
+    FILE* spStreamFile; ///< \brief The open stream file, if any. Closed if the pattern is redefined or the object destroyed.
+    void* vpVecPrefix; ///< \brief Vector of the literal prefix characters (\ref prefix_r) that every match must begin with.
+    const uint8_t* ucpFirstMap; ///< \brief The start rule's PPPT map, used as the set of possible first characters. NULL if none.
+    achar acFirst; ///< \brief The only possible first character if bSingleFirst is true.
+    abool bSingleFirst; ///< \brief True if only one character, acFirst, can begin a match.
+    abool bPrefilter; ///< \brief True if either the first-character set or the literal prefix can be used to skip start offsets.
+    void* vpVecParMatches; ///< \brief Vector of the matched phrases (\ref par_match) found by the workers of a parallel scan.
+    void* vpVecParChunks; ///< \brief Vector of the chunks (\ref par_chunk) of a parallel scan.
 } apgex;
 
+/** \struct stream_src
+ * \brief For internal object use only. The source of a stream scan, either a file or a memory buffer.
+ */
+typedef struct{
+    FILE* spFile; ///< \brief The open file, if scanning a file. Otherwise NULL.
+    const uint8_t* ucpBuffer; ///< \brief The memory buffer, if scanning a buffer.
+    luint luiLength; ///< \brief The length of the memory buffer.
+    luint luiOffset; ///< \brief The offset of the next byte to read from the memory buffer.
+    void* vpVecBytes; ///< \brief Staging area for file bytes when sizeof(achar) > 1.
+    const achar* acpPhrase; ///< \brief The source string, if scanning a string. luiLength and luiOffset then count characters.
+} stream_src;
+
+/** \struct stream_out
+ * \brief For internal object use only. The state of a streaming replace or split.
+ */
+typedef struct{
+    pfn_apgex_sink pfnSink; ///< \brief The user's output function.
+    void* vpUser; ///< \brief The user's data for the output function.
+    apg_phrase* spReplacement; ///< \brief The replacement phrase, if any.
+    pfn_replace pfnFunc; ///< \brief The replacement function, if any. Otherwise the replacement phrase is used.
+    void* vpFuncUser; ///< \brief The user's data for the replacement function.
+    luint luiWritten; ///< \brief The stream offset of the first character not yet written.
+    luint luiCount; ///< \brief The number of replacements made or sub-phrases written.
+    aint uiLimit; ///< \brief Split only. The number of matches left to find.
+    abool bSplit; ///< \brief True for a split, false for a replacement.
+    abool bOpen; ///< \brief Split only. True if some text of the current sub-phrase has been written.
+    abool bDone; ///< \brief Split only. True if the limit has been reached and nothing more is to be written.
+} stream_out;
+
+/** \struct par_match
+ * \brief For internal object use only. A phrase matched by a worker of a parallel scan.
+ */
+typedef struct{
+    luint luiOffset; ///< \brief The buffer offset of the matched phrase.
+    aint uiLength; ///< \brief The length of the matched phrase.
+    aint uiNodeHits; ///< \brief The number of node hits in the matching parse.
+    aint uiTreeDepth; ///< \brief The maximum tree depth reached in the matching parse.
+} par_match;
+
+/** \struct par_chunk
+ * \brief For internal object use only. A chunk of the buffer of a parallel scan.
+ */
+typedef struct{
+    luint luiBeg; ///< \brief The buffer offset of the first offset to try.
+    luint luiEnd; ///< \brief The buffer offset following the last offset to try. It follows a delimiter, if one was found.
+    aint uiWorker; ///< \brief The index of the worker that scanned the chunk.
+    aint uiFirst; ///< \brief The index of the chunk's first match in the worker's vector of matches,
+                  ///< and after the merge, in the apgex object's vector.
+    aint uiCount; ///< \brief The number of matches found in the chunk.
+} par_chunk;
+
+/** \struct par_window
+ * \brief For internal object use only. A parser and its window on the buffer of a parallel scan.
+ */
+typedef struct{
+    exception* spException; ///< \brief The exception for errors in this window's thread.
+    void* vpParser; ///< \brief The parser.
+    void* vpVecWindow; ///< \brief Vector for the window's alphabet characters.
+    const uint8_t* ucpBuffer; ///< \brief The buffer being scanned.
+    luint luiLength; ///< \brief The number of bytes in the buffer.
+    luint luiWindow; ///< \brief The buffer offset of the first character in the window.
+    aint uiLimit; ///< \brief Window offsets below this limit have at least uiMaxMatch characters following them,
+                  ///< or the end of the buffer is in the window.
+    aint uiMaxMatch; ///< \brief The maximum length of a matched phrase.
+    abool bParsed; ///< \brief True if the parser holds a copy of the window and need only re-parse it.
+    parser_config sConfig; ///< \brief The parser configuration for the window.
+} par_window;
+
+/** \struct par_scan
+ * \brief For internal object use only. The state shared by the workers of a parallel scan.
+ */
+typedef struct{
+    apgex* spExp; ///< \brief The apgex object. Only its pattern and prefilter are used by the workers.
+    par_window sWindow; ///< \brief The template for the workers' windows.
+    par_chunk* spChunks; ///< \brief The chunks.
+    aint uiChunkCount; ///< \brief The number of chunks.
+    aint uiNextChunk; ///< \brief The index of the next chunk to be scanned.
+    abool bStop; ///< \brief True if a worker has failed and the others are to stop.
+    pthread_mutex_t sMutex; ///< \brief Guards uiNextChunk and bStop.
+} par_scan;
+
+/** \struct par_worker
+ * \brief For internal object use only. One worker thread of a parallel scan.
+ */
+typedef struct{
+    par_scan* spScan; ///< \brief The shared state of the scan.
+    exception sException; ///< \brief The worker's own exception. Errors are reported by the main thread after all workers are done.
+    void* vpMem; ///< \brief The worker's own memory object.
+    void* vpVecMatches; ///< \brief Vector of the worker's matched phrases (\ref par_match), chunk by chunk.
+    par_window sWindow; ///< \brief The worker's own parser and window.
+    aint uiIndex; ///< \brief The index of the worker.
+    pthread_t sThread; ///< \brief The worker's thread.
+    abool bStarted; ///< \brief True if the worker's thread was started.
+    abool bError; ///< \brief True if an exception was thrown in the worker.
+} par_worker;
+
+/** \struct set_pattern
+ * \brief For internal object use only. One pattern of a pattern set.
+ */
+typedef struct{
+    aint uiTextOffset; ///< \brief Offset of the original pattern text in the vector of pattern texts.
+    aint uiNameOffset; ///< \brief Offset of the pattern's renamed start rule name in the vector of names.
+    aint uiStartRule; ///< \brief The index of the pattern's start rule in the combined grammar.
+    const uint8_t* ucpFirstMap; ///< \brief The start rule's PPPT map. NULL if none.
+    abool bEnabled; ///< \brief True if the pattern is to be matched.
+} set_pattern;
+
+/** \struct apgex_set
+ * \brief For internal object use only. The pattern set object context.
+ */
+typedef struct{
+    const void* vpValidate; ///< \brief Must be the "magic number" to be a valid context.
+    exception* spException; ///< \brief Pointer to the exception structure for reporting errors to the application catch block.
+    void* vpMem; ///< \brief Pointer to a memory object used for all memory allocations.
+    void* vpApi; ///< \brief Pointer to the API object used to compile the combined grammar.
+    void* vpFmt; ///< \brief Pointer to a format object for displaying non-ASCII phrases.
+    void* vpParser; ///< \brief Pointer to the parser for the combined grammar. NULL if not compiled.
+    cache_entry* spCacheEntry; ///< \brief The cached compiled grammar the parser was constructed from.
+    void* vpVecPatterns; ///< \brief Vector of patterns (\ref set_pattern).
+    void* vpVecText; ///< \brief Vector of the null-terminated original pattern texts.
+    void* vpVecNames; ///< \brief Vector of the null-terminated, renamed start rule names.
+    void* vpVecGrammar; ///< \brief The combined grammar.
+    void* vpVecDispatch; ///< \brief For each character, the list of patterns that may begin with it.
+    void* vpVecDispatchIndex; ///< \brief For each character, the offset of its list in vpVecDispatch. One extra at the end.
+    void* vpVecAll; ///< \brief The list of all patterns, used if there is no dispatch table.
+    void* vpVecMatches; ///< \brief Vector of matched phrases (\ref apgex_set_match).
+    void* vpVecMatched; ///< \brief For each pattern, true if it has matched.
+    abool bFirst; ///< \brief True if only the first matching pattern at an offset is reported.
+} apgex_set;
+
 static const void* s_vpMagicNumber = (const void*)"apgex";
+static const void* s_vpSetMagicNumber = (const void*)"apgex_set";
 static const char* s_cpNoPattern = "No pattern or properties defined yet. This function call must be preceded by\n"
         "vApgexPattern(), vApgexPatternFile() or vApgexPatternParser()";
 static char s_cZero = 0;
 static char* s_cpExternalPattern = "<external>";
 static const char* s_cpEmptySource = "source cannot be NULL or empty";
 static char* s_cpEndian = "???";
+static pthread_mutex_t s_sCacheMutex = PTHREAD_MUTEX_INITIALIZER;
+static cache_entry* s_spCacheFirst = NULL;
+static cache_entry* s_spCacheLast = NULL;
+static aint s_uiCacheCount = 0;
+static aint s_uiCacheMax = APGEX_CACHE_SIZE;
+static luint s_luiCacheHits = 0;
+static luint s_luiCacheMisses = 0;
 
 static inline void vMakeAbsPhrase(apgex* spExp, phrase_r* spRelPhrase, apgex_phrase* spAbsPhrase);
 static inline void vMakeRelPhrase(apgex* spExp, aint uiSourceOffset, aint uiLen, phrase_r* spPhrase);
 static inline char* cpBool(abool bVal);
 static void vClearForParse(apgex* spExp);
+static void vClearForMatch(apgex* spExp);
 static void vClearForPattern(apgex* spExp);
 static void vExecResult(apgex* spExp, apgex_result* spResult);
 static abool bExecTest(apgex* spExp);
@@ -178,6 +358,12 @@ static void vMatchSticky(apgex* spExp, parser_config* spConfig, apgex_result* sp
 static abool bTestDefault(apgex* spExp, parser_config* spConfig);
 static abool bTestGlobal(apgex* spExp, parser_config* spConfig);
 static abool bTestSticky(apgex* spExp, parser_config* spConfig);
+static void vParse(apgex* spExp, parser_config* spConfig, parser_state* spState);
+static void vInitPrefilter(apgex* spExp);
+static abool bPrefixOp(apgex* spExp, const opcode* spOp, aint uiDepth);
+static abool bNextStart(apgex* spExp, parser_config* spConfig);
+static aint uiNextStart(apgex* spExp, parser* spParser, const achar* acpSrc, aint uiBeg, aint uiEnd);
+static inline abool bPrefixChar(const prefix_r* spPrefix, achar acChar);
 static void vReplacement(apgex* spExp, apgex_result* spResult);
 static void vReplaceFunc(apgex* spExp, apgex_result* spResult, pfn_replace pfnFunc, void* vpUser);
 static void vReplace(apgex* spExp, apgex_result* spResult);
@@ -187,12 +373,46 @@ static aint pfnRuleCallback(ast_data* spData);
 static aint pfnUdtCallback(ast_data* spData);
 //static void pfnRuleCallback(callback_data* spData);
 //static void pfnUdtCallback(callback_data* spData);
-static void vPrintPhrase(apgex* spExp, apgex_phrase* spPhrase, FILE* spOut);
+static void vPrintPhrase(void* vpFmt, apgex_phrase* spPhrase, FILE* spOut);
 static void vDecodeFlags(apgex* spExp, const char* cpFlags);
 static void vConstructParser(apgex* spExp);
+static luint luiCacheHash(const char* cpPattern, size_t uiLength);
+static cache_entry* spCacheGet(const char* cpPattern, abool bPppt);
+static cache_entry* spCachePut(exception* spEx, const char* cpPattern, abool bPppt, void* vpParserInit);
+static void vCacheRelease(cache_entry* spEntry);
+static void vCacheUnlink(cache_entry* spEntry);
+static void vCacheEvict(aint uiMax);
+static aint uiStreamRead(stream_src* spSrc, achar* acpDst, aint uiMax);
+static luint luiStream(apgex* spExp, stream_src* spSrc, aint uiMaxMatch, pfn_apgex_stream pfnMatch, void* vpUser,
+        stream_out* spOut);
+static void vStreamWrite(stream_out* spOut, const achar* acpText, aint uiLength, aint uiType);
+static abool bStreamOut(apgex* spExp, stream_out* spOut, apgex_result* spResult, luint luiBase);
+static void vStreamOutEnd(apgex* spExp, stream_src* spSrc, stream_out* spOut, luint luiBase, abool bEos);
+static void vStreamReplacement(apgex* spExp, apg_phrase* spReplacement);
+static void vStreamOpen(apgex* spExp, stream_src* spSrc, const char* cpFileName);
+static void vStreamClose(apgex* spExp, stream_src* spSrc);
+static void vProperties(apgex* spExp, apgex_properties* spProps);
+static luint luiParallel(apgex* spExp, const uint8_t* ucpBuffer, luint luiLength, const char* cpDelimiter,
+        aint uiThreads, aint uiMaxMatch, pfn_apgex_stream pfnMatch, void* vpUser);
+static inline void vParWindow(par_window* spWin, luint luiOffset);
+static void vParLoad(par_window* spWin, luint luiOffset);
+static abool bParMatch(par_window* spWin, luint luiOffset, parser_state* spState);
+static void vParChunks(apgex* spExp, const uint8_t* ucpBuffer, luint luiLength, const char* cpDelimiter, aint uiThreads);
+static par_chunk* spParNextChunk(par_scan* spScan);
+static void* vpParWorker(void* vpArg);
+static void vParScanChunk(par_worker* spWork, par_chunk* spChunk);
+static void vParWorkers(apgex* spExp, par_scan* spScan, aint uiThreads);
+static abool bParOut(apgex* spExp, par_window* spMain, luint luiOffset, parser_state* spState,
+        pfn_apgex_stream pfnMatch, void* vpUser);
+static void vSetClear(apgex_set* spSet);
+static void vSetGrammar(apgex_set* spSet);
+static void vSetDispatch(apgex_set* spSet);
+static inline abool bIsNameStart(char cChar);
 static void vInitRules(apgex* spExp);
 static void vInitCallbacks(apgex* spExp);
 static void vResetCallbacks(apgex* spExp);
+static void vAstMode(apgex* spExp, abool bCapture);
+static void vAstRebuild(apgex* spExp);
 static abool bIsNameChar(char cChar);
 static void vNamePhrase(apgex* spExp, achar* acpName, aint uiNameLen, apg_phrase* spPhrase);
 
@@ -261,6 +481,10 @@ void* vpApgexCtor(exception* spEx){
     spExp->vpVecReplaceRaw = vpVecCtor(vpMem, sizeof(achar), 1024);
     spExp->vpVecReplacement = vpVecCtor(vpMem, sizeof(achar), 1024);
     spExp->vpVecSplitPhrases = vpVecCtor(vpMem, sizeof(apg_phrase), 128);
+    spExp->vpVecPrefix = vpVecCtor(vpMem, sizeof(prefix_r), 64);
+    spExp->vpVecStreamBytes = vpVecCtor(vpMem, sizeof(uint8_t), APGEX_STREAM_CHUNK);
+    spExp->vpVecParMatches = vpVecCtor(vpMem, sizeof(par_match), 1024);
+    spExp->vpVecParChunks = vpVecCtor(vpMem, sizeof(par_chunk), 64);
     spExp->vpFmt = vpFmtCtor(spEx);
     spExp->bDefaultMode = APG_TRUE;
     spExp->vpValidate = s_vpMagicNumber;
@@ -303,10 +527,14 @@ void vApgexDtor(void *vpCtx) {
             // destroy the local parser, which destroys AST and trace object along with it
             vParserDtor(spExp->vpParser);
         }
+        vCacheRelease(spExp->spCacheEntry);
         if(spExp->spDisplay && (spExp->spDisplay != stdout)){
             fclose(spExp->spDisplay);
             spExp->spDisplay = NULL;
         }
+        if(spExp->spStreamFile){
+            fclose(spExp->spStreamFile);
+        }
         vApiDtor(spExp->vpApi);
         vFmtDtor(spExp->vpFmt);
         memset(vpCtx, 0, sizeof(apgex));
@@ -462,11 +690,55 @@ void vApgexPatternParser(void* vpCtx, void* vpParser, const char* cpFlags){
     spExp->vpExternalParser = vpParser;
     spExp->vpParser = vpParser;
     spExp->vpAst = vpAstCtor(spExp->vpParser);
+    vInitPrefilter(spExp);
 
     // initialize the rule list
     vInitRules(spExp);
 }
 
+/** \brief Set the maximum number of compiled patterns in the process-wide pattern cache.
+ *
+ * Compiling a pattern runs the full parser generator and may take milliseconds.
+ * Therefore, compiled patterns are kept in a process-wide cache, keyed on the pattern text and the PPPT flag, `p`.
+ * The compiled pattern, the parser's initialization data, is shared read only by all apgex objects using it.
+ * Defining a cached pattern with vApgexPattern() or vApgexPatternFile() costs only the construction of
+ * the object's own parser context from it. When the cache is full the least recently used pattern is evicted.
+ *
+ * The cache is thread safe. apgex objects themselves are not and must not be shared between threads.
+ * \param uiMaxEntries The maximum number of cached patterns. If 0, patterns are not cached.
+ * The default is \ref APGEX_CACHE_SIZE.
+ */
+void vApgexCacheSize(aint uiMaxEntries){
+    pthread_mutex_lock(&s_sCacheMutex);
+    s_uiCacheMax = uiMaxEntries;
+    vCacheEvict(s_uiCacheMax);
+    pthread_mutex_unlock(&s_sCacheMutex);
+}
+
+/** \brief Remove all compiled patterns from the pattern cache.
+ *
+ * Patterns still in use by apgex objects remain valid until the objects define new patterns or are destroyed.
+ */
+void vApgexCacheClear(void){
+    pthread_mutex_lock(&s_sCacheMutex);
+    vCacheEvict(0);
+    pthread_mutex_unlock(&s_sCacheMutex);
+}
+
+/** \brief Get information about the pattern cache.
+ * \param spInfo Pointer to the structure to receive the information. Silently ignored if NULL.
+ */
+void vApgexCacheInfo(apgex_cache_info* spInfo){
+    if(spInfo){
+        pthread_mutex_lock(&s_sCacheMutex);
+        spInfo->uiEntries = s_uiCacheCount;
+        spInfo->uiMaxEntries = s_uiCacheMax;
+        spInfo->luiHits = s_luiCacheHits;
+        spInfo->luiMisses = s_luiCacheMisses;
+        pthread_mutex_unlock(&s_sCacheMutex);
+    }
+}
+
 /** \brief Attempt a pattern match on the source array of APG alphabet characters.
  *
  * \param vpCtx A pointer to a valid apgex object context returned from vpApgexCtor().
@@ -491,7 +763,7 @@ apgex_result sApgexExec(void* vpCtx, apg_phrase* spSource){
     vClearForParse(spExp);
     vpVecPushn(spExp->vpVecSource, (void*)spSource->acpPhrase, spSource->uiLength);
 
-    vInitCallbacks(spExp);
+    vAstMode(spExp, (spExp->uiEnabledRuleCount || spExp->uiEnabledUdtCount));
     vExecResult(spExp, &sResult);
     vResetCallbacks(spExp);
     return sResult;
@@ -536,7 +808,7 @@ apg_phrase sApgexReplace(void* vpCtx, apg_phrase* spSource, apg_phrase* spReplac
     apg_phrase sPhrase = {};
     apgex_result sResult = {};
     vClearForParse(spExp);
-    vInitCallbacks(spExp);
+    vAstMode(spExp, (spExp->uiEnabledRuleCount || spExp->uiEnabledUdtCount));
     spExp->bReplaceMode = APG_TRUE;
     vpVecPushn(spExp->vpVecSource, (void*)spSource->acpPhrase, spSource->uiLength);
     vpVecPushn(spExp->vpVecOriginalSource, (void*)(void*)spSource->acpPhrase, spSource->uiLength);
@@ -554,6 +826,10 @@ apg_phrase sApgexReplace(void* vpCtx, apg_phrase* spSource, apg_phrase* spReplac
         while(sResult.spResult){
             vReplacement(spExp, &sResult);
             vReplace(spExp, &sResult);
+            if(!spExp->bAstDeferred){
+                // each match removes the callbacks
+                vInitCallbacks(spExp);
+            }
             vExecResult(spExp, &sResult);
         }
     }
@@ -590,7 +866,8 @@ apg_phrase sApgexReplaceFunc(void* vpCtx, apg_phrase* spSource, pfn_replace pfnF
         XTHROW(spExp->spException, "pfnFunc cannot be NULL");
     }
     vClearForParse(spExp);
-    vInitCallbacks(spExp);
+    // the replacement function is handed the properties, and with them the AST, at every match
+    vAstMode(spExp, APG_TRUE);
     spExp->bReplaceMode = APG_TRUE;
     vpVecPushn(spExp->vpVecSource, (void*)spSource->acpPhrase, spSource->uiLength);
     vpVecPushn(spExp->vpVecOriginalSource, (void*)(void*)spSource->acpPhrase, spSource->uiLength);
@@ -607,6 +884,10 @@ apg_phrase sApgexReplaceFunc(void* vpCtx, apg_phrase* spSource, pfn_replace pfnF
         while(sResult.spResult){
             vReplaceFunc(spExp, &sResult, pfnFunc, vpUser);
             vReplace(spExp, &sResult);
+            if(!spExp->bAstDeferred){
+                // each match removes the callbacks
+                vInitCallbacks(spExp);
+            }
             vExecResult(spExp, &sResult);
         }
     }
@@ -688,12 +969,17 @@ apg_phrase* spApgexSplit(void* vpCtx, apg_phrase* spSource, aint uiLimit, aint*
     for(ui = 0; ui < spExp->uiUdtCount; ui++){
         spExp->spRelUdts[ui].bEnabled = APG_FALSE;
     }
+    vAstMode(spExp, APG_FALSE);
 
     if(spExp->vpTrace){
         // initalize the trace
         TRACE_APGEX_HEADER(spExp->vpTrace);
     }
 
+    if(spExp->vpExternalParser){
+        // the application may have used its parser for other input since the last match
+        spExp->bParserInput = APG_FALSE;
+    }
     // initialize for the parser input
     sConfig.acpInput = (achar*)vpVecFirst(spExp->vpVecSource);
     sConfig.uiInputLength = uiVecLen(spExp->vpVecSource);
@@ -759,6 +1045,7 @@ abool bApgexTest(void* vpCtx, apg_phrase* spSource){
     }
     vClearForParse(spExp);
     vpVecPushn(spExp->vpVecSource, (void*)spSource->acpPhrase, spSource->uiLength);
+    vAstMode(spExp, APG_FALSE);
     return bExecTest(spExp);
 }
 
@@ -893,6 +1180,15 @@ apgex_properties sApgexProperties(void* vpCtx){
     if(!spExp->vpParser){
         XTHROW(spExp->spException, s_cpNoPattern);
     }
+    if(spExp->bAstDeferred){
+        vAstRebuild(spExp);
+    }
+    apgex_properties sProps;
+    vProperties(spExp, &sProps);
+    return sProps;
+}
+
+static void vProperties(apgex* spExp, apgex_properties* spProps){
     apgex_properties sProps;
     memset(&sProps, 0, sizeof(apgex_properties));
     sProps.vpParser = spExp->vpParser;
@@ -925,7 +1221,7 @@ apgex_properties sApgexProperties(void* vpCtx){
     if(spExp->spRightContext){
         sProps.sRightContext = *spExp->spRightContext;
     }
-    return sProps;
+    *spProps = sProps;
 }
 
 /** \brief Get a pointer to the AST object's context.
@@ -944,6 +1240,8 @@ apgex_properties sApgexProperties(void* vpCtx){
  *
  *  Following a successful phrase match, the AST object will have records for all rules and UDTs in the pattern
  *  but all call back functions will be NULL.
+ *  If no rules or UDTs were enabled for the match, the AST was not kept.
+ *  It is then rebuilt here by re-parsing the matched phrase, calling any UDT callback functions again.
  *  Use vAstSetRuleCallback() and vAstSetUdtCallback() to set the translation functions
  *  specific to the application prior to translation with vAstTranslate().
  *
@@ -962,6 +1260,9 @@ void* vpApgexGetAst(void* vpCtx){
     if(!spExp->vpParser){
         XTHROW(spExp->spException, s_cpNoPattern);
     }
+    if(spExp->bAstDeferred){
+        vAstRebuild(spExp);
+    }
     return spExp->vpAst;
 }
 
@@ -1065,22 +1366,22 @@ void vApgexDisplayProperties(void* vpCtx, apgex_properties* spProperties, const
     if(spExp->bReplaceMode){
         fprintf(spOut, "Original Source: ");
         sOutPhrase.sPhrase = spProperties->sOriginalSource;
-        vPrintPhrase(spExp, &sOutPhrase, spOut);
+        vPrintPhrase(spExp->vpFmt, &sOutPhrase, spOut);
         fprintf(spOut, "Replaced Source: ");
         sOutPhrase.sPhrase = spProperties->sLastSource;
-        vPrintPhrase(spExp, &sOutPhrase, spOut);
+        vPrintPhrase(spExp->vpFmt, &sOutPhrase, spOut);
     }else{
         fprintf(spOut, "Original Source: ");
         sOutPhrase.sPhrase = spProperties->sOriginalSource;
-        vPrintPhrase(spExp, &sOutPhrase, spOut);
+        vPrintPhrase(spExp->vpFmt, &sOutPhrase, spOut);
     }
     fprintf(spOut, "     Last Index: %"PRIuMAX"\n", (luint)spExp->uiLastIndex);
     fprintf(spOut, "     Last Match: ");
-    vPrintPhrase(spExp, &spProperties->sLastMatch, spOut);
+    vPrintPhrase(spExp->vpFmt, &spProperties->sLastMatch, spOut);
     fprintf(spOut, "   Left Context: ");
-    vPrintPhrase(spExp, &spProperties->sLeftContext, spOut);
+    vPrintPhrase(spExp->vpFmt, &spProperties->sLeftContext, spOut);
     fprintf(spOut, "  Right Context: ");
-    vPrintPhrase(spExp, &spProperties->sRightContext, spOut);
+    vPrintPhrase(spExp->vpFmt, &spProperties->sRightContext, spOut);
     if(spOut && (spOut != stdout)){
         fclose(spOut);
         spExp->spDisplay = NULL;
@@ -1112,7 +1413,7 @@ void vApgexDisplayPhrase(void* vpCtx, apgex_phrase* spPhrase, const char* cpFile
             XTHROW(spExp->spException, caBuf);
         }
     }
-    vPrintPhrase(spExp, spPhrase, spExp->spDisplay);
+    vPrintPhrase(spExp->vpFmt, spPhrase, spExp->spDisplay);
     if(spExp->spDisplay && (spExp->spDisplay != stdout)){
         fclose(spExp->spDisplay);
         spExp->spDisplay = NULL;
@@ -1149,11 +1450,11 @@ void vApgexDisplayResult(void* vpCtx, apgex_result* spResult, const char* cpFile
     if(!spResult->spResult){
         fprintf(spOut, "no match\n");
     }else{
-        vPrintPhrase(spExp, spResult->spResult, spOut);
+        vPrintPhrase(spExp->vpFmt, spResult->spResult, spOut);
         fprintf(spOut, "left context : ");
-        vPrintPhrase(spExp, spResult->spLeftContext, spOut);
+        vPrintPhrase(spExp->vpFmt, spResult->spLeftContext, spOut);
         fprintf(spOut, "right context: ");
-        vPrintPhrase(spExp, spResult->spRightContext, spOut);
+        vPrintPhrase(spExp->vpFmt, spResult->spRightContext, spOut);
         fprintf(spOut, "uiLastIndex  : %"PRIuMAX"\n", (luint)spResult->uiLastIndex);
         fprintf(spOut, "node hits    : %"PRIuMAX"\n", (luint)spResult->uiNodeHits);
         fprintf(spOut, "tree depth   : %"PRIuMAX"\n", (luint)spResult->uiTreeDepth);
@@ -1166,7 +1467,7 @@ void vApgexDisplayResult(void* vpCtx, apgex_result* spResult, const char* cpFile
                 }
                 fprintf(spOut, "%s: phrases: %"PRIuMAX"\n", spResult->spRules[ui].cpRuleName, (luint)spResult->spRules[ui].uiPhraseCount);
                 for(uj = 0; uj < spResult->spRules[ui].uiPhraseCount; uj++){
-                    vPrintPhrase(spExp, &spResult->spRules[ui].spPhrases[uj], spOut);
+                    vPrintPhrase(spExp->vpFmt, &spResult->spRules[ui].spPhrases[uj], spOut);
                 }
             }
         }
@@ -1237,121 +1538,810 @@ void vApgexDefineUDT(void* vpCtx, const char* cpName, parser_callback pfnUdt){
 //    spExp->spRelUdts[spUdt->uiUdtIndex].pfnUdt = pfnUdt;
 }
 
-//  ///////////////////////////////////////////////////////////////////////////////
-//      STATIC FUNCTIONS
-//  ///////////////////////////////////////////////////////////////////////////////
-static inline void vMakeAbsPhrase(apgex* spExp, phrase_r* spRelPhrase, apgex_phrase* spAbsPhrase){
-    spAbsPhrase->sPhrase.acpPhrase = (achar*)vpVecFirst(spExp->vpVecSource) + spRelPhrase->uiSourceOffset;
-    spAbsPhrase->sPhrase.uiLength = spRelPhrase->uiLength;
-    spAbsPhrase->uiPhraseOffset = spRelPhrase->uiSourceOffset;
+/** \brief Scan a file for matched phrases, calling a user function for each.
+ *
+ * The file is read and scanned through a window of bounded size, so that files of any size can be scanned
+ * with a fixed amount of memory. Each byte of the file is one alphabet character.
+ * The stream is always scanned for all matches, as in global mode. In sticky mode, the scan
+ * stops at the first offset, beginning at the start of the stream, that does not match.
+ * uiLastIndex is ignored and is zero on return.
+ *
+ * The parser sees at least `uiMaxMatch` characters on either side of each offset at which a match is attempted.
+ * That is, the result is the same as if the entire file were in memory provided that neither the matched phrases
+ * nor any look ahead or look behind extends beyond `uiMaxMatch` characters.
+ * An exception is thrown if a matched phrase is longer than `uiMaxMatch`.
+ * The trace mode is not supported.
+ * \param vpCtx A pointer to a valid apgex object context returned from vpApgexCtor().
+ * If not valid the application will silently exit with a \ref BAD_CONTEXT exit code.
+ * \param cpFileName The name of the file to scan.
+ * \param uiMaxMatch The maximum length of a matched phrase. If 0, \ref APGEX_STREAM_MAX_MATCH is used.
+ * \param pfnMatch The function to call for each matched phrase. See \ref pfn_apgex_stream.
+ * \param vpUser Pointer to user data, passed to `pfnMatch`. May be NULL.
+ * \return The number of matched phrases.
+ */
+luint luiApgexStreamFile(void* vpCtx, const char* cpFileName, aint uiMaxMatch, pfn_apgex_stream pfnMatch, void* vpUser){
+    apgex* spExp = (apgex*) vpCtx;
+    if(!vpCtx || (spExp->vpValidate != s_vpMagicNumber)){
+            vExContext();
+    }
+    stream_src sSrc = {};
+    luint luiCount;
+    vStreamOpen(spExp, &sSrc, cpFileName);
+    luiCount = luiStream(spExp, &sSrc, uiMaxMatch, pfnMatch, vpUser, NULL);
+    vStreamClose(spExp, &sSrc);
+    return luiCount;
 }
 
-static inline void vMakeRelPhrase(apgex* spExp, aint uiSourceOffset, aint uiLen, phrase_r* spPhrase){
-    spPhrase->uiSourceOffset = uiSourceOffset;
-    spPhrase->uiLength = uiLen;
+/** \brief Scan a memory buffer for matched phrases, calling a user function for each.
+ *
+ * Same as luiApgexStreamFile() except that the stream is a memory buffer, for example a memory-mapped file.
+ * The buffer is never copied as a whole. Only the window is converted to alphabet characters.
+ * \param vpCtx A pointer to a valid apgex object context returned from vpApgexCtor().
+ * If not valid the application will silently exit with a \ref BAD_CONTEXT exit code.
+ * \param ucpBuffer The buffer to scan. Each byte is one alphabet character.
+ * \param luiLength The number of bytes in the buffer.
+ * \param uiMaxMatch The maximum length of a matched phrase. If 0, \ref APGEX_STREAM_MAX_MATCH is used.
+ * \param pfnMatch The function to call for each matched phrase. See \ref pfn_apgex_stream.
+ * \param vpUser Pointer to user data, passed to `pfnMatch`. May be NULL.
+ * \return The number of matched phrases.
+ */
+luint luiApgexStreamBuffer(void* vpCtx, const uint8_t* ucpBuffer, luint luiLength, aint uiMaxMatch,
+        pfn_apgex_stream pfnMatch, void* vpUser){
+    apgex* spExp = (apgex*) vpCtx;
+    if(!vpCtx || (spExp->vpValidate != s_vpMagicNumber)){
+            vExContext();
+    }
+    if(!ucpBuffer && luiLength){
+        XTHROW(spExp->spException, "buffer cannot be NULL");
+    }
+    stream_src sSrc = {};
+    sSrc.ucpBuffer = ucpBuffer;
+    sSrc.luiLength = luiLength;
+    return luiStream(spExp, &sSrc, uiMaxMatch, pfnMatch, vpUser, NULL);
 }
 
-static inline char* cpBool(abool bVal){
-    if(bVal){
-        return "yes";
+/** \brief Replace the matched phrases in a source string, writing the output to a sink function as it is found.
+ *
+ * The output is the same as the phrase returned by sApgexReplace() except that
+ * the replacement phrase may not refer to the left and right contexts or the whole source
+ * (`` $` ``, `$'` and `$_`). It is written in segments to the sink function as the matches are found.
+ * It is never held in memory as a whole.
+ * The source is scanned through a window of bounded size, as for luiApgexStreamBuffer(), and is never copied as a whole.
+ * The output is the same provided that no matched phrase, look ahead or look behind extends
+ * beyond `uiMaxMatch` characters. An exception is thrown if a matched phrase is longer than `uiMaxMatch`.
+ * The search always begins at the start of the source. uiLastIndex is ignored and is zero on return.
+ * The trace mode is not supported.
+ * \param vpCtx A pointer to a valid apgex object context returned from vpApgexCtor().
+ * If not valid the application will silently exit with a \ref BAD_CONTEXT exit code.
+ * \param spSource Pointer to the source as a \ref apg_phrase.
+ * \param uiMaxMatch The maximum length of a matched phrase. If 0, \ref APGEX_STREAM_MAX_MATCH is used.
+ * \param spReplacement Pointer to the replacement phrase. See sApgexReplace() for the special characters.
+ * \param pfnSink The output function. See \ref pfn_apgex_sink.
+ * \param vpUser Pointer to user data, passed to `pfnSink`. May be NULL.
+ * \return The number of replacements made.
+ */
+luint luiApgexReplaceSink(void* vpCtx, apg_phrase* spSource, aint uiMaxMatch, apg_phrase* spReplacement,
+        pfn_apgex_sink pfnSink, void* vpUser){
+    apgex* spExp = (apgex*) vpCtx;
+    if(!vpCtx || (spExp->vpValidate != s_vpMagicNumber)){
+            vExContext();
     }
-    return "no";
+    if(!(spSource && spSource->acpPhrase && spSource->uiLength)){
+        XTHROW(spExp->spException, s_cpEmptySource);
+    }
+    stream_src sSrc = {};
+    stream_out sOut = {};
+    sSrc.acpPhrase = spSource->acpPhrase;
+    sSrc.luiLength = (luint)spSource->uiLength;
+    sOut.pfnSink = pfnSink;
+    sOut.vpUser = vpUser;
+    sOut.spReplacement = spReplacement;
+    luiStream(spExp, &sSrc, uiMaxMatch, NULL, NULL, &sOut);
+    return sOut.luiCount;
 }
 
-static void vNamePhrase(apgex* spExp, achar* acpName, aint uiNameLen, apg_phrase* spPhrase){
-    rule_r* spRule = NULL;
-    udt_r* spUdt = NULL;
-    char* cpNameStr;
-    phrase_r* spRelPhrase;
-    achar* acpSource = (achar*)vpVecFirst(spExp->vpVecSource);
-    aint ui;
-    char caBuf[BUF_SIZE];
-    void* vpVecTmp = spExp->vpVecStrings;
-    vVecClear(vpVecTmp);
-    memset(spPhrase, 0, sizeof(*spPhrase));
-    // look up name
-    for(ui = 0; ui < uiNameLen; ui++){
-        char cChar = (char)acpName[ui];
-        vpVecPush(vpVecTmp, &cChar);
+/** \brief Replace the matched phrases in a source string with user-generated phrases,
+ * writing the output to a sink function as it is found.
+ *
+ * Same as luiApgexReplaceSink() except that the replacements are generated as for sApgexReplaceFunc().
+ * In the result passed to the replacement function, the left and right contexts are NULL.
+ * In the properties, the AST pointer is NULL and the original and last sources are empty.
+ * \param vpCtx A pointer to a valid apgex object context returned from vpApgexCtor().
+ * If not valid the application will silently exit with a \ref BAD_CONTEXT exit code.
+ * \param spSource Pointer to the source as a \ref apg_phrase.
+ * \param uiMaxMatch The maximum length of a matched phrase. If 0, \ref APGEX_STREAM_MAX_MATCH is used.
+ * \param pfnFunc Pointer to the replacement function. See \ref pfn_replace.
+ * \param vpFuncUser Pointer to user data, passed to `pfnFunc`. May be NULL.
+ * \param pfnSink The output function. See \ref pfn_apgex_sink.
+ * \param vpUser Pointer to user data, passed to `pfnSink`. May be NULL.
+ * \return The number of replacements made.
+ */
+luint luiApgexReplaceFuncSink(void* vpCtx, apg_phrase* spSource, aint uiMaxMatch, pfn_replace pfnFunc, void* vpFuncUser,
+        pfn_apgex_sink pfnSink, void* vpUser){
+    apgex* spExp = (apgex*) vpCtx;
+    if(!vpCtx || (spExp->vpValidate != s_vpMagicNumber)){
+            vExContext();
     }
-    vpVecPush(vpVecTmp, &s_cZero);
-    cpNameStr = (char*)vpVecFirst(vpVecTmp);
-    spRule = spFindRule(spExp, (const char*)cpNameStr);
-    if(spRule){
-        if(spRule->bEnabled && spRule->uiFirstPhrase != APG_INFINITE){
-            spRelPhrase = (phrase_r*)vpVecAt(spExp->vpVecRelPhrases, spRule->uiFirstPhrase);
-            spPhrase->acpPhrase = &acpSource[spRelPhrase->uiSourceOffset];
-            spPhrase->uiLength = spRelPhrase->uiLength;
-        }
-        goto found;
+    if(!(spSource && spSource->acpPhrase && spSource->uiLength)){
+        XTHROW(spExp->spException, s_cpEmptySource);
     }
-    spUdt = spFindUdt(spExp, (const char*)cpNameStr);
-    if(spUdt){
-        if(spUdt->bEnabled && spUdt->uiFirstPhrase != APG_INFINITE){
-            spRelPhrase = (phrase_r*)vpVecAt(spExp->vpVecRelPhrases, spUdt->uiFirstPhrase);
-            spPhrase->acpPhrase = &acpSource[spRelPhrase->uiSourceOffset];
-            spPhrase->uiLength = spRelPhrase->uiLength;
+    if(!pfnFunc){
+        XTHROW(spExp->spException, "pfnFunc cannot be NULL");
+    }
+    stream_src sSrc = {};
+    stream_out sOut = {};
+    sSrc.acpPhrase = spSource->acpPhrase;
+    sSrc.luiLength = (luint)spSource->uiLength;
+    sOut.pfnSink = pfnSink;
+    sOut.vpUser = vpUser;
+    sOut.pfnFunc = pfnFunc;
+    sOut.vpFuncUser = vpFuncUser;
+    luiStream(spExp, &sSrc, uiMaxMatch, NULL, NULL, &sOut);
+    return sOut.luiCount;
+}
+
+/** \brief Replace the matched phrases in a file, writing the output to a sink function as it is found.
+ *
+ * Same as luiApgexReplaceSink() except that the source is a file. Files of any size can be processed with a fixed amount of memory.
+ * \param vpCtx A pointer to a valid apgex object context returned from vpApgexCtor().
+ * If not valid the application will silently exit with a \ref BAD_CONTEXT exit code.
+ * \param cpFileName The name of the file. Each byte is one alphabet character.
+ * \param uiMaxMatch The maximum length of a matched phrase. If 0, \ref APGEX_STREAM_MAX_MATCH is used.
+ * \param spReplacement Pointer to the replacement phrase. See sApgexReplace() for the special characters.
+ * \param pfnSink The output function. See \ref pfn_apgex_sink.
+ * \param vpUser Pointer to user data, passed to `pfnSink`. May be NULL.
+ * \return The number of replacements made.
+ */
+luint luiApgexReplaceFile(void* vpCtx, const char* cpFileName, aint uiMaxMatch, apg_phrase* spReplacement,
+        pfn_apgex_sink pfnSink, void* vpUser){
+    apgex* spExp = (apgex*) vpCtx;
+    if(!vpCtx || (spExp->vpValidate != s_vpMagicNumber)){
+            vExContext();
+    }
+    stream_src sSrc = {};
+    stream_out sOut = {};
+    sOut.pfnSink = pfnSink;
+    sOut.vpUser = vpUser;
+    sOut.spReplacement = spReplacement;
+    vStreamOpen(spExp, &sSrc, cpFileName);
+    luiStream(spExp, &sSrc, uiMaxMatch, NULL, NULL, &sOut);
+    vStreamClose(spExp, &sSrc);
+    return sOut.luiCount;
+}
+
+/** \brief Split a source string, writing the sub-phrases to a sink function as they are found.
+ *
+ * The sub-phrases are the same as those returned by spApgexSplit(), with the same rules for the flags,
+ * the enabled rules and `uiLimit`. Each is written as one or more \ref APGEX_SEGMENT_TEXT segments
+ * followed by an \ref APGEX_SEGMENT_END segment. The trace mode is not supported.
+ * The source is scanned through a window of bounded size, as for luiApgexReplaceSink().
+ * \param vpCtx A pointer to a valid apgex object context returned from vpApgexCtor().
+ * If not valid the application will silently exit with a \ref BAD_CONTEXT exit code.
+ * \param spSource Pointer to the source as a \ref apg_phrase.
+ * \param uiMaxMatch The maximum length of a matched phrase. If 0, \ref APGEX_STREAM_MAX_MATCH is used.
+ * \param uiLimit Places a limit on the number of pattern matches to find. If 0, all matches are found.
+ * \param pfnSink The output function. See \ref pfn_apgex_sink.
+ * \param vpUser Pointer to user data, passed to `pfnSink`. May be NULL.
+ * \return The number of sub-phrases written.
+ */
+luint luiApgexSplitSink(void* vpCtx, apg_phrase* spSource, aint uiMaxMatch, aint uiLimit,
+        pfn_apgex_sink pfnSink, void* vpUser){
+    apgex* spExp = (apgex*) vpCtx;
+    if(!vpCtx || (spExp->vpValidate != s_vpMagicNumber)){
+            vExContext();
+    }
+    if(!(spSource && spSource->acpPhrase && spSource->uiLength)){
+        XTHROW(spExp->spException, s_cpEmptySource);
+    }
+    stream_src sSrc = {};
+    stream_out sOut = {};
+    sSrc.acpPhrase = spSource->acpPhrase;
+    sSrc.luiLength = (luint)spSource->uiLength;
+    sOut.pfnSink = pfnSink;
+    sOut.vpUser = vpUser;
+    sOut.bSplit = APG_TRUE;
+    sOut.uiLimit = uiLimit ? uiLimit : APG_MAX_AINT;
+    luiStream(spExp, &sSrc, uiMaxMatch, NULL, NULL, &sOut);
+    return sOut.luiCount;
+}
+
+/** \brief Split a file, writing the sub-phrases to a sink function as they are found.
+ *
+ * Same as luiApgexSplitSink() except that the source is a file. Files of any size can be processed with a fixed amount of memory.
+ * \param vpCtx A pointer to a valid apgex object context returned from vpApgexCtor().
+ * If not valid the application will silently exit with a \ref BAD_CONTEXT exit code.
+ * \param cpFileName The name of the file. Each byte is one alphabet character.
+ * \param uiMaxMatch The maximum length of a matched phrase. If 0, \ref APGEX_STREAM_MAX_MATCH is used.
+ * \param uiLimit Places a limit on the number of pattern matches to find. If 0, all matches are found.
+ * \param pfnSink The output function. See \ref pfn_apgex_sink.
+ * \param vpUser Pointer to user data, passed to `pfnSink`. May be NULL.
+ * \return The number of sub-phrases written.
+ */
+luint luiApgexSplitFile(void* vpCtx, const char* cpFileName, aint uiMaxMatch, aint uiLimit,
+        pfn_apgex_sink pfnSink, void* vpUser){
+    apgex* spExp = (apgex*) vpCtx;
+    if(!vpCtx || (spExp->vpValidate != s_vpMagicNumber)){
+            vExContext();
+    }
+    stream_src sSrc = {};
+    stream_out sOut = {};
+    sOut.pfnSink = pfnSink;
+    sOut.vpUser = vpUser;
+    sOut.bSplit = APG_TRUE;
+    sOut.uiLimit = uiLimit ? uiLimit : APG_MAX_AINT;
+    vStreamOpen(spExp, &sSrc, cpFileName);
+    luiStream(spExp, &sSrc, uiMaxMatch, NULL, NULL, &sOut);
+    vStreamClose(spExp, &sSrc);
+    return sOut.luiCount;
+}
+
+/** \brief A ready-made sink function that writes the output to an open file.
+ *
+ * Each alphabet character is written as a single byte, the inverse of the way files are read by
+ * luiApgexReplaceFile() and luiApgexSplitFile(). Characters larger than 0xFF are truncated.
+ * An \ref APGEX_SEGMENT_END segment is written as a line feed, so that each sub-phrase of a split is on its own line.
+ * \param spSegment The segment to write.
+ * \param uiType The segment type.
+ * \param vpUser The open file, as a FILE pointer. May be stdout.
+ */
+void vApgexSinkFile(apg_phrase* spSegment, aint uiType, void* vpUser){
+    FILE* spFile = (FILE*)vpUser;
+    if(uiType == APGEX_SEGMENT_END){
+        fputc('\n', spFile);
+    }else if(sizeof(achar) == 1){
+        fwrite((const void*)spSegment->acpPhrase, 1, (size_t)spSegment->uiLength, spFile);
+    }else{
+        aint ui;
+        for(ui = 0; ui < spSegment->uiLength; ui++){
+            fputc((int)(uint8_t)spSegment->acpPhrase[ui], spFile);
         }
-        goto found;
     }
-    snprintf(caBuf, BUF_SIZE, "replacement error: &<%s> not a valid rule or UDT name", (char*)cpNameStr);
-    vVecClear(vpVecTmp);
-    XTHROW(spExp->spException, caBuf);
-    found:;
-    vVecClear(vpVecTmp);
 }
-static void vReplaceFunc(apgex* spExp, apgex_result* spResult, pfn_replace pfnFunc, void* vpUser){
-    vVecClear(spExp->vpVecReplacement);
-    apgex_properties sProps = sApgexProperties(spExp);
-    apg_phrase sPhrase = pfnFunc(spResult, &sProps, vpUser);
-    if(sPhrase.acpPhrase && sPhrase.uiLength){
-        vpVecPushn(spExp->vpVecReplacement, (void*)sPhrase.acpPhrase, sPhrase.uiLength);
+
+/** \brief Scan a record-oriented memory buffer for matched phrases with several threads, calling a user function for each.
+ *
+ * The buffer is divided into chunks, each ending just after a record delimiter.
+ * Worker threads, each with its own parser constructed from the compiled pattern, take the chunks in turn
+ * and scan them for all matches, as in global mode. The calling thread is one of the workers.
+ * When all chunks have been scanned, the matched phrases are merged and `pfnMatch` is called for each,
+ * in offset order, on the calling thread.
+ * A matched phrase may run past the end of its chunk. The beginning of the next chunk is then re-scanned
+ * on the calling thread until the scan is back in step with the worker's.
+ * The matched phrases and the order in which they are reported are therefore the same as for luiApgexStreamBuffer()
+ * with the same `uiMaxMatch`, whatever the delimiter and the number of threads.
+ * The delimiter only puts the chunk boundaries where matched phrases are least likely to cross them.
+ *
+ * If any rules or UDTs are enabled, each matched phrase is parsed again on the calling thread to capture their phrases.
+ * Note that UDT callback functions are called from the worker threads and must be thread safe.
+ * The matched phrases are held in memory, 24 bytes or so each, until all chunks have been scanned.
+ * If `pfnMatch` returns false, no more phrases are reported. The entire buffer will have been scanned by then.
+ *
+ * In sticky mode, or if the pattern parser was supplied with vApgexPatternParser(), the scan is not divided
+ * and this is the same as luiApgexStreamBuffer(). The trace mode is not supported.
+ * uiLastIndex is ignored and is zero on return.
+ * \param vpCtx A pointer to a valid apgex object context returned from vpApgexCtor().
+ * If not valid the application will silently exit with a \ref BAD_CONTEXT exit code.
+ * \param ucpBuffer The buffer to scan, for example a memory-mapped file. Each byte is one alphabet character.
+ * \param luiLength The number of bytes in the buffer.
+ * \param cpDelimiter The record delimiter, a null-terminated string of bytes, for example "\n" or "\r\n".
+ * If NULL or empty, the chunks end wherever their nominal lengths put them.
+ * \param uiThreads The number of worker threads, including the calling thread.
+ * If 0, the number of online processors. At most \ref APGEX_PARALLEL_MAX_THREADS.
+ * \param uiMaxMatch The maximum length of a matched phrase. If 0, \ref APGEX_STREAM_MAX_MATCH is used.
+ * \param pfnMatch The function to call for each matched phrase. See \ref pfn_apgex_stream.
+ * \param vpUser Pointer to user data, passed to `pfnMatch`. May be NULL.
+ * \return The number of matched phrases reported.
+ */
+luint luiApgexParallelBuffer(void* vpCtx, const uint8_t* ucpBuffer, luint luiLength, const char* cpDelimiter,
+        aint uiThreads, aint uiMaxMatch, pfn_apgex_stream pfnMatch, void* vpUser){
+    apgex* spExp = (apgex*) vpCtx;
+    if(!vpCtx || (spExp->vpValidate != s_vpMagicNumber)){
+            vExContext();
     }
+    if(!ucpBuffer && luiLength){
+        XTHROW(spExp->spException, "buffer cannot be NULL");
+    }
+    if(spExp->bStickyMode || !spExp->spCacheEntry){
+        // sticky scans are sequential and external parsers can't be copied for the workers
+        stream_src sSrc = {};
+        sSrc.ucpBuffer = ucpBuffer;
+        sSrc.luiLength = luiLength;
+        return luiStream(spExp, &sSrc, uiMaxMatch, pfnMatch, vpUser, NULL);
+    }
+    return luiParallel(spExp, ucpBuffer, luiLength, cpDelimiter, uiThreads, uiMaxMatch, pfnMatch, vpUser);
 }
 
-static void vReplacement(apgex* spExp, apgex_result* spResult){
-    // the raw replacement achar array is in vpVecReplaceRaw
-    // make the substituted replacement achar array is in vpVecReplacement
-    // make the string version of the substituted replacement achar array is in vpVecReplaceString
-    vVecClear(spExp->vpVecReplacement);
-    achar* acpRaw = (achar*)vpVecFirst(spExp->vpVecReplaceRaw);
-    aint uiRawLen = uiVecLen(spExp->vpVecReplaceRaw);
-    aint ui, uii, uj, uiNameLen;
-    apg_phrase *spMatch, *spLeft, *spRight;
-    char caBuf[BUF_SIZE];
-    if(uiRawLen > 1){
-        ui = 0;
-        uii = 1;
-        spMatch = &spResult->spResult->sPhrase;
-        spLeft = &spResult->spLeftContext->sPhrase;
-        spRight = &spResult->spRightContext->sPhrase;
-        while(ui < uiRawLen){
-            while(APG_TRUE){
-                if(acpRaw[ui] == DOLLAR){
-                    if(uii >= uiRawLen){
-                        XTHROW(spExp->spException, "replacement error: $ found at end of string - must be $`, $&, $', $$ or $<rulename>");
-                    }
-                    if(acpRaw[uii] == DOLLAR){
-                        vpVecPush(spExp->vpVecReplacement, &acpRaw[ui]);
-                        ui += 2;
-                        uii += 2;
-                        break;
-                    }
-                    if(acpRaw[uii] == UNDER){
-                        if(spMatch->uiLength){
-                            vpVecPushn(spExp->vpVecReplacement, vpVecFirst(spExp->vpVecOriginalSource), uiVecLen(spExp->vpVecOriginalSource));
-                        }
-                        ui += 2;
-                        uii += 2;
-                        break;
-                    }
-                    if(acpRaw[uii] == AMP){
-                        if(spMatch->uiLength){
-                            vpVecPushn(spExp->vpVecReplacement, (void*)spMatch->acpPhrase, spMatch->uiLength);
-                        }
-                        ui += 2;
-                        uii += 2;
-                        break;
+/** \brief The pattern set object constructor.
+ *
+ * A pattern set matches a number of SABNF patterns against a source string in a single pass.
+ * The patterns are compiled together into a single combined grammar and parser.
+ * At each offset of the source string, only the patterns whose start rules can begin with the character
+ * at that offset are attempted. The results report which patterns matched at which offsets.
+ *
+ * Patterns are added with uiApgexSetAdd() and compiled with vApgexSetCompile().
+ * Individual patterns can be enabled and disabled at any time with vApgexSetEnable().
+ * \param spEx Pointer to a valid exception structure initialized with \ref XCTOR().
+ * If not valid the application will silently exit with a \ref BAD_CONTEXT exit code.
+ * \return Returns a pointer to the pattern set object context.
+ */
+void* vpApgexSetCtor(exception* spEx){
+    if(!bExValidate(spEx)){
+        vExContext();
+    }
+    BKR_APGEX_CHECK(spEx);
+    void* vpMem = vpMemCtor(spEx);
+    apgex_set* spSet = (apgex_set*) vpMemAlloc(vpMem, sizeof(apgex_set));
+    memset((void*) spSet, 0, sizeof(apgex_set));
+    spSet->vpMem = vpMem;
+    spSet->spException = spEx;
+    spSet->vpApi = vpApiCtor(spEx);
+    spSet->vpFmt = vpFmtCtor(spEx);
+    spSet->vpVecPatterns = vpVecCtor(vpMem, sizeof(set_pattern), 32);
+    spSet->vpVecText = vpVecCtor(vpMem, sizeof(char), 4096);
+    spSet->vpVecNames = vpVecCtor(vpMem, sizeof(char), 512);
+    spSet->vpVecGrammar = vpVecCtor(vpMem, sizeof(char), 4096);
+    spSet->vpVecDispatch = vpVecCtor(vpMem, sizeof(aint), 1024);
+    spSet->vpVecDispatchIndex = vpVecCtor(vpMem, sizeof(aint), 256);
+    spSet->vpVecAll = vpVecCtor(vpMem, sizeof(aint), 32);
+    spSet->vpVecMatches = vpVecCtor(vpMem, sizeof(apgex_set_match), 256);
+    spSet->vpVecMatched = vpVecCtor(vpMem, sizeof(abool), 32);
+    spSet->vpValidate = s_vpSetMagicNumber;
+    s_cpEndian = bIsBigEndian() ? "big" : "little";
+    return (void*) spSet;
+}
+
+/** \brief The pattern set object destructor.
+ * \param vpCtx A pointer to a valid pattern set object context returned from vpApgexSetCtor().
+ * Silently ignores a NULL pointer, but exits the application with \ref BAD_CONTEXT exit code
+ * if the pointer is non-NULL and not a valid pattern set object context pointer.
+ */
+void vApgexSetDtor(void* vpCtx){
+    if(vpCtx){
+        apgex_set* spSet = (apgex_set*) vpCtx;
+        if(spSet->vpValidate != s_vpSetMagicNumber){
+            vExContext(); // does not return
+        }
+        void* vpMem = spSet->vpMem;
+        vSetClear(spSet);
+        vApiDtor(spSet->vpApi);
+        vFmtDtor(spSet->vpFmt);
+        memset(vpCtx, 0, sizeof(apgex_set));
+        vMemDtor(vpMem);
+    }
+}
+
+/** \brief Add a pattern to the pattern set.
+ *
+ * The pattern is a complete SABNF grammar, exactly as for vApgexPattern(). Its first rule is its start rule.
+ * Each pattern's rule names are private to it. That is, different patterns may use the same rule names
+ * with different definitions. UDTs are not supported.
+ * Adding a pattern discards any previous compilation. vApgexSetCompile() must be called again before matching.
+ * \param vpCtx A pointer to a valid pattern set object context returned from vpApgexSetCtor().
+ * If not valid the application will silently exit with a \ref BAD_CONTEXT exit code.
+ * \param cpPattern The SABNF grammar defining the pattern.
+ * \return The index of the pattern in the set. Patterns are indexed in the order they are added, beginning with 0.
+ */
+aint uiApgexSetAdd(void* vpCtx, const char* cpPattern){
+    apgex_set* spSet = (apgex_set*) vpCtx;
+    if(!vpCtx || (spSet->vpValidate != s_vpSetMagicNumber)){
+        vExContext(); // does not return
+    }
+    if(!cpPattern || !cpPattern[0]){
+        XTHROW(spSet->spException, "pattern cannot be NULL or empty");
+    }
+    set_pattern sPattern = {};
+    vSetClear(spSet);
+    sPattern.uiTextOffset = uiVecLen(spSet->vpVecText);
+    sPattern.bEnabled = APG_TRUE;
+    vpVecPushn(spSet->vpVecText, (void*)cpPattern, (aint)(strlen(cpPattern) + 1));
+    vpVecPush(spSet->vpVecPatterns, (void*)&sPattern);
+    return uiVecLen(spSet->vpVecPatterns) - 1;
+}
+
+/** \brief Compile the patterns of the set into a single parser.
+ *
+ * The rules of each pattern are renamed with a prefix unique to the pattern
+ * and all patterns are combined into a single grammar.
+ * The combined grammar is always compiled with PPPTs, so that the start rule's map of each pattern can be used to
+ * dispatch on the first character. Compiled grammars are kept in the process-wide cache. See vApgexCacheSize().
+ * \param vpCtx A pointer to a valid pattern set object context returned from vpApgexSetCtor().
+ * If not valid the application will silently exit with a \ref BAD_CONTEXT exit code.
+ * \param cpFlags A string of flags that control the matching behavior.
+ *  - NULL or empty string - all matches<br>
+ *  At each offset of the source string, every enabled pattern is attempted. All matches are reported,
+ *  so that matches of different patterns, and of the same pattern at different offsets, may overlap.
+ *  - f - first match<br>
+ *  At each offset, the enabled patterns are attempted in order and only the first matching pattern is reported.
+ *  The search resumes at the first character following the matched phrase.
+ *  This is the behavior of an ordered ALT of the patterns' start rules applied in global mode.
+ *
+ *  In either case empty phrases are not reported as matches.
+ */
+void vApgexSetCompile(void* vpCtx, const char* cpFlags){
+    apgex_set* spSet = (apgex_set*) vpCtx;
+    if(!vpCtx || (spSet->vpValidate != s_vpSetMagicNumber)){
+        vExContext(); // does not return
+    }
+    vSetClear(spSet);
+    if(!uiVecLen(spSet->vpVecPatterns)){
+        XTHROW(spSet->spException, "pattern set has no patterns - use uiApgexSetAdd()");
+    }
+    spSet->bFirst = APG_FALSE;
+    if(cpFlags){
+        for(; *cpFlags; cpFlags++){
+            if(*cpFlags == 'f'){
+                spSet->bFirst = APG_TRUE;
+            }else{
+                char caBuf[BUF_SIZE];
+                snprintf(caBuf, BUF_SIZE, "pattern set flag '%c' not recognized", *cpFlags);
+                XTHROW(spSet->spException, caBuf);
+            }
+        }
+    }
+
+    // compile the combined grammar
+    vSetGrammar(spSet);
+    const char* cpGrammar = (const char*)vpVecFirst(spSet->vpVecGrammar);
+    vApiInClear(spSet->vpApi);
+    cache_entry* spEntry = spCacheGet(cpGrammar, APG_TRUE);
+    if(!spEntry){
+        cpApiInString(spSet->vpApi, cpGrammar);
+        vApiInValidate(spSet->vpApi, APG_FALSE);
+        vApiSyntax(spSet->vpApi, APG_FALSE);
+        vApiOpcodes(spSet->vpApi);
+        bApiAttrs(spSet->vpApi);
+        vApiPppt(spSet->vpApi, NULL, 0);
+        spEntry = spCachePut(spSet->spException, cpGrammar, APG_TRUE, vpApiOutputParserInit(spSet->vpApi));
+    }
+    spSet->spCacheEntry = spEntry;
+    spSet->vpParser = vpParserCtor(spSet->spException, spEntry->vpParserInit);
+    if(((parser*)spSet->vpParser)->uiUdtCount){
+        XTHROW(spSet->spException, "UDTs are not supported in pattern sets");
+    }
+
+    // find the start rules and build the first-character dispatch table
+    set_pattern* spPattern = (set_pattern*)vpVecFirst(spSet->vpVecPatterns);
+    aint uiCount = uiVecLen(spSet->vpVecPatterns);
+    const char* cpNames = (const char*)vpVecFirst(spSet->vpVecNames);
+    aint ui = 0;
+    for(; ui < uiCount; ui++, spPattern++){
+        spPattern->uiStartRule = uiParserRuleLookup(spSet->vpParser, &cpNames[spPattern->uiNameOffset]);
+        if(spPattern->uiStartRule == APG_UNDEFINED){
+            char caBuf[BUF_SIZE];
+            snprintf(caBuf, BUF_SIZE, "pattern %"PRIuMAX" has no start rule", (luint)ui);
+            XTHROW(spSet->spException, caBuf);
+        }
+        spPattern->ucpFirstMap = ((parser*)spSet->vpParser)->spRules[spPattern->uiStartRule].ucpPpptMap;
+        vpVecPush(spSet->vpVecAll, (void*)&ui);
+    }
+    vSetDispatch(spSet);
+}
+
+/** \brief Enable or disable a pattern of the set.
+ *
+ * Disabled patterns are not attempted. All patterns are enabled when added.
+ * May be called at any time. It does not require recompiling the set.
+ * \param vpCtx A pointer to a valid pattern set object context returned from vpApgexSetCtor().
+ * If not valid the application will silently exit with a \ref BAD_CONTEXT exit code.
+ * \param uiPattern The index of the pattern, as returned from uiApgexSetAdd().
+ * \param bEnable If true, enable the pattern, if false, disable it.
+ */
+void vApgexSetEnable(void* vpCtx, aint uiPattern, abool bEnable){
+    apgex_set* spSet = (apgex_set*) vpCtx;
+    if(!vpCtx || (spSet->vpValidate != s_vpSetMagicNumber)){
+        vExContext(); // does not return
+    }
+    set_pattern* spPattern = (set_pattern*)vpVecAt(spSet->vpVecPatterns, uiPattern);
+    if(!spPattern){
+        char caBuf[BUF_SIZE];
+        snprintf(caBuf, BUF_SIZE, "pattern index %"PRIuMAX" out of range", (luint)uiPattern);
+        XTHROW(spSet->spException, caBuf);
+    }
+    spPattern->bEnabled = bEnable ? APG_TRUE : APG_FALSE;
+}
+
+/** \brief Match all enabled patterns of the set against a source string.
+ *
+ * The source string is scanned once. At each offset, the patterns that can begin with the character
+ * there are attempted in pattern order. See vApgexSetCompile() for the flags that determine
+ * which matches are reported.
+ * \param vpCtx A pointer to a valid pattern set object context returned from vpApgexSetCtor().
+ * If not valid the application will silently exit with a \ref BAD_CONTEXT exit code.
+ * \param spSource The source string to search.
+ * \return The matched phrases and the patterns matched. See \ref apgex_set_result.
+ */
+apgex_set_result sApgexSetExec(void* vpCtx, apg_phrase* spSource){
+    apgex_set* spSet = (apgex_set*) vpCtx;
+    if(!vpCtx || (spSet->vpValidate != s_vpSetMagicNumber)){
+        vExContext(); // does not return
+    }
+    if(!spSet->vpParser){
+        XTHROW(spSet->spException, "pattern set not compiled - use vApgexSetCompile()");
+    }
+    if(!spSource || !spSource->acpPhrase){
+        XTHROW(spSet->spException, "source phrase cannot be NULL");
+    }
+    apgex_set_result sResult = {};
+    parser_config sConfig = {};
+    parser_state sState;
+    parser* spParser = (parser*)spSet->vpParser;
+    set_pattern* spPatterns = (set_pattern*)vpVecFirst(spSet->vpVecPatterns);
+    aint uiPatternCount = uiVecLen(spSet->vpVecPatterns);
+    const aint* uipDispatch = (const aint*)vpVecFirst(spSet->vpVecDispatch);
+    const aint* uipIndex = (const aint*)vpVecFirst(spSet->vpVecDispatchIndex);
+    const aint* uipCandidates;
+    aint uiCandidates, uiOffset, uiNext, ui;
+    abool* bpMatched;
+    abool bInput = APG_FALSE;
+    achar acChar;
+    set_pattern* spPattern;
+    apgex_set_match sMatch;
+    vVecClear(spSet->vpVecMatches);
+    vVecClear(spSet->vpVecMatched);
+    bpMatched = (abool*)vpVecPushn(spSet->vpVecMatched, NULL, uiPatternCount);
+    memset((void*)bpMatched, 0, (sizeof(abool) * uiPatternCount));
+    sConfig.acpInput = spSource->acpPhrase;
+    sConfig.uiInputLength = spSource->uiLength;
+    sConfig.bParseSubString = APG_TRUE;
+    uiOffset = 0;
+    while(uiOffset < spSource->uiLength){
+        // get the candidate patterns for the character at this offset
+        acChar = spSource->acpPhrase[uiOffset];
+        if(uipIndex){
+            if((acChar < spParser->acAcharMin) || (acChar > spParser->acAcharMax)){
+                uiOffset++;
+                continue;
+            }
+            uiCandidates = uipIndex[acChar - spParser->acAcharMin + 1] - uipIndex[acChar - spParser->acAcharMin];
+            uipCandidates = uiCandidates ? &uipDispatch[uipIndex[acChar - spParser->acAcharMin]] : NULL;
+        }else{
+            uipCandidates = (const aint*)vpVecFirst(spSet->vpVecAll);
+            uiCandidates = uiPatternCount;
+        }
+        uiNext = uiOffset + 1;
+        for(ui = 0; ui < uiCandidates; ui++){
+            spPattern = &spPatterns[uipCandidates[ui]];
+            if(!spPattern->bEnabled){
+                continue;
+            }
+            sConfig.uiStartRule = spPattern->uiStartRule;
+            sConfig.uiSubStringBeg = uiOffset;
+            if(bInput){
+                vParserReparse(spSet->vpParser, &sConfig, &sState);
+            }else{
+                vParserParse(spSet->vpParser, &sConfig, &sState);
+                bInput = APG_TRUE;
+            }
+            // empty phrases are not reported, as if the pattern had not matched
+            if((sState.uiState == ID_MATCH) && sState.uiPhraseLength){
+                sMatch.uiPattern = uipCandidates[ui];
+                sMatch.sPhrase.uiPhraseOffset = uiOffset;
+                sMatch.sPhrase.sPhrase.acpPhrase = &spSource->acpPhrase[uiOffset];
+                sMatch.sPhrase.sPhrase.uiLength = sState.uiPhraseLength;
+                vpVecPush(spSet->vpVecMatches, (void*)&sMatch);
+                if(!bpMatched[sMatch.uiPattern]){
+                    bpMatched[sMatch.uiPattern] = APG_TRUE;
+                    sResult.uiPatternsMatched++;
+                }
+                if(spSet->bFirst){
+                    uiNext = uiOffset + sState.uiPhraseLength;
+                    break;
+                }
+            }
+        }
+        uiOffset = uiNext;
+    }
+    sResult.spMatches = (apgex_set_match*)vpVecFirst(spSet->vpVecMatches);
+    sResult.uiMatchCount = uiVecLen(spSet->vpVecMatches);
+    sResult.bpMatched = bpMatched;
+    sResult.uiPatternCount = uiPatternCount;
+    return sResult;
+}
+
+/** \brief Display the results of a pattern set match.
+ * \param vpCtx A pointer to a valid pattern set object context returned from vpApgexSetCtor().
+ * If not valid the application will silently exit with a \ref BAD_CONTEXT exit code.
+ * \param spResult Pointer to the results, the return from sApgexSetExec().
+ * \param cpFileName The file to display the output to. If NULL, stdout is used.
+ */
+void vApgexSetDisplayResult(void* vpCtx, apgex_set_result* spResult, const char* cpFileName){
+    apgex_set* spSet = (apgex_set*) vpCtx;
+    if(!vpCtx || (spSet->vpValidate != s_vpSetMagicNumber)){
+        vExContext();
+    }
+    if(!spResult){
+        XTHROW(spSet->spException, "result to display, spResult, cannot be NULL");
+    }
+    FILE* spOut = stdout;
+    aint ui;
+    if(cpFileName){
+        spOut = fopen(cpFileName, "wb");
+        if(!spOut){
+            char caBuf[BUF_SIZE];
+            snprintf(caBuf, BUF_SIZE, "can't open file %s for writing", cpFileName);
+            XTHROW(spSet->spException, caBuf);
+        }
+    }
+    fprintf(spOut, "    patterns: %"PRIuMAX"\n", (luint)spResult->uiPatternCount);
+    fprintf(spOut, "     matched: %"PRIuMAX"\n", (luint)spResult->uiPatternsMatched);
+    for(ui = 0; ui < spResult->uiPatternCount; ui++){
+        if(spResult->bpMatched[ui]){
+            fprintf(spOut, "   pattern %"PRIuMAX": matched\n", (luint)ui);
+        }
+    }
+    fprintf(spOut, "     phrases: %"PRIuMAX"\n", (luint)spResult->uiMatchCount);
+    for(ui = 0; ui < spResult->uiMatchCount; ui++){
+        fprintf(spOut, "   pattern %"PRIuMAX": ", (luint)spResult->spMatches[ui].uiPattern);
+        vPrintPhrase(spSet->vpFmt, &spResult->spMatches[ui].sPhrase, spOut);
+    }
+    if(spOut != stdout){
+        fclose(spOut);
+    }
+}
+
+/** \brief Display any errors from compiling the pattern set.
+ *
+ * The line numbers in the error messages refer to the combined grammar, which is displayed following them.
+ * \param vpCtx A pointer to a valid pattern set object context returned from vpApgexSetCtor().
+ * If not valid the application will silently exit with a \ref BAD_CONTEXT exit code.
+ * \param cpFileName The file to display the output to. If NULL, stdout is used.
+ */
+void vApgexSetDisplayPatternErrors(void* vpCtx, const char* cpFileName){
+    apgex_set* spSet = (apgex_set*) vpCtx;
+    if(!vpCtx || (spSet->vpValidate != s_vpSetMagicNumber)){
+        vExContext();
+    }
+    FILE* spOut = stdout;
+    if(cpFileName){
+        spOut = fopen(cpFileName, "wb");
+        if(!spOut){
+            char caBuf[BUF_SIZE];
+            snprintf(caBuf, BUF_SIZE, "can't open file %s for writing", cpFileName);
+            XTHROW(spSet->spException, caBuf);
+        }
+    }
+    void* vpMsgs = vpApiGetErrorLog(spSet->vpApi);
+    if(!bMsgsValidate(vpMsgs)){
+        vExContext();
+    }
+    const char* cpMsg = cpMsgsFirst(vpMsgs);
+    if(cpMsg){
+        while(cpMsg){
+            fprintf(spOut, "%s\n", cpMsg);
+            cpMsg = cpMsgsNext(vpMsgs);
+        }
+        const char* cpGrammar = (const char*)vpVecFirst(spSet->vpVecGrammar);
+        if(cpGrammar){
+            aint uiLine = 0;
+            fprintf(spOut, "\ncombined grammar:\n");
+            while(*cpGrammar){
+                const char* cpEnd = strchr(cpGrammar, '\n');
+                int iLen = cpEnd ? (int)(cpEnd - cpGrammar) : (int)strlen(cpGrammar);
+                fprintf(spOut, "%4"PRIuMAX": %.*s\n", (luint)uiLine++, iLen, cpGrammar);
+                cpGrammar += cpEnd ? (iLen + 1) : iLen;
+            }
+        }
+    }
+    if(spOut != stdout){
+        fclose(spOut);
+    }
+}
+
+//  ///////////////////////////////////////////////////////////////////////////////
+//      STATIC FUNCTIONS
+//  ///////////////////////////////////////////////////////////////////////////////
+static inline void vMakeAbsPhrase(apgex* spExp, phrase_r* spRelPhrase, apgex_phrase* spAbsPhrase){
+    spAbsPhrase->sPhrase.acpPhrase = (achar*)vpVecFirst(spExp->vpVecSource) + spRelPhrase->uiSourceOffset;
+    spAbsPhrase->sPhrase.uiLength = spRelPhrase->uiLength;
+    spAbsPhrase->uiPhraseOffset = spRelPhrase->uiSourceOffset;
+}
+
+static inline void vMakeRelPhrase(apgex* spExp, aint uiSourceOffset, aint uiLen, phrase_r* spPhrase){
+    spPhrase->uiSourceOffset = uiSourceOffset;
+    spPhrase->uiLength = uiLen;
+}
+
+static inline char* cpBool(abool bVal){
+    if(bVal){
+        return "yes";
+    }
+    return "no";
+}
+
+static void vNamePhrase(apgex* spExp, achar* acpName, aint uiNameLen, apg_phrase* spPhrase){
+    rule_r* spRule = NULL;
+    udt_r* spUdt = NULL;
+    char* cpNameStr;
+    phrase_r* spRelPhrase;
+    achar* acpSource = (achar*)vpVecFirst(spExp->vpVecSource);
+    aint ui;
+    char caBuf[BUF_SIZE];
+    void* vpVecTmp = spExp->vpVecStrings;
+    vVecClear(vpVecTmp);
+    memset(spPhrase, 0, sizeof(*spPhrase));
+    // look up name
+    for(ui = 0; ui < uiNameLen; ui++){
+        char cChar = (char)acpName[ui];
+        vpVecPush(vpVecTmp, &cChar);
+    }
+    vpVecPush(vpVecTmp, &s_cZero);
+    cpNameStr = (char*)vpVecFirst(vpVecTmp);
+    spRule = spFindRule(spExp, (const char*)cpNameStr);
+    if(spRule){
+        if(spRule->bEnabled && spRule->uiFirstPhrase != APG_INFINITE){
+            spRelPhrase = (phrase_r*)vpVecAt(spExp->vpVecRelPhrases, spRule->uiFirstPhrase);
+            spPhrase->acpPhrase = &acpSource[spRelPhrase->uiSourceOffset];
+            spPhrase->uiLength = spRelPhrase->uiLength;
+        }
+        goto found;
+    }
+    spUdt = spFindUdt(spExp, (const char*)cpNameStr);
+    if(spUdt){
+        if(spUdt->bEnabled && spUdt->uiFirstPhrase != APG_INFINITE){
+            spRelPhrase = (phrase_r*)vpVecAt(spExp->vpVecRelPhrases, spUdt->uiFirstPhrase);
+            spPhrase->acpPhrase = &acpSource[spRelPhrase->uiSourceOffset];
+            spPhrase->uiLength = spRelPhrase->uiLength;
+        }
+        goto found;
+    }
+    snprintf(caBuf, BUF_SIZE, "replacement error: &<%s> not a valid rule or UDT name", (char*)cpNameStr);
+    vVecClear(vpVecTmp);
+    XTHROW(spExp->spException, caBuf);
+    found:;
+    vVecClear(vpVecTmp);
+}
+static void vReplaceFunc(apgex* spExp, apgex_result* spResult, pfn_replace pfnFunc, void* vpUser){
+    vVecClear(spExp->vpVecReplacement);
+    apgex_properties sProps = sApgexProperties(spExp);
+    apg_phrase sPhrase = pfnFunc(spResult, &sProps, vpUser);
+    if(sPhrase.acpPhrase && sPhrase.uiLength){
+        vpVecPushn(spExp->vpVecReplacement, (void*)sPhrase.acpPhrase, sPhrase.uiLength);
+    }
+}
+
+static void vReplacement(apgex* spExp, apgex_result* spResult){
+    // the raw replacement achar array is in vpVecReplaceRaw
+    // make the substituted replacement achar array is in vpVecReplacement
+    // make the string version of the substituted replacement achar array is in vpVecReplaceString
+    vVecClear(spExp->vpVecReplacement);
+    achar* acpRaw = (achar*)vpVecFirst(spExp->vpVecReplaceRaw);
+    aint uiRawLen = uiVecLen(spExp->vpVecReplaceRaw);
+    aint ui, uii, uj, uiNameLen;
+    apg_phrase *spMatch, *spLeft, *spRight;
+    char caBuf[BUF_SIZE];
+    if(uiRawLen){
+        ui = 0;
+        uii = 1;
+        spMatch = &spResult->spResult->sPhrase;
+        spLeft = &spResult->spLeftContext->sPhrase;
+        spRight = &spResult->spRightContext->sPhrase;
+        while(ui < uiRawLen){
+            while(APG_TRUE){
+                if(acpRaw[ui] == DOLLAR){
+                    if(uii >= uiRawLen){
+                        XTHROW(spExp->spException, "replacement error: $ found at end of string - must be $`, $&, $', $$ or $<rulename>");
+                    }
+                    if(acpRaw[uii] == DOLLAR){
+                        vpVecPush(spExp->vpVecReplacement, &acpRaw[ui]);
+                        ui += 2;
+                        uii += 2;
+                        break;
+                    }
+                    if(acpRaw[uii] == UNDER){
+                        if(spMatch->uiLength){
+                            vpVecPushn(spExp->vpVecReplacement, vpVecFirst(spExp->vpVecOriginalSource), uiVecLen(spExp->vpVecOriginalSource));
+                        }
+                        ui += 2;
+                        uii += 2;
+                        break;
+                    }
+                    if(acpRaw[uii] == AMP){
+                        if(spMatch->uiLength){
+                            vpVecPushn(spExp->vpVecReplacement, (void*)spMatch->acpPhrase, spMatch->uiLength);
+                        }
+                        ui += 2;
+                        uii += 2;
+                        break;
                     }
                     if(acpRaw[uii] == ACCENT){
                         if(spLeft->uiLength){
@@ -1411,6 +2401,7 @@ static void vReplace(apgex* spExp, apgex_result* spResult){
     apg_phrase *spLeft = &spResult->spLeftContext->sPhrase;
     apg_phrase *spRight = &spResult->spRightContext->sPhrase;
     uiReplaceLen = uiVecLen(spExp->vpVecReplacement);
+    spExp->bParserInput = APG_FALSE;
     if(spRight->uiLength){
         // save right context
         uiRight = uiVecLen(spExp->vpVecReplacement);
@@ -1438,10 +2429,16 @@ static void vReplace(apgex* spExp, apgex_result* spResult){
 
 static void vExecResult(apgex* spExp, apgex_result* spResult){
     parser_config sConfig = {};
+    if(spExp->vpExternalParser){
+        // the application may have used its parser for other input since the last match
+        spExp->bParserInput = APG_FALSE;
+    }
     while(APG_TRUE){
         sConfig.uiInputLength = uiVecLen(spExp->vpVecSource);
         if(spExp->uiLastIndex >= sConfig.uiInputLength){
             // no match - no substring to parse
+            // (the replace loops would otherwise see the previous result again)
+            memset((void*)spResult, 0, sizeof(*spResult));
             break;
         }
 
@@ -1479,6 +2476,10 @@ static void vExecResult(apgex* spExp, apgex_result* spResult){
 static abool bExecTest(apgex* spExp){
     abool bReturn = APG_FALSE;
     parser_config sConfig = {};
+    if(spExp->vpExternalParser){
+        // the application may have used its parser for other input since the last match
+        spExp->bParserInput = APG_FALSE;
+    }
     while(APG_TRUE){
         sConfig.uiInputLength = uiVecLen(spExp->vpVecSource);
         if(spExp->uiLastIndex >= sConfig.uiInputLength){
@@ -1580,29 +2581,191 @@ static void vDecodeFlags(apgex* spExp, const char* cpFlags){
     }
 }
 
-static void vConstructParser(apgex* spExp){
-    char* cpPattern = (char*)vpVecFirst(spExp->vpVecPattern);
-    aint uiPatternLen = (aint)strlen(cpPattern);
-    if(!cpPattern || (uiPatternLen <= 1)){
-        XTHROW(spExp->spException, "attmpting to construct the parser but the pattern is not yet defined");
-    }
-    vApiInClear(spExp->vpApi);
-    cpApiInString(spExp->vpApi, cpPattern);
-    vApiInValidate(spExp->vpApi, APG_FALSE);
-    vApiSyntax(spExp->vpApi, APG_FALSE);
-    vApiOpcodes(spExp->vpApi);
-    bApiAttrs(spExp->vpApi);
-    if(spExp->bPpptMode){
-        vApiPppt(spExp->vpApi, NULL, 0);
-    }
-    spExp->vpParser = vpApiOutputParser(spExp->vpApi);
-    TRACE_APGEX_OUTPUT(spExp);
-    spExp->vpAst = vpAstCtor(spExp->vpParser);
+static luint luiCacheHash(const char* cpPattern, size_t uiLength){
+    // FNV-1a
+    luint luiHash = (luint)14695981039346656037ULL;
+    size_t ui = 0;
+    for(; ui < uiLength; ui++){
+        luiHash ^= (luint)(uint8_t)cpPattern[ui];
+        luiHash *= (luint)1099511628211ULL;
+    }
+    return luiHash;
 }
 
-static void vInitRules(apgex* spExp){
-    if(!spExp->vpParser){
-        XTHROW(spExp->spException, "attempting to initialize rules and UDTS but parser not defined");
+/** \brief Find a compiled pattern in the cache.
+ * \return The entry, with a reference taken, or NULL if the pattern is not cached.
+ */
+static cache_entry* spCacheGet(const char* cpPattern, abool bPppt){
+    size_t uiLength = strlen(cpPattern);
+    luint luiHash = luiCacheHash(cpPattern, uiLength);
+    cache_entry* spEntry;
+    pthread_mutex_lock(&s_sCacheMutex);
+    for(spEntry = s_spCacheFirst; spEntry; spEntry = spEntry->spNext){
+        if((spEntry->luiHash == luiHash) && (spEntry->uiPatternLength == uiLength) && (spEntry->bPppt == bPppt)
+                && !memcmp(spEntry->cpPattern, cpPattern, uiLength)){
+            break;
+        }
+    }
+    if(spEntry){
+        // move to the front of the list
+        vCacheUnlink(spEntry);
+        spEntry->bCached = APG_TRUE;
+        spEntry->spNext = s_spCacheFirst;
+        if(s_spCacheFirst){
+            s_spCacheFirst->spPrev = spEntry;
+        }
+        s_spCacheFirst = spEntry;
+        if(!s_spCacheLast){
+            s_spCacheLast = spEntry;
+        }
+        s_uiCacheCount++;
+        spEntry->uiRefCount++;
+        s_luiCacheHits++;
+    }else{
+        s_luiCacheMisses++;
+    }
+    pthread_mutex_unlock(&s_sCacheMutex);
+    return spEntry;
+}
+
+/** \brief Add a newly compiled pattern to the cache.
+ *
+ * If another thread has cached the same pattern in the meantime, that entry is used and this one discarded.
+ * \return The entry, with a reference taken. It is not in the cache if the cache size is 0,
+ * but remains valid until released.
+ */
+static cache_entry* spCachePut(exception* spEx, const char* cpPattern, abool bPppt, void* vpParserInit){
+    size_t uiLength = strlen(cpPattern);
+    cache_entry* spEntry = (cache_entry*)malloc(sizeof(cache_entry) + uiLength + 1);
+    cache_entry* spFound;
+    if(!spEntry){
+        free(vpParserInit);
+        XTHROW(spEx, "malloc failed to allocate a pattern cache entry");
+    }
+    memset((void*)spEntry, 0, sizeof(*spEntry));
+    spEntry->cpPattern = (char*)(spEntry + 1);
+    memcpy(spEntry->cpPattern, cpPattern, (uiLength + 1));
+    spEntry->uiPatternLength = uiLength;
+    spEntry->luiHash = luiCacheHash(cpPattern, uiLength);
+    spEntry->bPppt = bPppt;
+    spEntry->uiRefCount = 1;
+    spEntry->vpParserInit = vpParserInit;
+    pthread_mutex_lock(&s_sCacheMutex);
+    for(spFound = s_spCacheFirst; spFound; spFound = spFound->spNext){
+        if((spFound->luiHash == spEntry->luiHash) && (spFound->uiPatternLength == uiLength) && (spFound->bPppt == bPppt)
+                && !memcmp(spFound->cpPattern, cpPattern, uiLength)){
+            break;
+        }
+    }
+    if(spFound){
+        spFound->uiRefCount++;
+        pthread_mutex_unlock(&s_sCacheMutex);
+        free(vpParserInit);
+        free(spEntry);
+        return spFound;
+    }
+    if(s_uiCacheMax){
+        spEntry->bCached = APG_TRUE;
+        spEntry->spNext = s_spCacheFirst;
+        if(s_spCacheFirst){
+            s_spCacheFirst->spPrev = spEntry;
+        }
+        s_spCacheFirst = spEntry;
+        if(!s_spCacheLast){
+            s_spCacheLast = spEntry;
+        }
+        s_uiCacheCount++;
+        vCacheEvict(s_uiCacheMax);
+    }
+    pthread_mutex_unlock(&s_sCacheMutex);
+    return spEntry;
+}
+
+/** \brief Release an apgex object's reference to a compiled pattern.
+ *
+ * The pattern is freed if it is no longer cached and this was the last reference. NULL is silently ignored.
+ */
+static void vCacheRelease(cache_entry* spEntry){
+    if(spEntry){
+        abool bFree;
+        pthread_mutex_lock(&s_sCacheMutex);
+        spEntry->uiRefCount--;
+        bFree = !spEntry->bCached && !spEntry->uiRefCount;
+        pthread_mutex_unlock(&s_sCacheMutex);
+        if(bFree){
+            free(spEntry->vpParserInit);
+            free(spEntry);
+        }
+    }
+}
+
+/** \brief Remove an entry from the cache list. The cache mutex must be locked.
+ */
+static void vCacheUnlink(cache_entry* spEntry){
+    if(spEntry->bCached){
+        if(spEntry->spPrev){
+            spEntry->spPrev->spNext = spEntry->spNext;
+        }else{
+            s_spCacheFirst = spEntry->spNext;
+        }
+        if(spEntry->spNext){
+            spEntry->spNext->spPrev = spEntry->spPrev;
+        }else{
+            s_spCacheLast = spEntry->spPrev;
+        }
+        spEntry->spNext = NULL;
+        spEntry->spPrev = NULL;
+        spEntry->bCached = APG_FALSE;
+        s_uiCacheCount--;
+    }
+}
+
+/** \brief Evict the least recently used entries until no more than uiMax remain. The cache mutex must be locked.
+ *
+ * Entries still referenced by apgex objects are freed when the last reference is released.
+ */
+static void vCacheEvict(aint uiMax){
+    cache_entry* spEntry;
+    while(s_uiCacheCount > uiMax){
+        spEntry = s_spCacheLast;
+        vCacheUnlink(spEntry);
+        if(!spEntry->uiRefCount){
+            free(spEntry->vpParserInit);
+            free(spEntry);
+        }
+    }
+}
+
+static void vConstructParser(apgex* spExp){
+    char* cpPattern = (char*)vpVecFirst(spExp->vpVecPattern);
+    aint uiPatternLen = (aint)strlen(cpPattern);
+    if(!cpPattern || (uiPatternLen <= 1)){
+        XTHROW(spExp->spException, "attmpting to construct the parser but the pattern is not yet defined");
+    }
+    vApiInClear(spExp->vpApi);
+    cache_entry* spEntry = spCacheGet(cpPattern, spExp->bPpptMode);
+    if(!spEntry){
+        // compile the pattern
+        cpApiInString(spExp->vpApi, cpPattern);
+        vApiInValidate(spExp->vpApi, APG_FALSE);
+        vApiSyntax(spExp->vpApi, APG_FALSE);
+        vApiOpcodes(spExp->vpApi);
+        bApiAttrs(spExp->vpApi);
+        if(spExp->bPpptMode){
+            vApiPppt(spExp->vpApi, NULL, 0);
+        }
+        spEntry = spCachePut(spExp->spException, cpPattern, spExp->bPpptMode, vpApiOutputParserInit(spExp->vpApi));
+    }
+    spExp->spCacheEntry = spEntry;
+    spExp->vpParser = vpParserCtor(spExp->spException, spEntry->vpParserInit);
+    TRACE_APGEX_OUTPUT(spExp);
+    spExp->vpAst = vpAstCtor(spExp->vpParser);
+    vInitPrefilter(spExp);
+}
+
+static void vInitRules(apgex* spExp){
+    if(!spExp->vpParser){
+        XTHROW(spExp->spException, "attempting to initialize rules and UDTS but parser not defined");
     }
 
     // set all rule and UDT call backs, even if disabled
@@ -1669,9 +2832,69 @@ static void vResetCallbacks(apgex* spExp){
     }
 }
 
+/** \brief Attach the AST for a match that captures rule phrases, or detach it for one that does not.
+ *
+ * If no rules or UDTs are enabled, only the matched phrase and its contexts are needed.
+ * The AST is then detached from the parser, so that no AST records are kept
+ * and the lean operator set (\ref APG_LEAN_OPERATORS), if compiled, is used.
+ * The offset of the last match is remembered and vAstRebuild() re-parses it
+ * if the application asks for the AST.
+ * \param spExp Pointer to the apgex object context.
+ * \param bCapture True if rule or UDT phrases are to be captured.
+ */
+static void vAstMode(apgex* spExp, abool bCapture){
+    parser* spParser = (parser*)spExp->vpParser;
+    spExp->bAstDeferred = !bCapture;
+    spExp->uiAstOffset = APG_UNDEFINED;
+    if(bCapture){
+        spParser->vpAst = spExp->vpAst;
+        vInitCallbacks(spExp);
+    }else{
+        spParser->vpAst = NULL;
+    }
+    vParserSelectOperators(spParser);
+}
+
+/** \brief Rebuild the AST of the last match made with the AST detached.
+ *
+ * The parser still holds the source of the last match, so the start rule is simply re-entered at the match offset
+ * with the AST attached and all callbacks set. The AST is then as if the match had been made with it.
+ * Note that UDT callback functions are called again for the re-parse.
+ * If there was no match, the AST is left empty.
+ * \param spExp Pointer to the apgex object context.
+ */
+static void vAstRebuild(apgex* spExp){
+    parser* spParser = (parser*)spExp->vpParser;
+    parser_config sConfig = {};
+    parser_state sState;
+    spParser->vpAst = spExp->vpAst;
+    vParserSelectOperators(spParser);
+    spExp->bAstDeferred = APG_FALSE;
+    if(spExp->uiAstOffset == APG_UNDEFINED){
+        vAstClear(spExp->vpAst);
+        return;
+    }
+    sConfig.acpInput = spParser->acpConfigInput;
+    sConfig.uiInputLength = spParser->uiInputStringLength;
+    sConfig.bParseSubString = APG_TRUE;
+    sConfig.uiSubStringBeg = spExp->uiAstOffset;
+    sConfig.vpUserData = (void*)spExp;
+    vInitCallbacks(spExp);
+    vParserReparse(spExp->vpParser, &sConfig, &sState);
+    vResetCallbacks(spExp);
+}
+
 static void vMatchResult(apgex* spExp, parser_config* spConfig, parser_state* spState, apgex_result* spResult){
-    // translate the AST to get the relative phrases
-    vAstTranslate(spExp->vpAst, (void*)spExp);
+    // each match has its own phrases (global mode may find many matches in one call)
+    vClearForMatch(spExp);
+
+    if(spExp->bAstDeferred){
+        // capture-free - only the matched phrase and its contexts are needed
+        spExp->uiAstOffset = spConfig->uiSubStringBeg;
+    }else{
+        // translate the AST to get the relative phrases
+        vAstTranslate(spExp->vpAst, (void*)spExp);
+    }
 
     // // push 3 relative phrases for the result, left and right context
     phrase_r* spRelResult = (phrase_r*)vpVecPush(spExp->vpVecRelPhrases, NULL);
@@ -1778,26 +3001,246 @@ static void vMatchResult(apgex* spExp, parser_config* spConfig, parser_state* sp
         }
     }
 
-    // remove all AST call back functions in case user wants to use the AST
+    if(!spExp->bAstDeferred){
+        // remove all AST call back functions in case user wants to use the AST
+        aint ui;
+        for(ui = 0; ui < spExp->uiRuleCount; ui++){
+            vAstSetRuleCallback(spExp->vpAst, ui, NULL);
+        }
+        if(spExp->uiUdtCount){
+            for(ui = 0; ui < spExp->uiUdtCount; ui++){
+                vAstSetUdtCallback(spExp->vpAst, ui, NULL);
+            }
+        }
+    }
+}
+/** \brief Parse the source at the configured offset.
+ *
+ * The source is copied into the parser only on the first parse after it changes.
+ * Subsequent parses, at each offset of a scan and for each match in global mode,
+ * only re-enter the start rule.
+ */
+static void vParse(apgex* spExp, parser_config* spConfig, parser_state* spState){
+    if(spExp->bParserInput){
+        vParserReparse(spExp->vpParser, spConfig, spState);
+    }else{
+        vParserParse(spExp->vpParser, spConfig, spState);
+        spExp->bParserInput = APG_TRUE;
+    }
+}
+
+/** \brief Compute the start-position prefilter for the pattern.
+ *
+ * Two properties of the start rule are used to skip start offsets that cannot begin a match.
+ *  - The first-character set. If PPPTs are in use (the "p" flag), the start rule's PPPT map gives,
+ * for each character, whether a match can begin with it. The parser would reject any other start offset
+ * immediately, so skipping it changes nothing but the time.
+ *  - The literal prefix. The characters of the literal strings that every match must begin with, if any.
+ *
+ * Nothing is skipped if the start rule has a parser callback function, since it may match anything.
+ */
+static void vInitPrefilter(apgex* spExp){
+    parser* spParser = (parser*)spExp->vpParser;
+    rule* spStart = &spParser->spRules[0];
+    prefix_r* spPrefix;
+    spExp->bPrefilter = APG_FALSE;
+    spExp->ucpFirstMap = NULL;
+    spExp->bSingleFirst = APG_FALSE;
+    vVecClear(spExp->vpVecPrefix);
+    if(spStart->pfnCallback){
+        return;
+    }
+    bPrefixOp(spExp, spStart->spOp, 0);
+    spPrefix = (prefix_r*)vpVecFirst(spExp->vpVecPrefix);
+#ifndef APG_NO_PPPT
+    if(spParser->ucpMaps && spStart->ucpPpptMap){
+        luint luiChar;
+        luint luiCount = 0;
+        luint luiChars = (luint)spParser->acAcharMax - (luint)spParser->acAcharMin + 1;
+        spExp->ucpFirstMap = spStart->ucpPpptMap;
+        for(luiChar = 0; luiChar < luiChars; luiChar++){
+            if(spExp->ucpFirstMap[luiChar] != ID_PPPT_NOMATCH){
+                spExp->acFirst = (achar)(luiChar + spParser->acAcharMin);
+                if(++luiCount > 1){
+                    break;
+                }
+            }
+        }
+        spExp->bSingleFirst = (luiCount == 1);
+    }
+#endif /* APG_NO_PPPT */
+    if(!spExp->ucpFirstMap && spPrefix){
+        spExp->acFirst = spPrefix->acChar;
+        spExp->bSingleFirst = !(spPrefix->bFold && (spPrefix->acChar >= (achar)97) && (spPrefix->acChar <= (achar)122));
+    }
+    spExp->bPrefilter = (spExp->ucpFirstMap || spPrefix);
+}
+
+/** \brief Append the literal characters that a match of this opcode must begin with to the literal prefix.
+ *
+ * \return True if the opcode matches only a fixed literal string, so that the prefix continues after it.
+ * False if the prefix ends with this opcode.
+ */
+static abool bPrefixOp(apgex* spExp, const opcode* spOp, aint uiDepth){
+    parser* spParser = (parser*)spExp->vpParser;
+    prefix_r sChar;
+    const aint* uipChild;
+    const aint* uipEnd;
     aint ui;
-    for(ui = 0; ui < spExp->uiRuleCount; ui++){
-        vAstSetRuleCallback(spExp->vpAst, ui, NULL);
+    if(uiDepth > spParser->uiRuleCount){
+        // recursive rule
+        return APG_FALSE;
+    }
+    switch(spOp->sGen.uiId){
+    case ID_RNM:
+        if(spOp->sRnm.spRule->pfnCallback){
+            return APG_FALSE;
+        }
+        return bPrefixOp(spExp, spOp->sRnm.spRule->spOp, (uiDepth + 1));
+    case ID_CAT:
+        uipChild = spOp->sCat.uipChildList;
+        uipEnd = uipChild + spOp->sCat.uiChildCount;
+        for(; uipChild < uipEnd; uipChild++){
+            if(!bPrefixOp(spExp, (spParser->spOpcodes + *uipChild), uiDepth)){
+                return APG_FALSE;
+            }
+        }
+        return APG_TRUE;
+    case ID_ALT:
+        if(spOp->sAlt.uiChildCount == 1){
+            return bPrefixOp(spExp, (spParser->spOpcodes + spOp->sAlt.uipChildList[0]), uiDepth);
+        }
+        return APG_FALSE;
+    case ID_REP:
+        if(spOp->sRep.uiMin == 0){
+            return APG_FALSE;
+        }
+        return bPrefixOp(spExp, (spOp + 1), uiDepth) && (spOp->sRep.uiMax == 1);
+    case ID_TBS:
+    case ID_TLS:
+        sChar.bFold = (spOp->sGen.uiId == ID_TLS);
+        for(ui = 0; ui < spOp->sTbs.uiStrLen; ui++){
+            sChar.acChar = spOp->sTbs.acpStrTbl[ui];
+            vpVecPush(spExp->vpVecPrefix, (void*)&sChar);
+        }
+        return APG_TRUE;
+    case ID_TRG:
+        if(spOp->sTrg.acMin == spOp->sTrg.acMax){
+            sChar.bFold = APG_FALSE;
+            sChar.acChar = spOp->sTrg.acMin;
+            vpVecPush(spExp->vpVecPrefix, (void*)&sChar);
+            return APG_TRUE;
+        }
+        return APG_FALSE;
+    case ID_AND:
+    case ID_NOT:
+    case ID_BKA:
+    case ID_BKN:
+    case ID_ABG:
+    case ID_AEN:
+        // look arounds and anchors do not consume characters
+        return APG_TRUE;
     }
-    if(spExp->uiUdtCount){
-        for(ui = 0; ui < spExp->uiUdtCount; ui++){
-            vAstSetUdtCallback(spExp->vpAst, ui, NULL);
+    // UDT and BKR phrases are not known in advance
+    return APG_FALSE;
+}
+
+static inline abool bPrefixChar(const prefix_r* spPrefix, achar acChar){
+    if(spPrefix->bFold && (acChar >= (achar)65) && (acChar <= (achar)90)){
+        acChar += (achar)32;
+    }
+    return (acChar == spPrefix->acChar);
+}
+
+/** \brief Advance the start offset to the next offset that could begin a match.
+ *
+ * Not used when tracing, so that the trace shows a parse attempt at every offset.
+ * \return True if a candidate offset was found. False if no match is possible in the remainder of the source.
+ */
+static abool bNextStart(apgex* spExp, parser_config* spConfig){
+    aint uiBeg = uiNextStart(spExp, (parser*)spExp->vpParser, spConfig->acpInput, spConfig->uiSubStringBeg,
+            spConfig->uiInputLength);
+    spConfig->uiSubStringBeg = uiBeg;
+    spExp->uiLastIndex = uiBeg;
+    return (uiBeg < spConfig->uiInputLength);
+}
+
+/** \brief Find the next offset at which a match can begin.
+ *
+ * Nothing is changed, so the workers of a parallel scan may call this at the same time, each with its own parser.
+ * \param spExp Pointer to the apgex object context, for its prefilter.
+ * \param spParser Pointer to the parser. Only the alphabet range and the start rule's callback function are used.
+ * \param acpSrc The source string.
+ * \param uiBeg The first offset to try.
+ * \param uiEnd The length of the source string.
+ * \return The first offset, not less than uiBeg, at which a match can begin. uiEnd if there is none.
+ */
+static aint uiNextStart(apgex* spExp, parser* spParser, const achar* acpSrc, aint uiBeg, aint uiEnd){
+    const prefix_r* spPrefix = (const prefix_r*)vpVecFirst(spExp->vpVecPrefix);
+    aint uiPrefixLen = uiVecLen(spExp->vpVecPrefix);
+    aint ui;
+    achar acChar;
+    if(spExp->vpTrace || spParser->spRules[0].pfnCallback){
+        return uiBeg;
+    }
+    while(uiBeg < uiEnd){
+        // find the next possible first character
+        if(spExp->bSingleFirst){
+            if(sizeof(achar) == 1){
+                const void* vpFound = memchr((const void*)&acpSrc[uiBeg], (int)spExp->acFirst, (size_t)(uiEnd - uiBeg));
+                uiBeg = vpFound ? (aint)((const achar*)vpFound - acpSrc) : uiEnd;
+            }else{
+                while((uiBeg < uiEnd) && (acpSrc[uiBeg] != spExp->acFirst)){
+                    uiBeg++;
+                }
+            }
+        }else if(spExp->ucpFirstMap){
+            for(; uiBeg < uiEnd; uiBeg++){
+                acChar = acpSrc[uiBeg];
+                if((acChar >= spParser->acAcharMin) && (acChar <= spParser->acAcharMax)
+                        && (spExp->ucpFirstMap[acChar - spParser->acAcharMin] != ID_PPPT_NOMATCH)){
+                    break;
+                }
+            }
+        }else{
+            while((uiBeg < uiEnd) && !bPrefixChar(spPrefix, acpSrc[uiBeg])){
+                uiBeg++;
+            }
+        }
+        if(uiBeg >= uiEnd){
+            break;
+        }
+
+        // verify the literal prefix
+        if(uiPrefixLen > (uiEnd - uiBeg)){
+            uiBeg = uiEnd;
+            break;
         }
+        for(ui = 0; ui < uiPrefixLen; ui++){
+            if(!bPrefixChar(&spPrefix[ui], acpSrc[uiBeg + ui])){
+                break;
+            }
+        }
+        if(ui == uiPrefixLen){
+            break;
+        }
+        uiBeg++;
     }
-    ui = 0;
+    return uiBeg;
 }
+
 static void vMatchDefault(apgex* spExp, parser_config* spConfig, apgex_result* spResult){
     parser_state sState;
     memset(spResult, 0, sizeof(*spResult));
+    spExp->uiAstOffset = APG_UNDEFINED;
     while(spConfig->uiSubStringBeg < spConfig->uiInputLength){
+        if(spExp->bPrefilter && !bNextStart(spExp, spConfig)){
+            break;
+        }
         if(spExp->vpTrace){
             TRACE_APGEX_SEPARATOR(spExp);
         }
-        vParserParse(spExp->vpParser, spConfig, &sState);
+        vParse(spExp, spConfig, &sState);
         if(sState.uiState == ID_MATCH){
             vMatchResult(spExp, spConfig, &sState, spResult);
             break;
@@ -1810,11 +3253,15 @@ static void vMatchDefault(apgex* spExp, parser_config* spConfig, apgex_result* s
 static void vMatchGlobal(apgex* spExp, parser_config* spConfig, apgex_result* spResult){
     parser_state sState;
     memset(spResult, 0, sizeof(*spResult));
+    spExp->uiAstOffset = APG_UNDEFINED;
     while(spConfig->uiSubStringBeg < spConfig->uiInputLength){
+        if(spExp->bPrefilter && !bNextStart(spExp, spConfig)){
+            break;
+        }
         if(spExp->vpTrace){
             TRACE_APGEX_SEPARATOR(spExp);
         }
-        vParserParse(spExp->vpParser, spConfig, &sState);
+        vParse(spExp, spConfig, &sState);
         if(sState.uiState == ID_MATCH){
             vMatchResult(spExp, spConfig, &sState, spResult);
             if(sState.uiPhraseLength){
@@ -1832,10 +3279,11 @@ static void vMatchGlobal(apgex* spExp, parser_config* spConfig, apgex_result* sp
 static void vMatchSticky(apgex* spExp, parser_config* spConfig, apgex_result* spResult){
     parser_state sState;
     memset(spResult, 0, sizeof(*spResult));
+    spExp->uiAstOffset = APG_UNDEFINED;
     if(spExp->vpTrace){
         TRACE_APGEX_SEPARATOR(spExp);
     }
-    vParserParse(spExp->vpParser, spConfig, &sState);
+    vParse(spExp, spConfig, &sState);
     if(sState.uiState == ID_MATCH){
         vMatchResult(spExp, spConfig, &sState, spResult);
         if(sState.uiPhraseLength){
@@ -1850,10 +3298,13 @@ static abool bTestDefault(apgex* spExp, parser_config* spConfig){
     abool bReturn = APG_FALSE;
     parser_state sState;
     while(spConfig->uiSubStringBeg < spConfig->uiInputLength){
+        if(spExp->bPrefilter && !bNextStart(spExp, spConfig)){
+            break;
+        }
         if(spExp->vpTrace){
             TRACE_APGEX_SEPARATOR(spExp);
         }
-        vParserParse(spExp->vpParser, spConfig, &sState);
+        vParse(spExp, spConfig, &sState);
         if(sState.uiState == ID_MATCH){
             bReturn = APG_TRUE;
             break;
@@ -1868,10 +3319,13 @@ static abool bTestGlobal(apgex* spExp, parser_config* spConfig){
     abool bReturn = APG_FALSE;
     parser_state sState;
     while(spConfig->uiSubStringBeg < spConfig->uiInputLength){
+        if(spExp->bPrefilter && !bNextStart(spExp, spConfig)){
+            break;
+        }
         if(spExp->vpTrace){
             TRACE_APGEX_SEPARATOR(spExp);
         }
-        vParserParse(spExp->vpParser, spConfig, &sState);
+        vParse(spExp, spConfig, &sState);
         if(sState.uiState == ID_MATCH){
             bReturn = APG_TRUE;
             if(sState.uiPhraseLength){
@@ -1893,7 +3347,7 @@ static abool bTestSticky(apgex* spExp, parser_config* spConfig){
     if(spExp->vpTrace){
         TRACE_APGEX_SEPARATOR(spExp);
     }
-    vParserParse(spExp->vpParser, spConfig, &sState);
+    vParse(spExp, spConfig, &sState);
     if(sState.uiState == ID_MATCH){
         bReturn = APG_TRUE;
         if(sState.uiPhraseLength){
@@ -1914,7 +3368,7 @@ static abool bTestSticky(apgex* spExp, parser_config* spConfig){
  * \param spPhrase Pointer to the phrase to display.
  * \param vpFmt Pointer to a format object. Returned from vpFmtCtor().
  */
-static void vPrintPhrase(apgex* spExp, apgex_phrase* spPhrase, FILE* spOut){
+static void vPrintPhrase(void* vpFmt, apgex_phrase* spPhrase, FILE* spOut){
     if(spPhrase->sPhrase.uiLength){
         if(bIsPhraseAscii(&spPhrase->sPhrase)){
             aint ui = 0;
@@ -1950,10 +3404,10 @@ static void vPrintPhrase(apgex* spExp, apgex_phrase* spPhrase, FILE* spOut){
                 fprintf(spOut, "offset: %"PRIuMAX" length: %"PRIuMAX", %d-byte, %s-endian words\n",
                         (luint)spPhrase->uiPhraseOffset, (luint)spPhrase->sPhrase.uiLength, (int)uiWordSize, s_cpEndian);
             }
-            cpLine = cpFmtFirstBytes(spExp->vpFmt, ucpBytes, iByteCount, FMT_CANONICAL, 0, 0);
+            cpLine = cpFmtFirstBytes(vpFmt, ucpBytes, iByteCount, FMT_CANONICAL, 0, 0);
             while(cpLine){
                 fprintf(spOut, "%s", cpLine);
-                cpLine = cpFmtNext(spExp->vpFmt);
+                cpLine = cpFmtNext(vpFmt);
             }
         }
     }else{
@@ -2084,16 +3538,12 @@ static aint pfnUdtCallback(ast_data* spData){
 //}
 
 static void vClearForParse(apgex* spExp){
+    spExp->bParserInput = APG_FALSE;
     spExp->uiNodeHits = 0;
     spExp->uiTreeDepth = 0;
     vVecClear(spExp->vpVecStrings);
     vVecClear(spExp->vpVecSource);
     vVecClear(spExp->vpVecOriginalSource);
-    vVecClear(spExp->vpVecPhrases);
-    vVecClear(spExp->vpVecRelPhrases);
-    vVecClear(spExp->vpVecRules);
-    vVecClear(spExp->vpVecUdts);
-    vVecClear(spExp->vpVecSource);
     vVecClear(spExp->vpVecReplaceRaw);
     vVecClear(spExp->vpVecReplacement);
     vVecClear(spExp->vpVecSplitPhrases);
@@ -2101,6 +3551,13 @@ static void vClearForParse(apgex* spExp){
     spExp->spLastMatch = NULL;
     spExp->spLeftContext = NULL;
     spExp->spRightContext = NULL;
+    vClearForMatch(spExp);
+}
+static void vClearForMatch(apgex* spExp){
+    vVecClear(spExp->vpVecPhrases);
+    vVecClear(spExp->vpVecRelPhrases);
+    vVecClear(spExp->vpVecRules);
+    vVecClear(spExp->vpVecUdts);
     aint ui;
     for(ui = 0; ui < spExp->uiRuleCount; ui++){
         spExp->spRelRules[ui].uiFirstPhrase = APG_UNDEFINED;
@@ -2116,6 +3573,13 @@ static void vClearForParse(apgex* spExp){
     }
 }
 static void vClearForPattern(apgex* spExp){
+    spExp->bParserInput = APG_FALSE;
+    spExp->bAstDeferred = APG_FALSE;
+    spExp->uiAstOffset = APG_UNDEFINED;
+    spExp->bPrefilter = APG_FALSE;
+    spExp->ucpFirstMap = NULL;
+    spExp->bSingleFirst = APG_FALSE;
+    vVecClear(spExp->vpVecPrefix);
     vVecClear(spExp->vpVecStrings);
     vVecClear(spExp->vpVecSource);
     vVecClear(spExp->vpVecOriginalSource);
@@ -2134,6 +3598,10 @@ static void vClearForPattern(apgex* spExp){
         fclose(spExp->spDisplay);
         spExp->spDisplay = NULL;
     }
+    if(spExp->spStreamFile){
+        fclose(spExp->spStreamFile);
+        spExp->spStreamFile = NULL;
+    }
     if(spExp->vpExternalParser){
         // destroy the AST and trace objects, if any, but leave the user's external parser intact
         vAstDtor(spExp->vpAst);
@@ -2142,6 +3610,8 @@ static void vClearForPattern(apgex* spExp){
         // destroy the local parser which calls destructors for vpTrace & vpAst
         vParserDtor(spExp->vpParser);
     }
+    vCacheRelease(spExp->spCacheEntry);
+    spExp->spCacheEntry = NULL;
     spExp->vpParser = NULL;
     spExp->vpExternalParser = NULL;
     spExp->vpAst = NULL;
@@ -2217,3 +3687,976 @@ static abool bIsNameChar(char cChar){
     return APG_FALSE;
 }
 
+
+static inline abool bIsNameStart(char cChar){
+    return ((cChar >= 65 && cChar <= 90) || (cChar >= 97 && cChar <= 122));
+}
+
+/** \brief Discard the compiled parser, if any, of a pattern set.
+ */
+static void vSetClear(apgex_set* spSet){
+    vParserDtor(spSet->vpParser);
+    spSet->vpParser = NULL;
+    vCacheRelease(spSet->spCacheEntry);
+    spSet->spCacheEntry = NULL;
+    vVecClear(spSet->vpVecDispatch);
+    vVecClear(spSet->vpVecDispatchIndex);
+    vVecClear(spSet->vpVecAll);
+    vVecClear(spSet->vpVecMatches);
+    vVecClear(spSet->vpVecMatched);
+}
+
+/** \brief Combine the patterns of a set into a single grammar.
+ *
+ * Every rule name of pattern i, both where defined and where referenced, is given the prefix "pi-".
+ * The pattern text is scanned just far enough to find the names. That is, comments, quoted strings,
+ * prose values and numeric terminals are copied unchanged.
+ * The first rule defined in each pattern is its start rule.
+ */
+static void vSetGrammar(apgex_set* spSet){
+    set_pattern* spPattern = (set_pattern*)vpVecFirst(spSet->vpVecPatterns);
+    aint uiCount = uiVecLen(spSet->vpVecPatterns);
+    const char* cpText;
+    const char* cpName;
+    char caPrefix[64];
+    char cQuote;
+    abool bLineStart, bStart;
+    aint ui = 0;
+    vVecClear(spSet->vpVecGrammar);
+    vVecClear(spSet->vpVecNames);
+    for(; ui < uiCount; ui++, spPattern++){
+        snprintf(caPrefix, sizeof(caPrefix), "p%"PRIuMAX"-", (luint)ui);
+        cpText = (const char*)vpVecAt(spSet->vpVecText, spPattern->uiTextOffset);
+        bLineStart = APG_TRUE;
+        bStart = APG_FALSE;
+        while(*cpText){
+            if(bIsNameStart(*cpText)){
+                // a rule name
+                cpName = cpText;
+                while(bIsNameChar(*cpText) || ((*cpText >= 48) && (*cpText <= 57))){
+                    cpText++;
+                }
+                if((cpText - cpName) > 1 && (cpName[1] == '_') && ((cpName[0] | 0x20) == 'u' || (cpName[0] | 0x20) == 'e')){
+                    char caBuf[BUF_SIZE];
+                    snprintf(caBuf, BUF_SIZE, "pattern %"PRIuMAX": UDTs are not supported in pattern sets", (luint)ui);
+                    XTHROW(spSet->spException, caBuf);
+                }
+                vpVecPushn(spSet->vpVecGrammar, (void*)caPrefix, (aint)strlen(caPrefix));
+                vpVecPushn(spSet->vpVecGrammar, (void*)cpName, (aint)(cpText - cpName));
+                if(bLineStart && !bStart){
+                    spPattern->uiNameOffset = uiVecLen(spSet->vpVecNames);
+                    vpVecPushn(spSet->vpVecNames, (void*)caPrefix, (aint)strlen(caPrefix));
+                    vpVecPushn(spSet->vpVecNames, (void*)cpName, (aint)(cpText - cpName));
+                    vpVecPush(spSet->vpVecNames, (void*)&s_cZero);
+                    bStart = APG_TRUE;
+                }
+                bLineStart = APG_FALSE;
+                continue;
+            }
+            bLineStart = (*cpText == '\n') || (*cpText == '\r');
+            if(*cpText == ';'){
+                // comment to end of line
+                cpName = cpText;
+                while(*cpText && (*cpText != '\n') && (*cpText != '\r')){
+                    cpText++;
+                }
+                vpVecPushn(spSet->vpVecGrammar, (void*)cpName, (aint)(cpText - cpName));
+                continue;
+            }
+            if((*cpText == '"') || (*cpText == '\'') || (*cpText == '<')){
+                // quoted string or prose value
+                cQuote = (*cpText == '<') ? '>' : *cpText;
+                cpName = cpText++;
+                while(*cpText && (*cpText != cQuote) && (*cpText != '\n') && (*cpText != '\r')){
+                    cpText++;
+                }
+                if(*cpText == cQuote){
+                    cpText++;
+                }
+                vpVecPushn(spSet->vpVecGrammar, (void*)cpName, (aint)(cpText - cpName));
+                continue;
+            }
+            if(*cpText == '%'){
+                // numeric terminal, string case or back reference modifier, or anchor
+                cpName = cpText++;
+                switch(*cpText){
+                case 'd':
+                case 'D':
+                case 'x':
+                case 'X':
+                case 'b':
+                case 'B':
+                    cpText++;
+                    while(((*cpText >= 48) && (*cpText <= 57)) || ((*cpText >= 65) && (*cpText <= 70))
+                            || ((*cpText >= 97) && (*cpText <= 102)) || (*cpText == '.') || (*cpText == '-')){
+                        cpText++;
+                    }
+                    break;
+                case 's':
+                case 'S':
+                case 'i':
+                case 'I':
+                case 'u':
+                case 'U':
+                case 'p':
+                case 'P':
+                    cpText++;
+                    break;
+                }
+                vpVecPushn(spSet->vpVecGrammar, (void*)cpName, (aint)(cpText - cpName));
+                continue;
+            }
+            vpVecPush(spSet->vpVecGrammar, (void*)cpText);
+            cpText++;
+        }
+        if(!bStart){
+            char caBuf[BUF_SIZE];
+            snprintf(caBuf, BUF_SIZE, "pattern %"PRIuMAX" defines no rules", (luint)ui);
+            XTHROW(spSet->spException, caBuf);
+        }
+        cpText = (const char*)vpVecLast(spSet->vpVecGrammar);
+        if((*cpText != '\n') && (*cpText != '\r')){
+            vpVecPushn(spSet->vpVecGrammar, (void*)"\n", 1);
+        }
+    }
+    vpVecPush(spSet->vpVecGrammar, (void*)&s_cZero);
+}
+
+/** \brief Build the first-character dispatch table.
+ *
+ * For each character of the grammar's alphabet, the list of patterns, in order,
+ * whose start rule's PPPT map does not rule out a non-empty match beginning with that character.
+ * Characters outside the alphabet cannot begin any match.
+ * The table is not built, and all patterns are attempted at every offset,
+ * if PPPTs are not in use or the alphabet is too large.
+ */
+static void vSetDispatch(apgex_set* spSet){
+#ifndef APG_NO_PPPT
+    parser* spParser = (parser*)spSet->vpParser;
+    set_pattern* spPatterns = (set_pattern*)vpVecFirst(spSet->vpVecPatterns);
+    aint uiCount = uiVecLen(spSet->vpVecPatterns);
+    luint luiChars = (luint)spParser->acAcharMax - (luint)spParser->acAcharMin + 1;
+    luint luiChar;
+    aint ui, uiIndex;
+    if(!spParser->ucpMaps || (luiChars > 0x10000)){
+        return;
+    }
+    for(ui = 0; ui < uiCount; ui++){
+        if(!spPatterns[ui].ucpFirstMap){
+            return;
+        }
+    }
+    for(luiChar = 0; luiChar < luiChars; luiChar++){
+        uiIndex = uiVecLen(spSet->vpVecDispatch);
+        vpVecPush(spSet->vpVecDispatchIndex, (void*)&uiIndex);
+        for(ui = 0; ui < uiCount; ui++){
+            // empty phrases are not reported, so a deterministic empty match is as good as no match
+            if((spPatterns[ui].ucpFirstMap[luiChar] != ID_PPPT_NOMATCH) && (spPatterns[ui].ucpFirstMap[luiChar] != ID_PPPT_EMPTY)){
+                vpVecPush(spSet->vpVecDispatch, (void*)&ui);
+            }
+        }
+    }
+    uiIndex = uiVecLen(spSet->vpVecDispatch);
+    vpVecPush(spSet->vpVecDispatchIndex, (void*)&uiIndex);
+#endif /* APG_NO_PPPT */
+}
+
+/** \brief Read up to uiMax alphabet characters from a stream source.
+ * \return The number of characters read. Less than uiMax only at the end of the stream.
+ */
+static aint uiStreamRead(stream_src* spSrc, achar* acpDst, aint uiMax){
+    aint ui, uiRead = 0;
+    if(spSrc->spFile){
+        if(sizeof(achar) == 1){
+            uiRead = (aint)fread((void*)acpDst, 1, (size_t)uiMax, spSrc->spFile);
+        }else{
+            vVecClear(spSrc->vpVecBytes);
+            uint8_t* ucpBytes = (uint8_t*)vpVecPushn(spSrc->vpVecBytes, NULL, uiMax);
+            uiRead = (aint)fread((void*)ucpBytes, 1, (size_t)uiMax, spSrc->spFile);
+            for(ui = 0; ui < uiRead; ui++){
+                acpDst[ui] = (achar)ucpBytes[ui];
+            }
+        }
+    }else if(spSrc->acpPhrase){
+        luint luiLeft = spSrc->luiLength - spSrc->luiOffset;
+        uiRead = (luiLeft < (luint)uiMax) ? (aint)luiLeft : uiMax;
+        memcpy((void*)acpDst, (const void*)(spSrc->acpPhrase + spSrc->luiOffset), (sizeof(achar) * (size_t)uiRead));
+        spSrc->luiOffset += (luint)uiRead;
+    }else{
+        luint luiLeft = spSrc->luiLength - spSrc->luiOffset;
+        const uint8_t* ucpBytes = spSrc->ucpBuffer + spSrc->luiOffset;
+        uiRead = (luiLeft < (luint)uiMax) ? (aint)luiLeft : uiMax;
+        if(sizeof(achar) == 1){
+            memcpy((void*)acpDst, (const void*)ucpBytes, (size_t)uiRead);
+        }else{
+            for(ui = 0; ui < uiRead; ui++){
+                acpDst[ui] = (achar)ucpBytes[ui];
+            }
+        }
+        spSrc->luiOffset += (luint)uiRead;
+    }
+    return uiRead;
+}
+
+/** \brief Scan a stream for matched phrases through a sliding window.
+ *
+ * The window, the source vector, holds up to uiMaxMatch characters preceding the next offset to try,
+ * the most recently read chunk and whatever remains of previous chunks.
+ * Offsets are tried only if at least uiMaxMatch characters follow them in the window, or if the end of the stream is in the window.
+ * The window then slides forward, keeping uiMaxMatch characters of history.
+ * Matches are reported in window offsets. The callback adds the window's stream offset.
+ */
+static luint luiStream(apgex* spExp, stream_src* spSrc, aint uiMaxMatch, pfn_apgex_stream pfnMatch, void* vpUser,
+        stream_out* spOut){
+    if(!spExp->vpParser){
+        XTHROW(spExp->spException, s_cpNoPattern);
+    }
+    if(spOut){
+        if(!spOut->pfnSink){
+            XTHROW(spExp->spException, "sink function cannot be NULL");
+        }
+    }else if(!pfnMatch){
+        XTHROW(spExp->spException, "match callback function cannot be NULL");
+    }
+    if(spExp->vpTrace){
+        XTHROW(spExp->spException, "the trace mode is not supported for streams");
+    }
+    parser_config sConfig = {};
+    parser_state sState;
+    apgex_result sResult;
+    apgex_phrase sPhrase;
+    achar* acpWindow;
+    luint luiBase = 0;
+    luint luiCount = 0;
+    aint ui, uiLen, uiRead, uiLimit, uiDiscard;
+    aint uiNext = 0;
+    abool bEos = APG_FALSE;
+    abool bContinue = APG_TRUE;
+    abool bSticky = spExp->bStickyMode;
+    if(spOut && spOut->bSplit){
+        // as for spApgexSplit(), all matches are found and nothing is captured
+        bSticky = APG_FALSE;
+        spExp->uiEnabledRuleCount = 0;
+        spExp->uiEnabledUdtCount = 0;
+        for(ui = 0; ui < spExp->uiRuleCount; ui++){
+            spExp->spRelRules[ui].bEnabled = APG_FALSE;
+        }
+        for(ui = 0; ui < spExp->uiUdtCount; ui++){
+            spExp->spRelUdts[ui].bEnabled = APG_FALSE;
+        }
+    }
+    abool bCapture = (spExp->uiEnabledRuleCount || spExp->uiEnabledUdtCount);
+    if(uiMaxMatch == 0){
+        uiMaxMatch = APGEX_STREAM_MAX_MATCH;
+    }
+    vClearForParse(spExp);
+    spExp->uiLastIndex = 0;
+    if(spOut && !spOut->bSplit && !spOut->pfnFunc){
+        vStreamReplacement(spExp, spOut->spReplacement);
+    }
+    vAstMode(spExp, bCapture);
+    sConfig.bParseSubString = APG_TRUE;
+    sConfig.uiLookBehindLength = uiMaxMatch;
+    sConfig.vpUserData = (void*)spExp;
+    while(bContinue){
+        // read the next chunk into the window
+        uiLen = uiVecLen(spExp->vpVecSource);
+        acpWindow = (achar*)vpVecPushn(spExp->vpVecSource, NULL, APGEX_STREAM_CHUNK);
+        uiRead = uiStreamRead(spSrc, acpWindow, APGEX_STREAM_CHUNK);
+        if(uiRead < APGEX_STREAM_CHUNK){
+            vpVecPopn(spExp->vpVecSource, (APGEX_STREAM_CHUNK - uiRead));
+            bEos = APG_TRUE;
+        }
+        spExp->bParserInput = APG_FALSE;
+        uiLen += uiRead;
+        if(bEos){
+            uiLimit = uiLen;
+        }else{
+            uiLimit = (uiLen > uiMaxMatch) ? (uiLen - uiMaxMatch) : 0;
+        }
+
+        // try each offset that can be decided with the characters in the window
+        sConfig.acpInput = (achar*)vpVecFirst(spExp->vpVecSource);
+        sConfig.uiInputLength = uiLen;
+        while(uiNext < uiLimit){
+            sConfig.uiSubStringBeg = uiNext;
+            if(spExp->bPrefilter && !bSticky){
+                if(!bNextStart(spExp, &sConfig)){
+                    // no candidate offsets before the limit
+                    uiNext = bEos ? uiLen : uiLimit;
+                    break;
+                }
+                uiNext = sConfig.uiSubStringBeg;
+                if(uiNext >= uiLimit){
+                    break;
+                }
+            }
+            vParse(spExp, &sConfig, &sState);
+            if(sState.uiState == ID_MATCH){
+                if(sState.uiPhraseLength > uiMaxMatch){
+                    char caBuf[BUF_SIZE];
+                    snprintf(caBuf, BUF_SIZE, "matched phrase at stream offset %"PRIuMAX" is longer than the maximum, %"PRIuMAX,
+                            (luiBase + (luint)uiNext), (luint)uiMaxMatch);
+                    XTHROW(spExp->spException, caBuf);
+                }
+                luiCount++;
+                if(bCapture){
+                    vMatchResult(spExp, &sConfig, &sState, &sResult);
+                    sResult.spLeftContext = NULL;
+                    sResult.spRightContext = NULL;
+                    vInitCallbacks(spExp);
+                }else{
+                    memset((void*)&sResult, 0, sizeof(sResult));
+                    sPhrase.sPhrase.acpPhrase = sConfig.acpInput + uiNext;
+                    sPhrase.sPhrase.uiLength = sState.uiPhraseLength;
+                    sPhrase.uiPhraseOffset = uiNext;
+                    sResult.spResult = &sPhrase;
+                    sResult.uiNodeHits = sState.uiHitCount;
+                    sResult.uiTreeDepth = sState.uiMaxTreeDepth;
+                }
+                // as in global mode, an empty match advances one character
+                uiNext += sState.uiPhraseLength ? sState.uiPhraseLength : 1;
+                sResult.uiLastIndex = uiNext;
+                if(spOut ? !bStreamOut(spExp, spOut, &sResult, luiBase) : !pfnMatch(&sResult, luiBase, vpUser)){
+                    bContinue = APG_FALSE;
+                    break;
+                }
+            }else if(bSticky){
+                bContinue = APG_FALSE;
+                break;
+            }else{
+                uiNext++;
+            }
+        }
+        if(bEos){
+            break;
+        }
+
+        // slide the window, keeping uiMaxMatch characters of history
+        if(uiNext > uiMaxMatch){
+            uiDiscard = uiNext - uiMaxMatch;
+            acpWindow = (achar*)vpVecFirst(spExp->vpVecSource);
+            if(spOut && !spOut->bDone && (spOut->luiWritten < (luiBase + (luint)uiDiscard))){
+                // write the unchanged text that is about to leave the window
+                ui = (aint)(spOut->luiWritten - luiBase);
+                vStreamWrite(spOut, (acpWindow + ui), (uiDiscard - ui), APGEX_SEGMENT_TEXT);
+                spOut->luiWritten = luiBase + (luint)uiDiscard;
+                spOut->bOpen = APG_TRUE;
+            }
+            memmove((void*)acpWindow, (void*)(acpWindow + uiDiscard), (sizeof(achar) * (uiLen - uiDiscard)));
+            vpVecPopn(spExp->vpVecSource, uiDiscard);
+            luiBase += (luint)uiDiscard;
+            uiNext -= uiDiscard;
+        }
+    }
+    if(spOut){
+        vStreamOutEnd(spExp, spSrc, spOut, luiBase, bEos);
+    }
+    vResetCallbacks(spExp);
+    vClearForParse(spExp);
+    spExp->uiLastIndex = 0;
+    // the window is gone, nothing is left to rebuild the AST from
+    spExp->bAstDeferred = APG_TRUE;
+    spExp->uiAstOffset = APG_UNDEFINED;
+    return luiCount;
+}
+
+static void vStreamWrite(stream_out* spOut, const achar* acpText, aint uiLength, aint uiType){
+    apg_phrase sSegment;
+    if(uiLength || (uiType == APGEX_SEGMENT_END)){
+        sSegment.acpPhrase = acpText;
+        sSegment.uiLength = uiLength;
+        spOut->pfnSink(&sSegment, uiType, spOut->vpUser);
+    }
+}
+
+/** \brief Write the output for one matched phrase of a streaming replace or split.
+ *
+ * The unchanged text from the last output up to the matched phrase is written first.
+ * For a replacement, it is followed by the replacement. For a split, it ends a sub-phrase, if not empty.
+ * \return True to continue the scan, false to stop.
+ */
+static abool bStreamOut(apgex* spExp, stream_out* spOut, apgex_result* spResult, luint luiBase){
+    apgex_phrase* spMatch = spResult->spResult;
+    const achar* acpWindow = (const achar*)vpVecFirst(spExp->vpVecSource);
+    aint uiText = (aint)(luiBase + (luint)spMatch->uiPhraseOffset - spOut->luiWritten);
+    vStreamWrite(spOut, (acpWindow + (spOut->luiWritten - luiBase)), uiText, APGEX_SEGMENT_TEXT);
+    spOut->luiWritten = luiBase + (luint)(spMatch->uiPhraseOffset + spMatch->sPhrase.uiLength);
+    if(spOut->bSplit){
+        if(uiText || spOut->bOpen){
+            vStreamWrite(spOut, NULL, 0, APGEX_SEGMENT_END);
+            spOut->luiCount++;
+        }
+        spOut->bOpen = APG_FALSE;
+        spOut->uiLimit--;
+        if(spOut->uiLimit == 0){
+            spOut->bDone = APG_TRUE;
+            return APG_FALSE;
+        }
+        return APG_TRUE;
+    }
+    if(spOut->pfnFunc){
+        apgex_properties sProps;
+        vProperties(spExp, &sProps);
+        sProps.vpAst = NULL;
+        memset((void*)&sProps.sOriginalSource, 0, sizeof(sProps.sOriginalSource));
+        memset((void*)&sProps.sLastSource, 0, sizeof(sProps.sLastSource));
+        sProps.sLastMatch = *spMatch;
+        apg_phrase sPhrase = spOut->pfnFunc(spResult, &sProps, spOut->vpFuncUser);
+        vStreamWrite(spOut, sPhrase.acpPhrase, (sPhrase.acpPhrase ? sPhrase.uiLength : 0), APGEX_SEGMENT_REPLACE);
+    }else{
+        // the contexts are not available, the replacement has been checked not to refer to them
+        apgex_phrase sEmpty = {};
+        apgex_result sResult = *spResult;
+        sResult.spLeftContext = &sEmpty;
+        sResult.spRightContext = &sEmpty;
+        vReplacement(spExp, &sResult);
+        vStreamWrite(spOut, (const achar*)vpVecFirst(spExp->vpVecReplacement), uiVecLen(spExp->vpVecReplacement),
+                APGEX_SEGMENT_REPLACE);
+    }
+    spOut->luiCount++;
+    // in default mode only the first matched phrase is replaced
+    return !spExp->bDefaultMode;
+}
+
+/** \brief Finish the output of a streaming replace or split.
+ *
+ * The rest of the window is written and, if the scan stopped before the end of the stream,
+ * the rest of the stream is copied through unchanged. Nothing is written if a split reached its limit.
+ */
+static void vStreamOutEnd(apgex* spExp, stream_src* spSrc, stream_out* spOut, luint luiBase, abool bEos){
+    achar* acpWindow;
+    aint uiLen, uiRead;
+    if(spOut->bDone){
+        return;
+    }
+    acpWindow = (achar*)vpVecFirst(spExp->vpVecSource);
+    uiLen = uiVecLen(spExp->vpVecSource);
+    if(spOut->luiWritten < (luiBase + (luint)uiLen)){
+        vStreamWrite(spOut, (acpWindow + (spOut->luiWritten - luiBase)), (aint)(luiBase + (luint)uiLen - spOut->luiWritten),
+                APGEX_SEGMENT_TEXT);
+        spOut->bOpen = APG_TRUE;
+    }
+    while(!bEos){
+        vVecClear(spExp->vpVecSource);
+        acpWindow = (achar*)vpVecPushn(spExp->vpVecSource, NULL, APGEX_STREAM_CHUNK);
+        uiRead = uiStreamRead(spSrc, acpWindow, APGEX_STREAM_CHUNK);
+        vStreamWrite(spOut, acpWindow, uiRead, APGEX_SEGMENT_TEXT);
+        if(uiRead){
+            spOut->bOpen = APG_TRUE;
+        }
+        bEos = (uiRead < APGEX_STREAM_CHUNK);
+    }
+    if(spOut->bSplit && spOut->bOpen){
+        vStreamWrite(spOut, NULL, 0, APGEX_SEGMENT_END);
+        spOut->luiCount++;
+    }
+}
+
+/** \brief Save the replacement phrase for a streaming replace.
+ *
+ * The left and right contexts and the whole source are not available to a streaming replace.
+ * An exception is thrown if the replacement phrase refers to them.
+ */
+static void vStreamReplacement(apgex* spExp, apg_phrase* spReplacement){
+    aint ui;
+    vVecClear(spExp->vpVecReplaceRaw);
+    if(spReplacement && spReplacement->acpPhrase && spReplacement->uiLength){
+        for(ui = 0; (ui + 1) < spReplacement->uiLength; ui++){
+            if(spReplacement->acpPhrase[ui] == DOLLAR){
+                ui++;
+                if((spReplacement->acpPhrase[ui] == UNDER) || (spReplacement->acpPhrase[ui] == ACCENT)
+                        || (spReplacement->acpPhrase[ui] == APOS)){
+                    XTHROW(spExp->spException, "replacement error: $_, $` and $' are not available when streaming");
+                }
+            }
+        }
+        vpVecPushn(spExp->vpVecReplaceRaw, (void*)spReplacement->acpPhrase, spReplacement->uiLength);
+    }
+}
+
+static void vStreamOpen(apgex* spExp, stream_src* spSrc, const char* cpFileName){
+    if(!cpFileName){
+        XTHROW(spExp->spException, "file name cannot be NULL");
+    }
+    if(spExp->spStreamFile){
+        // left open by an exception thrown during a previous scan
+        fclose(spExp->spStreamFile);
+        spExp->spStreamFile = NULL;
+    }
+    spSrc->spFile = fopen(cpFileName, "rb");
+    if(!spSrc->spFile){
+        char caBuf[BUF_SIZE];
+        snprintf(caBuf, BUF_SIZE, "can't open file %s for reading", cpFileName);
+        XTHROW(spExp->spException, caBuf);
+    }
+    spExp->spStreamFile = spSrc->spFile;
+    if(sizeof(achar) > 1){
+        spSrc->vpVecBytes = spExp->vpVecStreamBytes;
+    }
+}
+
+static void vStreamClose(apgex* spExp, stream_src* spSrc){
+    fclose(spSrc->spFile);
+    spSrc->spFile = NULL;
+    spExp->spStreamFile = NULL;
+}
+
+/** \brief Scan a buffer for matched phrases with several worker threads. See luiApgexParallelBuffer().
+ *
+ * The workers record the matched phrases of each chunk. They are then merged on the calling thread.
+ * luiNext follows the offsets that a single, sequential scan would try. It is normally at the beginning
+ * of the next chunk, in step with the worker that scanned it. If a matched phrase has run into the next chunk,
+ * luiNext may fall inside one of that worker's matched phrases, an offset the worker never tried.
+ * The calling thread then tries the offsets itself, until it reaches one that the worker also tried.
+ * From there on, the worker's matches are the sequential scan's matches.
+ */
+static luint luiParallel(apgex* spExp, const uint8_t* ucpBuffer, luint luiLength, const char* cpDelimiter,
+        aint uiThreads, aint uiMaxMatch, pfn_apgex_stream pfnMatch, void* vpUser){
+    if(!spExp->vpParser){
+        XTHROW(spExp->spException, s_cpNoPattern);
+    }
+    if(!pfnMatch){
+        XTHROW(spExp->spException, "match callback function cannot be NULL");
+    }
+    if(spExp->vpTrace){
+        XTHROW(spExp->spException, "the trace mode is not supported for parallel scans");
+    }
+    par_scan sScan = {};
+    par_window sMain;
+    parser_state sState;
+    par_chunk* spChunk;
+    par_chunk* spChunkEnd;
+    par_match* spMatch;
+    par_match* spMatchEnd;
+    par_match* spLast;
+    luint luiNext = 0;
+    luint luiCount = 0;
+    abool bContinue = APG_TRUE;
+    abool bCapture = (spExp->uiEnabledRuleCount || spExp->uiEnabledUdtCount);
+    if(uiMaxMatch == 0){
+        uiMaxMatch = APGEX_STREAM_MAX_MATCH;
+    }
+    if(uiThreads == 0){
+        long lProcessors = sysconf(_SC_NPROCESSORS_ONLN);
+        uiThreads = (lProcessors > 0) ? (aint)lProcessors : 1;
+    }
+    if(uiThreads > APGEX_PARALLEL_MAX_THREADS){
+        uiThreads = APGEX_PARALLEL_MAX_THREADS;
+    }
+    vClearForParse(spExp);
+    spExp->uiLastIndex = 0;
+    vVecClear(spExp->vpVecParMatches);
+
+    // scan the chunks
+    vParChunks(spExp, ucpBuffer, luiLength, cpDelimiter, uiThreads);
+    sScan.spExp = spExp;
+    sScan.spChunks = (par_chunk*)vpVecFirst(spExp->vpVecParChunks);
+    sScan.uiChunkCount = uiVecLen(spExp->vpVecParChunks);
+    sScan.sWindow.ucpBuffer = ucpBuffer;
+    sScan.sWindow.luiLength = luiLength;
+    sScan.sWindow.uiMaxMatch = uiMaxMatch;
+    sScan.sWindow.sConfig.bParseSubString = APG_TRUE;
+    sScan.sWindow.sConfig.uiLookBehindLength = uiMaxMatch;
+    sScan.sWindow.sConfig.vpUserData = (void*)spExp;
+    if(sScan.uiChunkCount){
+        vParWorkers(spExp, &sScan, uiThreads);
+    }
+
+    // merge the matched phrases in offset order
+    vAstMode(spExp, bCapture);
+    sMain = sScan.sWindow;
+    sMain.spException = spExp->spException;
+    sMain.vpParser = spExp->vpParser;
+    sMain.vpVecWindow = spExp->vpVecSource;
+    spChunk = sScan.spChunks;
+    spChunkEnd = spChunk + sScan.uiChunkCount;
+    for(; bContinue && (spChunk < spChunkEnd); spChunk++){
+        spMatch = NULL;
+        spMatchEnd = NULL;
+        spLast = NULL;
+        if(spChunk->uiCount){
+            spMatch = (par_match*)vpVecFirst(spExp->vpVecParMatches) + spChunk->uiFirst;
+            spMatchEnd = spMatch + spChunk->uiCount;
+        }
+
+        // re-scan until the worker's scan is reached
+        while(luiNext < spChunk->luiEnd){
+            while((spMatch < spMatchEnd) && (spMatch->luiOffset < luiNext)){
+                spLast = spMatch++;
+            }
+            if(!spLast || ((spLast->luiOffset + (spLast->uiLength ? spLast->uiLength : 1)) <= luiNext)){
+                // the worker tried this offset too
+                break;
+            }
+            if(bParMatch(&sMain, luiNext, &sState)){
+                luiCount++;
+                if(!bParOut(spExp, &sMain, luiNext, &sState, pfnMatch, vpUser)){
+                    bContinue = APG_FALSE;
+                }
+                luiNext += sState.uiPhraseLength ? sState.uiPhraseLength : 1;
+                if(!bContinue){
+                    break;
+                }
+            }else{
+                luiNext++;
+            }
+        }
+        if(!bContinue || (luiNext >= spChunk->luiEnd)){
+            continue;
+        }
+
+        // in step with the worker, its remaining matches are the sequential scan's
+        for(; spMatch < spMatchEnd; spMatch++){
+            if(bCapture){
+                // parse again with the AST to capture the rule and UDT phrases
+                if(!bParMatch(&sMain, spMatch->luiOffset, &sState) || (sState.uiPhraseLength != spMatch->uiLength)){
+                    XTHROW(spExp->spException, "parallel scan: a worker's matched phrase did not match again");
+                }
+            }else{
+                memset((void*)&sState, 0, sizeof(sState));
+                sState.uiState = ID_MATCH;
+                sState.uiPhraseLength = spMatch->uiLength;
+                sState.uiHitCount = spMatch->uiNodeHits;
+                sState.uiMaxTreeDepth = spMatch->uiTreeDepth;
+            }
+            luiCount++;
+            luiNext = spMatch->luiOffset + (spMatch->uiLength ? spMatch->uiLength : 1);
+            if(!bParOut(spExp, &sMain, spMatch->luiOffset, &sState, pfnMatch, vpUser)){
+                bContinue = APG_FALSE;
+                break;
+            }
+        }
+        if(luiNext < spChunk->luiEnd){
+            luiNext = spChunk->luiEnd;
+        }
+    }
+    vResetCallbacks(spExp);
+    vClearForParse(spExp);
+    vVecClear(spExp->vpVecParMatches);
+    spExp->uiLastIndex = 0;
+    // the window is gone, nothing is left to rebuild the AST from
+    spExp->bAstDeferred = APG_TRUE;
+    spExp->uiAstOffset = APG_UNDEFINED;
+    return luiCount;
+}
+
+/** \brief Make sure that the window holds the characters needed to try a match at a buffer offset.
+ *
+ * Offsets are only ever tried in increasing order.
+ */
+static inline void vParWindow(par_window* spWin, luint luiOffset){
+    // offsets before the window wrap around to large values
+    if((luiOffset - spWin->luiWindow) >= (luint)spWin->uiLimit){
+        vParLoad(spWin, luiOffset);
+    }
+}
+
+/** \brief Load the window with uiMaxMatch characters of look behind,
+ * followed by \ref APGEX_STREAM_CHUNK offsets to try and uiMaxMatch characters of look ahead.
+ */
+static void vParLoad(par_window* spWin, luint luiOffset){
+    achar* acpWindow;
+    const uint8_t* ucpBytes;
+    luint luiEnd;
+    aint ui, uiLen;
+    spWin->luiWindow = (luiOffset > (luint)spWin->uiMaxMatch) ? (luiOffset - (luint)spWin->uiMaxMatch) : 0;
+    luiEnd = luiOffset + (luint)spWin->uiMaxMatch + APGEX_STREAM_CHUNK;
+    if(luiEnd > spWin->luiLength){
+        luiEnd = spWin->luiLength;
+    }
+    uiLen = (aint)(luiEnd - spWin->luiWindow);
+    ucpBytes = spWin->ucpBuffer + spWin->luiWindow;
+    vVecClear(spWin->vpVecWindow);
+    acpWindow = (achar*)vpVecPushn(spWin->vpVecWindow, NULL, uiLen);
+    if(sizeof(achar) == 1){
+        memcpy((void*)acpWindow, (const void*)ucpBytes, (size_t)uiLen);
+    }else{
+        for(ui = 0; ui < uiLen; ui++){
+            acpWindow[ui] = (achar)ucpBytes[ui];
+        }
+    }
+    spWin->uiLimit = (luiEnd == spWin->luiLength) ? uiLen : (uiLen - spWin->uiMaxMatch);
+    spWin->sConfig.acpInput = acpWindow;
+    spWin->sConfig.uiInputLength = uiLen;
+    spWin->bParsed = APG_FALSE;
+}
+
+/** \brief Try a match at a buffer offset.
+ * \return True if a phrase was matched. An exception is thrown if it is longer than uiMaxMatch.
+ */
+static abool bParMatch(par_window* spWin, luint luiOffset, parser_state* spState){
+    vParWindow(spWin, luiOffset);
+    spWin->sConfig.uiSubStringBeg = (aint)(luiOffset - spWin->luiWindow);
+    if(spWin->bParsed){
+        vParserReparse(spWin->vpParser, &spWin->sConfig, spState);
+    }else{
+        vParserParse(spWin->vpParser, &spWin->sConfig, spState);
+        spWin->bParsed = APG_TRUE;
+    }
+    if(spState->uiState != ID_MATCH){
+        return APG_FALSE;
+    }
+    if(spState->uiPhraseLength > spWin->uiMaxMatch){
+        char caBuf[BUF_SIZE];
+        snprintf(caBuf, BUF_SIZE, "matched phrase at buffer offset %"PRIuMAX" is longer than the maximum, %"PRIuMAX,
+                luiOffset, (luint)spWin->uiMaxMatch);
+        XTHROW(spWin->spException, caBuf);
+    }
+    return APG_TRUE;
+}
+
+/** \brief Divide the buffer of a parallel scan into chunks.
+ *
+ * The nominal chunk length gives each worker several chunks, to even out the load, but is no more than
+ * \ref APGEX_PARALLEL_CHUNK. A chunk ends just after the first delimiter following its nominal end,
+ * if one is found within another nominal length. Otherwise, at its nominal end.
+ */
+static void vParChunks(apgex* spExp, const uint8_t* ucpBuffer, luint luiLength, const char* cpDelimiter, aint uiThreads){
+    const uint8_t* ucpDelim = (const uint8_t*)cpDelimiter;
+    const uint8_t* ucpFound;
+    size_t uiDelimLen = cpDelimiter ? strlen(cpDelimiter) : 0;
+    par_chunk* spChunk;
+    luint luiBeg = 0;
+    luint luiEnd, luiSearch, luiStop;
+    luint luiSize = luiLength / ((luint)uiThreads * 4);
+    if(luiSize < APGEX_STREAM_CHUNK){
+        luiSize = APGEX_STREAM_CHUNK;
+    }
+    if(luiSize > APGEX_PARALLEL_CHUNK){
+        luiSize = APGEX_PARALLEL_CHUNK;
+    }
+    vVecClear(spExp->vpVecParChunks);
+    while(luiBeg < luiLength){
+        luiEnd = luiBeg + luiSize;
+        if(luiEnd >= luiLength){
+            luiEnd = luiLength;
+        }else if(uiDelimLen){
+            luiSearch = luiEnd;
+            luiStop = luiEnd + luiSize;
+            if(luiStop > luiLength){
+                luiStop = luiLength;
+            }
+            while(luiSearch < luiStop){
+                ucpFound = (const uint8_t*)memchr((const void*)(ucpBuffer + luiSearch), (int)ucpDelim[0], (size_t)(luiStop - luiSearch));
+                if(!ucpFound){
+                    break;
+                }
+                luiSearch = (luint)(ucpFound - ucpBuffer);
+                if(((luiSearch + uiDelimLen) <= luiLength) && (memcmp((const void*)ucpFound, (const void*)ucpDelim, uiDelimLen) == 0)){
+                    luiEnd = luiSearch + uiDelimLen;
+                    break;
+                }
+                luiSearch++;
+            }
+        }
+        spChunk = (par_chunk*)vpVecPush(spExp->vpVecParChunks, NULL);
+        memset((void*)spChunk, 0, sizeof(*spChunk));
+        spChunk->luiBeg = luiBeg;
+        spChunk->luiEnd = luiEnd;
+        luiBeg = luiEnd;
+    }
+}
+
+/** \brief Take the next chunk to be scanned.
+ * \return Pointer to the chunk. NULL if there are no more or if a worker has failed.
+ */
+static par_chunk* spParNextChunk(par_scan* spScan){
+    par_chunk* spChunk = NULL;
+    pthread_mutex_lock(&spScan->sMutex);
+    if(!spScan->bStop && (spScan->uiNextChunk < spScan->uiChunkCount)){
+        spChunk = &spScan->spChunks[spScan->uiNextChunk++];
+    }
+    pthread_mutex_unlock(&spScan->sMutex);
+    return spChunk;
+}
+
+/** \brief The worker thread function. Scans chunks until there are no more.
+ *
+ * The worker has its own exception, memory object and parser. Nothing of the apgex object is changed.
+ * If an exception is thrown, the other workers are stopped and the calling thread re-throws it.
+ */
+static void* vpParWorker(void* vpArg){
+    par_worker* spWork = (par_worker*)vpArg;
+    par_scan* spScan = spWork->spScan;
+    parser* spParser = (parser*)spScan->spExp->vpParser;
+    par_chunk* spChunk;
+    aint ui;
+    XCTOR(spWork->sException);
+    if(spWork->sException.try){
+        spWork->vpMem = vpMemCtor(&spWork->sException);
+        spWork->vpVecMatches = vpVecCtor(spWork->vpMem, sizeof(par_match), 1024);
+        spWork->sWindow = spScan->sWindow;
+        spWork->sWindow.spException = &spWork->sException;
+        spWork->sWindow.vpVecWindow = vpVecCtor(spWork->vpMem, sizeof(achar), APGEX_STREAM_CHUNK);
+        spWork->sWindow.vpParser = vpParserCtor(&spWork->sException, spScan->spExp->spCacheEntry->vpParserInit);
+        // the same callback functions as the apgex object's parser
+        for(ui = 0; ui < spParser->uiRuleCount; ui++){
+            vParserSetRuleCallback(spWork->sWindow.vpParser, ui, spParser->spRules[ui].pfnCallback);
+        }
+        for(ui = 0; ui < spParser->uiUdtCount; ui++){
+            vParserSetUdtCallback(spWork->sWindow.vpParser, ui, spParser->spUdts[ui].pfnCallback);
+        }
+        while((spChunk = spParNextChunk(spScan)) != NULL){
+            vParScanChunk(spWork, spChunk);
+        }
+    }else{
+        spWork->bError = APG_TRUE;
+        pthread_mutex_lock(&spScan->sMutex);
+        spScan->bStop = APG_TRUE;
+        pthread_mutex_unlock(&spScan->sMutex);
+    }
+    return NULL;
+}
+
+/** \brief Scan one chunk for all matches, as in global mode.
+ *
+ * Offsets are tried from the beginning of the chunk up to its end. A matched phrase may extend beyond the end.
+ */
+static void vParScanChunk(par_worker* spWork, par_chunk* spChunk){
+    apgex* spExp = spWork->spScan->spExp;
+    par_window* spWin = &spWork->sWindow;
+    parser_state sState;
+    par_match* spMatch;
+    luint luiNext = spChunk->luiBeg;
+    aint uiBeg;
+    spChunk->uiWorker = spWork->uiIndex;
+    spChunk->uiFirst = uiVecLen(spWork->vpVecMatches);
+    while(luiNext < spChunk->luiEnd){
+        if(spExp->bPrefilter){
+            vParWindow(spWin, luiNext);
+            uiBeg = uiNextStart(spExp, (parser*)spWin->vpParser, spWin->sConfig.acpInput,
+                    (aint)(luiNext - spWin->luiWindow), spWin->sConfig.uiInputLength);
+            if(uiBeg >= spWin->uiLimit){
+                // no candidate offsets in this window
+                luiNext = spWin->luiWindow + (luint)spWin->uiLimit;
+                continue;
+            }
+            luiNext = spWin->luiWindow + (luint)uiBeg;
+            if(luiNext >= spChunk->luiEnd){
+                break;
+            }
+        }
+        if(bParMatch(spWin, luiNext, &sState)){
+            spMatch = (par_match*)vpVecPush(spWork->vpVecMatches, NULL);
+            spMatch->luiOffset = luiNext;
+            spMatch->uiLength = sState.uiPhraseLength;
+            spMatch->uiNodeHits = sState.uiHitCount;
+            spMatch->uiTreeDepth = sState.uiMaxTreeDepth;
+            luiNext += sState.uiPhraseLength ? sState.uiPhraseLength : 1;
+        }else{
+            luiNext++;
+        }
+    }
+    spChunk->uiCount = uiVecLen(spWork->vpVecMatches) - spChunk->uiFirst;
+}
+
+/** \brief Run the workers of a parallel scan and collect their matched phrases into the apgex object, chunk by chunk.
+ *
+ * The calling thread is worker 0. If some threads can't be started, the chunks are shared among those that were.
+ */
+static void vParWorkers(apgex* spExp, par_scan* spScan, aint uiThreads){
+    par_worker* spWorkers;
+    par_worker* spWork;
+    par_chunk* spChunk;
+    par_chunk* spChunkEnd;
+    exception sEx;
+    aint ui, uiFirst;
+    aint uiError = APG_UNDEFINED;
+    if(uiThreads > spScan->uiChunkCount){
+        uiThreads = spScan->uiChunkCount;
+    }
+    spWorkers = (par_worker*)vpMemAlloc(spExp->vpMem, (aint)(sizeof(par_worker) * uiThreads));
+    memset((void*)spWorkers, 0, (sizeof(par_worker) * uiThreads));
+    for(ui = 0; ui < uiThreads; ui++){
+        spWorkers[ui].spScan = spScan;
+        spWorkers[ui].uiIndex = ui;
+    }
+    pthread_mutex_init(&spScan->sMutex, NULL);
+    for(ui = 1; ui < uiThreads; ui++){
+        if(pthread_create(&spWorkers[ui].sThread, NULL, vpParWorker, (void*)&spWorkers[ui]) != 0){
+            break;
+        }
+        spWorkers[ui].bStarted = APG_TRUE;
+    }
+    vpParWorker((void*)&spWorkers[0]);
+    for(ui = 1; ui < uiThreads; ui++){
+        if(spWorkers[ui].bStarted){
+            pthread_join(spWorkers[ui].sThread, NULL);
+        }
+        if(spWorkers[ui].bError && (uiError == APG_UNDEFINED)){
+            uiError = ui;
+        }
+    }
+    if(spWorkers[0].bError){
+        uiError = 0;
+    }
+    pthread_mutex_destroy(&spScan->sMutex);
+    if(uiError == APG_UNDEFINED){
+        spChunk = spScan->spChunks;
+        spChunkEnd = spChunk + spScan->uiChunkCount;
+        for(; spChunk < spChunkEnd; spChunk++){
+            spWork = &spWorkers[spChunk->uiWorker];
+            uiFirst = uiVecLen(spExp->vpVecParMatches);
+            if(spChunk->uiCount){
+                vpVecPushn(spExp->vpVecParMatches, ((par_match*)vpVecFirst(spWork->vpVecMatches) + spChunk->uiFirst),
+                        spChunk->uiCount);
+            }
+            spChunk->uiFirst = uiFirst;
+        }
+    }else{
+        sEx = spWorkers[uiError].sException;
+    }
+    for(ui = 0; ui < uiThreads; ui++){
+        vParserDtor(spWorkers[ui].sWindow.vpParser);
+        vMemDtor(spWorkers[ui].vpMem);
+    }
+    vMemFree(spExp->vpMem, (void*)spWorkers);
+    if(uiError != APG_UNDEFINED){
+        vExRethrow(&sEx, spExp->spException);
+    }
+}
+
+/** \brief Report one matched phrase of a parallel scan to the user's callback function.
+ *
+ * If phrases are captured, the calling thread's parser has just matched the phrase in its window, with the AST attached.
+ * Otherwise, spState need only give the phrase length and the parse statistics.
+ * The phrase alone is then converted to alphabet characters and the window is not needed.
+ * \return The return of the callback function. True to continue, false to stop.
+ */
+static abool bParOut(apgex* spExp, par_window* spMain, luint luiOffset, parser_state* spState,
+        pfn_apgex_stream pfnMatch, void* vpUser){
+    apgex_result sResult;
+    apgex_phrase sPhrase;
+    achar* acpPhrase;
+    const uint8_t* ucpBytes;
+    luint luiBase;
+    aint ui, uiOffset;
+    if(!spExp->bAstDeferred){
+        luiBase = spMain->luiWindow;
+        uiOffset = (aint)(luiOffset - luiBase);
+        spMain->sConfig.uiSubStringBeg = uiOffset;
+        vMatchResult(spExp, &spMain->sConfig, spState, &sResult);
+        sResult.spLeftContext = NULL;
+        sResult.spRightContext = NULL;
+        vInitCallbacks(spExp);
+    }else{
+        luiBase = luiOffset;
+        uiOffset = 0;
+        ucpBytes = spMain->ucpBuffer + luiOffset;
+        vVecClear(spExp->vpVecReplacement);
+        acpPhrase = (achar*)vpVecPushn(spExp->vpVecReplacement, NULL, (spState->uiPhraseLength + 1));
+        for(ui = 0; ui < spState->uiPhraseLength; ui++){
+            acpPhrase[ui] = (achar)ucpBytes[ui];
+        }
+        memset((void*)&sResult, 0, sizeof(sResult));
+        sPhrase.sPhrase.acpPhrase = acpPhrase;
+        sPhrase.sPhrase.uiLength = spState->uiPhraseLength;
+        sPhrase.uiPhraseOffset = 0;
+        sResult.spResult = &sPhrase;
+        sResult.uiNodeHits = spState->uiHitCount;
+        sResult.uiTreeDepth = spState->uiMaxTreeDepth;
+    }
+    sResult.uiLastIndex = uiOffset + (spState->uiPhraseLength ? spState->uiPhraseLength : 1);
+    return pfnMatch(&sResult, luiBase, vpUser);
+}
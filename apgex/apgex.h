@@ -115,6 +115,103 @@ typedef struct{
     abool bTraceHtmlMode; ///< \brief True if the `th` flags ar set for HTML trace output in the `cpFlags` string.
 } apgex_properties;
 
+/** \def APGEX_CACHE_SIZE
+ * \brief The default maximum number of compiled patterns in the process-wide pattern cache. See vApgexCacheSize().
+ */
+#define APGEX_CACHE_SIZE 64
+
+/** \struct apgex_cache_info
+ * \brief Information about the process-wide cache of compiled patterns. See vApgexCacheInfo().
+ */
+typedef struct{
+    aint uiEntries; ///< \brief The number of compiled patterns in the cache.
+    aint uiMaxEntries; ///< \brief The maximum number of compiled patterns the cache will hold.
+    luint luiHits; ///< \brief The number of patterns found in the cache.
+    luint luiMisses; ///< \brief The number of patterns that had to be compiled.
+} apgex_cache_info;
+
+/** \def APGEX_STREAM_CHUNK
+ * \brief The number of characters read from a stream at a time. See luiApgexStreamFile().
+ */
+#define APGEX_STREAM_CHUNK 65536
+
+/** \def APGEX_STREAM_MAX_MATCH
+ * \brief The default maximum length of a phrase matched in a stream. See luiApgexStreamFile().
+ */
+#define APGEX_STREAM_MAX_MATCH 4096
+
+/** \def APGEX_PARALLEL_CHUNK
+ * \brief The maximum number of bytes in each chunk of a parallel scan. See luiApgexParallelBuffer().
+ */
+#define APGEX_PARALLEL_CHUNK 1048576
+
+/** \def APGEX_PARALLEL_MAX_THREADS
+ * \brief The maximum number of worker threads of a parallel scan. See luiApgexParallelBuffer().
+ */
+#define APGEX_PARALLEL_MAX_THREADS 64
+
+/** \typedef pfn_apgex_stream
+ * \brief Prototype for the match callback function used by luiApgexStreamFile(), luiApgexStreamBuffer()
+ * and luiApgexParallelBuffer().
+ * \param spResult Pointer to the matched result. Same as the return from sApgexExec() except that
+ * the left and right contexts are NULL. The phrases point into an internal window on the stream
+ * and are valid only for the duration of the callback.
+ * \param luiBase The stream offset of the window. The stream offset of any phrase in the result is
+ * `luiBase + uiPhraseOffset`.
+ * \param vpUser Pointer to user-supplied data. Same as passed to luiApgexStreamFile() or luiApgexStreamBuffer().
+ * \return True to continue scanning the stream, false to stop.
+ */
+typedef abool (*pfn_apgex_stream)(apgex_result* spResult, luint luiBase, void* vpUser);
+
+/** \def APGEX_SEGMENT_TEXT
+ * \brief A segment of unchanged source text. See \ref pfn_apgex_sink.
+ */
+#define APGEX_SEGMENT_TEXT 0
+/** \def APGEX_SEGMENT_REPLACE
+ * \brief A replacement for a matched phrase. See \ref pfn_apgex_sink.
+ */
+#define APGEX_SEGMENT_REPLACE 1
+/** \def APGEX_SEGMENT_END
+ * \brief The end of a sub-phrase of a split. The segment is empty. See \ref pfn_apgex_sink.
+ */
+#define APGEX_SEGMENT_END 2
+
+/** \typedef pfn_apgex_sink
+ * \brief Prototype for the output function used by the streaming replace and split functions,
+ * luiApgexReplaceSink(), luiApgexReplaceFile(), luiApgexSplitSink() and luiApgexSplitFile().
+ *
+ * The output is delivered in order as a sequence of segments. Concatenated, the segments of a replacement
+ * are the same as the phrase returned by sApgexReplace(). Unchanged text may arrive in several segments.
+ * A sub-phrase of a split is the concatenation of the text segments since the previous \ref APGEX_SEGMENT_END.
+ * \param spSegment The segment. Valid only for the duration of the call.
+ * \param uiType The segment type, \ref APGEX_SEGMENT_TEXT, \ref APGEX_SEGMENT_REPLACE or \ref APGEX_SEGMENT_END.
+ * \param vpUser Pointer to user-supplied data. Same as passed to the streaming function.
+ */
+typedef void (*pfn_apgex_sink)(apg_phrase* spSegment, aint uiType, void* vpUser);
+
+/** \struct apgex_set_match
+ * \brief One phrase matched by one of the patterns in a pattern set.
+ */
+typedef struct{
+    apgex_phrase sPhrase; ///< \brief The matched phrase.
+    aint uiPattern; ///< \brief The index of the matching pattern, as returned from uiApgexSetAdd().
+} apgex_set_match;
+
+/** \struct apgex_set_result
+ * \brief The results of matching a pattern set against a source string.
+ *
+ * Note that all data pointers in this structure are valid only until the next function call on the pattern set object.
+ * The matched phrases point into the source string and are valid only as long as it is.
+ */
+typedef struct{
+    apgex_set_match* spMatches; /**< \brief The matched phrases, in order of offset and, at each offset, in order of pattern index.
+    NULL if no match. */
+    aint uiMatchCount; ///< \brief The number of matched phrases.
+    const abool* bpMatched; ///< \brief Indexed by pattern, true if the pattern matched anywhere in the source string.
+    aint uiPatternCount; ///< \brief The number of patterns in the set.
+    aint uiPatternsMatched; ///< \brief The number of different patterns that matched.
+} apgex_set_result;
+
 /** \typedef pfn_replace
  * \brief Prototype for the replacement function used by sApgexReplaceFunc().
  * \param spResult Pointer to a pattern-matching result - same as return from sApgexExec().
@@ -137,6 +234,13 @@ void vApgexPatternFile(void* vpCtx, const char* cpFileName, const char* cpFlags)
 void vApgexPatternParser(void* vpCtx, void* vpParser, const char* cpFlags);
 ///@}
 
+/** @name Compiled-Pattern Cache */
+///@{
+void vApgexCacheSize(aint uiMaxEntries);
+void vApgexCacheClear(void);
+void vApgexCacheInfo(apgex_cache_info* spInfo);
+///@}
+
 /** @name Pattern Matching Configuration */
 ///@{
 void vApgexEnableRules(void* vpCtx, const char* cpNames, abool bEnable);
@@ -157,6 +261,38 @@ void* vpApgexGetTrace(void* vpCtx);
 void* vpApgexGetParser(void* vpCtx);
 ///@}
 
+/** @name Stream Matching */
+///@{
+luint luiApgexStreamFile(void* vpCtx, const char* cpFileName, aint uiMaxMatch, pfn_apgex_stream pfnMatch, void* vpUser);
+luint luiApgexStreamBuffer(void* vpCtx, const uint8_t* ucpBuffer, luint luiLength, aint uiMaxMatch,
+        pfn_apgex_stream pfnMatch, void* vpUser);
+luint luiApgexReplaceSink(void* vpCtx, apg_phrase* spSource, aint uiMaxMatch, apg_phrase* spReplacement,
+        pfn_apgex_sink pfnSink, void* vpUser);
+luint luiApgexReplaceFuncSink(void* vpCtx, apg_phrase* spSource, aint uiMaxMatch, pfn_replace pfnFunc, void* vpFuncUser,
+        pfn_apgex_sink pfnSink, void* vpUser);
+luint luiApgexReplaceFile(void* vpCtx, const char* cpFileName, aint uiMaxMatch, apg_phrase* spReplacement,
+        pfn_apgex_sink pfnSink, void* vpUser);
+luint luiApgexSplitSink(void* vpCtx, apg_phrase* spSource, aint uiMaxMatch, aint uiLimit,
+        pfn_apgex_sink pfnSink, void* vpUser);
+luint luiApgexSplitFile(void* vpCtx, const char* cpFileName, aint uiMaxMatch, aint uiLimit,
+        pfn_apgex_sink pfnSink, void* vpUser);
+void vApgexSinkFile(apg_phrase* spSegment, aint uiType, void* vpUser);
+luint luiApgexParallelBuffer(void* vpCtx, const uint8_t* ucpBuffer, luint luiLength, const char* cpDelimiter,
+        aint uiThreads, aint uiMaxMatch, pfn_apgex_stream pfnMatch, void* vpUser);
+///@}
+
+/** @name Pattern Sets */
+///@{
+void* vpApgexSetCtor(exception* spEx);
+void vApgexSetDtor(void* vpCtx);
+aint uiApgexSetAdd(void* vpCtx, const char* cpPattern);
+void vApgexSetCompile(void* vpCtx, const char* cpFlags);
+void vApgexSetEnable(void* vpCtx, aint uiPattern, abool bEnable);
+apgex_set_result sApgexSetExec(void* vpCtx, apg_phrase* spSource);
+void vApgexSetDisplayResult(void* vpCtx, apgex_set_result* spResult, const char* cpFileName);
+void vApgexSetDisplayPatternErrors(void* vpCtx, const char* cpFileName);
+///@}
+
 /** @name Display Helpers */
 ///@{
 void vApgexDisplayResult(void* vpCtx, apgex_result* spResult, const char* cpFileName);
@@ -180,6 +316,8 @@ void vApgexBkrCheck(exception* spEx);
  - [Replace the Matched Phrase](\ref apgex_anchor_replace)<br>
  - [Split - Matched Phrases as Delimiters](\ref apgex_anchor_split)<br>
 
+[Stream Matching](\ref apgex_anchor_stream)<br>
+[Pattern Sets](\ref apgex_anchor_sets)<br>
 [Properties](\ref apgex_anchor_props)<br>
 [Trace - the Debugger](\ref apgex_anchor_trace)<br>
 [Abstract Syntax Tree - the Matched Phrase AST](\ref apgex_anchor_ast)<br>
@@ -298,6 +436,50 @@ spApgexSplit()<br>
  See the function description for details.<br>
 [&uarr;top](\ref apgex_anchor_top)
 
+\anchor apgex_anchor_stream
+### Stream Matching
+The execution functions above require the entire source string in memory.
+For very large sources, such as multi-gigabyte log files, luiApgexStreamFile() and luiApgexStreamBuffer()
+scan a file or a memory buffer, for example a memory-mapped file, through a window of bounded size.
+A user-supplied callback function is called for each matched phrase, with any enabled rule and UDT phrases.
+Nothing is accumulated between matches. Matched phrases are limited to a maximum length,
+which bounds the size of the window.
+
+The replace and split functions likewise build their complete output in memory.
+Their streaming counterparts write the output, as it is found, to a user-supplied sink function
+(see \ref pfn_apgex_sink). vApgexSinkFile() is a ready-made sink that writes to an open file.
+ - luiApgexReplaceSink() and luiApgexReplaceFuncSink() - replace in a source string
+ - luiApgexReplaceFile() - replace in a file
+ - luiApgexSplitSink() - split a source string
+ - luiApgexSplitFile() - split a file
+
+Sources, strings as well as files, are scanned through a window of bounded size, as for the stream matching functions.
+The output begins before the scan ends and neither the source nor the output is ever copied as a whole.
+The left and right contexts of the matched phrases are not available.
+Therefore, the replacement phrase may not refer to them or to the whole source (`$_`, `` $` `` and `$'`).
+
+For line- or record-oriented buffers, luiApgexParallelBuffer() spreads the scan over several threads.
+The buffer is divided into chunks ending at a user-supplied record delimiter, for example `"\n"`.
+Each worker thread scans chunks with its own parser and the matched phrases are merged and reported
+in offset order, exactly as luiApgexStreamBuffer() would report them.<br>
+[&uarr;top](\ref apgex_anchor_top)
+
+\anchor apgex_anchor_sets
+### Pattern Sets
+When the same source must be searched for many different patterns, a pattern set does it in a single pass
+rather than with many `apgex` objects and many scans of the source.
+The patterns are compiled together into a single combined grammar, each pattern's rule names being private to it.
+At each offset of the source only the patterns whose start rules can begin with the character there are attempted.
+The results report which patterns matched and every matched phrase with the index of the pattern that matched it.
+ - vpApgexSetCtor() and vApgexSetDtor() - construction and destruction
+ - uiApgexSetAdd() - add a pattern to the set
+ - vApgexSetCompile() - compile the set and choose between reporting all matches or only the first matching pattern at each offset
+ - vApgexSetEnable() - enable or disable individual patterns
+ - sApgexSetExec() - match the enabled patterns against a source string
+ - vApgexSetDisplayResult() and vApgexSetDisplayPatternErrors() - display helpers
+
+[&uarr;top](\ref apgex_anchor_top)
+
 \anchor apgex_anchor_props
 ### Properties
 Properties are the current state of the `apgex` object. In addition to the last phrase match, if any,
@@ -324,6 +506,14 @@ It may be that a more complex translation of the matched phrases is needed than
 The AST is the ultimate translation tool as discussed in the [library](\ref library) section.
 The full capabilities of the AST library are available for the translation or manipulation of the matched phrases.
 Use vpApgexGetAst() to get a pointer to the AST object's context.<br>
+
+If no rules or UDTs are [enabled](\ref vApgexEnableRules()), there is nothing to capture but the matched phrase itself.
+The phrase-matching functions then run capture-free: the AST is detached from the parser,
+no AST records are kept and, if available, the lean operator set (\ref APG_LEAN_OPERATORS) is used.
+bApgexTest() and spApgexSplit() always run capture-free. sApgexReplaceFunc() never does,
+since its replacement function is handed the AST with the properties.
+Enabling any rule or UDT switches back to the full, AST-recording parse for the next match.
+If the AST is requested after a capture-free match, the match is re-parsed once to build it.<br>
 [&uarr;top](\ref apgex_anchor_top)
 
 \anchor apgex_anchor_display
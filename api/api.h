@@ -86,6 +86,7 @@ typedef struct{
     luint luiMapSize; ///< \brief The size, in bytes, of a single PPPT table entry (map).
     luint luiMaps; ///< \brief The number of maps needed.
     luint luiTableSize; /**< \brief The memory requirement, in bytes, of the full table. */
+    luint luiMaps2; /**< \brief The number of second-level (two-character) maps. Known only after vApiPppt2(). */
 } pppt_size;
 
 // the API constructor and destructor
@@ -152,6 +153,7 @@ void vApiAttrsErrorsToAscii(void *vpCtx, const char *cpMode, const char *cpFileN
  * */
 ///@{
 void vApiPppt(void *vpCtx, char **cppProtectedRules, aint uiProtectedRules);
+void vApiPppt2(void *vpCtx);
 void vApiPpptSize(void *vpCtx, pppt_size* spSize);
 ///@}
 
@@ -178,6 +180,7 @@ void vApiString(void *vpCtx, const char *cpString, abool bStrict, abool bPppt);
 ///@{
 void vApiOutput(void *vpCtx, const char *cpOutput);
 void* vpApiOutputParser(void* vpCtx);
+void* vpApiOutputParserInit(void* vpCtx);
 ///@}
 
 /** \page api The Parser Generator API
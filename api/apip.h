@@ -165,12 +165,14 @@ typedef struct {
 
     // PPPT table
     abool bUsePppt; ///< \brief True of PPPT are being used.
+    abool bUsePppt2; ///< \brief True if the second-level (two-character) PPPT maps have been generated.
     uint8_t *ucpPpptUndecidedMap; ///< \brief Common PPPT character map for an operator that is indeterminate on the next alphabet character.
     uint8_t *ucpPpptEmptyMap; ///< \brief Common PPPT character map for an operator that is an empty match on the next alphabet character.
     uint8_t *ucpPpptTable; ///< \brief Pointer to the PPPT table of operator maps.
     luint luiPpptTableLength; ///< \brief The PPPT length.
     luint luiPpptMapCount; ///< \brief The number of operator maps in the table.
     luint luiPpptMapSize; ///< \brief The size, in bytes, of a single operator map.
+    luint luiPpptMap2Count; ///< \brief The number of second-level (two-character) maps appended to the table.
     luint luiAcharMin; ///< \brief The minimum alphabet character referenced by the terminal nodes, TLS, TBL & TRG.
     luint luiAcharMax; ///< \brief The maximum alphabet character referenced by the terminal nodes, TLS, TBL & TRG.
     luint luiAcharEos; ///< \brief The special End-Of-String character. In practice, luiAcharMax + 1.
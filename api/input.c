@@ -69,6 +69,8 @@ void vApiInClear(void* vpCtx) {
     vLinesDtor(spCtx->vpLines);
     vAttrsDtor(spCtx->vpAttrsCtx);
     vParserDtor(spCtx->vpParser);
+    spCtx->vpParser = NULL;
+    spCtx->vpAst = NULL;
     vMemFree(spCtx->vpMem, spCtx->spOpcodes);
     spCtx->spOpcodes = NULL;
     vMemFree(spCtx->vpMem, spCtx->spRules);
@@ -103,6 +105,7 @@ void vApiInClear(void* vpCtx) {
     spCtx->bSyntaxValid = APG_FALSE;
     spCtx->bSemanticsValid = APG_FALSE;
     spCtx->bUsePppt = APG_FALSE;
+    spCtx->bUsePppt2 = APG_FALSE;
 }
 
 /** \brief Reads an SABNF grammar byte stream from a file.
@@ -125,6 +125,8 @@ static abool bNameToCamelCase(const char* cpPrefix, const char* cpName, char* cp
 static void vOutputHeader(api* spApi, const char* cpName, FILE* spOut);
 static void vOutputSource(api* spApi, const char* cpName, FILE* spOut);
 static void* vpOutputParser(api* spApi);
+static void vOutputParserInit(api* spApi, parser_init* spParserInit);
+static size_t uiAlign(size_t uiSize);
 static int iCompRule(const void* vpL, const void* vpR);
 static int iCompUdt(const void* vpL, const void* vpR);
 static char cToUpper(char cChar);
@@ -235,6 +237,72 @@ void* vpApiOutputParser(void* vpCtx) {
     return vpOutputParser(spApi);
 }
 
+/** \brief Generate the parser initialization data in a single, self-contained block of memory.
+ *
+ * The block holds the same data as the generated source file of \ref vApiOutput().
+ * Any number of parsers can be constructed from it with \ref vpParserCtor(), as from the generated file.
+ * These parsers share its tables, read only, rather than copying them.
+ * This is for applications that construct many parsers from the same grammar.
+ *
+ * \param vpCtx Pointer to an API context previously returned from vpApiCtor().
+ * \return Pointer to the initialization data, allocated with malloc().
+ * The application owns it and must free() it, but only after all parsers constructed from it have been destroyed.
+ * Throws exceptions on errors.
+ */
+void* vpApiOutputParserInit(void* vpCtx){
+    if(!bApiValidate(vpCtx)){
+        vExContext();
+    }
+    api* spApi = (api*) vpCtx;
+    vMsgsClear(spApi->vpLog);
+    if (!spApi->bInputValid) {
+        XTHROW(spApi->spException, "attempted output but input grammar not validated");
+    }
+    if (!spApi->bSyntaxValid) {
+        XTHROW(spApi->spException, "attempted output but syntax not validated");
+    }
+    if (!spApi->bSemanticsValid) {
+        XTHROW(spApi->spException, "attempted output but opcodes have not been constructed and validated");
+    }
+    parser_init sInit;
+    vOutputParserInit(spApi, &sInit);
+
+    // the sizes of the four tables, each aligned for the widest integer
+    init_hdr_out* spHdr = (init_hdr_out*)spApi->luipInit;
+    size_t uiStrings = uiAlign((size_t)sInit.uiStringTableLength);
+    size_t uiPppt = sInit.ucpPpptTable ? uiAlign((size_t)sInit.uiPpptTableLength) : 0;
+    size_t uiAcharBytes = (size_t)uiGetSize(spApi->luiAcharMax) * (size_t)sInit.uiAcharTableLength;
+    size_t uiInitBytes = (size_t)uiGetSize(spHdr->luiUintMax) * (size_t)sInit.uiParserInitLength;
+    size_t uiAchars = uiAlign(uiAcharBytes);
+    size_t uiInit = uiAlign(uiInitBytes);
+    size_t uiHdr = uiAlign(sizeof(parser_init));
+    uint8_t* ucpBlock = (uint8_t*)malloc(uiHdr + uiStrings + uiPppt + uiAchars + uiInit);
+    if(!ucpBlock){
+        XTHROW(spApi->spException, "malloc failed to allocate the parser initialization data");
+    }
+    parser_init* spInit = (parser_init*)ucpBlock;
+    uint8_t* ucpNext = ucpBlock + uiHdr;
+    *spInit = sInit;
+    memcpy((void*)ucpNext, (void*)sInit.cpStringTable, (size_t)sInit.uiStringTableLength);
+    spInit->cpStringTable = (const char*)ucpNext;
+    ucpNext += uiStrings;
+    if(uiPppt){
+        memcpy((void*)ucpNext, (void*)sInit.ucpPpptTable, (size_t)sInit.uiPpptTableLength);
+        spInit->ucpPpptTable = (const uint8_t*)ucpNext;
+        ucpNext += uiPppt;
+    }
+    if(sInit.uiAcharTableLength){
+        memcpy((void*)ucpNext, sInit.vpAcharTable, uiAcharBytes);
+        spInit->vpAcharTable = (const void*)ucpNext;
+        ucpNext += uiAchars;
+    }else{
+        spInit->vpAcharTable = NULL;
+    }
+    memcpy((void*)ucpNext, sInit.vpParserInit, uiInitBytes);
+    spInit->vpParserInit = (const void*)ucpNext;
+    return (void*)ucpBlock;
+}
+
 static void vOutputHeader(api* spApi, const char* cpName, FILE* spOut){
     aint uiBufSize = PATH_MAX;
     char caDefine[PATH_MAX];
@@ -456,6 +524,9 @@ static void vOutputSource(api* spApi, const char* cpName, FILE* spOut){
     }
     fprintf(spOut, "//   no. maps = %"PRIuMAX"\n", spApi->luiPpptMapCount);
     fprintf(spOut, "//   map size = %"PRIuMAX" (bytes)\n", spApi->luiPpptMapSize);
+    if(spApi->bUsePppt2){
+        fprintf(spOut, "//   2nd maps = %"PRIuMAX"\n", spApi->luiPpptMap2Count);
+    }
     if(spApi->luiPpptTableLength == (luint)APG_MAX_AINT){
         fprintf(spOut, "// table size = %"PRIuMAX" (overflow)\n", spApi->luiPpptTableLength);
     }else{
@@ -518,6 +589,12 @@ static void vOutputSource(api* spApi, const char* cpName, FILE* spOut){
 }
 
 static void* vpOutputParser(api* spApi){
+    parser_init sParserInit = {};
+    vOutputParserInit(spApi, &sParserInit);
+    return vpParserAllocCtor(spApi->spException, &sParserInit, APG_TRUE);
+}
+
+static void vOutputParserInit(api* spApi, parser_init* spParserInit){
     luint* luipInit = NULL;
     if(spApi->luipInit){
         vMemFree(spApi->vpMem, spApi->luipInit);
@@ -525,26 +602,25 @@ static void* vpOutputParser(api* spApi){
     spApi->luipInit = luipMakeInitData(spApi);
     luipInit = spApi->luipInit;
     init_hdr_out* spHdr = (init_hdr_out*)luipInit;
-    parser_init sParserInit = {};
-    sParserInit.uiSizeofAchar = (aint)spHdr->luiSizeofAchar;
-    sParserInit.uiSizeofUint = (aint)spHdr->luiSizeofUint;
+    memset((void*)spParserInit, 0, sizeof(*spParserInit));
+    spParserInit->uiSizeofAchar = (aint)spHdr->luiSizeofAchar;
+    spParserInit->uiSizeofUint = (aint)spHdr->luiSizeofUint;
 
     // the string table
-    sParserInit.cpStringTable = spApi->cpStringTable;
-    sParserInit.uiStringTableLength = spApi->uiStringTableLength;
+    spParserInit->cpStringTable = spApi->cpStringTable;
+    spParserInit->uiStringTableLength = spApi->uiStringTableLength;
 
     // the PPPT maps
-    sParserInit.ucpPpptTable = spApi->ucpPpptTable;
-    sParserInit.uiPpptTableLength = spApi->luiPpptTableLength;
+    spParserInit->ucpPpptTable = spApi->ucpPpptTable;
+    spParserInit->uiPpptTableLength = spApi->luiPpptTableLength;
 
     // the achar table
-    sParserInit.vpAcharTable = vpMakeAcharTable(spApi, spApi->luiAcharMax,
+    spParserInit->vpAcharTable = vpMakeAcharTable(spApi, spApi->luiAcharMax,
             spApi->luipAcharTable, spApi->uiAcharTableLength);
-    sParserInit.uiAcharTableLength = spApi->uiAcharTableLength;
+    spParserInit->uiAcharTableLength = spApi->uiAcharTableLength;
 
-    sParserInit.uiParserInitLength = (aint)spHdr->luiSizeInInts;
-    sParserInit.vpParserInit = vpMakeParserInit(spApi, spHdr->luiUintMax, luipInit, sParserInit.uiParserInitLength);
-    return vpParserAllocCtor(spApi->spException, &sParserInit, APG_TRUE);
+    spParserInit->uiParserInitLength = (aint)spHdr->luiSizeInInts;
+    spParserInit->vpParserInit = vpMakeParserInit(spApi, spHdr->luiUintMax, luipInit, spParserInit->uiParserInitLength);
 }
 
 static luint* luipMakeInitData(api* spApi){
@@ -1074,6 +1150,10 @@ static void vPrintLongs(FILE* spOut, const luint* luiVals, aint uiLength){
     }
 }
 
+static size_t uiAlign(size_t uiSize){
+    return (uiSize + 7) & ~(size_t)7;
+}
+
 static aint uiGetSize(luint luiValue){
     if(luiValue <= 0xFF){
         return 1;
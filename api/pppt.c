@@ -37,6 +37,16 @@
  *
  * For example, if parsing a grammar that uses the full range of UTF-32 characters the alphabet character range
  * is 0x00 - 0x10FFFF. Not a good fit for PPPTs.
+ *
+ * Many of the non-deterministic (ACTIVE) map entries can be resolved by looking at a second character.
+ * For example, `"/" / "//"` or `"%" 2HEXDIG`.
+ * Optionally, vApiPppt2() follows the single-character maps with a bounded number
+ * of second-level maps. A second-level map is keyed on the character following the map's leading character
+ * and refines the ACTIVE entry into NOMATCH, EMPTY, MATCH, MATCH2 (a two-character phrase) or, failing that, ACTIVE.
+ * In the single-character map, an entry of \ref ID_PPPT_MAP2 + i indicates an ACTIVE character with second-level map i.
+ * At most \ref PPPT_MAP2_MAX distinct second-level maps are generated, appended to the PPPT table.
+ * More operators are deterministic on two characters than on one, so more rules are hidden under PPPT-mapped nodes.
+ * Rules with callback functions that must always be called need to be protected in vApiPppt().
  */
 
 // sanity check assertion
@@ -88,6 +98,9 @@ static void vAltMap(api* spApi, api_op* spOp, uint8_t* ucpMap);
 static void vCatMap(api* spApi, api_op* spOp, uint8_t* ucpMap);
 static void vRepMap(api* spApi, api_op* spOp, uint8_t* ucpMap);
 static void vOpcodeMap(api* spApi, api_op* spOp, uint8_t* ucpMap);
+#ifndef APG_NO_PPPT2
+static void vGetMaps2(api* spApi);
+#endif /* APG_NO_PPPT2 */
 
 /** \brief Compute the Partially-Predictive Parsing Tables.
  *
@@ -232,6 +245,35 @@ void vApiPppt(void* vpCtx, char** cppProtectedRules, aint uiProtectedRules){
 
     // success
     spApi->bUsePppt = APG_TRUE;
+    spApi->bUsePppt2 = APG_FALSE;
+    spApi->luiPpptMap2Count = 0;
+}
+
+/** \brief Refine the Partially-Predictive Parsing Tables with second-level, two-character maps.
+ *
+ * Optional. Must follow vApiPppt(). Each ACTIVE entry of a single-character map that can be resolved
+ * by the following character is replaced with a second-level map keyed on that character.
+ * Note that more rules may be hidden under PPPT-mapped nodes than with the single-character maps alone.
+ * Any rule with a callback function that may reject a phrase, or that must otherwise always be called,
+ * must be protected in the call to vApiPppt().
+ * Does nothing if the macro APG_NO_PPPT2 is defined or if called more than once.
+ * \param vpCtx Context pointer previously returned from vpApiCtor().
+ */
+void vApiPppt2(void* vpCtx){
+    if(!bApiValidate(vpCtx)){
+        vExContext();
+    }
+    api* spApi = (api*) vpCtx;
+    if (!spApi->bUsePppt) {
+        XTHROW(spApi->spException,
+                "attempted second-level PPPT construction but the PPPT maps (vApiPppt()) have not been constructed");
+    }
+#ifndef APG_NO_PPPT2
+    if(!spApi->bUsePppt2){
+        vGetMaps2(spApi);
+        spApi->bUsePppt2 = APG_TRUE;
+    }
+#endif /* APG_NO_PPPT2 */
 }
 
 /** \brief Compute the size of the PPPT maps and the number of bytes for the entire table.
@@ -259,6 +301,7 @@ void vApiPpptSize(void *vpCtx, pppt_size* spSize){
     spSize->luiMapSize = spApi->luiPpptMapSize;
     spSize->luiMaps = spApi->luiPpptMapCount;
     spSize->luiTableSize = spApi->luiPpptTableLength;
+    spSize->luiMaps2 = spApi->luiPpptMap2Count;
 }
 
 static void vSetMapValGen(uint8_t* ucpMap, luint luiOffset, luint luiChar, uint8_t ucVal){
@@ -528,6 +571,383 @@ static void vOpcodeMap(api* spApi, api_op* spOp, uint8_t* ucpMap){
     }
     TRACE_OPCODE_CLOSE(spOp);
 }
+#ifndef APG_NO_PPPT2
+// The possible outcomes of an operator, two characters into the input string, as a set of bits.
+// Lengths are counted from the current position, with everything beyond two characters lumped together.
+#define OUT_NOMATCH 0x01 // the operator fails
+#define OUT_LEN0    0x02 // the operator matches the empty phrase
+#define OUT_LEN1    0x04 // the operator matches a phrase of length 1
+#define OUT_LEN2    0x08 // the operator matches a phrase of length 2
+#define OUT_LONG    0x10 // the operator matches a phrase of length 3 or more
+#define OUT_ALL     0x1F // anything can happen
+#define OUT_OPEN    0x80 // memo marker - this operator is being evaluated
+#define OUT_LENS    (OUT_LEN0 | OUT_LEN1 | OUT_LEN2 | OUT_LONG)
+
+// no second-level maps are computed for alphabets larger than this
+#define PPPT_MAP2_MAX_SIZE 1024
+
+/** \struct pppt2_ctx
+ * \brief Working data for the computation of the second-level maps.
+ */
+typedef struct{
+    api* spApi; ///< \brief Pointer to the API context.
+    luint luiChar; ///< \brief The leading character of the second-level maps being computed.
+    uint8_t* ucpMemo; ///< \brief Outcomes of each opcode for each second character with the current leading character.
+} pppt2_ctx;
+
+static uint8_t ucOutcomes(pppt2_ctx* spCtx, api_op* spOp, luint luiNext);
+
+// move all lengths in the outcome set up by uiShift characters, saturating at OUT_LONG
+static uint8_t ucShift(uint8_t ucSet, aint uiShift){
+    uint8_t ucLens = ucSet & OUT_LENS;
+    while(uiShift--){
+        ucLens = (uint8_t)(((ucLens << 1) & OUT_LENS) | (ucLens & OUT_LONG));
+    }
+    return ucLens;
+}
+
+// the number of characters to a position (OUT_LONG, i.e. three, saturates)
+static aint uiPosLength(uint8_t ucPos){
+    switch(ucPos){
+    case OUT_LEN0:
+        return 0;
+    case OUT_LEN1:
+        return 1;
+    case OUT_LEN2:
+        return 2;
+    }
+    return 3;
+}
+
+// the outcomes of an operator at the second character - only the single-character map is known
+static uint8_t ucOutcomes1(pppt2_ctx* spCtx, api_op* spOp, luint luiNext){
+    api* spApi = spCtx->spApi;
+    uint8_t ucVal;
+    switch(spOp->uiId){
+    case ID_RNM:
+        ucVal = spApi->ucpPpptTable[spApi->spRules[spOp->uiIndex].uiPpptIndex + (luiNext - spApi->luiAcharMin)];
+        break;
+    case ID_ALT:
+    case ID_CAT:
+    case ID_REP:
+    case ID_TRG:
+    case ID_TLS:
+    case ID_TBS:
+    case ID_AND:
+    case ID_NOT:
+        ucVal = spApi->ucpPpptTable[spOp->uiPpptIndex + (luiNext - spApi->luiAcharMin)];
+        break;
+    default:
+        return OUT_ALL;
+    }
+    switch(ucVal){
+    case ID_PPPT_NOMATCH:
+        return OUT_NOMATCH;
+    case ID_PPPT_MATCH:
+        return OUT_LEN1;
+    case ID_PPPT_EMPTY:
+        return OUT_LEN0;
+    }
+    return OUT_ALL;
+}
+
+// the outcomes of an operator at the given position (OUT_LEN0, etc.) relative to the leading character
+static uint8_t ucOutcomesAt(pppt2_ctx* spCtx, api_op* spOp, uint8_t ucPos, luint luiNext){
+    if(ucPos == OUT_LEN0){
+        return ucOutcomes(spCtx, spOp, luiNext);
+    }
+    if(ucPos == OUT_LEN1){
+        return ucOutcomes1(spCtx, spOp, luiNext);
+    }
+    return OUT_ALL;
+}
+
+// follow the REP operator from the given repetition count and position
+static uint8_t ucRepOutcomes(pppt2_ctx* spCtx, api_op* spOp, luint luiCount, uint8_t ucPos, luint luiNext){
+    uint8_t ucReturn = 0;
+    uint8_t ucChild, ucLen;
+    if(ucPos & (OUT_LEN2 | OUT_LONG)){
+        // beyond the known characters, any longer phrase is possible and failure only if the minimum is not yet met
+        ucReturn = (ucPos == OUT_LEN2) ? (OUT_LEN2 | OUT_LONG) : OUT_LONG;
+        if(luiCount < spOp->luiMin){
+            ucReturn |= OUT_NOMATCH;
+        }
+        return ucReturn;
+    }
+    ucChild = ucOutcomesAt(spCtx, (spOp + 1), ucPos, luiNext);
+    if(ucChild & OUT_NOMATCH){
+        ucReturn |= (luiCount >= spOp->luiMin && luiCount <= spOp->luiMax) ? ucPos : OUT_NOMATCH;
+    }
+    if(ucChild & OUT_LEN0){
+        // REP succeeds on empty, regardless of min/max
+        ucReturn |= ucPos;
+    }
+    for(ucLen = OUT_LEN1; ucLen <= OUT_LONG; ucLen <<= 1){
+        if(ucChild & ucLen){
+            uint8_t ucNext = ucShift(ucLen, uiPosLength(ucPos));
+            if((luiCount + 1) >= spOp->luiMax){
+                ucReturn |= ucNext;
+            }else{
+                ucReturn |= ucRepOutcomes(spCtx, spOp, (luiCount + 1), ucNext, luiNext);
+            }
+        }
+    }
+    return ucReturn;
+}
+
+// compare the leading and next characters to a TLS or TBS string
+static uint8_t ucStringOutcomes(pppt2_ctx* spCtx, api_op* spOp, luint luiNext, abool bCaseInsensitive){
+    luint luiFirst = spCtx->luiChar;
+    luint luiSecond = luiNext;
+    if(spOp->uiAcharLength == 0){
+        return OUT_LEN0;
+    }
+    if(bCaseInsensitive){
+        // TLS strings are already lower case
+        if(luiFirst >= 65 && luiFirst <= 90){
+            luiFirst += 32;
+        }
+        if(luiSecond >= 65 && luiSecond <= 90){
+            luiSecond += 32;
+        }
+    }
+    if(luiFirst != spOp->luipAchar[0]){
+        return OUT_NOMATCH;
+    }
+    if(spOp->uiAcharLength == 1){
+        return OUT_LEN1;
+    }
+    if(luiNext == spCtx->spApi->luiAcharEos || luiSecond != spOp->luipAchar[1]){
+        return OUT_NOMATCH;
+    }
+    if(spOp->uiAcharLength == 2){
+        return OUT_LEN2;
+    }
+    return OUT_NOMATCH | OUT_LONG;
+}
+
+/** Evaluate the possible outcomes of an operator at the map's leading character
+ * with luiNext as the following character (or the EOS character).
+ */
+static uint8_t ucOutcomes(pppt2_ctx* spCtx, api_op* spOp, luint luiNext){
+    api* spApi = spCtx->spApi;
+    uint8_t* ucpMemo = &spCtx->ucpMemo[(luint)(spOp - spApi->spOpcodes) * spApi->luiPpptMapSize
+                                       + (luiNext - spApi->luiAcharMin)];
+    uint8_t ucReturn = 0;
+    uint8_t ucChild, ucPos, ucNextPos, ucBit;
+    aint ui;
+    if(*ucpMemo == OUT_OPEN){
+        // should not happen with a grammar free of left recursion, but be safe
+        return OUT_ALL;
+    }
+    if(*ucpMemo){
+        return *ucpMemo;
+    }
+    *ucpMemo = OUT_OPEN;
+    switch(spOp->uiId){
+    case ID_ALT:
+        ucChild = OUT_NOMATCH;
+        for(ui = 0; ui < spOp->uiChildCount; ui++){
+            // the next alternative is only tried if this one can fail
+            ucChild = ucOutcomes(spCtx, &spApi->spOpcodes[spOp->uipChildIndex[ui]], luiNext);
+            ucReturn |= ucChild & OUT_LENS;
+            if(!(ucChild & OUT_NOMATCH)){
+                break;
+            }
+        }
+        ucReturn |= ucChild & OUT_NOMATCH;
+        break;
+    case ID_CAT:
+        // track the set of positions reachable after each child
+        ucPos = OUT_LEN0;
+        for(ui = 0; ui < spOp->uiChildCount && ucPos; ui++){
+            ucNextPos = 0;
+            for(ucBit = OUT_LEN0; ucBit <= OUT_LONG; ucBit <<= 1){
+                if(ucPos & ucBit){
+                    ucChild = ucOutcomesAt(spCtx, &spApi->spOpcodes[spOp->uipChildIndex[ui]], ucBit, luiNext);
+                    ucReturn |= ucChild & OUT_NOMATCH;
+                    ucNextPos |= ucShift(ucChild, uiPosLength(ucBit));
+                }
+            }
+            ucPos = ucNextPos;
+        }
+        ucReturn |= ucPos;
+        break;
+    case ID_REP:
+        ucReturn = ucRepOutcomes(spCtx, spOp, 0, OUT_LEN0, luiNext);
+        break;
+    case ID_RNM:
+        if(spApi->spRules[spOp->uiIndex].bProtected){
+            ucReturn = OUT_ALL;
+        }else{
+            ucReturn = ucOutcomes(spCtx, &spApi->spOpcodes[spApi->spRules[spOp->uiIndex].uiOpOffset], luiNext);
+        }
+        break;
+    case ID_AND:
+        ucChild = ucOutcomes(spCtx, (spOp + 1), luiNext);
+        ucReturn = (ucChild & OUT_NOMATCH) | ((ucChild & OUT_LENS) ? OUT_LEN0 : 0);
+        break;
+    case ID_NOT:
+        ucChild = ucOutcomes(spCtx, (spOp + 1), luiNext);
+        ucReturn = ((ucChild & OUT_NOMATCH) ? OUT_LEN0 : 0) | ((ucChild & OUT_LENS) ? OUT_NOMATCH : 0);
+        break;
+    case ID_TRG:
+        ucReturn = (spCtx->luiChar >= spOp->luiMin && spCtx->luiChar <= spOp->luiMax) ? OUT_LEN1 : OUT_NOMATCH;
+        break;
+    case ID_TLS:
+        ucReturn = ucStringOutcomes(spCtx, spOp, luiNext, APG_TRUE);
+        break;
+    case ID_TBS:
+        ucReturn = ucStringOutcomes(spCtx, spOp, luiNext, APG_FALSE);
+        break;
+    default:
+        // UDT, BKR, BKA, BKN, ABG & AEN are unpredictable
+        ucReturn = OUT_ALL;
+        break;
+    }
+    *ucpMemo = ucReturn;
+    return ucReturn;
+}
+
+// hash a second-level map for quick duplicate detection
+static uint32_t uiHashMap(uint8_t* ucpMap, luint luiLen){
+    uint32_t uiHash = 2166136261u;
+    luint lu = 0;
+    for(; lu < luiLen; lu++){
+        uiHash = (uiHash ^ ucpMap[lu]) * 16777619u;
+    }
+    return uiHash;
+}
+
+/** Compute the second-level maps.
+ * For each ACTIVE entry in each single-character map, compute the map of values for the following character.
+ * Identical maps are shared. Maps with no deterministic values are discarded.
+ * The maps are appended to the PPPT table and the ACTIVE entries replaced with ID_PPPT_MAP2 + (map index).
+ */
+static void vGetMaps2(api* spApi){
+    luint luiMapSize = spApi->luiPpptMapSize;
+    luint luiMaps = spApi->luiPpptMapCount;
+    luint luiChar, luiNext, lu, luiIndex;
+    aint ui;
+    api_op* spOp;
+    uint8_t ucVal;
+    abool bDeterministic;
+    pppt2_ctx sCtx;
+    spApi->luiPpptMap2Count = 0;
+    if(luiMapSize > PPPT_MAP2_MAX_SIZE){
+        // the alphabet is too large for this to be practical
+        return;
+    }
+    // the operator (first opcode of the rule for rule maps) for each map in the table
+    api_op** sppMapOps = (api_op**)vpMemAlloc(spApi->vpMem, (aint)(luiMaps * sizeof(api_op*)));
+    memset((void*)sppMapOps, 0, (size_t)(luiMaps * sizeof(api_op*)));
+    for(ui = 0; ui < spApi->uiRuleCount; ui++){
+        if(!spApi->spRules[ui].bProtected){
+            sppMapOps[spApi->spRules[ui].uiPpptIndex / luiMapSize] = &spApi->spOpcodes[spApi->spRules[ui].uiOpOffset];
+        }
+    }
+    spOp = spApi->spOpcodes;
+    for(ui = 0; ui < spApi->uiOpcodeCount; ui++, spOp++){
+        switch (spOp->uiId) {
+        case ID_ALT:
+        case ID_CAT:
+        case ID_REP:
+        case ID_TRG:
+        case ID_TLS:
+        case ID_TBS:
+        case ID_AND:
+        case ID_NOT:
+            sppMapOps[spOp->uiPpptIndex / luiMapSize] = spOp;
+            break;
+        }
+    }
+
+    // the second-level maps, their hashes, and the single-character map entries to point to them
+    uint8_t* ucpMaps2 = (uint8_t*)vpMemAlloc(spApi->vpMem, (aint)(PPPT_MAP2_MAX * luiMapSize));
+    uint32_t uiaHash[PPPT_MAP2_MAX];
+    void* vpVecEntries = vpVecCtor(spApi->vpMem, sizeof(luint), 1024);
+    uint8_t ucaMap2[luiMapSize];
+    sCtx.spApi = spApi;
+    sCtx.ucpMemo = (uint8_t*)vpMemAlloc(spApi->vpMem, (aint)((luint)spApi->uiOpcodeCount * luiMapSize));
+    for(luiChar = spApi->luiAcharMin; luiChar < spApi->luiAcharEos; luiChar++){
+        memset((void*)sCtx.ucpMemo, 0, (size_t)((luint)spApi->uiOpcodeCount * luiMapSize));
+        sCtx.luiChar = luiChar;
+        for(lu = 0; lu < luiMaps; lu++){
+            luiIndex = lu * luiMapSize + (luiChar - spApi->luiAcharMin);
+            if(!sppMapOps[lu] || spApi->ucpPpptTable[luiIndex] != ID_PPPT_ACTIVE){
+                continue;
+            }
+            bDeterministic = APG_FALSE;
+            for(luiNext = spApi->luiAcharMin; luiNext <= spApi->luiAcharEos; luiNext++){
+                switch(ucOutcomes(&sCtx, sppMapOps[lu], luiNext)){
+                case OUT_NOMATCH:
+                    ucVal = ID_PPPT_NOMATCH;
+                    break;
+                case OUT_LEN0:
+                    ucVal = ID_PPPT_EMPTY;
+                    break;
+                case OUT_LEN1:
+                    ucVal = ID_PPPT_MATCH;
+                    break;
+                case OUT_LEN2:
+                    ucVal = ID_PPPT_MATCH2;
+                    break;
+                default:
+                    ucVal = ID_PPPT_ACTIVE;
+                    break;
+                }
+                if(ucVal != ID_PPPT_ACTIVE){
+                    bDeterministic = APG_TRUE;
+                }
+                ucaMap2[luiNext - spApi->luiAcharMin] = ucVal;
+            }
+            if(!bDeterministic){
+                continue;
+            }
+            // share identical maps
+            uint32_t uiHash = uiHashMap(ucaMap2, luiMapSize);
+            luint luiMap2;
+            for(luiMap2 = 0; luiMap2 < spApi->luiPpptMap2Count; luiMap2++){
+                if(uiaHash[luiMap2] == uiHash
+                        && memcmp((void*)&ucpMaps2[luiMap2 * luiMapSize], (void*)ucaMap2, luiMapSize) == 0){
+                    break;
+                }
+            }
+            if(luiMap2 == spApi->luiPpptMap2Count){
+                if(luiMap2 == PPPT_MAP2_MAX){
+                    // table is full, leave this one ACTIVE
+                    continue;
+                }
+                memcpy((void*)&ucpMaps2[luiMap2 * luiMapSize], (void*)ucaMap2, luiMapSize);
+                uiaHash[luiMap2] = uiHash;
+                spApi->luiPpptMap2Count++;
+            }
+            vpVecPush(vpVecEntries, (void*)&luiIndex);
+            luiIndex = luiMap2;
+            vpVecPush(vpVecEntries, (void*)&luiIndex);
+        }
+    }
+
+    if(spApi->luiPpptMap2Count){
+        // append the second-level maps to the table and point the ACTIVE entries to them
+        luint luiLength = spApi->luiPpptTableLength + spApi->luiPpptMap2Count * luiMapSize;
+        spApi->ucpPpptTable = (uint8_t*)vpMemRealloc(spApi->vpMem, spApi->ucpPpptTable, (aint)luiLength);
+        memcpy((void*)&spApi->ucpPpptTable[spApi->luiPpptTableLength], (void*)ucpMaps2,
+                (size_t)(spApi->luiPpptMap2Count * luiMapSize));
+        spApi->luiPpptTableLength = luiLength;
+        luint* luipEntries = (luint*)vpVecFirst(vpVecEntries);
+        luint luiEntries = (luint)uiVecLen(vpVecEntries);
+        for(lu = 0; lu < luiEntries; lu += 2){
+            spApi->ucpPpptTable[luipEntries[lu]] = (uint8_t)(ID_PPPT_MAP2 + luipEntries[lu + 1]);
+        }
+    }
+    vVecDtor(vpVecEntries);
+    vMemFree(spApi->vpMem, sCtx.ucpMemo);
+    vMemFree(spApi->vpMem, ucpMaps2);
+    vMemFree(spApi->vpMem, sppMapOps);
+}
+#endif /* APG_NO_PPPT2 */
+
 static int iCompOps(const void* vpL, const void* vpR){
     api_rule* spRuleL = (api_rule*)vpL;
     api_rule* spRuleR = (api_rule*)vpR;
@@ -74,7 +74,17 @@ The compiled example will execute the following cases. Run the application with
  - case 14: Illustrate extracting quoted and unquoted fields from Comma Separated Value (CSV) records.
  - case 15: Illustrate the use of patterns with wide characters.
  - case 16: Illustrate back references, universal and parent modes.
+ - case 17: Benchmark scanning large inputs in default, test and global modes.
+ - case 18: Illustrate the process-wide cache of compiled patterns.
+ - case 19: Illustrate matching a set of patterns in a single pass.
+ - case 20: Illustrate scanning a large file as a stream, with a callback function for each match.
+ - case 21: Illustrate streaming the output of replace and split to a sink function or a file.
+ - case 22: Illustrate scanning a record-oriented buffer with several threads.
+
+Note that the compiled-pattern cache is thread safe, parallel scans run worker threads,
+and the application must link with the pthreads library.
 */
+#include <time.h>
 #include "../../apgex/apgex.h"
 
 #include "source.h"
@@ -106,6 +116,12 @@ static char* s_cppCases[] = {
         "Illustrate extracting quoted and unquoted fields from Comma Separated Value (CSV) records.",
         "Illustrate the use of patterns with wide characters.",
         "Illustrate back references, universal and parent modes.",
+        "Benchmark scanning large inputs in default, test and global modes.",
+        "Illustrate the process-wide cache of compiled patterns.",
+        "Illustrate matching a set of patterns in a single pass.",
+        "Illustrate scanning a large file as a stream, with a callback function for each match.",
+        "Illustrate streaming the output of replace and split to a sink function or a file.",
+        "Illustrate scanning a record-oriented buffer with several threads.",
 };
 static long int s_iCaseCount = (long int)(sizeof(s_cppCases) / sizeof(s_cppCases[0]));
 
@@ -1637,6 +1653,698 @@ static int iBackReference() {
     return iReturn;
 }
 
+static double dMSec(clock_t tStart){
+    return ((double)(clock() - tStart) * 1000.0) / (double)CLOCKS_PER_SEC;
+}
+
+static double dMBPerSec(aint uiChars, double dMs){
+    return dMs > 0.0 ? ((double)uiChars / 1000000.0) / (dMs / 1000.0) : 0.0;
+}
+
+static int iScanning() {
+    int iReturn = EXIT_SUCCESS;
+    static void* vpMem = NULL;
+    static void* vpApgex = NULL;
+    char* cpFiller = "the quick brown fox jumps over the lazy dog\n";
+    char* cpNeedle = "xyzzy";
+    char* cpPatternNeedle = "needle = \"xyzzy\"\n";
+    char* cpPatternWord = "word = \"fox\"\n";
+    char* cpPatternDigits = "digits = 1*%d48-57\n";
+    aint uiaSizes[] = {16384, 65536, 262144, 1048576};
+    aint uiSizeCount = (aint)(sizeof(uiaSizes) / sizeof(uiaSizes[0]));
+    aint ui, uj, uiLen, uiFillerLen, uiNeedleLen, uiCount;
+    achar* acpBuf;
+    apg_phrase sPhrase;
+    apgex_result sResult;
+    abool bFound;
+    clock_t tStart;
+    double dMs;
+    exception e;
+    XCTOR(e);
+    if(e.try){
+        // try block
+        vpMem = vpMemCtor(&e);
+        vpApgex = vpApgexCtor(&e);
+
+        // display the information header
+        char* cpHeader =
+                "This example case is a benchmark for scanning large inputs.\n"
+                "Each input is repeated lines of filler text with a single \"needle\" at the very end.\n"
+                "In default and test modes a parse is attempted at every offset until the needle is found.\n"
+                "In global mode the input is split on every occurrence of \"fox\".\n"
+                "In global PPPT mode the input is searched for digits, of which there are none.\n"
+                "The input is copied into the parser once per scan, not once per offset,\n"
+                "so the time should grow linearly with the input size.\n"
+                "Offsets that cannot begin a match are skipped without parsing,\n"
+                "using the pattern's literal prefix or, in PPPT mode, its set of possible first characters.\n";
+        printf("\n%s", cpHeader);
+
+        uiFillerLen = (aint)strlen(cpFiller);
+        uiNeedleLen = (aint)strlen(cpNeedle);
+        acpBuf = (achar*)vpMemAlloc(vpMem, (uiaSizes[uiSizeCount - 1] * sizeof(achar)));
+        printf("\n%10s %10s %10s %10s %10s\n", "mode", "chars", "found", "msec", "Mchars/sec");
+        for(ui = 0; ui < uiSizeCount; ui++){
+            // fill the buffer and put the needle at the end
+            uiLen = uiaSizes[ui];
+            for(uj = 0; uj < (uiLen - uiNeedleLen); uj++){
+                acpBuf[uj] = (achar)cpFiller[uj % uiFillerLen];
+            }
+            for(; uj < uiLen; uj++){
+                acpBuf[uj] = (achar)cpNeedle[uj - (uiLen - uiNeedleLen)];
+            }
+            sPhrase.acpPhrase = acpBuf;
+            sPhrase.uiLength = uiLen;
+
+            // default mode, find the needle
+            vApgexPattern(vpApgex, cpPatternNeedle, "");
+            tStart = clock();
+            sResult = sApgexExec(vpApgex, &sPhrase);
+            dMs = dMSec(tStart);
+            printf("%10s %10"PRIuMAX" %10s %10.2f %10.2f\n", "default", (luint)uiLen,
+                    (sResult.spResult ? "yes" : "no"), dMs, dMBPerSec(uiLen, dMs));
+
+            // test mode, find the needle
+            tStart = clock();
+            bFound = bApgexTest(vpApgex, &sPhrase);
+            dMs = dMSec(tStart);
+            printf("%10s %10"PRIuMAX" %10s %10.2f %10.2f\n", "test", (luint)uiLen,
+                    (bFound ? "yes" : "no"), dMs, dMBPerSec(uiLen, dMs));
+
+            // global mode, split on every word
+            vApgexPattern(vpApgex, cpPatternWord, "g");
+            tStart = clock();
+            spApgexSplit(vpApgex, &sPhrase, 0, &uiCount);
+            dMs = dMSec(tStart);
+            printf("%10s %10"PRIuMAX" %10"PRIuMAX" %10.2f %10.2f\n", "global", (luint)uiLen,
+                    (luint)uiCount, dMs, dMBPerSec(uiLen, dMs));
+
+            // global PPPT mode, split on digits (none)
+            vApgexPattern(vpApgex, cpPatternDigits, "gp");
+            tStart = clock();
+            spApgexSplit(vpApgex, &sPhrase, 0, &uiCount);
+            dMs = dMSec(tStart);
+            printf("%10s %10"PRIuMAX" %10"PRIuMAX" %10.2f %10.2f\n", "global p", (luint)uiLen,
+                    (luint)uiCount, dMs, dMBPerSec(uiLen, dMs));
+        }
+    }else{
+        // catch block - display the exception location and message
+        vUtilPrintException(&e);
+        vApgexDisplayPatternErrors(vpApgex, NULL);
+        iReturn = EXIT_FAILURE;
+    }
+
+    // clean up resources
+    vApgexDtor(vpApgex);
+    vMemDtor(vpMem);
+    return iReturn;
+}
+
+static int iCache() {
+    int iReturn = EXIT_SUCCESS;
+    static void* vpApgex = NULL;
+    char* cpaPatterns[] = {
+            "email = local \"@\" domain\n"
+            "local = 1*(%d97-122 / %d48-57 / \".\" / \"_\")\n"
+            "domain = 1*(%d97-122 / %d48-57 / \".\")\n",
+            "word = 1*%d97-122\n",
+            "digits = 1*%d48-57\n",
+    };
+    aint uiPatternCount = (aint)(sizeof(cpaPatterns) / sizeof(cpaPatterns[0]));
+    aint uiaSizes[] = {0, APGEX_CACHE_SIZE};
+    aint ui, uj, uiRepeat = 200;
+    apgex_cache_info sInfo;
+    clock_t tStart;
+    double dMs;
+    exception e;
+    XCTOR(e);
+    if(e.try){
+        // try block
+        // display the information header
+        char* cpHeader =
+                "This example case illustrates the process-wide cache of compiled patterns.\n"
+                "Compiling a pattern runs the full parser generator.\n"
+                "Compiled patterns are cached, keyed on the pattern and the PPPT flag, and shared read only\n"
+                "by all apgex objects using them. Each object constructs only its own parser context.\n"
+                "A few patterns are defined repeatedly in new apgex objects, first with the cache disabled\n"
+                "and then with the default cache size.\n";
+        printf("\n%s", cpHeader);
+
+        printf("\n%10s %10s %10s %10s %10s\n", "cache size", "patterns", "hits", "misses", "msec");
+        for(ui = 0; ui < (aint)(sizeof(uiaSizes) / sizeof(uiaSizes[0])); ui++){
+            vApgexCacheClear();
+            vApgexCacheSize(uiaSizes[ui]);
+            tStart = clock();
+            for(uj = 0; uj < uiRepeat; uj++){
+                vpApgex = vpApgexCtor(&e);
+                vApgexPattern(vpApgex, cpaPatterns[uj % uiPatternCount], "");
+                vApgexDtor(vpApgex);
+                vpApgex = NULL;
+            }
+            dMs = dMSec(tStart);
+            vApgexCacheInfo(&sInfo);
+            printf("%10"PRIuMAX" %10"PRIuMAX" %10"PRIuMAX" %10"PRIuMAX" %10.2f\n", (luint)uiaSizes[ui], (luint)uiRepeat,
+                    sInfo.luiHits, sInfo.luiMisses, dMs);
+        }
+        vApgexCacheInfo(&sInfo);
+        printf("\ncached patterns: %"PRIuMAX" of a maximum of %"PRIuMAX"\n", (luint)sInfo.uiEntries, (luint)sInfo.uiMaxEntries);
+        printf("Note that hits and misses are cumulative.\n");
+    }else{
+        // catch block - display the exception location and message
+        vUtilPrintException(&e);
+        vApgexDisplayPatternErrors(vpApgex, NULL);
+        iReturn = EXIT_FAILURE;
+    }
+
+    // clean up resources
+    vApgexDtor(vpApgex);
+    return iReturn;
+}
+
+static int iPatternSet() {
+    int iReturn = EXIT_SUCCESS;
+    static void* vpMem = NULL;
+    static void* vpSet = NULL;
+    static void* vpBad = NULL;
+    static void* vpEmpty = NULL;
+    char* cpIp =
+            "ip = 1*3d \".\" 1*3d \".\" 1*3d \".\" 1*3d\n"
+            "d  = %d48-57\n";
+    char* cpDate =
+            "date = 4d \"-\" 2d \"-\" 2d\n"
+            "d    = %d48-57 ; same rule name as in the ip pattern, but private to this pattern\n";
+    char* cpLevel = "level = %s\"ERROR\" / %s\"WARN\" / %s\"INFO\"\n";
+    char* cpQuoted = "quoted = %d34 *(%d32-33 / %d35-126) %d34\n";
+    char* cpNumber = "number = 1*%d48-57\n";
+    char* cpLine = "2021-06-14 ERROR 192.168.1.10 \"connection refused\" port 8080";
+    aint uiLevel, uiNumber;
+    apg_phrase* spPhrase;
+    apgex_set_result sResult;
+    exception e;
+    XCTOR(e);
+    if(e.try){
+        // try block
+        vpMem = vpMemCtor(&e);
+        vpSet = vpApgexSetCtor(&e);
+
+        // display the information header
+        char* cpHeader =
+                "This example case illustrates matching a set of patterns against a log line in a single pass.\n"
+                "The patterns are compiled together into a single grammar. Each pattern's rule names are private to it.\n"
+                "At each offset only the patterns that can begin with the character there are attempted.\n";
+        printf("\n%s", cpHeader);
+
+        uiApgexSetAdd(vpSet, cpIp);
+        uiApgexSetAdd(vpSet, cpDate);
+        uiLevel = uiApgexSetAdd(vpSet, cpLevel);
+        uiApgexSetAdd(vpSet, cpQuoted);
+        uiNumber = uiApgexSetAdd(vpSet, cpNumber);
+        spPhrase = spUtilStrToPhrase(vpMem, cpLine);
+        printf("\nThe patterns:\n");
+        printf("0: %s", cpIp);
+        printf("1: %s", cpDate);
+        printf("2: %s", cpLevel);
+        printf("3: %s", cpQuoted);
+        printf("4: %s", cpNumber);
+        printf("\nThe log line:\n%s\n", cpLine);
+
+        printf("\nAll matches of all patterns at all offsets.\n");
+        vApgexSetCompile(vpSet, "");
+        sResult = sApgexSetExec(vpSet, spPhrase);
+        vApgexSetDisplayResult(vpSet, &sResult, NULL);
+
+        printf("\nFirst matching pattern only, resuming after each match.\n");
+        vApgexSetCompile(vpSet, "f");
+        sResult = sApgexSetExec(vpSet, spPhrase);
+        vApgexSetDisplayResult(vpSet, &sResult, NULL);
+
+        printf("\nSame with the level and number patterns disabled.\n");
+        vApgexSetEnable(vpSet, uiLevel, APG_FALSE);
+        vApgexSetEnable(vpSet, uiNumber, APG_FALSE);
+        sResult = sApgexSetExec(vpSet, spPhrase);
+        vApgexSetDisplayResult(vpSet, &sResult, NULL);
+
+        printf("\nErrors in a pattern are reported against the combined grammar.\n");
+        exception eBad;
+        XCTOR(eBad);
+        if(eBad.try){
+            vpBad = vpApgexSetCtor(&eBad);
+            uiApgexSetAdd(vpBad, cpNumber);
+            uiApgexSetAdd(vpBad, "bad = \"x\" / \n");
+            vApgexSetCompile(vpBad, "");
+        }else{
+            vApgexSetDisplayPatternErrors(vpBad, NULL);
+        }
+        vApgexSetDtor(vpBad);
+
+        printf("\nEmpty phrases are never reported. Where a pattern matches only the empty phrase\n");
+        printf("the next pattern is attempted and the search moves on.\n");
+        vpEmpty = vpApgexSetCtor(&e);
+        uiApgexSetAdd(vpEmpty, "p = \"ab\" / \"\"\n");
+        uiApgexSetAdd(vpEmpty, "q = \"c\"\n");
+        spPhrase = spUtilStrToPhrase(vpMem, "xacab");
+        printf("0: p = \"ab\" / \"\"\n1: q = \"c\"\nsource: xacab\n");
+        printf("\nAll matches.\n");
+        vApgexSetCompile(vpEmpty, "");
+        sResult = sApgexSetExec(vpEmpty, spPhrase);
+        vApgexSetDisplayResult(vpEmpty, &sResult, NULL);
+        printf("\nFirst matching pattern only.\n");
+        vApgexSetCompile(vpEmpty, "f");
+        sResult = sApgexSetExec(vpEmpty, spPhrase);
+        vApgexSetDisplayResult(vpEmpty, &sResult, NULL);
+    }else{
+        // catch block - display the exception location and message
+        vUtilPrintException(&e);
+        vApgexSetDisplayPatternErrors(vpSet, NULL);
+        iReturn = EXIT_FAILURE;
+    }
+
+    // clean up resources
+    vApgexSetDtor(vpSet);
+    vApgexSetDtor(vpEmpty);
+    vMemDtor(vpMem);
+    return iReturn;
+}
+
+typedef struct{
+    luint luiMatches;
+    luint luiErrors;
+    luint luiLastOffset;
+    char caLastCode[16];
+} stream_counts;
+
+static abool bStreamMatch(apgex_result* spResult, luint luiBase, void* vpUser){
+    stream_counts* spCounts = (stream_counts*)vpUser;
+    apgex_rule* spCode = &spResult->spRules[0];
+    aint ui;
+    spCounts->luiMatches++;
+    spCounts->luiLastOffset = luiBase + spResult->spResult->uiPhraseOffset;
+    if(spCode->uiPhraseCount){
+        // the rule "code" is the only enabled rule
+        for(ui = 0; (ui < spCode->spPhrases[0].sPhrase.uiLength) && (ui < 15); ui++){
+            spCounts->caLastCode[ui] = (char)spCode->spPhrases[0].sPhrase.acpPhrase[ui];
+        }
+        spCounts->caLastCode[ui] = 0;
+        if(spCounts->caLastCode[0] == 53){
+            // 5xx status codes
+            spCounts->luiErrors++;
+        }
+    }
+    return APG_TRUE;
+}
+
+static abool bBehindMatch(apgex_result* spResult, luint luiBase, void* vpUser){
+    stream_counts* spCounts = (stream_counts*)vpUser;
+    spCounts->luiMatches++;
+    spCounts->luiLastOffset = luiBase + spResult->spResult->uiPhraseOffset;
+    return APG_TRUE;
+}
+
+static luint luiExecMatches(void* vpApgex, void* vpMem, const uint8_t* ucpInput, luint luiLength){
+    apg_phrase sPhrase;
+    apgex_result sResult;
+    luint luiIndex, luiCount = 0;
+    achar* acpBuf = (achar*)vpMemAlloc(vpMem, (aint)(luiLength * sizeof(achar)));
+    for(luiIndex = 0; luiIndex < luiLength; luiIndex++){
+        acpBuf[luiIndex] = (achar)ucpInput[luiIndex];
+    }
+    sPhrase.acpPhrase = acpBuf;
+    sPhrase.uiLength = (aint)luiLength;
+    vApgexSetLastIndex(vpApgex, 0);
+    sResult = sApgexExec(vpApgex, &sPhrase);
+    while(sResult.spResult){
+        luiCount++;
+        sResult = sApgexExec(vpApgex, &sPhrase);
+    }
+    vMemFree(vpMem, (void*)acpBuf);
+    return luiCount;
+}
+
+static int iStream() {
+    int iReturn = EXIT_SUCCESS;
+    static void* vpApgex = NULL;
+    static FILE* spFile = NULL;
+    static void* vpMem = NULL;
+    static void* vpBehind = NULL;
+    char* cpPattern =
+            "status = %s\"status=\" code\n"
+            "code   = 3%d48-57\n";
+    char* caLines[] = {
+            "GET /index.html status=200 bytes=5120\n",
+            "GET /missing status=404 bytes=0\n",
+            "POST /form status=503 bytes=12\n",
+            "GET /image.png status=304 bytes=0\n",
+    };
+    char* cpBehind = "b = &&\"a\" \"b\"\n";
+    char* cpBehindInput = "ab xb ab";
+    char caFileBuf[PATH_MAX];
+    const char* cpFileName;
+    aint uiLines = 200000;
+    aint ui;
+    volatile luint luiBytes = 0;
+    luint luiCount;
+    stream_counts sCounts = {};
+    stream_counts sBehind = {};
+    clock_t tStart;
+    double dMs;
+    exception e;
+    XCTOR(e);
+    if(e.try){
+        // try block
+        // display the information header
+        char* cpHeader =
+                "This example case illustrates scanning a file as a stream.\n"
+                "The file is scanned through a window of bounded size and the matched phrases,\n"
+                "with the enabled rule phrases, are passed to a callback function as they are found.\n"
+                "Nothing is accumulated, so that files of any size can be scanned in a fixed amount of memory.\n";
+        printf("\n%s", cpHeader);
+
+        // generate a log file
+        cpFileName = cpMakeFileName(caFileBuf, SOURCE_DIR, "/../output/", "stream.log");
+        spFile = fopen(cpFileName, "wb");
+        if(!spFile){
+            XTHROW(&e, "can't open the log file for writing");
+        }
+        for(ui = 0; ui < uiLines; ui++){
+            luiBytes += (luint)fprintf(spFile, "%s", caLines[ui % 4]);
+        }
+        fclose(spFile);
+        spFile = NULL;
+
+        // scan it
+        vpApgex = vpApgexCtor(&e);
+        vApgexPattern(vpApgex, cpPattern, "g");
+        vApgexEnableRules(vpApgex, "code", APG_TRUE);
+        tStart = clock();
+        luiCount = luiApgexStreamFile(vpApgex, cpFileName, 64, bStreamMatch, (void*)&sCounts);
+        dMs = dMSec(tStart);
+        printf("\n     file bytes: %"PRIuMAX"\n", luiBytes);
+        printf("        matches: %"PRIuMAX"\n", luiCount);
+        printf("callback counts: %"PRIuMAX"\n", sCounts.luiMatches);
+        printf("    5xx matches: %"PRIuMAX"\n", sCounts.luiErrors);
+        printf("    last offset: %"PRIuMAX"\n", sCounts.luiLastOffset);
+        printf("      last code: %s\n", sCounts.caLastCode);
+        printf("     Mbytes/sec: %.2f\n", dMBPerSec((aint)luiBytes, dMs));
+        remove(cpFileName);
+
+        // look behind on a newly constructed object, the stream scan and exec must agree
+        printf("\nLook behind in a stream, pattern: %s", cpBehind);
+        printf("input: \"%s\"\n", cpBehindInput);
+        vpMem = vpMemCtor(&e);
+        vpBehind = vpApgexCtor(&e);
+        vApgexPattern(vpBehind, cpBehind, "g");
+        luiCount = luiApgexStreamBuffer(vpBehind, (const uint8_t*)cpBehindInput, (luint)strlen(cpBehindInput), 64,
+                bBehindMatch, (void*)&sBehind);
+        printf(" stream matches: %"PRIuMAX"\n", luiCount);
+        printf("   exec matches: %"PRIuMAX"\n",
+                luiExecMatches(vpBehind, vpMem, (const uint8_t*)cpBehindInput, (luint)strlen(cpBehindInput)));
+        printf("    last offset: %"PRIuMAX"\n", sBehind.luiLastOffset);
+    }else{
+        // catch block - display the exception location and message
+        vUtilPrintException(&e);
+        iReturn = EXIT_FAILURE;
+    }
+
+    // clean up resources
+    if(spFile){
+        fclose(spFile);
+    }
+    vApgexDtor(vpApgex);
+    vApgexDtor(vpBehind);
+    vMemDtor(vpMem);
+    return iReturn;
+}
+
+static void vSegment(apg_phrase* spSegment, aint uiType, void* vpUser){
+    aint ui;
+    (void)vpUser;
+    if(uiType == APGEX_SEGMENT_END){
+        printf("|\n");
+        return;
+    }
+    printf("%s", ((uiType == APGEX_SEGMENT_REPLACE) ? "{" : ""));
+    for(ui = 0; ui < spSegment->uiLength; ui++){
+        printf("%c", (char)spSegment->acpPhrase[ui]);
+    }
+    printf("%s", ((uiType == APGEX_SEGMENT_REPLACE) ? "}" : ""));
+}
+
+static int iStreamOutput() {
+    int iReturn = EXIT_SUCCESS;
+    static void* vpMem = NULL;
+    static void* vpApgex = NULL;
+    static FILE* spFile = NULL;
+    char* cpPattern =
+            "status = %s\"status=\" code\n"
+            "code   = 3%d48-57\n";
+    char* cpStr = "GET /index.html status=200, GET /missing status=404, POST /form status=503";
+    char* caLines[] = {
+            "GET /index.html status=200 bytes=5120\n",
+            "GET /missing status=404 bytes=0\n",
+            "POST /form status=503 bytes=12\n",
+            "GET /image.png status=304 bytes=0\n",
+    };
+    char caInBuf[PATH_MAX];
+    char caOutBuf[PATH_MAX];
+    const char* cpInName;
+    const char* cpOutName;
+    aint uiLines = 200000;
+    aint ui;
+    volatile luint luiBytes = 0;
+    luint luiOutBytes;
+    luint luiCount;
+    apg_phrase* spPhrase;
+    apg_phrase* spReplacement;
+    apg_phrase sReplaced;
+    clock_t tStart;
+    double dMs;
+    exception e;
+    XCTOR(e);
+    if(e.try){
+        // try block
+        vpMem = vpMemCtor(&e);
+        vpApgex = vpApgexCtor(&e);
+
+        // display the information header
+        char* cpHeader =
+                "This example case illustrates streaming the output of replace and split.\n"
+                "Rather than building the complete output in memory, the output is written\n"
+                "in segments to a sink function as the matches are found.\n"
+                "The sink can be a user function or vApgexSinkFile(), which writes to an open file.\n";
+        printf("\n%s", cpHeader);
+        spPhrase = spUtilStrToPhrase(vpMem, cpStr);
+        spReplacement = spUtilStrToPhrase(vpMem, "status=<$<code>>");
+        vApgexPattern(vpApgex, cpPattern, "g");
+        vApgexEnableRules(vpApgex, "code", APG_TRUE);
+        printf("\nThe Input String\n%s\n", cpStr);
+
+        // replace in memory
+        printf("\nsApgexReplace()\n");
+        sReplaced = sApgexReplace(vpApgex, spPhrase, spReplacement);
+        printf("%s\n", cpUtilPhraseToStr(vpMem, &sReplaced));
+
+        // replace to stdout
+        printf("\nluiApgexReplaceSink() to stdout\n");
+        luiCount = luiApgexReplaceSink(vpApgex, spPhrase, 64, spReplacement, vApgexSinkFile, (void*)stdout);
+        printf("\nreplacements: %"PRIuMAX"\n", luiCount);
+
+        // replace to a user function
+        printf("\nluiApgexReplaceSink() to a user function, replacements in braces\n");
+        luiApgexReplaceSink(vpApgex, spPhrase, 64, spReplacement, vSegment, NULL);
+        printf("\n");
+
+        // split to a user function
+        vApgexPattern(vpApgex, "sep = \", \"\n", "g");
+        printf("\nluiApgexSplitSink() to a user function, sub-phrases end with |\n");
+        luiCount = luiApgexSplitSink(vpApgex, spPhrase, 64, 0, vSegment, NULL);
+        printf("sub-phrases: %"PRIuMAX"\n", luiCount);
+
+        // generate a log file
+        cpInName = cpMakeFileName(caInBuf, SOURCE_DIR, "/../output/", "stream-in.log");
+        cpOutName = cpMakeFileName(caOutBuf, SOURCE_DIR, "/../output/", "stream-out.log");
+        spFile = fopen(cpInName, "wb");
+        if(!spFile){
+            XTHROW(&e, "can't open the log file for writing");
+        }
+        for(ui = 0; ui < uiLines; ui++){
+            luiBytes += (luint)fprintf(spFile, "%s", caLines[ui % 4]);
+        }
+        fclose(spFile);
+        spFile = NULL;
+
+        // redact the status codes from file to file
+        printf("\nluiApgexReplaceFile() from file to file, redacting status codes\n");
+        vApgexPattern(vpApgex, cpPattern, "g");
+        spReplacement = spUtilStrToPhrase(vpMem, "status=xxx");
+        spFile = fopen(cpOutName, "wb");
+        if(!spFile){
+            XTHROW(&e, "can't open the output file for writing");
+        }
+        tStart = clock();
+        luiCount = luiApgexReplaceFile(vpApgex, cpInName, 64, spReplacement, vApgexSinkFile, (void*)spFile);
+        dMs = dMSec(tStart);
+        luiOutBytes = (luint)ftell(spFile);
+        fclose(spFile);
+        spFile = NULL;
+        printf("  input bytes: %"PRIuMAX"\n", luiBytes);
+        printf(" output bytes: %"PRIuMAX"\n", luiOutBytes);
+        printf(" replacements: %"PRIuMAX"\n", luiCount);
+        printf("   Mbytes/sec: %.2f\n", dMBPerSec((aint)luiBytes, dMs));
+        remove(cpInName);
+        remove(cpOutName);
+    }else{
+        // catch block - display the exception location and message
+        vUtilPrintException(&e);
+        vApgexDisplayPatternErrors(vpApgex, NULL);
+        iReturn = EXIT_FAILURE;
+    }
+
+    // clean up resources
+    if(spFile){
+        fclose(spFile);
+    }
+    vApgexDtor(vpApgex);
+    vMemDtor(vpMem);
+    return iReturn;
+}
+
+static double dWallMSec(struct timespec* spStart){
+    struct timespec sNow;
+    clock_gettime(CLOCK_MONOTONIC, &sNow);
+    return ((double)(sNow.tv_sec - spStart->tv_sec) * 1000.0) + ((double)(sNow.tv_nsec - spStart->tv_nsec) / 1000000.0);
+}
+
+static abool bParallelMatch(apgex_result* spResult, luint luiBase, void* vpUser){
+    stream_counts* spCounts = (stream_counts*)vpUser;
+    apg_phrase* spMatch = &spResult->spResult->sPhrase;
+    spCounts->luiMatches++;
+    spCounts->luiLastOffset = luiBase + spResult->spResult->uiPhraseOffset;
+    // the status code follows "status="
+    if(spMatch->acpPhrase[7] == 53){
+        // 5xx status codes
+        spCounts->luiErrors++;
+    }
+    return APG_TRUE;
+}
+
+static int iParallel() {
+    int iReturn = EXIT_SUCCESS;
+    static void* vpApgex = NULL;
+    static uint8_t* ucpBuffer = NULL;
+    static void* vpMem = NULL;
+    static void* vpBehind = NULL;
+    char* cpPattern =
+            "status = %s\"status=\" 3%d48-57 %d32 \"bytes=\" 1*%d48-57\n";
+    char* caLines[] = {
+            "GET /index.html status=200 bytes=5120\n",
+            "GET /missing status=404 bytes=0\n",
+            "POST /form status=503 bytes=12\n",
+            "GET /image.png status=304 bytes=0\n",
+    };
+    char* cpBehind = "b = &&\"a\" \"b\"\n";
+    char* cpBehindLine = "ab xb ab\n";
+    aint uiThreads[] = {1, 2, 4, 0};
+    aint uiLines = 1000000;
+    aint ui, uiLen;
+    luint luiBytes = 0;
+    luint luiCount;
+    stream_counts sStream = {};
+    stream_counts sParallel;
+    stream_counts sBehind = {};
+    struct timespec sStart;
+    double dMs;
+    exception e;
+    XCTOR(e);
+    if(e.try){
+        // try block
+        // display the information header
+        char* cpHeader =
+                "This example case illustrates scanning a record-oriented buffer with several threads.\n"
+                "The buffer is divided into chunks that end at line feeds. Worker threads, each with its own parser,\n"
+                "scan the chunks and the matched phrases are reported in offset order on the calling thread.\n"
+                "The matched phrases are the same as for a single-threaded stream scan, whatever the number of threads.\n"
+                "Note that the speed up depends on the number of processors available.\n";
+        printf("\n%s", cpHeader);
+
+        // generate a log in memory
+        for(ui = 0; ui < 4; ui++){
+            luiBytes += (luint)strlen(caLines[ui]);
+        }
+        luiBytes *= (luint)(uiLines / 4);
+        ucpBuffer = (uint8_t*)malloc((size_t)luiBytes);
+        if(!ucpBuffer){
+            XTHROW(&e, "can't allocate the log buffer");
+        }
+        luiBytes = 0;
+        for(ui = 0; ui < uiLines; ui++){
+            uiLen = (aint)strlen(caLines[ui % 4]);
+            memcpy((void*)&ucpBuffer[luiBytes], (void*)caLines[ui % 4], (size_t)uiLen);
+            luiBytes += (luint)uiLen;
+        }
+        printf("\n  buffer bytes: %"PRIuMAX"\n", luiBytes);
+
+        // scan it as a stream
+        vpApgex = vpApgexCtor(&e);
+        vApgexPattern(vpApgex, cpPattern, "g");
+        clock_gettime(CLOCK_MONOTONIC, &sStart);
+        luiCount = luiApgexStreamBuffer(vpApgex, ucpBuffer, luiBytes, 64, bParallelMatch, (void*)&sStream);
+        dMs = dWallMSec(&sStart);
+        printf("\nluiApgexStreamBuffer()\n");
+        printf("       matches: %"PRIuMAX"\n", luiCount);
+        printf("   5xx matches: %"PRIuMAX"\n", sStream.luiErrors);
+        printf("   last offset: %"PRIuMAX"\n", sStream.luiLastOffset);
+        printf("    Mbytes/sec: %.2f\n", dMBPerSec((aint)luiBytes, dMs));
+
+        // scan it in parallel
+        for(ui = 0; ui < 4; ui++){
+            memset((void*)&sParallel, 0, sizeof(sParallel));
+            clock_gettime(CLOCK_MONOTONIC, &sStart);
+            luiCount = luiApgexParallelBuffer(vpApgex, ucpBuffer, luiBytes, "\n", uiThreads[ui], 64,
+                    bParallelMatch, (void*)&sParallel);
+            dMs = dWallMSec(&sStart);
+            if(uiThreads[ui]){
+                printf("\nluiApgexParallelBuffer() with %"PRIuMAX" thread(s)\n", (luint)uiThreads[ui]);
+            }else{
+                printf("\nluiApgexParallelBuffer() with a thread for each processor\n");
+            }
+            printf("       matches: %"PRIuMAX"\n", luiCount);
+            printf("   5xx matches: %"PRIuMAX"\n", sParallel.luiErrors);
+            printf("   last offset: %"PRIuMAX"\n", sParallel.luiLastOffset);
+            printf("same as stream: %s\n", ((sParallel.luiMatches == sStream.luiMatches)
+                    && (sParallel.luiErrors == sStream.luiErrors)
+                    && (sParallel.luiLastOffset == sStream.luiLastOffset)) ? "yes" : "no");
+            printf("    Mbytes/sec: %.2f\n", dMBPerSec((aint)luiBytes, dMs));
+        }
+
+        // look behind, each worker's parser is newly constructed, the parallel scan and exec must agree
+        uiLen = (aint)strlen(cpBehindLine);
+        luiBytes = (luint)uiLen * (luint)(uiLines / 1000);
+        for(ui = 0; ui < (uiLines / 1000); ui++){
+            memcpy((void*)&ucpBuffer[(luint)ui * (luint)uiLen], (void*)cpBehindLine, (size_t)uiLen);
+        }
+        printf("\nLook behind in parallel, pattern: %s", cpBehind);
+        printf("  buffer bytes: %"PRIuMAX" (lines of \"ab xb ab\")\n", luiBytes);
+        vpMem = vpMemCtor(&e);
+        vpBehind = vpApgexCtor(&e);
+        vApgexPattern(vpBehind, cpBehind, "g");
+        luiCount = luiApgexParallelBuffer(vpBehind, ucpBuffer, luiBytes, "\n", 0, 64, bBehindMatch, (void*)&sBehind);
+        printf("parallel matches: %"PRIuMAX"\n", luiCount);
+        printf("    exec matches: %"PRIuMAX"\n", luiExecMatches(vpBehind, vpMem, ucpBuffer, luiBytes));
+        printf("     last offset: %"PRIuMAX"\n", sBehind.luiLastOffset);
+    }else{
+        // catch block - display the exception location and message
+        vUtilPrintException(&e);
+        vApgexDisplayPatternErrors(vpApgex, NULL);
+        iReturn = EXIT_FAILURE;
+    }
+
+    // clean up resources
+    free(ucpBuffer);
+    vApgexDtor(vpApgex);
+    vApgexDtor(vpBehind);
+    vMemDtor(vpMem);
+    return iReturn;
+}
+
 /**
  * \brief Main function for the basic application.
  * \param argc The number of command line arguments.
@@ -1685,6 +2393,18 @@ int main(int argc, char **argv) {
         return iWide();
     case 16:
         return iBackReference();
+    case 17:
+        return iScanning();
+    case 18:
+        return iCache();
+    case 19:
+        return iPatternSet();
+    case 20:
+        return iStream();
+    case 21:
+        return iStreamOutput();
+    case 22:
+        return iParallel();
     default:
         return iHelp();
     }
@@ -53,7 +53,7 @@ The compiled example will execute the following cases. Run the application with
  - case 3: Input, validation fails with bad characters and no final EOL.
  - case 4: Illustrate a grammar with bad syntax.
  - case 5: Illustrate a grammar with bad semantics.
- - case 6: Illustrate generating a parser with and without PPPT.
+ - case 6: Illustrate generating a parser with and without PPPT, and with two-character PPPT maps.
 
  */
 
@@ -78,7 +78,7 @@ The compiled example will execute the following cases. Run the application with
  - case 3: Input, validation fails with bad characters and no final EOL.
  - case 4: Illustrate a grammar with bad syntax.
  - case 5: Illustrate a grammar with bad semantics.
- - case 6: Illustrate generating a parser with and without PPPT.
+ - case 6: Illustrate generating a parser with and without PPPT, and with two-character PPPT maps.
 */
 #include "../../utilities/utilities.h"
 #include "../../api/api.h"
@@ -103,7 +103,7 @@ static char* s_cppCases[] = {
         "Input, validation fails with bad characters and no final EOL.",
         "Illustrate a grammar with bad syntax.",
         "Illustrate a grammar with bad semantics.",
-        "Illustrate generating a parser with and without PPPT.",
+        "Illustrate generating a parser with and without PPPT, and with two-character PPPT maps.",
 };
 static long int s_iCaseCount = (long int)(sizeof(s_cppCases) / sizeof(s_cppCases[0]));
 static void vPrintCase(long int iCase){
@@ -322,6 +322,7 @@ static int iInPppt() {
     static void* vpApi = NULL;
     static void* vpParser = NULL;
     static void* vpPpptParser  = NULL;
+    static void* vpPppt2Parser  = NULL;
     char* cpInput = "{"
             "\"array\": [1,2,3,4],"
             "\"object\": {\"t\": true, \"f\": false, \"n\":null}"
@@ -379,6 +380,21 @@ static int iInPppt() {
         printf("\nState showing node hits with PPPT\n");
         vUtilPrintParserState(&sState);
 
+        // parse with the second-level, two-character PPPT maps
+        // note that this grammar has no rule callback functions that would need protection
+        vApiPppt2(vpApi);
+        vApiPpptSize(vpApi, &sPpptSize);
+        printf("\n  number of second-level maps: %"PRIuMAX"\n", sPpptSize.luiMaps2);
+        printf("    total table size in bytes: %"PRIuMAX"\n", sPpptSize.luiTableSize);
+        vpPppt2Parser = vpApiOutputParser(vpApi);
+        memset(&sConfig, 0, sizeof(sConfig));
+        sConfig.acpInput = spPhrase->acpPhrase;
+        sConfig.uiInputLength = spPhrase->uiLength;
+        sConfig.uiStartRule = uiParserRuleLookup(vpParser, "JSON-text");
+        vParserParse(vpPppt2Parser, &sConfig, &sState);
+        printf("\nState showing node hits with two-character PPPT maps\n");
+        vUtilPrintParserState(&sState);
+
     }else{
         // catch block - display the exception location and message
         vUtilPrintException(&e);
@@ -386,6 +402,7 @@ static int iInPppt() {
     }
     vParserDtor(vpParser);
     vParserDtor(vpPpptParser);
+    vParserDtor(vpPppt2Parser);
     vApiDtor(vpApi);
     vMemDtor(vpMem);
     return iReturn;
@@ -75,6 +75,7 @@ The compiled example will execute the following cases. Run the application with
  - case 1: display the current state of the APG library (type names, type sizes and defined macros)
  - case 2: parse a simple input string and display the final parsed state
  - case 3: set call back functions for some of the grammar's rule names and execute them during the parse
+ - case 5: abandon a parse that exceeds a hit count, tree depth or time limit
 */
 #include "../../utilities/utilities.h"
 #include "./float.h"
@@ -87,6 +88,7 @@ static char* s_cppCases[] = {
         "Parse an input string and display the parser state.",
         "Define rule call back functions to display phrase information during the parser's traversal of the parse tree.",
         "Illustrate reporting a fatal parsing error.",
+        "Abandon a parse that exceeds a hit count, tree depth or time limit.",
 };
 static long int s_iCaseCount = (long int)(sizeof(s_cppCases) / sizeof(s_cppCases[0]));
 
@@ -95,7 +97,7 @@ static int iHelp(void){
     vUtilCurrentWorkingDirectory();
     printf("description: %s\n", s_cpDescription);
     printf("      usage: ex-basic arg\n");
-    printf("             arg = n, 1 <= n <= 4\n");
+    printf("             arg = n, 1 <= n <= %ld\n", s_iCaseCount);
     printf("                   execute case number n\n");
     printf("             arg = anthing else\n");
     printf("                   print this help screen\n");
@@ -369,6 +371,70 @@ static int iParseError() {
     return iReturn;
 }
 
+static int iParseLimits() {
+    int iReturn = EXIT_SUCCESS;
+    static void* vpParser = NULL;
+    parser_state sState;
+    parser_config sInput;
+    apg_phrase sPhrase;
+    apg_phrase* spPhrase;
+    achar acaBuffer[128];
+    aint uiBufSize = 128;
+    exception e;
+    XCTOR(e);
+    if(e.try){
+        // try block
+
+        // construct the parser from the pre-generated grammar files
+        vpParser = vpParserCtor(&e, vpFloatInit);
+
+        // convert the input string to APG alphabet characters (in general not necessarily same size as char)
+        char* cpInput = "-12.3456e+10";
+        sPhrase.acpPhrase = acaBuffer;
+        sPhrase.uiLength = uiBufSize;
+        spPhrase = spStrToPhrase(cpInput, &sPhrase);
+        if(!spPhrase){
+            XTHROW(&e, "alphabet buffer size to small for input string");
+        }
+
+        // configure the parser with no limits
+        memset((void*)&sInput, 0, sizeof(sInput));
+        sInput.acpInput = spPhrase->acpPhrase;
+        sInput.uiInputLength = spPhrase->uiLength;
+        sInput.uiStartRule = 0;
+        vParserParse(vpParser, &sInput, &sState);
+        printf("\nNo limits\n");
+        vUtilPrintParserState(&sState);
+
+        // a node hit count limit
+        sInput.uiMaxHits = 10;
+        vParserParse(vpParser, &sInput, &sState);
+        printf("\nMaximum hit count: %"PRIuMAX"\n", (luint)sInput.uiMaxHits);
+        vUtilPrintParserState(&sState);
+
+        // a tree depth limit
+        sInput.uiMaxHits = 0;
+        sInput.uiMaxTreeDepth = 3;
+        vParserParse(vpParser, &sInput, &sState);
+        printf("\nMaximum tree depth: %"PRIuMAX"\n", (luint)sInput.uiMaxTreeDepth);
+        vUtilPrintParserState(&sState);
+
+        // a generous time limit, checking the clock every 100 nodes
+        sInput.uiMaxTreeDepth = 0;
+        sInput.uiMaxMilliseconds = 1000;
+        sInput.uiCheckInterval = 100;
+        vParserParse(vpParser, &sInput, &sState);
+        printf("\nMaximum time: %"PRIuMAX" milliseconds\n", (luint)sInput.uiMaxMilliseconds);
+        vUtilPrintParserState(&sState);
+    }else{
+        // catch block - display the exception location and message
+        vUtilPrintException(&e);
+        iReturn = EXIT_FAILURE;
+    }
+    vParserDtor(vpParser);
+    return iReturn;
+}
+
 /**
  * \brief Main function for the basic application.
 
@@ -396,6 +462,8 @@ int main(int argc, char **argv) {
         return iParseString();
     case 4:
         return iParseError();
+    case 5:
+        return iParseLimits();
     }
 }
 
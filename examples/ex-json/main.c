@@ -54,6 +54,14 @@ The compiled example will execute the following cases. Run the application with
  - case 4: Illustrate walking a sub-tree and the siblings of a sub-root explicitly with the iterator.
  - case 5: Illustrate writing a JSON file from a value tree of parsed JSON values.
  - case 6: Illustrate building a JSON file.
+ - case 7: Illustrate the throughput of parsing many small JSON documents with a single JSON object.
+ - case 8: Illustrate the parsing events, with and without building the value tree.
+ - case 9: Illustrate the lazy reading of a large JSON document.
+ - case 10: Illustrate UTF-8 keys and string values.
+ - case 11: Illustrate the direct lookup of object members with hashed key indexes.
+ - case 12: Illustrate the parallel reading of a JSON Lines file.
+ - case 13: Illustrate the direct UTF-8 writer, compact and indented.
+ - case 14: Illustrate the fast conversion of numbers.
  */
 
 /**
@@ -78,8 +86,18 @@ The compiled example will execute the following cases. Run the application with
  - case 4: Illustrate walking a sub-tree and the siblings of a sub-root explicitly with the iterator.
  - case 5: Illustrate writing a JSON file from a value tree of parsed JSON values.
  - case 6: Illustrate building a JSON file.
+ - case 7: Illustrate the throughput of parsing many small JSON documents with a single JSON object.
+ - case 8: Illustrate the parsing events, with and without building the value tree.
+ - case 9: Illustrate the lazy reading of a large JSON document.
+ - case 10: Illustrate UTF-8 keys and string values.
+ - case 11: Illustrate the direct lookup of object members with hashed key indexes.
+ - case 12: Illustrate the parallel reading of a JSON Lines file.
+ - case 13: Illustrate the direct UTF-8 writer, compact and indented.
+ - case 14: Illustrate the fast conversion of numbers.
 */
 #include <limits.h>
+#include <time.h>
+#include <stdatomic.h>
 #include "../../json/json.h"
 
 #include "source.h"
@@ -104,6 +122,14 @@ static char* s_cppCases[] = {
         "Illustrate walking a sub-tree and the siblings of a sub-root explicitly with the iterator.",
         "Illustrate writing a JSON file from a value tree of parsed JSON values.",
         "Illustrate building a JSON file.",
+        "Illustrate the throughput of parsing many small JSON documents with a single JSON object.",
+        "Illustrate the parsing events, with and without building the value tree.",
+        "Illustrate the lazy reading of a large JSON document.",
+        "Illustrate UTF-8 keys and string values.",
+        "Illustrate the direct lookup of object members with hashed key indexes.",
+        "Illustrate the parallel reading of a JSON Lines file.",
+        "Illustrate the direct UTF-8 writer, compact and indented.",
+        "Illustrate the fast conversion of numbers.",
 };
 static long int s_iCaseCount = (long int)(sizeof(s_cppCases) / sizeof(s_cppCases[0]));
 
@@ -542,6 +568,888 @@ static int iBuilder() {
     return iReturn;
 }
 
+static double dWallMSec(struct timespec* spStart){
+    struct timespec sNow;
+    clock_gettime(CLOCK_MONOTONIC, &sNow);
+    return ((double)(sNow.tv_sec - spStart->tv_sec) * 1000.0) + ((double)(sNow.tv_nsec - spStart->tv_nsec) / 1000000.0);
+}
+
+static void vSmallDocsReport(const char* cpTitle, aint uiDocs, luint luiBytes, luint luiValues, double dMs){
+    double dSec = dMs / 1000.0;
+    printf("\n%s\n", cpTitle);
+    printf("  documents: %"PRIuMAX"\n", (luint)uiDocs);
+    printf("     values: %"PRIuMAX"\n", luiValues);
+    printf("       time: %.3f msec\n", dMs);
+    if(dSec > 0.0){
+        printf("   docs/sec: %.0f\n", (double)uiDocs / dSec);
+        printf("       MB/s: %.3f\n", ((double)luiBytes / (1024.0 * 1024.0)) / dSec);
+    }
+}
+
+static int iSmallDocs() {
+    int iReturn = EXIT_SUCCESS;
+    static void* vpMem = NULL;
+    static void* vpJson = NULL;
+    static void* vpVecDocs = NULL;
+    static void* vpVecLengths = NULL;
+    json_value* spRoot;
+    void* vpIt;
+    struct timespec sStart;
+    double dMs;
+    aint uiDocs = 20000;
+    aint ui, uiLen;
+    volatile luint luiBytes = 0, luiValues = 0;
+    char caDoc[256];
+    const char* cppTemplates[] = {
+            "{\"id\":%u,\"name\":\"user%u\",\"active\":true,\"score\":%u.5}",
+            "[%u,%u,%u,null,false,\"item\"]",
+            "{\"order\":%u,\"lines\":[{\"sku\":\"A%u\",\"qty\":%u},{\"sku\":\"B\",\"qty\":1}],\"note\":\"tab\\tand \\u00e9\"}",
+            "{\"event\":\"click\",\"x\":%u,\"y\":-%u,\"t\":%u.25e-3,\"tags\":[]}",
+    };
+    aint uiTemplates = (aint)(sizeof(cppTemplates) / sizeof(cppTemplates[0]));
+    exception e;
+    XCTOR(e);
+    if(e.try){
+        // try block
+        vpMem = vpMemCtor(&e);
+
+        // display the information header
+        char* cpHeader =
+                "This example case illustrates the throughput of parsing many small JSON documents.\n"
+                "Services often parse a steady stream of small documents, each only a few dozen bytes long.\n"
+                "A single JSON object keeps its grammar parser and all of its working vectors alive from document\n"
+                "to document, so the per-document cost is essentially just the parse itself.\n"
+                "For comparison, the same documents are then parsed with a new JSON object for each document.\n";
+        printf("\n%s", cpHeader);
+
+        // generate the small documents in memory
+        vpVecDocs = vpVecCtor(vpMem, sizeof(uint8_t), 1024 * 1024);
+        vpVecLengths = vpVecCtor(vpMem, sizeof(aint), (aint)uiDocs);
+        for(ui = 0; ui < uiDocs; ui++){
+            unsigned int u = (unsigned int)ui;
+            uiLen = (aint)snprintf(caDoc, sizeof(caDoc), cppTemplates[ui % uiTemplates], u, u % 97, u % 13);
+            vpVecPushn(vpVecDocs, caDoc, uiLen);
+            vpVecPush(vpVecLengths, &uiLen);
+            luiBytes += (luint)uiLen;
+        }
+        uint8_t* ucpDocs = (uint8_t*)vpVecFirst(vpVecDocs);
+        aint* uipLengths = (aint*)vpVecFirst(vpVecLengths);
+        printf("\nlast document: %.*s\n", (int)uipLengths[uiDocs - 1], (char*)&ucpDocs[luiBytes - (luint)uipLengths[uiDocs - 1]]);
+
+        // parse all documents with a single JSON object
+        vpJson = vpJsonCtor(&e);
+        uint8_t* ucpDoc = ucpDocs;
+        clock_gettime(CLOCK_MONOTONIC, &sStart);
+        for(ui = 0; ui < uiDocs; ui++){
+            vpIt = vpJsonReadArray(vpJson, ucpDoc, uipLengths[ui]);
+            luiValues += (luint)uiJsonIteratorCount(vpIt);
+            vJsonIteratorDtor(vpIt);
+            ucpDoc += uipLengths[ui];
+        }
+        dMs = dWallMSec(&sStart);
+        vSmallDocsReport("one JSON object for all documents", uiDocs, luiBytes, luiValues, dMs);
+
+        // display the values of the last document to show that the reused object is intact
+        vpIt = vpJsonReadArray(vpJson, ucpDocs + luiBytes - (luint)uipLengths[uiDocs - 1], uipLengths[uiDocs - 1]);
+        spRoot = spJsonIteratorFirst(vpIt);
+        printf("\nThe JSON Values of the Last Document\n");
+        vJsonDisplayValue(vpJson, spRoot, 0);
+        vJsonIteratorDtor(vpIt);
+        vJsonDtor(vpJson);
+        vpJson = NULL;
+
+        // parse all documents with a new JSON object for each
+        luiValues = 0;
+        ucpDoc = ucpDocs;
+        clock_gettime(CLOCK_MONOTONIC, &sStart);
+        for(ui = 0; ui < uiDocs; ui++){
+            vpJson = vpJsonCtor(&e);
+            vpIt = vpJsonReadArray(vpJson, ucpDoc, uipLengths[ui]);
+            luiValues += (luint)uiJsonIteratorCount(vpIt);
+            vJsonDtor(vpJson);
+            vpJson = NULL;
+            ucpDoc += uipLengths[ui];
+        }
+        dMs = dWallMSec(&sStart);
+        vSmallDocsReport("a new JSON object for each document", uiDocs, luiBytes, luiValues, dMs);
+    }else{
+        // catch block - display the exception location and message
+        vUtilPrintException(&e);
+        iReturn = EXIT_FAILURE;
+    }
+
+    // clean up resources
+    vJsonDtor(vpJson);
+    vMemDtor(vpMem);
+    return iReturn;
+}
+
+static void vEventIndent(aint uiDepth){
+    aint ui = 0;
+    for(; ui < uiDepth; ui++){
+        printf("  ");
+    }
+}
+static void vEventPrintString(u32_phrase* spString){
+    uint32_t ui = 0;
+    printf("\"");
+    for(; ui < spString->uiLength; ui++){
+        uint32_t uiChar = spString->uipPhrase[ui];
+        if(uiChar >= 32 && uiChar < 127){
+            printf("%c", (char)uiChar);
+        }else{
+            printf("\\u%04X", (unsigned int)uiChar);
+        }
+    }
+    printf("\"");
+}
+static void vEventBegin(aint uiDepth, aint uiCount, void* vpUserData){
+    (void)uiCount;
+    vEventIndent(uiDepth);
+    printf("%s begin\n", (char*)vpUserData);
+}
+static void vEventEnd(aint uiDepth, aint uiCount, void* vpUserData){
+    vEventIndent(uiDepth);
+    printf("%s end: %"PRIuMAX" children\n", (char*)vpUserData, (luint)uiCount);
+}
+static void vEventString(u32_phrase* spString, aint uiDepth, void* vpUserData){
+    vEventIndent(uiDepth);
+    printf("%s: ", (char*)vpUserData);
+    vEventPrintString(spString);
+    printf("\n");
+}
+static void vEventNumber(json_number* spNumber, aint uiDepth, void* vpUserData){
+    (void)vpUserData;
+    vEventIndent(uiDepth);
+    if(spNumber->uiType == JSON_ID_FLOAT){
+        printf("number: float: %g\n", spNumber->dFloat);
+    }else if(spNumber->uiType == JSON_ID_SIGNED){
+        printf("number: signed int: %"PRIiMAX"\n", (intmax_t)spNumber->iSigned);
+    }else{
+        printf("number: unsigned int: %"PRIuMAX"\n", (luint)spNumber->uiUnsigned);
+    }
+}
+static void vEventLiteral(aint uiId, aint uiDepth, void* vpUserData){
+    (void)vpUserData;
+    vEventIndent(uiDepth);
+    printf("literal: %s\n", (uiId == JSON_ID_TRUE) ? "true" : ((uiId == JSON_ID_FALSE) ? "false" : "null"));
+}
+
+typedef struct{
+    abool bPrice;
+    abool bQty;
+    double dPrice;
+    luint luiOrders;
+    double dTotal;
+} order_totals;
+static void vTotalsKey(u32_phrase* spKey, aint uiDepth, void* vpUserData){
+    order_totals* spTotals = (order_totals*)vpUserData;
+    // only the members of the order objects are at depth 2
+    spTotals->bPrice = (uiDepth == 2) && (spKey->uiLength == 5) && (spKey->uipPhrase[0] == 'p');
+    spTotals->bQty = (uiDepth == 2) && (spKey->uiLength == 3) && (spKey->uipPhrase[0] == 'q');
+}
+static void vTotalsNumber(json_number* spNumber, aint uiDepth, void* vpUserData){
+    order_totals* spTotals = (order_totals*)vpUserData;
+    (void)uiDepth;
+    double dValue = (spNumber->uiType == JSON_ID_FLOAT) ? spNumber->dFloat : (double)spNumber->uiUnsigned;
+    if(spTotals->bPrice){
+        spTotals->dPrice = dValue;
+    }else if(spTotals->bQty){
+        spTotals->dTotal += spTotals->dPrice * dValue;
+        spTotals->luiOrders++;
+    }
+}
+
+static int iEvents() {
+    int iReturn = EXIT_SUCCESS;
+    static void* vpMem = NULL;
+    static void* vpJson = NULL;
+    static void* vpVecDoc = NULL;
+    void* vpIt;
+    json_value* spValue;
+    char caOrder[256];
+    aint ui, uiLen;
+    aint uiOrders = 50000;
+    order_totals sTotals;
+    const char* cpSmall =
+            "{\"name\":\"caf\\u00e9\",\"open\":true,\"rating\":4.5,\"tables\":12,\"offset\":-3,\n"
+            " \"menu\":[\"soup\",{\"dish\":\"pie\",\"price\":null}],\"closed\":false}";
+    exception e;
+    XCTOR(e);
+    if(e.try){
+        // try block
+        vpMem = vpMemCtor(&e);
+        vpJson = vpJsonCtor(&e);
+
+        // display the information header
+        char* cpHeader =
+                "This example case illustrates the event-driven parsing of JSON text.\n"
+                "As the parser recognizes each value it calls the application's callback functions, in document order,\n"
+                "for the beginning and end of objects and arrays, for member keys and for string, number and literal values.\n"
+                "If the value tree is not needed, its construction can be turned off so that\n"
+                "the memory used no longer grows with the size of the document.\n";
+        printf("\n%s", cpHeader);
+
+        // trace all of the events of a small document
+        printf("\nThe JSON Text\n%s\n", cpSmall);
+        printf("\nThe Parsing Events (value tree not built)\n");
+        vJsonSetTreeBuilding(vpJson, APG_FALSE);
+        vJsonSetObjectBeginCallback(vpJson, vEventBegin, (void*)"object");
+        vJsonSetObjectEndCallback(vpJson, vEventEnd, (void*)"object");
+        vJsonSetArrayBeginCallback(vpJson, vEventBegin, (void*)"array");
+        vJsonSetArrayEndCallback(vpJson, vEventEnd, (void*)"array");
+        vJsonSetKeyCallback(vpJson, vEventString, (void*)"key");
+        vJsonSetStringCallback(vpJson, vEventString, (void*)"string");
+        vJsonSetNumberCallback(vpJson, vEventNumber, NULL);
+        vJsonSetLiteralCallback(vpJson, vEventLiteral, NULL);
+        vpIt = vpJsonReadArray(vpJson, (uint8_t*)cpSmall, (aint)strlen(cpSmall));
+        printf("returned iterator: %s\n", vpIt ? "not NULL" : "NULL");
+
+        // aggregate a few fields of a larger document
+        vpVecDoc = vpVecCtor(vpMem, sizeof(char), 4096);
+        vpVecPush(vpVecDoc, "[");
+        for(ui = 0; ui < uiOrders; ui++){
+            uiLen = (aint)snprintf(caOrder, sizeof(caOrder),
+                    "%s{\"id\":%u,\"item\":\"widget-%u\",\"price\":%u.25,\"qty\":%u,\"tags\":[\"a\",\"b\"]}",
+                    (ui ? ",\n" : "\n"), (unsigned int)ui, (unsigned int)(ui % 10), (unsigned int)(ui % 100), (unsigned int)(ui % 5));
+            vpVecPushn(vpVecDoc, caOrder, uiLen);
+        }
+        vpVecPushn(vpVecDoc, "\n]", 2);
+        printf("\nTotal the price times quantity of %"PRIuMAX" orders, %"PRIuMAX" bytes of JSON text, with the events only.\n",
+                (luint)uiOrders, (luint)uiVecLen(vpVecDoc));
+        memset(&sTotals, 0, sizeof(sTotals));
+        vJsonSetObjectBeginCallback(vpJson, NULL, NULL);
+        vJsonSetObjectEndCallback(vpJson, NULL, NULL);
+        vJsonSetArrayBeginCallback(vpJson, NULL, NULL);
+        vJsonSetArrayEndCallback(vpJson, NULL, NULL);
+        vJsonSetStringCallback(vpJson, NULL, NULL);
+        vJsonSetLiteralCallback(vpJson, NULL, NULL);
+        vJsonSetKeyCallback(vpJson, vTotalsKey, &sTotals);
+        vJsonSetNumberCallback(vpJson, vTotalsNumber, &sTotals);
+        vpJsonReadArray(vpJson, (uint8_t*)vpVecFirst(vpVecDoc), uiVecLen(vpVecDoc));
+        printf("orders: %"PRIuMAX"\n", sTotals.luiOrders);
+        printf(" total: %.2f\n", sTotals.dTotal);
+
+        // the same totals from the value tree
+        printf("\nThe same totals from the value tree.\n");
+        vJsonSetKeyCallback(vpJson, NULL, NULL);
+        vJsonSetNumberCallback(vpJson, NULL, NULL);
+        vJsonSetTreeBuilding(vpJson, APG_TRUE);
+        vpIt = vpJsonReadArray(vpJson, (uint8_t*)vpVecFirst(vpVecDoc), uiVecLen(vpVecDoc));
+        printf("values in the tree: %"PRIuMAX"\n", (luint)uiJsonIteratorCount(vpIt));
+        memset(&sTotals, 0, sizeof(sTotals));
+        spValue = spJsonIteratorFirst(vpIt);
+        vpIt = vpJsonChildren(vpJson, spValue);
+        spValue = spJsonIteratorFirst(vpIt);
+        while(spValue){
+            aint uiChild = 0;
+            for(; uiChild < spValue->uiChildCount; uiChild++){
+                json_value* spMember = spValue->sppChildren[uiChild];
+                u32_phrase sKey = *spMember->spKey;
+                if(spMember->uiId == JSON_ID_NUMBER){
+                    vTotalsKey(&sKey, 2, &sTotals);
+                    vTotalsNumber(spMember->spNumber, 2, &sTotals);
+                }
+            }
+            spValue = spJsonIteratorNext(vpIt);
+        }
+        printf("orders: %"PRIuMAX"\n", sTotals.luiOrders);
+        printf(" total: %.2f\n", sTotals.dTotal);
+    }else{
+        // catch block - display the exception location and message
+        vUtilPrintException(&e);
+        iReturn = EXIT_FAILURE;
+    }
+
+    // clean up resources
+    vJsonDtor(vpJson);
+    vMemDtor(vpMem);
+    return iReturn;
+}
+
+static int iLazy() {
+    int iReturn = EXIT_SUCCESS;
+    static void* vpMem = NULL;
+    static void* vpJson = NULL;
+    static void* vpVecDoc = NULL;
+    void* vpIt;
+    void* vpItKeys;
+    json_value* spRoot;
+    json_value* spValue;
+    struct timespec sStart;
+    double dMsGrammar, dMsLazy;
+    char caRecord[256];
+    aint ui, uiLen, uiGrammarValues;
+    aint uiRecords = 20000;
+    volatile luint luiGrammarSum = 0, luiLazySum = 0;
+    exception e;
+    XCTOR(e);
+    if(e.try){
+        // try block
+        vpMem = vpMemCtor(&e);
+        vpJson = vpJsonCtor(&e);
+
+        // display the information header
+        char* cpHeader =
+                "This example case illustrates the lazy reading of a large JSON document.\n"
+                "Often only a few of the values of a large document are ever needed.\n"
+                "The lazy reader builds the tree structure from a fast structural index of the input and\n"
+                "decodes the keys, strings and numbers only when they are returned by an iterator.\n"
+                "The document is read both ways and the same values are found in each tree.\n";
+        printf("\n%s", cpHeader);
+
+        // generate a large document
+        vpVecDoc = vpVecCtor(vpMem, sizeof(char), 4096);
+        vpVecPush(vpVecDoc, "[");
+        for(ui = 0; ui < uiRecords; ui++){
+            uiLen = (aint)snprintf(caRecord, sizeof(caRecord),
+                    "%s{\"id\":%u,\"name\":\"customer \\\"%u\\\"\",\"active\":%s,\"balance\":%u.75,"
+                    "\"address\":{\"street\":\"%u Main St.\",\"city\":\"city-%u\",\"zip\":\"%05u\"},\"tags\":[\"new\",\"caf\\u00e9\",null]}",
+                    (ui ? ",\n" : "\n"), (unsigned int)ui, (unsigned int)ui, ((ui % 3) ? "true" : "false"), (unsigned int)(ui % 1000),
+                    (unsigned int)(ui % 500), (unsigned int)(ui % 50), (unsigned int)(ui % 100000));
+            vpVecPushn(vpVecDoc, caRecord, uiLen);
+        }
+        vpVecPushn(vpVecDoc, "\n]", 2);
+        printf("\nrecords: %"PRIuMAX"\n", (luint)uiRecords);
+        printf("  bytes: %"PRIuMAX"\n", (luint)uiVecLen(vpVecDoc));
+
+        // read with the grammar parser and sum the ids
+        clock_gettime(CLOCK_MONOTONIC, &sStart);
+        vpIt = vpJsonReadArray(vpJson, (uint8_t*)vpVecFirst(vpVecDoc), uiVecLen(vpVecDoc));
+        dMsGrammar = dWallMSec(&sStart);
+        uiGrammarValues = uiJsonIteratorCount(vpIt);
+        spRoot = spJsonIteratorFirst(vpIt);
+        vpItKeys = vpJsonFindKeyA(vpJson, "id", spRoot);
+        for(spValue = spJsonIteratorFirst(vpItKeys); spValue; spValue = spJsonIteratorNext(vpItKeys)){
+            luiGrammarSum += (luint)spValue->spNumber->uiUnsigned;
+        }
+        vJsonIteratorDtor(vpItKeys);
+        vJsonIteratorDtor(vpIt);
+
+        // read lazily and sum the ids
+        clock_gettime(CLOCK_MONOTONIC, &sStart);
+        vpIt = vpJsonReadArrayLazy(vpJson, (uint8_t*)vpVecFirst(vpVecDoc), uiVecLen(vpVecDoc));
+        dMsLazy = dWallMSec(&sStart);
+        spRoot = spJsonIteratorFirst(vpIt);
+        vpItKeys = vpJsonFindKeyA(vpJson, "id", spRoot);
+        for(spValue = spJsonIteratorFirst(vpItKeys); spValue; spValue = spJsonIteratorNext(vpItKeys)){
+            luiLazySum += (luint)spValue->spNumber->uiUnsigned;
+        }
+        vJsonIteratorDtor(vpItKeys);
+        printf("\n              grammar reader     lazy reader\n");
+        printf("values:  %15"PRIuMAX" %15"PRIuMAX"\n", (luint)uiGrammarValues, (luint)uiJsonIteratorCount(vpIt));
+        printf("sum ids: %15"PRIuMAX" %15"PRIuMAX"\n", luiGrammarSum, luiLazySum);
+        printf("msec:    %15.3f %15.3f\n", dMsGrammar, dMsLazy);
+        if(dMsLazy > 0.0){
+            printf("speedup: %31.1fx\n", dMsGrammar / dMsLazy);
+        }
+
+        // display one record from the lazily read tree
+        printf("\nThe Last Record, from the Lazily Read Tree\n");
+        vpItKeys = vpJsonChildren(vpJson, spRoot);
+        vJsonDisplayValue(vpJson, spJsonIteratorLast(vpItKeys), 0);
+        vJsonIteratorDtor(vpItKeys);
+        vJsonIteratorDtor(vpIt);
+    }else{
+        // catch block - display the exception location and message
+        vUtilPrintException(&e);
+        iReturn = EXIT_FAILURE;
+    }
+
+    // clean up resources
+    vJsonDtor(vpJson);
+    vMemDtor(vpMem);
+    return iReturn;
+}
+
+static void vPrintUtf8(const char* cpLabel, u8_phrase* spString){
+    printf("%s: %"PRIuMAX" bytes: \"%.*s\"\n", cpLabel, (luint)spString->uiLength, (int)spString->uiLength, (const char*)spString->ucpPhrase);
+}
+
+static int iUtf8Strings() {
+    int iReturn = EXIT_SUCCESS;
+    static void* vpJson = NULL;
+    void* vpIt;
+    json_value* spValue;
+    volatile luint luiUtf8Bytes = 0, luiCodePoints = 0;
+    const char* cpDoc =
+            "{\"name\":\"caf\\u00e9 \\\"Ren\\u00e9\\\"\",\"city\":\"K\xc3\xb8" "benhavn\",\n"
+            " \"tags\":[\"espresso\",\"tea\",\"\\u00e9clair\"],\"seats\":24}";
+    exception e;
+    XCTOR(e);
+    if(e.try){
+        // try block
+        vpJson = vpJsonCtor(&e);
+
+        // display the information header
+        char* cpHeader =
+                "This example case illustrates UTF-8 keys and string values.\n"
+                "By default, keys and strings are decoded to arrays of 32-bit Unicode code points.\n"
+                "With UTF-8 strings turned on, strings without escaped characters point directly into the JSON object's\n"
+                "copy of the input and only strings with escaped characters are decoded, to UTF-8.\n"
+                "The 32-bit strings are produced only when requested.\n";
+        printf("\n%s", cpHeader);
+        printf("\nThe JSON Text\n%s\n", cpDoc);
+
+        // read with UTF-8 strings
+        vJsonSetUtf8Strings(vpJson, APG_TRUE);
+        vpIt = vpJsonReadArray(vpJson, (uint8_t*)cpDoc, (aint)strlen(cpDoc));
+        printf("\nThe UTF-8 Keys and Strings\n");
+        for(spValue = spJsonIteratorFirst(vpIt); spValue; spValue = spJsonIteratorNext(vpIt)){
+            if(spValue->spKey8){
+                vPrintUtf8("   key", spValue->spKey8);
+                luiUtf8Bytes += (luint)spValue->spKey8->uiLength;
+            }
+            if(spValue->spString8){
+                vPrintUtf8("string", spValue->spString8);
+                luiUtf8Bytes += (luint)spValue->spString8->uiLength;
+            }
+        }
+
+        // request the 32-bit strings
+        for(spValue = spJsonIteratorFirst(vpIt); spValue; spValue = spJsonIteratorNext(vpIt)){
+            spJsonValueU(vpJson, spValue);
+            if(spValue->spKey){
+                luiCodePoints += (luint)spValue->spKey->uiLength;
+            }
+            if((spValue->uiId == JSON_ID_STRING) && spValue->spString){
+                luiCodePoints += (luint)spValue->spString->uiLength;
+            }
+        }
+        printf("\n      UTF-8 string bytes: %"PRIuMAX"\n", luiUtf8Bytes);
+        printf("32-bit string code points: %"PRIuMAX" (%"PRIuMAX" bytes)\n", luiCodePoints, (luint)(luiCodePoints * sizeof(uint32_t)));
+
+        // the display functions use the 32-bit strings as needed
+        printf("\nThe JSON Values\n");
+        vJsonDisplayValue(vpJson, spJsonIteratorFirst(vpIt), 0);
+        vJsonIteratorDtor(vpIt);
+    }else{
+        // catch block - display the exception location and message
+        vUtilPrintException(&e);
+        iReturn = EXIT_FAILURE;
+    }
+
+    // clean up resources
+    vJsonDtor(vpJson);
+    return iReturn;
+}
+
+static int iMembers() {
+    int iReturn = EXIT_SUCCESS;
+    static void* vpMem = NULL;
+    static void* vpJson = NULL;
+    static void* vpVecDoc = NULL;
+    void* vpIt;
+    void* vpItKey;
+    json_value* spRoot;
+    json_value* spValue;
+    struct timespec sStart;
+    double dMsFind, dMsMember;
+    char caMember[128];
+    aint ui, uiLen;
+    aint uiMembers = 5000;
+    volatile luint luiFindSum = 0, luiMemberSum = 0;
+    exception e;
+    XCTOR(e);
+    if(e.try){
+        // try block
+        vpMem = vpMemCtor(&e);
+        vpJson = vpJsonCtor(&e);
+
+        // display the information header
+        char* cpHeader =
+                "This example case illustrates the direct lookup of object members.\n"
+                "vpJsonFindKeyA() searches a whole sub-tree for a key and returns an iterator over all of the matches.\n"
+                "spJsonMemberA() returns a single member of a given object directly, without an iterator.\n"
+                "A large object is given a hashed index of its keys on the first lookup so that\n"
+                "each later lookup takes constant time, no matter how many members the object has.\n";
+        printf("\n%s", cpHeader);
+
+        // generate a document with one large object
+        vpVecDoc = vpVecCtor(vpMem, sizeof(char), 4096);
+        vpVecPush(vpVecDoc, "{");
+        for(ui = 0; ui < uiMembers; ui++){
+            uiLen = (aint)snprintf(caMember, sizeof(caMember), "%s\"sku-%u\":%u",
+                    (ui ? ",\n" : "\n"), (unsigned int)ui, (unsigned int)(ui % 100));
+            vpVecPushn(vpVecDoc, caMember, uiLen);
+        }
+        vpVecPushn(vpVecDoc, "\n}", 2);
+        vpIt = vpJsonReadArray(vpJson, (uint8_t*)vpVecFirst(vpVecDoc), uiVecLen(vpVecDoc));
+        spRoot = spJsonIteratorFirst(vpIt);
+        printf("\nobject members: %"PRIuMAX"\n", (luint)spRoot->uiChildCount);
+
+        // look up every member with a tree search
+        clock_gettime(CLOCK_MONOTONIC, &sStart);
+        for(ui = 0; ui < uiMembers; ui++){
+            snprintf(caMember, sizeof(caMember), "sku-%u", (unsigned int)ui);
+            vpItKey = vpJsonFindKeyA(vpJson, caMember, spRoot);
+            spValue = spJsonIteratorFirst(vpItKey);
+            luiFindSum += (luint)spValue->spNumber->uiUnsigned;
+            vJsonIteratorDtor(vpItKey);
+        }
+        dMsFind = dWallMSec(&sStart);
+
+        // look up every member directly
+        clock_gettime(CLOCK_MONOTONIC, &sStart);
+        for(ui = 0; ui < uiMembers; ui++){
+            snprintf(caMember, sizeof(caMember), "sku-%u", (unsigned int)ui);
+            spValue = spJsonMemberA(vpJson, spRoot, caMember);
+            luiMemberSum += (luint)spValue->spNumber->uiUnsigned;
+        }
+        dMsMember = dWallMSec(&sStart);
+        printf("\n            vpJsonFindKeyA()    spJsonMemberA()\n");
+        printf("sum:     %15"PRIuMAX" %18"PRIuMAX"\n", luiFindSum, luiMemberSum);
+        printf("msec:    %15.3f %18.3f\n", dMsFind, dMsMember);
+        printf("missing member: %s\n", spJsonMemberA(vpJson, spRoot, "sku-none") ? "found" : "NULL");
+        vJsonIteratorDtor(vpIt);
+    }else{
+        // catch block - display the exception location and message
+        vUtilPrintException(&e);
+        iReturn = EXIT_FAILURE;
+    }
+
+    // clean up resources
+    vJsonDtor(vpJson);
+    vMemDtor(vpMem);
+    return iReturn;
+}
+
+typedef struct{
+    atomic_uint_fast64_t uiSum; // the records of an unordered read may be reported from several threads at once
+    atomic_uint_fast64_t uiOutOfOrder;
+    atomic_uint_fast64_t uiLastOffset;
+} lines_totals;
+
+static abool bLinesRecord(void* vpJsonCtx, json_value* spRoot, luint luiOffset, void* vpUserData){
+    lines_totals* spTotals = (lines_totals*)vpUserData;
+    json_value* spId = spJsonMemberA(vpJsonCtx, spRoot, "id");
+    if(spId){
+        atomic_fetch_add(&spTotals->uiSum, (uint_fast64_t)spId->spNumber->uiUnsigned);
+    }
+    if((uint_fast64_t)luiOffset < atomic_exchange(&spTotals->uiLastOffset, (uint_fast64_t)luiOffset)){
+        atomic_fetch_add(&spTotals->uiOutOfOrder, 1);
+    }
+    return APG_TRUE;
+}
+
+static int iLines() {
+    int iReturn = EXIT_SUCCESS;
+    static void* vpMem = NULL;
+    static void* vpJson = NULL;
+    static void* vpVecDoc = NULL;
+    struct timespec sStart;
+    double dMs;
+    char caRecord[256];
+    aint ui, uiLen;
+    aint uiRecords = 20000;
+    luint luiCount;
+    lines_totals sTotals;
+    const char* cpFileName = cpMakeFileName(s_caBuf, SOURCE_DIR, "/../output/", "records.ndjson");
+    struct{
+        const char* cpName;
+        aint uiThreads;
+        aint uiFlags;
+    } saRuns[] = {
+            {"1 thread", 1, 0},
+            {"all processors, unordered", 0, 0},
+            {"all processors, ordered", 0, JSON_LINES_ORDERED},
+            {"all processors, lazy", 0, JSON_LINES_LAZY},
+    };
+    exception e;
+    XCTOR(e);
+    if(e.try){
+        // try block
+        vpMem = vpMemCtor(&e);
+        vpJson = vpJsonCtor(&e);
+
+        // display the information header
+        char* cpHeader =
+                "This example case illustrates the parallel reading of a JSON Lines (NDJSON) file.\n"
+                "Each line of the file is a complete JSON document, a record.\n"
+                "The file is mapped into memory and divided into chunks of lines which are read by a pool of worker threads.\n"
+                "The root value of each record is reported to a callback function, which sums the \"id\" members.\n"
+                "Unordered, the records are reported by the workers as they are read and the callback function must be thread safe.\n"
+                "Ordered, they are reported in file order by the calling thread.\n";
+        printf("\n%s", cpHeader);
+
+        // generate a JSON Lines file
+        vpVecDoc = vpVecCtor(vpMem, sizeof(char), 4096);
+        for(ui = 0; ui < uiRecords; ui++){
+            uiLen = (aint)snprintf(caRecord, sizeof(caRecord),
+                    "{\"id\":%u,\"name\":\"customer \\\"%u\\\"\",\"active\":%s,\"balance\":%u.75,"
+                    "\"address\":{\"street\":\"%u Main St.\",\"city\":\"city-%u\",\"zip\":\"%05u\"},\"tags\":[\"new\",\"caf\\u00e9\",null]}\n",
+                    (unsigned int)ui, (unsigned int)ui, ((ui % 3) ? "true" : "false"), (unsigned int)(ui % 1000),
+                    (unsigned int)(ui % 500), (unsigned int)(ui % 50), (unsigned int)(ui % 100000));
+            vpVecPushn(vpVecDoc, caRecord, uiLen);
+        }
+        vUtilFileWrite(vpMem, cpFileName, (uint8_t*)vpVecFirst(vpVecDoc), uiVecLen(vpVecDoc));
+        printf("\nrecords: %"PRIuMAX"\n", (luint)uiRecords);
+        printf("  bytes: %"PRIuMAX"\n", (luint)uiVecLen(vpVecDoc));
+
+        // read the file each way
+        printf("\n%-28s %10s %15s %12s %10s %12s\n", "", "records", "sum ids", "out of order", "msec", "records/sec");
+        for(ui = 0; ui < (aint)(sizeof(saRuns) / sizeof(saRuns[0])); ui++){
+            atomic_init(&sTotals.uiSum, 0);
+            atomic_init(&sTotals.uiOutOfOrder, 0);
+            atomic_init(&sTotals.uiLastOffset, 0);
+            clock_gettime(CLOCK_MONOTONIC, &sStart);
+            luiCount = luiJsonLinesFile(vpJson, cpFileName, saRuns[ui].uiThreads, saRuns[ui].uiFlags, bLinesRecord, &sTotals);
+            dMs = dWallMSec(&sStart);
+            printf("%-28s %10"PRIuMAX" %15"PRIuMAX" %12"PRIuMAX" %10.3f %12.0f\n", saRuns[ui].cpName, luiCount,
+                    (luint)atomic_load(&sTotals.uiSum), (luint)atomic_load(&sTotals.uiOutOfOrder), dMs,
+                    (dMs > 0.0) ? ((double)luiCount * 1000.0 / dMs) : 0.0);
+        }
+        remove(cpFileName);
+    }else{
+        // catch block - display the exception location and message
+        vUtilPrintException(&e);
+        iReturn = EXIT_FAILURE;
+    }
+
+    // clean up resources
+    vJsonDtor(vpJson);
+    vMemDtor(vpMem);
+    return iReturn;
+}
+
+static int iFastWriter() {
+    int iReturn = EXIT_SUCCESS;
+    static void* vpMem = NULL;
+    static void* vpJson = NULL;
+    static void* vpVecDoc = NULL;
+    static void* vpVecCompact = NULL;
+    void* vpIt;
+    json_value* spRoot;
+    uint8_t* ucpOut;
+    struct timespec sStart;
+    double dMsWrite, dMsCompact, dMsIndented;
+    char caRecord[256];
+    aint ui, uiLen, uiWriteLen, uiCompactLen, uiIndentedLen;
+    aint uiRecords = 20000;
+    static char* cpNumbers = "[0.1, 0.3333333333333333, 123.0, 1.0e21, 4.9e-324, 1.7976931348623157e308, -0.0, "
+            "-9223372036854775807, 18446744073709551615, {}, [], {\"k\": \"tab\\t, quote\\\", caf\\u00e9\"}]";
+    exception e;
+    XCTOR(e);
+    if(e.try){
+        // try block
+        vpMem = vpMemCtor(&e);
+        vpJson = vpJsonCtor(&e);
+        vJsonSetUtf8Strings(vpJson, APG_TRUE);
+
+        // display the information header
+        char* cpHeader =
+                "This example case illustrates the direct UTF-8 writer.\n"
+                "ucpJsonWrite() builds its output as 32-bit code points and then converts them to UTF-8.\n"
+                "ucpJsonWriteUtf8() writes UTF-8 bytes directly, copying UTF-8 strings as they are and\n"
+                "writing floating point numbers with the fewest digits that read back to the same value.\n"
+                "The compact output is read again and rewritten to show that it is unchanged.\n";
+        printf("\n%s", cpHeader);
+
+        // generate a large document
+        vpVecDoc = vpVecCtor(vpMem, sizeof(char), 4096);
+        vpVecPush(vpVecDoc, "[");
+        for(ui = 0; ui < uiRecords; ui++){
+            uiLen = (aint)snprintf(caRecord, sizeof(caRecord),
+                    "%s{\"id\":%u,\"name\":\"customer \\\"%u\\\"\",\"active\":%s,\"balance\":%u.75,\"ratio\":%.17g,"
+                    "\"address\":{\"street\":\"%u Main St.\",\"city\":\"city-%u\",\"zip\":\"%05u\"},\"tags\":[\"new\",\"caf\\u00e9\",null]}",
+                    (ui ? ",\n" : "\n"), (unsigned int)ui, (unsigned int)ui, ((ui % 3) ? "true" : "false"), (unsigned int)(ui % 1000),
+                    1.0 / (double)(ui + 3), (unsigned int)(ui % 500), (unsigned int)(ui % 50), (unsigned int)(ui % 100000));
+            vpVecPushn(vpVecDoc, caRecord, uiLen);
+        }
+        vpVecPushn(vpVecDoc, "\n]", 2);
+        vpIt = vpJsonReadArray(vpJson, (uint8_t*)vpVecFirst(vpVecDoc), uiVecLen(vpVecDoc));
+        spRoot = spJsonIteratorFirst(vpIt);
+        printf("\nrecords: %"PRIuMAX"\n", (luint)uiRecords);
+        printf("  bytes: %"PRIuMAX"\n", (luint)uiVecLen(vpVecDoc));
+
+        // write the document three ways
+        clock_gettime(CLOCK_MONOTONIC, &sStart);
+        ucpJsonWrite(vpJson, spRoot, &uiWriteLen);
+        dMsWrite = dWallMSec(&sStart);
+        clock_gettime(CLOCK_MONOTONIC, &sStart);
+        ucpOut = ucpJsonWriteUtf8(vpJson, spRoot, 0, &uiCompactLen);
+        dMsCompact = dWallMSec(&sStart);
+        vpVecCompact = vpVecCtor(vpMem, sizeof(uint8_t), uiCompactLen);
+        vpVecPushn(vpVecCompact, ucpOut, uiCompactLen);
+        clock_gettime(CLOCK_MONOTONIC, &sStart);
+        ucpJsonWriteUtf8(vpJson, spRoot, 2, &uiIndentedLen);
+        dMsIndented = dWallMSec(&sStart);
+        vJsonIteratorDtor(vpIt);
+        printf("\n                    bytes        msec\n");
+        printf("ucpJsonWrite: %11"PRIuMAX" %11.3f\n", (luint)uiWriteLen, dMsWrite);
+        printf("compact:      %11"PRIuMAX" %11.3f\n", (luint)uiCompactLen, dMsCompact);
+        printf("indented:     %11"PRIuMAX" %11.3f\n", (luint)uiIndentedLen, dMsIndented);
+        if(dMsCompact > 0.0){
+            printf("speedup:      %23.1fx\n", dMsWrite / dMsCompact);
+        }
+
+        // read the compact output and write it again
+        vpIt = vpJsonReadArray(vpJson, (uint8_t*)vpVecFirst(vpVecCompact), uiVecLen(vpVecCompact));
+        ucpOut = ucpJsonWriteUtf8(vpJson, spJsonIteratorFirst(vpIt), 0, &uiLen);
+        printf("\nrewritten compact output is %s\n",
+                ((uiLen == uiCompactLen) && !memcmp(ucpOut, vpVecFirst(vpVecCompact), (size_t)uiLen)) ? "unchanged" : "CHANGED");
+        vJsonIteratorDtor(vpIt);
+
+        // write some numbers and strings to stdout
+        vpIt = vpJsonReadArray(vpJson, (uint8_t*)cpNumbers, (aint)strlen(cpNumbers));
+        spRoot = spJsonIteratorFirst(vpIt);
+        printf("\nInput\n%s\n", cpNumbers);
+        printf("\nCompact\n");
+        vJsonWriteStream(vpJson, spRoot, 0, stdout);
+        printf("\n\nIndented\n");
+        vJsonWriteStream(vpJson, spRoot, 4, stdout);
+        printf("\n");
+        vJsonIteratorDtor(vpIt);
+    }else{
+        // catch block - display the exception location and message
+        vUtilPrintException(&e);
+        iReturn = EXIT_FAILURE;
+    }
+
+    // clean up resources
+    vJsonDtor(vpJson);
+    vMemDtor(vpMem);
+    return iReturn;
+}
+
+static aint uiNumberMismatches(void* vpJson, json_value* spRoot, const char* cpDoc, const aint* uipOffsets){
+    aint ui, uiMismatches = 0;
+    double dExpected;
+    json_value* spValue;
+    void* vpIt = vpJsonChildren(vpJson, spRoot);
+    for(spValue = spJsonIteratorFirst(vpIt), ui = 0; spValue; spValue = spJsonIteratorNext(vpIt), ui++){
+        if(spValue->spNumber->uiType == JSON_ID_FLOAT){
+            dExpected = strtod(cpDoc + uipOffsets[ui], NULL);
+            if(memcmp((void*)&dExpected, (void*)&spValue->spNumber->dFloat, sizeof(double))){
+                uiMismatches++;
+            }
+        }
+    }
+    vJsonIteratorDtor(vpIt);
+    return uiMismatches;
+}
+
+static int iNumbers() {
+    int iReturn = EXIT_SUCCESS;
+    static void* vpMem = NULL;
+    static void* vpJson = NULL;
+    static void* vpVecDoc = NULL;
+    static void* vpVecOffsets = NULL;
+    void* vpIt;
+    void* vpItNumbers;
+    json_value* spRoot;
+    json_value* spValue;
+    struct timespec sStart;
+    double dMsGrammar, dMsLazy;
+    char caNumber[64];
+    char caDoc[128];
+    aint ui, uiLen, uiOffset, uiMismatches = 0;
+    aint uiNumbers = 200000;
+    volatile aint uiFloats = 0;
+    volatile uint64_t uiSeed = 1;
+    static const char* cppSamples[] = {
+            "1E2", "3e-3", "-9223372036854775808", "18446744073709551615", "-0",
+            "0.1", "1e400", "4.9e-324", "123456789012345678901234567890.5"
+    };
+    exception e;
+    XCTOR(e);
+    if(e.try){
+        // try block
+        vpMem = vpMemCtor(&e);
+        vpJson = vpJsonCtor(&e);
+
+        // display the information header
+        char* cpHeader =
+                "This example case illustrates the conversion of numbers.\n"
+                "The grammar parser matches and converts each number in a single pass.\n"
+                "Integers are converted eight digits at a time and floating point numbers\n"
+                "are converted exactly, with Clinger's fast path or the Eisel-Lemire algorithm.\n"
+                "A large array of numbers is read with both readers and each floating point value\n"
+                "is compared to the value from strtod().\n";
+        printf("\n%s", cpHeader);
+
+        // generate an array of numbers, half floating point, half integers
+        vpVecDoc = vpVecCtor(vpMem, sizeof(char), 4096);
+        vpVecOffsets = vpVecCtor(vpMem, sizeof(aint), uiNumbers);
+        vpVecPush(vpVecDoc, "[");
+        for(ui = 0; ui < uiNumbers; ui++){
+            uiSeed = (uiSeed * 6364136223846793005ULL) + 1442695040888963407ULL;
+            if(ui & 1){
+                uiLen = (aint)snprintf(caNumber, sizeof(caNumber), "%"PRIuMAX, (luint)(uiSeed >> (uiSeed % 64)));
+            }else{
+                uiLen = (aint)snprintf(caNumber, sizeof(caNumber), "%.17g", (double)(uiSeed >> 11) / 9007199254740992.0 * 1000.0);
+            }
+            if(ui){
+                vpVecPush(vpVecDoc, ",");
+            }
+            uiOffset = uiVecLen(vpVecDoc);
+            vpVecPush(vpVecOffsets, &uiOffset);
+            vpVecPushn(vpVecDoc, caNumber, uiLen);
+        }
+        vpVecPush(vpVecDoc, "]");
+        printf("\nnumbers: %"PRIuMAX"\n", (luint)uiNumbers);
+        printf("  bytes: %"PRIuMAX"\n", (luint)uiVecLen(vpVecDoc));
+
+        // read with the grammar parser
+        clock_gettime(CLOCK_MONOTONIC, &sStart);
+        vpIt = vpJsonReadArray(vpJson, (uint8_t*)vpVecFirst(vpVecDoc), uiVecLen(vpVecDoc));
+        dMsGrammar = dWallMSec(&sStart);
+        uiMismatches += uiNumberMismatches(vpJson, spJsonIteratorFirst(vpIt), (char*)vpVecFirst(vpVecDoc), (aint*)vpVecFirst(vpVecOffsets));
+        vJsonIteratorDtor(vpIt);
+
+        // read lazily, converting every number
+        clock_gettime(CLOCK_MONOTONIC, &sStart);
+        vpIt = vpJsonReadArrayLazy(vpJson, (uint8_t*)vpVecFirst(vpVecDoc), uiVecLen(vpVecDoc));
+        spRoot = spJsonIteratorFirst(vpIt);
+        vpItNumbers = vpJsonChildren(vpJson, spRoot);
+        for(spValue = spJsonIteratorFirst(vpItNumbers); spValue; spValue = spJsonIteratorNext(vpItNumbers)){
+            if(spValue->spNumber->uiType == JSON_ID_FLOAT){
+                uiFloats++;
+            }
+        }
+        dMsLazy = dWallMSec(&sStart);
+        vJsonIteratorDtor(vpItNumbers);
+        uiMismatches += uiNumberMismatches(vpJson, spRoot, (char*)vpVecFirst(vpVecDoc), (aint*)vpVecFirst(vpVecOffsets));
+        vJsonIteratorDtor(vpIt);
+        printf("\n              grammar reader     lazy reader\n");
+        printf("msec:        %15.3f %15.3f\n", dMsGrammar, dMsLazy);
+        if((dMsGrammar > 0.0) && (dMsLazy > 0.0)){
+            printf("numbers/sec: %15.0f %15.0f\n", (double)uiNumbers * 1000.0 / dMsGrammar, (double)uiNumbers * 1000.0 / dMsLazy);
+        }
+        printf("\nfloating point numbers: %"PRIuMAX"\n", (luint)uiFloats);
+        printf("mismatches with strtod(): %"PRIuMAX"\n", (luint)uiMismatches);
+
+        // display some sample conversions
+        printf("\nSample Conversions\n");
+        for(ui = 0; ui < (aint)(sizeof(cppSamples) / sizeof(cppSamples[0])); ui++){
+            snprintf(caDoc, sizeof(caDoc), "[%s]", cppSamples[ui]);
+            vpIt = vpJsonReadArray(vpJson, (uint8_t*)caDoc, (aint)strlen(caDoc));
+            spValue = spJsonIteratorFirst(vpIt)->sppChildren[0];
+            switch(spValue->spNumber->uiType){
+            case JSON_ID_FLOAT:
+                printf("%34s: float:    %.17g\n", cppSamples[ui], spValue->spNumber->dFloat);
+                break;
+            case JSON_ID_SIGNED:
+                printf("%34s: signed:   %"PRIiMAX"\n", cppSamples[ui], (intmax_t)spValue->spNumber->iSigned);
+                break;
+            case JSON_ID_UNSIGNED:
+                printf("%34s: unsigned: %"PRIuMAX"\n", cppSamples[ui], (luint)spValue->spNumber->uiUnsigned);
+                break;
+            }
+            vJsonIteratorDtor(vpIt);
+        }
+    }else{
+        // catch block - display the exception location and message
+        vUtilPrintException(&e);
+        iReturn = EXIT_FAILURE;
+    }
+
+    // clean up resources
+    vJsonDtor(vpJson);
+    vMemDtor(vpMem);
+    return iReturn;
+}
+
 /**
  * \brief Main function for the basic application.
  * \param argc The number of command line arguments.
@@ -570,6 +1478,22 @@ int main(int argc, char **argv) {
         return iWriter();
     case 6:
         return iBuilder();
+    case 7:
+        return iSmallDocs();
+    case 8:
+        return iEvents();
+    case 9:
+        return iLazy();
+    case 10:
+        return iUtf8Strings();
+    case 11:
+        return iMembers();
+    case 12:
+        return iLines();
+    case 13:
+        return iFastWriter();
+    case 14:
+        return iNumbers();
     default:
         return iHelp();
     }
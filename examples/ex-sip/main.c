@@ -54,7 +54,7 @@ The compiled example will execute the following cases. Run the application with
  - case 4: Parse all invalid SIP messages.
  - case 5: Parse all semantically invalid SIP messages.
  - case 6: Parse all SIP messages and measure the times, with an without UDTs.
- - case 7: Parse all SIP messages and display the node-hit statistics, with an without UDTs.
+ - case 7: Parse all SIP messages and display the node-hit statistics, with an without UDTs, and the rule timing, call stack and backtracking profiles.
  */
 
 /**
@@ -197,7 +197,7 @@ The compiled example will execute the following cases. Run the application with
  - case 4: Parse and trace all invalid SIP messages, with and without UDTs.
  - case 5: Parse and trace all semantically invalid SIP messages, with and without UDTs.
  - case 6: Parse all SIP messages and measure the times, with and without UDTs.
- - case 7: Parse all SIP messages and display the node-hit statistics, with and without UDTs.
+ - case 7: Parse all SIP messages and display the node-hit statistics, with and without UDTs, and the rule timing, call stack and backtracking profiles.
 */
 
 #include <limits.h>
@@ -231,7 +231,7 @@ static char* s_cppCases[] = {
         "Parse and trace all invalid SIP messages, with and without UDTs..",
         "Parse and trace all semantically invalid SIP messages, with and without UDTs..",
         "Parse all SIP messages and measure the times, with and without UDTs.",
-        "Parse all SIP messages and display the node-hit statistics, with and without UDTs.",
+        "Parse all SIP messages and display the node-hit statistics, with and without UDTs, and the rule timing, call stack and backtracking profiles.",
 };
 static long int s_iCaseCount = (long int)(sizeof(s_cppCases) / sizeof(s_cppCases[0]));
 
@@ -1025,7 +1025,8 @@ static int iStats() {
 
         // display the information header
         char* cpHeader =
-                "This function will parse all of the SIP torture tests and display the node-hit statistics.\n"
+                "This function will parse all of the SIP torture tests and display the node-hit statistics\n"
+                "and the rule timing, call stack and backtracking profiles.\n"
                 "Comparisons will show the differences between parsing with and without PPPTs,\n"
                 " and with and without UDTs.\n";
         printf("\n%s", cpHeader);
@@ -1080,6 +1081,47 @@ static int iStats() {
         vStatsToAscii(vpStats, NULL, cpOut);
         printf("Results written to %s\n", cpOut);
 
+        // profile the rules to see where the parsing time is spent
+        vParserDtor(vpParser);
+        vpParser = vpParserCtor(&e, vpSip0Init);
+        vpStats = vpStatsCtor(vpParser);
+        vStatsTiming(vpStats, APG_TRUE);
+        vStatsCallStacks(vpStats, APG_TRUE);
+        spConfig = spStart;
+        printf("\nRule timing without UDTs: cumulative for %d messages\n", (int)uiMsgs);
+        for(; spConfig < spEnd; spConfig++){
+            vParserParse(vpParser, spConfig, &sState);
+        }
+        cpOut = cpMakeFileName(s_caBuf, SOURCE_DIR, "/../output/", "stats-timing.out");
+        vStatsToAscii(vpStats, NULL, cpOut);
+        printf("Results written to %s\n", cpOut);
+        cpOut = cpMakeFileName(s_caBuf, SOURCE_DIR, "/../output/", "stats-timing.csv");
+        vStatsToCsv(vpStats, cpOut);
+        printf("Results written to %s\n", cpOut);
+        cpOut = cpMakeFileName(s_caBuf, SOURCE_DIR, "/../output/", "stats-timing.folded");
+        vStatsToFolded(vpStats, "time", cpOut);
+        printf("Flame graph stacks (exclusive ns) written to %s\n", cpOut);
+        cpOut = cpMakeFileName(s_caBuf, SOURCE_DIR, "/../output/", "stats-hits.folded");
+        vStatsToFolded(vpStats, "hits", cpOut);
+        printf("Flame graph stacks (node hits) written to %s\n", cpOut);
+
+        // profile the backtracking to see where parsing work is wasted
+        vParserDtor(vpParser);
+        vpParser = vpParserCtor(&e, vpSip0Init);
+        vpStats = vpStatsCtor(vpParser);
+        vStatsBacktracking(vpStats, APG_TRUE);
+        spConfig = spStart;
+        printf("\nBacktracking without UDTs: cumulative for %d messages\n", (int)uiMsgs);
+        for(; spConfig < spEnd; spConfig++){
+            vParserParse(vpParser, spConfig, &sState);
+        }
+        cpOut = cpMakeFileName(s_caBuf, SOURCE_DIR, "/../output/", "stats-backtracking.out");
+        vStatsToAscii(vpStats, NULL, cpOut);
+        printf("Results written to %s\n", cpOut);
+        cpOut = cpMakeFileName(s_caBuf, SOURCE_DIR, "/../output/", "stats-backtracking.html");
+        vStatsHeatMapToHtml(vpStats, cpOut);
+        printf("Heat maps (offsets for the last message only) written to %s\n", cpOut);
+
         vParserDtor(vpParser);
         vpParser = vpParserCtor(&e, vpSip1Init);
         vSip1UdtCallbacks(vpParser);
@@ -70,6 +70,9 @@ The compiled example will execute the following cases. Run the application with
  - case  9: Parsing statistics, cumulative for multiple parses.",
  - case 10: Illustrate memory statistics.
  - case 11: Illustrate vector statistics.
+ - case 12: Record a binary trace and decode it offline.
+ - case 13: Flight-recorder trace, dumped only on failure.
+ - case 14: Farthest failure and expected set, without a trace.
  */
 
 /**
@@ -111,6 +114,9 @@ The compiled example will execute the following cases. Run the application with
  - case  9: Parsing statistics, cumulative for multiple parses.",
  - case 10: Illustrate memory statistics.
  - case 11: Illustrate vector statistics.
+ - case 12: Record a binary trace and decode it offline.
+ - case 13: Flight-recorder trace, dumped only on failure.
+ - case 14: Farthest failure and expected set, without a trace.
 */
 #include "../../utilities/utilities.h"
 #include "../../api/api.h"
@@ -140,6 +146,9 @@ static char* s_cppCases[] = {
         "Parsing statistics, cumulative for multiple parses.",
         "Illustrate memory statistics.",
         "Illustrate vector statistics.",
+        "Record a binary trace and decode it offline.",
+        "Flight-recorder trace, dumped only on failure.",
+        "Farthest failure and expected set, without a trace.",
 };
 static long int s_iCaseCount = (long int)(sizeof(s_cppCases) / sizeof(s_cppCases[0]));
 
@@ -811,6 +820,200 @@ static int iVecStats() {
  * \return The application's exit code.
  *
  */
+static int iTraceBinary() {
+    int iReturn = EXIT_SUCCESS;
+    static void* vpApi = NULL;
+    static void* vpMem = NULL;
+    static void* vpParser = NULL;
+    static void* vpTrace = NULL;
+    char* cpInput = "+123456789.0987654321E+100";
+    char caBinary[PATH_MAX];
+    parser_config sConfig;
+    parser_state sState;
+    apg_phrase* spPhrase;
+    exception e;
+    XCTOR(e);
+    if(e.try){
+        // try block - construct the API object
+        vpApi = vpApiCtor(&e);
+
+        // convert the input string to alphabet characters (in general, sizeof(achar) != sizeof(char))
+        vpMem = vpMemCtor(&e);
+        spPhrase = spUtilStrToPhrase(vpMem, cpInput);
+
+        // construct a floating point parser with PPPT
+        vApiFile(vpApi, cpMakeFileName(caBuf, SOURCE_DIR, "/../input/","float.abnf"), APG_FALSE, APG_TRUE);
+        vpParser = vpApiOutputParser(vpApi);
+
+        // record the trace in binary form, the configuration filters still apply
+        const char* cpConfig = cpMakeFileName(caBuf, SOURCE_DIR, "/../input/","float-config-select");
+        printf("\nUsing trace configuration file %s \n", cpConfig);
+        vpTrace = vpTraceCtor(vpParser);
+        vTraceConfig(vpTrace, cpConfig);
+        vTraceOutputType(vpTrace, TRACE_BINARY);
+        cpMakeFileName(caBinary, SOURCE_DIR, "/../output/", "float-trace.bin");
+        vTraceSetOutput(vpTrace, caBinary);
+        memset(&sConfig, 0, sizeof(sConfig));
+        sConfig.acpInput = spPhrase->acpPhrase;
+        sConfig.uiInputLength = spPhrase->uiLength;
+        sConfig.uiStartRule = uiParserRuleLookup(vpParser, "float");
+        vParserParse(vpParser, &sConfig, &sState);
+        printf("\nBinary trace records written to %s\n", caBinary);
+
+        // display the state
+        printf("\nParser State\n");
+        vUtilPrintParserState(&sState);
+
+        // decode the binary trace as ASCII to stdout
+        printf("\nDecoded Binary Trace\n");
+        vTraceOutputType(vpTrace, TRACE_ASCII);
+        vTraceSetOutput(vpTrace, NULL);
+        vTraceDecode(vpTrace, caBinary);
+
+        // decode the binary trace as HTML
+        vTraceOutputType(vpTrace, TRACE_HTML);
+        vTraceSetOutput(vpTrace, cpMakeFileName(caBuf, SOURCE_DIR, "/../output/", "float-trace.html"));
+        vTraceDecode(vpTrace, caBinary);
+        printf("\nDecoded HTML trace written to %s\n", caBuf);
+
+        // free the memory allocation
+        vMemFree(vpMem, spPhrase);
+
+    }else{
+        // catch block - display the exception location and message
+        vUtilPrintException(&e);
+        iReturn = EXIT_FAILURE;
+    }
+
+    // free up all allocated resources
+    vParserDtor(vpParser);
+    vApiDtor(vpApi);
+    vMemDtor(vpMem);
+    return iReturn;
+}
+
+static int iTraceRing() {
+    int iReturn = EXIT_SUCCESS;
+    static void* vpApi = NULL;
+    static void* vpMem = NULL;
+    static void* vpParser = NULL;
+    static void* vpTrace = NULL;
+    char* cppInput[] = {
+            "+123456789.0987654321E+100",
+            "+123456789.0987654321E+1x0",
+    };
+    aint uiHitLimit = 100;
+    aint ui;
+    parser_config sConfig;
+    parser_state sState;
+    apg_phrase* spPhrase;
+    exception e;
+    XCTOR(e);
+    if(e.try){
+        // try block - construct the API object
+        vpApi = vpApiCtor(&e);
+        vpMem = vpMemCtor(&e);
+
+        // construct a floating point parser without PPPT
+        vApiFile(vpApi, cpMakeFileName(caBuf, SOURCE_DIR, "/../input/","float.abnf"), APG_FALSE, APG_FALSE);
+        vpParser = vpApiOutputParser(vpApi);
+
+        // keep only the last 10 records in memory, nothing is displayed during the parse
+        vpTrace = vpTraceCtor(vpParser);
+        vTraceRing(vpTrace, 10);
+        memset(&sConfig, 0, sizeof(sConfig));
+        sConfig.uiStartRule = uiParserRuleLookup(vpParser, "float");
+        for(ui = 0; ui < (aint)(sizeof(cppInput) / sizeof(cppInput[0])); ui++){
+            spPhrase = spUtilStrToPhrase(vpMem, cppInput[ui]);
+            sConfig.acpInput = spPhrase->acpPhrase;
+            sConfig.uiInputLength = spPhrase->uiLength;
+            vParserParse(vpParser, &sConfig, &sState);
+            printf("\nParsing: %s\n", cppInput[ui]);
+            vUtilPrintParserState(&sState);
+
+            // dump the flight recorder only if the parse failed or took too long
+            if(!sState.uiSuccess || (sState.uiHitCount > uiHitLimit)){
+                printf("\nThe Last 10 Trace Records\n");
+                vTraceRingDump(vpTrace);
+            }else{
+                printf("\nParse succeeded, no trace displayed\n");
+            }
+            vMemFree(vpMem, spPhrase);
+        }
+
+    }else{
+        // catch block - display the exception location and message
+        vUtilPrintException(&e);
+        iReturn = EXIT_FAILURE;
+    }
+
+    // free up all allocated resources
+    vParserDtor(vpParser);
+    vApiDtor(vpApi);
+    vMemDtor(vpMem);
+    return iReturn;
+}
+
+static int iExpected() {
+    int iReturn = EXIT_SUCCESS;
+    static void* vpApi = NULL;
+    static void* vpMem = NULL;
+    static void* vpParser = NULL;
+    static void* vpParserPppt = NULL;
+    char* cpInput = "+123456789.0987654321E+1x0";
+    parser_config sConfig;
+    parser_state sState;
+    apg_phrase* spPhrase;
+    exception e;
+    XCTOR(e);
+    if(e.try){
+        // try block - construct the API object
+        vpApi = vpApiCtor(&e);
+
+        // convert the input string to alphabet characters (in general, sizeof(achar) != sizeof(char))
+        vpMem = vpMemCtor(&e);
+        spPhrase = spUtilStrToPhrase(vpMem, cpInput);
+
+        // construct a floating point parser without PPPT
+        vApiFile(vpApi, cpMakeFileName(caBuf, SOURCE_DIR, "/../input/","float.abnf"), APG_FALSE, APG_FALSE);
+        vpParser = vpApiOutputParser(vpApi);
+
+        // parse without a trace, the farthest failure is always tracked
+        memset(&sConfig, 0, sizeof(sConfig));
+        sConfig.acpInput = spPhrase->acpPhrase;
+        sConfig.uiInputLength = spPhrase->uiLength;
+        sConfig.uiStartRule = uiParserRuleLookup(vpParser, "float");
+        vParserParse(vpParser, &sConfig, &sState);
+        printf("\nParsing: %s\n", cpInput);
+        printf("\nParser State without PPPT\n");
+        vUtilPrintParserState(&sState);
+        vUtilPrintExpected(vpParser, &sState);
+
+        // with PPPT whole rules may be rejected without ever trying their terminals
+        vApiFile(vpApi, cpMakeFileName(caBuf, SOURCE_DIR, "/../input/","float.abnf"), APG_FALSE, APG_TRUE);
+        vpParserPppt = vpApiOutputParser(vpApi);
+        vParserParse(vpParserPppt, &sConfig, &sState);
+        printf("\nParser State with PPPT\n");
+        vUtilPrintParserState(&sState);
+        vUtilPrintExpected(vpParserPppt, &sState);
+
+        // free the memory allocation
+        vMemFree(vpMem, spPhrase);
+
+    }else{
+        // catch block - display the exception location and message
+        vUtilPrintException(&e);
+        iReturn = EXIT_FAILURE;
+    }
+
+    // free up all allocated resources
+    vParserDtor(vpParser);
+    vParserDtor(vpParserPppt);
+    vApiDtor(vpApi);
+    vMemDtor(vpMem);
+    return iReturn;
+}
+
 int main(int argc, char **argv) {
     long int iCase = 0;
     if(argc > 1){
@@ -842,6 +1045,12 @@ int main(int argc, char **argv) {
         return iMemStats();
     case 11:
         return iVecStats();
+    case 12:
+        return iTraceBinary();
+    case 13:
+        return iTraceRing();
+    case 14:
+        return iExpected();
     default:
         return iHelp();
     }
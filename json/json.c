@@ -47,6 +47,9 @@
  *      - functions for input of the JSON data byte stream from a file or array
  *          - vpJsonReadFile()
  *          - vpJsonReadArray()
+ *      - functions for lazy input of very large JSON data, decoding values only as they are accessed
+ *          - vpJsonReadFileLazy()
+ *          - vpJsonReadArrayLazy()
  *      - functions for finding and displaying the JSON data in a [hex dump](https://en.wikipedia.org/wiki/Hex_dump) format
  *      (the UTF-8 requirement for JSON input means that, in general, not all bytes will be printable.)
  *          - vpJsonTree()
@@ -95,6 +98,9 @@ static uint32_t s_uiReverseSolidus = 0x5C;
 static uint32_t s_uiLowerU = 0x75;
 
 static void vParseInput(json* spJson);
+static void vReadFile(json* spJson, const char* cpFileName);
+static void vReadArray(json* spJson, uint8_t* ucpData, aint uiDataLen);
+static void* vpValueIterator(json* spJson);
 static void vReintrantValueDisplay(json *spJson, struct json_value_tag *spValue);
 static void vIndent(aint uiIndent);
 static void vFindKeyValues(json* spJson, json_iterator* spIt, const uint32_t *uipKey, uint32_t uiLength, json_value* spValue);
@@ -124,6 +130,7 @@ void* vpJsonCtor(exception* spEx){
     // basics for input and output
     spJson->vpVecInput = vpVecCtor(vpMem, sizeof(uint8_t), 4096);
     spJson->vpVecOutput = vpVecCtor(vpMem, sizeof(uint32_t), 8192);
+    spJson->vpVecWrite8 = vpVecCtor(vpMem, sizeof(uint8_t), 8192);
 
     // vectors used to give caller access to resulting values
     spJson->vpVecTreeList = vpVecCtor(vpMem, sizeof(json_value*), 512);
@@ -142,12 +149,25 @@ void* vpJsonCtor(exception* spEx){
     spJson->vpVecNumbers = vpVecCtor(vpMem, sizeof(json_number), 1024);
     spJson->vpVecChildIndexes = vpVecCtor(vpMem, sizeof(aint), 1024);
     spJson->vpVecFrames = vpVecCtor(vpMem, sizeof(frame), 128);
+    spJson->vpVecFrameIndexes = vpVecCtor(vpMem, sizeof(void*), 128);
+    spJson->vpVecAchars = vpVecCtor(vpMem, sizeof(achar), 4096);
+
+    // vectors used by the lazy reader
+    spJson->vpVecStructural = vpVecCtor(vpMem, sizeof(aint), 4096);
+    spJson->vpVecLazy = vpVecCtor(vpMem, sizeof(lazy_value), 1024);
+    spJson->vpVecLazyFrames = vpVecCtor(vpMem, sizeof(lazy_frame), 128);
+    spJson->vpVecArena = vpVecCtor(vpMem, sizeof(uint32_t*), 32);
     spJson->vpVecValues = vpVecCtor(vpMem, sizeof(json_value), 128);
     spJson->vpVecStrings = vpVecCtor(vpMem, sizeof(u32_phrase), 128);
+    spJson->vpVecUtf8 = vpVecCtor(vpMem, sizeof(uint8_t), 4096);
+    spJson->vpVecStrings8 = vpVecCtor(vpMem, sizeof(u8_phrase), 128);
+    spJson->vpVecKeyIndex = vpVecCtor(vpMem, sizeof(key_index), 1024);
+    spJson->vpVecKeySlots = vpVecCtor(vpMem, sizeof(key_slot), 1024);
     spJson->vpVecChildPointers = vpVecCtor(vpMem, sizeof(json_value*), 128);
     spJson->vpFmt = vpFmtCtor(spEx);
 
     // success
+    spJson->bTree = APG_TRUE;
     spJson->vpMem = vpMem;
     spJson->spException = spEx;
     spJson->vpValidate = s_vpJsonValid;
@@ -170,9 +190,11 @@ void vJsonDtor(void *vpCtx) {
             if(spJson->spIn){
                 fclose(spJson->spIn);
             }
+            vParserDtor(spJson->vpParser);
             vConvDtor(spJson->vpConv);
             vFmtDtor(spJson->vpFmt);
             vLinesDtor(spJson->vpLines);
+            vJsonLinesUnmap(spJson);
             memset((void*) spJson, 0, sizeof(json));
             vMemDtor(vpMem);
         }else{
@@ -202,75 +224,19 @@ abool bJsonValidate(void* vpCtx){
  * If invalid the application will silently exit with a \ref BAD_CONTEXT exit code.
  * \param cpFileName The name of the file to read.
  * \return Returns an iterator to the values in the value tree. The order of values is that
- * of a depth-first walk of the value tree.
+ * of a depth-first walk of the value tree. NULL if tree building has been turned off with vJsonSetTreeBuilding().
  */
 void* vpJsonReadFile(void *vpCtx, const char *cpFileName){
     json* spJson = (json*) vpCtx;
     if((vpCtx == NULL) || (spJson->vpValidate != s_vpJsonValid)){
         vExContext();
     }
-    char caBuf[PATH_MAX + 128];
-    size_t uiSize = PATH_MAX + 128;
-    uint8_t ucaBom[3];
-    int iaBom[3];
-    vVecClear(spJson->vpVecInput);
-    vLinesDtor(spJson->vpLines);
-    spJson->vpLines = NULL;
-    if(spJson->spIn){
-        fclose(spJson->spIn);
-        spJson->spIn = NULL;
-    }
-    if(!cpFileName || !cpFileName[0]){
-        XTHROW(spJson->spException, "file name cannot be NULL or empty");
-
-    }
-    spJson->spIn = fopen(cpFileName, "rb");
-    if (!spJson->spIn) {
-        snprintf(caBuf, uiSize, "can't open input file: %s", cpFileName);
-        XTHROW(spJson->spException, caBuf);
-    }
-    // get the first 3 bytes and test for BOM
-    iaBom[0] = fgetc(spJson->spIn);
-    iaBom[1] = fgetc(spJson->spIn);
-    iaBom[2] = fgetc(spJson->spIn);
-    ucaBom[0] = (uint8_t) iaBom[0];
-    ucaBom[1] = (uint8_t) iaBom[1];
-    ucaBom[2] = (uint8_t) iaBom[2];
-    if (iaBom[0] == EOF) {
-        snprintf(caBuf, uiSize, "input file is empty: %s", cpFileName);
-        XTHROW(spJson->spException, caBuf);
-    }
-    if (iaBom[1] == EOF) {
-        // only one character - push and continue
-        vpVecPush(spJson->vpVecInput, &ucaBom[0]);
-    }else if (iaBom[2] == EOF) {
-        // only two characters - push and continue
-        vpVecPushn(spJson->vpVecInput, &ucaBom[0], 2);
-    }else{
-        if (!(ucaBom[0] == 0xEF && ucaBom[1] == 0xBB && ucaBom[2] == 0xBF)) {
-            // no BOM - save the first three characters and continue
-            vpVecPushn(spJson->vpVecInput, &ucaBom[0], 3);
-        }
-        uint8_t ucGotBuf[1024];
-        size_t uiGot = fread(ucGotBuf, 1, 1024, spJson->spIn);
-        while (uiGot != 0) {
-            vpVecPushn(spJson->vpVecInput, ucGotBuf, (aint)uiGot);
-            uiGot = fread(ucGotBuf, 1, 1024, spJson->spIn);
-        }
-    }
-    fclose(spJson->spIn);
-    spJson->spIn = NULL;
-    spJson->vpLines = vpLinesCtor(spJson->spException, (char*) vpVecFirst(spJson->vpVecInput), uiVecLen(spJson->vpVecInput));
+    vReadFile(spJson, cpFileName);
     vParseInput(spJson);
-    json_iterator* spIt = spJsonIteratorCtor(spJson);
-    json_value** sppValues = (json_value**)vpVecPushn(spIt->vpVec, NULL, spJson->uiValueCount);
-    aint ui = 0;
-    for(; ui < spJson->uiValueCount; ui++){
-        sppValues[ui] = &spJson->spValues[ui];
+    if(!spJson->bTree){
+        return NULL;
     }
-    spIt->sppValues = sppValues;
-    spIt->uiCount = spJson->uiValueCount;
-    return (void*)spIt;
+    return vpValueIterator(spJson);
 }
 
 /**
@@ -284,36 +250,76 @@ void* vpJsonReadFile(void *vpCtx, const char *cpFileName){
  * \param ucpData Pointer to the UTF-8 encoded JSON text.
  * \param uiDataLen The number of bytes of JSON text data.
  * \return Returns an iterator to the values in the value tree. The order of values is that
- * of a depth-first walk of the value tree.
+ * of a depth-first walk of the value tree. NULL if tree building has been turned off with vJsonSetTreeBuilding().
  */
 void* vpJsonReadArray(void *vpCtx, uint8_t *ucpData, aint uiDataLen){
     json* spJson = (json*) vpCtx;
     if((vpCtx == NULL) || (spJson->vpValidate != s_vpJsonValid)){
         vExContext();
     }
-    vVecClear(spJson->vpVecInput);
-    vLinesDtor(spJson->vpLines);
-    spJson->vpLines = NULL;
-    // check for BOM
-    if (uiDataLen >= 3) {
-        if (ucpData[0] == 0xEF && ucpData[1] == 0xBB && ucpData[2] == 0xBF) {
-            ucpData += 3;
-            uiDataLen -= 3;
-        }
-    }
-    vpVecPushn(spJson->vpVecInput, ucpData, uiDataLen);
-    spJson->vpLines = vpLinesCtor(spJson->spException, (char*) vpVecFirst(spJson->vpVecInput),
-            uiVecLen(spJson->vpVecInput));
+    vReadArray(spJson, ucpData, uiDataLen);
     vParseInput(spJson);
-    json_iterator* spIt = spJsonIteratorCtor(spJson);
-    json_value** sppValues = (json_value**)vpVecPushn(spIt->vpVec, NULL, spJson->uiValueCount);
-    aint ui = 0;
-    for(; ui < spJson->uiValueCount; ui++){
-        sppValues[ui] = &spJson->spValues[ui];
+    if(!spJson->bTree){
+        return NULL;
     }
-    spIt->sppValues = sppValues;
-    spIt->uiCount = spJson->uiValueCount;
-    return (void*)spIt;
+    return vpValueIterator(spJson);
+}
+
+/**
+ * \brief The lazy JSON file reader.
+ *
+ * Reads a file containing JSON text in UTF-8 format into a value tree without the APG grammar parser.
+ * Intended for very large files of which only a small fraction of the values will ever be read.
+ *
+ * The file is read in two fast passes over a structural index of the input.
+ * Only the tree structure, objects, arrays and the types of their values, is built.
+ * Keys, strings and numbers are decoded only when the value is first returned by an iterator,
+ * or displayed or written. Searches with vpJsonFindKeyA() and vpJsonFindKeyU() compare keys directly with the input.
+ *
+ * The structure of the document is checked, but this is not a validating reader.
+ * Errors in keys, strings and numbers are only detected, and the exception thrown, when they are decoded.
+ * vpJsonReadFile() remains the validating reference. The parsing event callbacks are not called.
+ *
+ * Note that values of a lazily read tree must be accessed with the iterators or spJsonValueU().
+ * Following the sppChildren pointers directly will find values that may not have been decoded yet.
+ *
+ * \param vpCtx Pointer to a valid parser context previously returned from  vpJsonCtor.
+ * If invalid the application will silently exit with a \ref BAD_CONTEXT exit code.
+ * \param cpFileName The name of the file to read.
+ * \return Returns an iterator to the values in the value tree. The order of values is that
+ * of a depth-first walk of the value tree, the same as for vpJsonReadFile().
+ */
+void* vpJsonReadFileLazy(void *vpCtx, const char *cpFileName){
+    json* spJson = (json*) vpCtx;
+    if((vpCtx == NULL) || (spJson->vpValidate != s_vpJsonValid)){
+        vExContext();
+    }
+    vReadFile(spJson, cpFileName);
+    vJsonLazyParse(spJson);
+    return vpValueIterator(spJson);
+}
+
+/**
+ * \brief The lazy JSON array reader.
+ *
+ * Reads an array containing JSON text in UTF-8 format into a value tree without the APG grammar parser.
+ * See vpJsonReadFileLazy() for details.
+ *
+ * \param vpCtx Pointer to a valid parser context previously returned from  vpJsonCtor.
+ * If invalid the application will silently exit with a \ref BAD_CONTEXT exit code.
+ * \param ucpData Pointer to the UTF-8 encoded JSON text.
+ * \param uiDataLen The number of bytes of JSON text data.
+ * \return Returns an iterator to the values in the value tree. The order of values is that
+ * of a depth-first walk of the value tree, the same as for vpJsonReadArray().
+ */
+void* vpJsonReadArrayLazy(void *vpCtx, uint8_t *ucpData, aint uiDataLen){
+    json* spJson = (json*) vpCtx;
+    if((vpCtx == NULL) || (spJson->vpValidate != s_vpJsonValid)){
+        vExContext();
+    }
+    vReadArray(spJson, ucpData, uiDataLen);
+    vJsonLazyParse(spJson);
+    return vpValueIterator(spJson);
 }
 
 /** \brief Converts a sub-tree of values into UTF-8 byte stream of JSON text.
@@ -354,6 +360,183 @@ uint8_t* ucpJsonWrite(void* vpCtx, json_value* spValue, aint* uipCount) {
     return ucpReturn;
 }
 
+/** \brief Choose UTF-8 or 32-bit keys and string values.
+ *
+ * By default, all keys and string values are decoded to arrays of 32-bit Unicode code points,
+ * spKey and spString in \ref json_value_tag. That is four times the memory of ASCII-heavy UTF-8 input
+ * and applications often only convert them back to UTF-8.
+ * With UTF-8 strings, spKey8 and spString8 are set instead. Strings without escaped characters point directly into
+ * the JSON object's copy of the input. Only strings with escaped characters are decoded to separate storage.
+ * The UTF-8 strings remain valid until the next document is read.
+ *
+ * For UTF-8 strings, spKey and spString are NULL until requested with spJsonValueU().
+ * Display, write and key search functions convert or compare keys and strings as needed.
+ * The string and key event callbacks always receive 32-bit strings.
+ * The setting takes effect with the next document read by any of the readers.
+ *
+ * \param vpCtx Pointer to a valid parser context previously returned from  vpJsonCtor.
+ * If invalid the application will silently exit with a \ref BAD_CONTEXT exit code.
+ * \param bUtf8 If true, keys and strings are UTF-8. If false (default), 32-bit code points.
+ */
+void vJsonSetUtf8Strings(void* vpCtx, abool bUtf8){
+    json* spJson = (json*) vpCtx;
+    if((vpCtx == NULL) || (spJson->vpValidate != s_vpJsonValid)){
+        vExContext();
+    }
+    spJson->bUtf8 = bUtf8;
+}
+
+/** \brief Turn the building of the value tree on or off.
+ *
+ * By default, the parser builds the complete tree of values before vpJsonReadFile() or vpJsonReadArray() return.
+ * If only the [parsing events](\ref vJsonSetKeyCallback) are needed, turning off the tree building
+ * means that, apart from the input itself, memory use no longer grows with the size of the document.
+ * With tree building off, vpJsonReadFile() and vpJsonReadArray() return NULL.
+ *
+ * \param vpCtx Pointer to a valid parser context previously returned from  vpJsonCtor.
+ * If invalid the application will silently exit with a \ref BAD_CONTEXT exit code.
+ * \param bBuild If true (default) the value tree is built. If false, it is not.
+ */
+void vJsonSetTreeBuilding(void* vpCtx, abool bBuild){
+    json* spJson = (json*) vpCtx;
+    if((vpCtx == NULL) || (spJson->vpValidate != s_vpJsonValid)){
+        vExContext();
+    }
+    spJson->bTree = bBuild ? APG_TRUE : APG_FALSE;
+}
+
+/** \brief Set the callback function for the beginning of each object value.
+ *
+ * \param vpCtx Pointer to a valid parser context previously returned from  vpJsonCtor.
+ * If invalid the application will silently exit with a \ref BAD_CONTEXT exit code.
+ * \param pfnCallback Pointer to the callback function. NULL to remove a previously set callback function.
+ * \param vpUserData Pointer to the user's private data, passed to the callback function. May be NULL.
+ */
+void vJsonSetObjectBeginCallback(void* vpCtx, pfnJsonContainerCallback pfnCallback, void* vpUserData){
+    json* spJson = (json*) vpCtx;
+    if((vpCtx == NULL) || (spJson->vpValidate != s_vpJsonValid)){
+        vExContext();
+    }
+    spJson->pfnObjectBegin = pfnCallback;
+    spJson->vpObjectBeginData = vpUserData;
+}
+
+/** \brief Set the callback function for the end of each object value.
+ *
+ * \param vpCtx Pointer to a valid parser context previously returned from  vpJsonCtor.
+ * If invalid the application will silently exit with a \ref BAD_CONTEXT exit code.
+ * \param pfnCallback Pointer to the callback function. NULL to remove a previously set callback function.
+ * \param vpUserData Pointer to the user's private data, passed to the callback function. May be NULL.
+ */
+void vJsonSetObjectEndCallback(void* vpCtx, pfnJsonContainerCallback pfnCallback, void* vpUserData){
+    json* spJson = (json*) vpCtx;
+    if((vpCtx == NULL) || (spJson->vpValidate != s_vpJsonValid)){
+        vExContext();
+    }
+    spJson->pfnObjectEnd = pfnCallback;
+    spJson->vpObjectEndData = vpUserData;
+}
+
+/** \brief Set the callback function for the beginning of each array value.
+ *
+ * \param vpCtx Pointer to a valid parser context previously returned from  vpJsonCtor.
+ * If invalid the application will silently exit with a \ref BAD_CONTEXT exit code.
+ * \param pfnCallback Pointer to the callback function. NULL to remove a previously set callback function.
+ * \param vpUserData Pointer to the user's private data, passed to the callback function. May be NULL.
+ */
+void vJsonSetArrayBeginCallback(void* vpCtx, pfnJsonContainerCallback pfnCallback, void* vpUserData){
+    json* spJson = (json*) vpCtx;
+    if((vpCtx == NULL) || (spJson->vpValidate != s_vpJsonValid)){
+        vExContext();
+    }
+    spJson->pfnArrayBegin = pfnCallback;
+    spJson->vpArrayBeginData = vpUserData;
+}
+
+/** \brief Set the callback function for the end of each array value.
+ *
+ * \param vpCtx Pointer to a valid parser context previously returned from  vpJsonCtor.
+ * If invalid the application will silently exit with a \ref BAD_CONTEXT exit code.
+ * \param pfnCallback Pointer to the callback function. NULL to remove a previously set callback function.
+ * \param vpUserData Pointer to the user's private data, passed to the callback function. May be NULL.
+ */
+void vJsonSetArrayEndCallback(void* vpCtx, pfnJsonContainerCallback pfnCallback, void* vpUserData){
+    json* spJson = (json*) vpCtx;
+    if((vpCtx == NULL) || (spJson->vpValidate != s_vpJsonValid)){
+        vExContext();
+    }
+    spJson->pfnArrayEnd = pfnCallback;
+    spJson->vpArrayEndData = vpUserData;
+}
+
+/** \brief Set the callback function for each object member's key.
+ *
+ * The parsing event callbacks are called in document order as the parser recognizes each value.
+ * They are called whether the value tree is being built or not. See vJsonSetTreeBuilding().
+ * Note that if the JSON text has errors, some events may be reported before the exception is thrown.
+ *
+ * \param vpCtx Pointer to a valid parser context previously returned from  vpJsonCtor.
+ * If invalid the application will silently exit with a \ref BAD_CONTEXT exit code.
+ * \param pfnCallback Pointer to the callback function. NULL to remove a previously set callback function.
+ * \param vpUserData Pointer to the user's private data, passed to the callback function. May be NULL.
+ */
+void vJsonSetKeyCallback(void* vpCtx, pfnJsonStringCallback pfnCallback, void* vpUserData){
+    json* spJson = (json*) vpCtx;
+    if((vpCtx == NULL) || (spJson->vpValidate != s_vpJsonValid)){
+        vExContext();
+    }
+    spJson->pfnKey = pfnCallback;
+    spJson->vpKeyData = vpUserData;
+}
+
+/** \brief Set the callback function for each string value.
+ *
+ * \param vpCtx Pointer to a valid parser context previously returned from  vpJsonCtor.
+ * If invalid the application will silently exit with a \ref BAD_CONTEXT exit code.
+ * \param pfnCallback Pointer to the callback function. NULL to remove a previously set callback function.
+ * \param vpUserData Pointer to the user's private data, passed to the callback function. May be NULL.
+ */
+void vJsonSetStringCallback(void* vpCtx, pfnJsonStringCallback pfnCallback, void* vpUserData){
+    json* spJson = (json*) vpCtx;
+    if((vpCtx == NULL) || (spJson->vpValidate != s_vpJsonValid)){
+        vExContext();
+    }
+    spJson->pfnString = pfnCallback;
+    spJson->vpStringData = vpUserData;
+}
+
+/** \brief Set the callback function for each number value.
+ *
+ * \param vpCtx Pointer to a valid parser context previously returned from  vpJsonCtor.
+ * If invalid the application will silently exit with a \ref BAD_CONTEXT exit code.
+ * \param pfnCallback Pointer to the callback function. NULL to remove a previously set callback function.
+ * \param vpUserData Pointer to the user's private data, passed to the callback function. May be NULL.
+ */
+void vJsonSetNumberCallback(void* vpCtx, pfnJsonNumberCallback pfnCallback, void* vpUserData){
+    json* spJson = (json*) vpCtx;
+    if((vpCtx == NULL) || (spJson->vpValidate != s_vpJsonValid)){
+        vExContext();
+    }
+    spJson->pfnNumber = pfnCallback;
+    spJson->vpNumberData = vpUserData;
+}
+
+/** \brief Set the callback function for each true, false and null value.
+ *
+ * \param vpCtx Pointer to a valid parser context previously returned from  vpJsonCtor.
+ * If invalid the application will silently exit with a \ref BAD_CONTEXT exit code.
+ * \param pfnCallback Pointer to the callback function. NULL to remove a previously set callback function.
+ * \param vpUserData Pointer to the user's private data, passed to the callback function. May be NULL.
+ */
+void vJsonSetLiteralCallback(void* vpCtx, pfnJsonLiteralCallback pfnCallback, void* vpUserData){
+    json* spJson = (json*) vpCtx;
+    if((vpCtx == NULL) || (spJson->vpValidate != s_vpJsonValid)){
+        vExContext();
+    }
+    spJson->pfnLiteral = pfnCallback;
+    spJson->vpLiteralData = vpUserData;
+}
+
 /** \brief Display the input JSON byte stream.
  *
  * This will use a [format](\ref library) object to display the JSON input byte stream in a hexdump-style format.
@@ -372,8 +555,9 @@ void vJsonDisplayInput(void *vpCtx, abool bShowLines) {
     aint uiOffset, uiChars;
     uint8_t* ucpChars = (uint8_t*) vpVecFirst(spJson->vpVecInput);
     const char* cpNextLine;
-    spLine = spLinesFirst(spJson->vpLines);
-    uiLines = uiLinesCount(spJson->vpLines);
+    void* vpLines = vpJsonLines(spJson);
+    spLine = spLinesFirst(vpLines);
+    uiLines = uiLinesCount(vpLines);
     if (!ucpChars || !spLine || !uiLines) {
         XTHROW(spJson->spException, "no JSON input");
     }
@@ -549,6 +733,120 @@ void* vpJsonChildren(void* vpCtx, json_value* spValue){
     return vpReturn;
 }
 
+/** \brief Get the 32-bit key and string of a value.
+ *
+ * For UTF-8 strings (see vJsonSetUtf8Strings()) the 32-bit key, spKey, and string value, spString,
+ * are converted from the UTF-8 strings on the first request.
+ * For values of a lazy read (see vpJsonReadFileLazy()) the key and the string or number are decoded
+ * if they have not been already. This allows values found by following the sppChildren pointers directly to be used.
+ * Otherwise, the value is returned unchanged.
+ *
+ * \param vpCtx Pointer to a valid parser context previously returned from  vpJsonCtor.
+ * If invalid the application will silently exit with a \ref BAD_CONTEXT exit code.
+ * \param spValue Pointer to the value.
+ * \return The value, spValue, with spKey and spString set.
+ */
+json_value* spJsonValueU(void* vpCtx, json_value* spValue){
+    json* spJson = (json*) vpCtx;
+    if((vpCtx == NULL) || (spJson->vpValidate != s_vpJsonValid)){
+        vExContext();
+    }
+    if (!spValue) {
+        XTHROW(spJson->spException, "value pointer cannot be NULL");
+    }
+    return spJsonUtf32Value(spJson, spValue);
+}
+
+/** \brief Get the member of an object with the specified ASCII key.
+ *
+ * A direct lookup of a single object member, without the need for an iterator.
+ * Objects with more than a few members are given a hashed index of their keys on the first lookup,
+ * or when the document is read if turned on with vJsonSetKeyIndexing().
+ * Later lookups in the same object take constant time.
+ *
+ * \param vpCtx Pointer to a valid parser context previously returned from  vpJsonCtor.
+ * If invalid the application will silently exit with a \ref BAD_CONTEXT exit code.
+ * \param spObject Pointer to the object value.
+ * \param cpKey The key as a null-terminated ASCII string.
+ * \return Pointer to the member value with the key. If the object has duplicate keys, the first.
+ * NULL if the object has no member with the key or if spObject is not an object.
+ */
+json_value* spJsonMemberA(void* vpCtx, json_value* spObject, const char* cpKey){
+    json* spJson = (json*) vpCtx;
+    if((vpCtx == NULL) || (spJson->vpValidate != s_vpJsonValid)){
+        vExContext();
+    }
+    if (!spObject || !cpKey) {
+        XTHROW(spJson->spException, "object and key pointers cannot be NULL");
+    }
+    aint uiLength = (aint)strlen(cpKey);
+    vVecClear(spJson->vpVecScratch32);
+    uint32_t* uipKey = (uint32_t*)vpVecPushn(spJson->vpVecScratch32, NULL, uiLength + 1);
+    aint ui = 0;
+    for(; ui < uiLength; ui++){
+        uipKey[ui] = (uint32_t)(uint8_t)cpKey[ui];
+    }
+    return spJsonKeyIndexFind(spJson, spObject, uipKey, uiLength);
+}
+
+/** \brief Get the member of an object with the specified 32-bit Unicode key.
+ *
+ * See spJsonMemberA() for details.
+ *
+ * \param vpCtx Pointer to a valid parser context previously returned from  vpJsonCtor.
+ * If invalid the application will silently exit with a \ref BAD_CONTEXT exit code.
+ * \param spObject Pointer to the object value.
+ * \param uipKey Pointer to the array of key string Unicode code points.
+ * \param uiLength The number of code points in the key.
+ * \return Pointer to the member value with the key. If the object has duplicate keys, the first.
+ * NULL if the object has no member with the key or if spObject is not an object.
+ */
+json_value* spJsonMemberU(void* vpCtx, json_value* spObject, const uint32_t* uipKey, aint uiLength){
+    json* spJson = (json*) vpCtx;
+    if((vpCtx == NULL) || (spJson->vpValidate != s_vpJsonValid)){
+        vExContext();
+    }
+    if (!spObject || (!uipKey && uiLength)) {
+        XTHROW(spJson->spException, "object and key pointers cannot be NULL");
+    }
+    return spJsonKeyIndexFind(spJson, spObject, uipKey, uiLength);
+}
+
+/** \brief Build the key indexes of all objects as each document is read.
+ *
+ * By default, an object's hashed key index is built on the first lookup of one of its members
+ * with spJsonMemberA() or spJsonMemberU(). Building them all as the document is read
+ * adds to the read time but makes the time of every lookup predictable.
+ * For the lazy readers, building the indexes decodes the keys, strings and numbers of all object members.
+ *
+ * \param vpCtx Pointer to a valid parser context previously returned from  vpJsonCtor.
+ * If invalid the application will silently exit with a \ref BAD_CONTEXT exit code.
+ * \param bAll If true, build the indexes of all objects as the document is read.
+ * If false (default), build each object's index on the first lookup.
+ */
+void vJsonSetKeyIndexing(void* vpCtx, abool bAll){
+    json* spJson = (json*) vpCtx;
+    if((vpCtx == NULL) || (spJson->vpValidate != s_vpJsonValid)){
+        vExContext();
+    }
+    spJson->bKeyIndexAll = bAll;
+}
+
+/** \brief Private function for internal object use only. Never called by the application.
+ *
+ * The lines object is only needed for displaying the input and for locating errors.
+ * It is constructed here, on first demand, rather than for every parsed document.
+ * \param spJson Pointer to the JSON object context.
+ * \return Pointer to the lines object for the current input. NULL if there is no input.
+ */
+void* vpJsonLines(json* spJson){
+    if(!spJson->vpLines && uiVecLen(spJson->vpVecInput)){
+        spJson->vpLines = vpLinesCtor(spJson->spException, (char*) vpVecFirst(spJson->vpVecInput),
+                uiVecLen(spJson->vpVecInput));
+    }
+    return spJson->vpLines;
+}
+
 /** \brief Private function for internal object use only. Never called by the application.
  *
  * JSON iterators are constructed internally by the JSON object.
@@ -616,7 +914,7 @@ json_value* spJsonIteratorFirst(void* vpIteratorCtx){
         vExContext();
     }
     spIt->uiCurrent = 0;
-    return *spIt->sppValues;
+    return spJsonLazyValue(spIt->spJson, *spIt->sppValues);
 }
 /** \brief Find the last value in the list represented by this iterator.
  *
@@ -634,7 +932,7 @@ json_value* spJsonIteratorLast(void* vpIteratorCtx){
         spIt->uiCurrent = spIt->uiCount - 1;
         spReturn = spIt->sppValues[spIt->uiCurrent];
     }
-    return spReturn;
+    return spJsonLazyValue(spIt->spJson, spReturn);
 }
 /** \brief Find the next value in the list represented by this iterator.
  *
@@ -658,7 +956,7 @@ json_value* spJsonIteratorNext(void* vpIteratorCtx){
             }
         }
     }
-    return spReturn;
+    return spJsonLazyValue(spIt->spJson, spReturn);
 }
 /** \brief Find the prev value in the list represented by this iterator.
  *
@@ -680,7 +978,7 @@ json_value* spJsonIteratorPrev(void* vpIteratorCtx){
             spReturn = spIt->sppValues[spIt->uiCurrent];
         }
     }
-    return spReturn;
+    return spJsonLazyValue(spIt->spJson, spReturn);
 }
 /** \brief Find the number of values in the list represented by this iterator.
  *
@@ -700,11 +998,11 @@ aint uiJsonIteratorCount(void* vpIteratorCtx){
  * \brief Parse the JSON-text byte stream into a tree of json_value nodes.
  *
  * The parser is built for reuse without memory leaks. All previously parsed values and related data, if any, are released
- * and re-initialized. An APG parser for the JSON SABNF grammar is constructed and used to parse
- * the JSON byte stream into an array of values.
+ * and re-initialized. The APG parser for the JSON SABNF grammar is constructed, and its callback functions set,
+ * only on the first call. It is then kept alive and reused for every subsequent document.
+ * If sizeof(achar) is 1 the UTF-8 byte stream is handed to the parser as is. Otherwise, it is first converted to achar units.
  *
- * \param vpCtx pointer to the parser's context - previously returned from  vpJsonCtor.
- * \param cpTraceOut - A file name for the output of the parser's trace. If NULL, no trace is done.
+ * \param spJson Pointer to the JSON object context.
  * \return void - throws exception on error
  */
 static void vParseInput(json* spJson) {
@@ -715,50 +1013,37 @@ static void vParseInput(json* spJson) {
     uint8_t* ucpChars;
 
     // clear previous parsing data, if any
+    vJsonLazyClear(spJson);
+    vJsonKeyIndexClear(spJson);
+    spJson->bUtf8Tree = spJson->bUtf8;
     spJson->spCurrentFrame = NULL;
     spJson->uiValueCount = 0;
     spJson->uiStringCount = 0;
     spJson->uiChar = 0;
-    spJson->bHasFrac = APG_FALSE;
-    spJson->bHasMinus = APG_FALSE;
-    if(spJson->vpParser){
-        vParserDtor(spJson->vpParser);
-        spJson->vpParser = NULL;
-    }
-    if(spJson->acpInput){
-        vMemFree(spJson->vpMem, spJson->acpInput);
-        spJson->acpInput = NULL;
-    }
     ucpChars = (uint8_t*) vpVecFirst(spJson->vpVecInput);
     uiCharCount = uiVecLen(spJson->vpVecInput);
     if (!uiCharCount) {
         XTHROW(spJson->spException, "JSON text is empty");
     }
-    // construct the parser
-    if(spJson->vpParser){
-        vParserDtor(spJson->vpParser);
-    }
-    spJson->vpParser = vpParserCtor(spJson->spException, vpJsonGrammarInit);
-//    if (spJson->cpTraceOut) {
-//        // attach the trace - no trace if NULL
-//        void* vpTrace = vpTraceCtor(spJson->vpParser);
-//        if(spJson->cpTraceOut[0] != 0){
-//            // use the specified file name
-//            vTraceSetOutput(vpTrace, spJson->cpTraceOut);
-//        }
-//    }
-
-    // set the rule callback functions
-    vJsonGrammarRuleCallbacks(spJson->vpParser);
+    if(!spJson->vpParser){
+        // construct the parser and set the rule callback functions, once only
+        spJson->vpParser = vpParserCtor(spJson->spException, vpJsonGrammarInit);
+        vJsonGrammarRuleCallbacks(spJson->vpParser);
+    }
 
     // configure the parser
-    spJson->acpInput = (achar*) vpMemAlloc(spJson->vpMem, ((aint) sizeof(achar) * uiCharCount));
-    for (ui = 0; ui < uiCharCount; ui++) {
-        // NOTE: since the input is a byte stream and sizeof(achar) >= 1 always, no data truncation is possible here
-        spJson->acpInput[ui] = (achar) ucpChars[ui];
-    }
     memset((void*) &sInput, 0, sizeof(sInput));
-    sInput.acpInput = spJson->acpInput;
+    if(sizeof(achar) == sizeof(uint8_t)){
+        sInput.acpInput = (const achar*)ucpChars;
+    }else{
+        vVecClear(spJson->vpVecAchars);
+        achar* acpInput = (achar*) vpVecPushn(spJson->vpVecAchars, NULL, uiCharCount);
+        for (ui = 0; ui < uiCharCount; ui++) {
+            // NOTE: since the input is a byte stream and sizeof(achar) >= 1 always, no data truncation is possible here
+            acpInput[ui] = (achar) ucpChars[ui];
+        }
+        sInput.acpInput = acpInput;
+    }
     sInput.uiInputLength = uiCharCount;
     sInput.uiStartRule = 0;
     sInput.vpUserData = (void*) spJson;
@@ -771,29 +1056,120 @@ static void vParseInput(json* spJson) {
         vUtilPrintParserState(&sState);
         XTHROW(spJson->spException, "JSON parser failed");
     }
-    vParserDtor(spJson->vpParser); // destroys vpTrace, if not NULL
-    spJson->vpParser = NULL;
-    vMemFree(spJson->vpMem, spJson->acpInput);
-    spJson->acpInput = NULL;
+    if(spJson->bKeyIndexAll){
+        vJsonKeyIndexAll(spJson);
+    }
+}
+
+/** \brief Read one JSON Lines record. For internal use by the JSON Lines reader.
+ *
+ * The same as vpJsonReadArray() or vpJsonReadArrayLazy(), but without constructing an iterator.
+ * \param spJson Pointer to the JSON object context.
+ * \param ucpData Pointer to the UTF-8 encoded record.
+ * \param uiDataLen The number of bytes in the record.
+ * \param bLazy True to read the record with the lazy reader, false with the grammar parser.
+ * \return Pointer to the root value of the record.
+ */
+json_value* spJsonReadRecord(json* spJson, const uint8_t* ucpData, aint uiDataLen, abool bLazy){
+    vReadArray(spJson, (uint8_t*)ucpData, uiDataLen);
+    if(bLazy){
+        vJsonLazyParse(spJson);
+    }else{
+        vParseInput(spJson);
+    }
+    return spJsonLazyValue(spJson, spJson->spValues);
+}
+
+/** \brief Read a file into the JSON object's input vector without parsing it. For internal use by the JSON Lines reader.
+ * \param spJson Pointer to the JSON object context.
+ * \param cpFileName The name of the file to read.
+ */
+void vJsonReadFileInput(json* spJson, const char* cpFileName){
+    vReadFile(spJson, cpFileName);
 }
 
 // static functions
-static abool bKeyComp(u32_phrase* spKey, const uint32_t *uipKey, uint32_t uiLength){
-    abool bReturn = APG_FALSE;
-    if(spKey->uiLength == uiLength){
-        uint32_t ui = 0;
-        for(; ui < uiLength; ui++){
-            if(spKey->uipPhrase[ui] != uipKey[ui]){
-                goto fail;
-            }
+static void vReadFile(json* spJson, const char* cpFileName){
+    char caBuf[PATH_MAX + 128];
+    size_t uiSize = PATH_MAX + 128;
+    uint8_t ucaBom[3];
+    int iaBom[3];
+    vVecClear(spJson->vpVecInput);
+    vLinesDtor(spJson->vpLines);
+    spJson->vpLines = NULL;
+    if(spJson->spIn){
+        fclose(spJson->spIn);
+        spJson->spIn = NULL;
+    }
+    if(!cpFileName || !cpFileName[0]){
+        XTHROW(spJson->spException, "file name cannot be NULL or empty");
+
+    }
+    spJson->spIn = fopen(cpFileName, "rb");
+    if (!spJson->spIn) {
+        snprintf(caBuf, uiSize, "can't open input file: %s", cpFileName);
+        XTHROW(spJson->spException, caBuf);
+    }
+    // get the first 3 bytes and test for BOM
+    iaBom[0] = fgetc(spJson->spIn);
+    iaBom[1] = fgetc(spJson->spIn);
+    iaBom[2] = fgetc(spJson->spIn);
+    ucaBom[0] = (uint8_t) iaBom[0];
+    ucaBom[1] = (uint8_t) iaBom[1];
+    ucaBom[2] = (uint8_t) iaBom[2];
+    if (iaBom[0] == EOF) {
+        snprintf(caBuf, uiSize, "input file is empty: %s", cpFileName);
+        XTHROW(spJson->spException, caBuf);
+    }
+    if (iaBom[1] == EOF) {
+        // only one character - push and continue
+        vpVecPush(spJson->vpVecInput, &ucaBom[0]);
+    }else if (iaBom[2] == EOF) {
+        // only two characters - push and continue
+        vpVecPushn(spJson->vpVecInput, &ucaBom[0], 2);
+    }else{
+        if (!(ucaBom[0] == 0xEF && ucaBom[1] == 0xBB && ucaBom[2] == 0xBF)) {
+            // no BOM - save the first three characters and continue
+            vpVecPushn(spJson->vpVecInput, &ucaBom[0], 3);
+        }
+        uint8_t ucGotBuf[1024];
+        size_t uiGot = fread(ucGotBuf, 1, 1024, spJson->spIn);
+        while (uiGot != 0) {
+            vpVecPushn(spJson->vpVecInput, ucGotBuf, (aint)uiGot);
+            uiGot = fread(ucGotBuf, 1, 1024, spJson->spIn);
         }
-        bReturn = APG_TRUE;
     }
-    fail:;
-    return bReturn;
+    fclose(spJson->spIn);
+    spJson->spIn = NULL;
+}
+static void vReadArray(json* spJson, uint8_t* ucpData, aint uiDataLen){
+    vVecClear(spJson->vpVecInput);
+    vLinesDtor(spJson->vpLines);
+    spJson->vpLines = NULL;
+    // check for BOM
+    if (uiDataLen >= 3) {
+        if (ucpData[0] == 0xEF && ucpData[1] == 0xBB && ucpData[2] == 0xBF) {
+            ucpData += 3;
+            uiDataLen -= 3;
+        }
+    }
+    if(uiDataLen){
+        vpVecPushn(spJson->vpVecInput, ucpData, uiDataLen);
+    }
+}
+static void* vpValueIterator(json* spJson){
+    json_iterator* spIt = spJsonIteratorCtor(spJson);
+    json_value** sppValues = (json_value**)vpVecPushn(spIt->vpVec, NULL, spJson->uiValueCount);
+    aint ui = 0;
+    for(; ui < spJson->uiValueCount; ui++){
+        sppValues[ui] = &spJson->spValues[ui];
+    }
+    spIt->sppValues = sppValues;
+    spIt->uiCount = spJson->uiValueCount;
+    return (void*)spIt;
 }
 static void vFindKeyValues(json* spJson, json_iterator* spIt, const uint32_t *uipKey, uint32_t uiLength, json_value* spValue){
-    if(spValue->spKey && bKeyComp(spValue->spKey, uipKey, uiLength)){
+    if(bJsonKeyComp(spJson, spValue, uipKey, uiLength)){
         vpVecPush(spIt->vpVec, &spValue);
     }
     if ((spValue->uiId == JSON_ID_OBJECT) || (spValue->uiId == JSON_ID_ARRAY)) {
@@ -824,6 +1200,7 @@ static void vReintrantValueDisplay(json *spJson, struct json_value_tag *spValue)
     aint ui;
     const char* cpNextLine;
     char* cpStr;
+    spJsonUtf32Value(spJson, spValue);
     if (spValue->spKey) {
         vIndent(uiIndent);
         if (bIsPhrase32Ascii(spValue->spKey)) {
@@ -1006,6 +1383,7 @@ static void vPushNumber(json* spJson, json_number* spNumber) {
 }
 
 static void vPushValue(json* spJson, json_value* spValue) {
+    spJsonUtf32Value(spJson, spValue);
     if(spJson->bFirstNode){
         spJson->bFirstNode = APG_FALSE;
     }else{
@@ -57,6 +57,8 @@
 /** @name Number Type Identifiers
  *  APG specifies numbers as one of three types &ndash; floating point, unsigned integer and signed integer.
  *  These identifiers are used to indicate which.
+ *  Numbers with a fraction or an exponent, or both, are floating point.
+ *  Otherwise, numbers with a minus sign are signed integers and numbers without are unsigned integers.
  */
 ///@{
 #define JSON_ID_FLOAT           19 ///< \brief Number value is a double floating point number
@@ -105,7 +107,9 @@ typedef struct json_value_tag {
      - JSON_ID_TRUE
      - JSON_ID_FALSE
      - JSON_ID_NULL, */
-    u32_phrase* spKey; /**< \brief Points to the associated key string if this is a member of a JSON object. Otherwise, NULL. */
+    u32_phrase* spKey; /**< \brief Points to the associated key string if this is a member of a JSON object. Otherwise, NULL.
+    For UTF-8 strings (see vJsonSetUtf8Strings()) NULL until requested with spJsonValueU(). */
+    u8_phrase* spKey8; /**< \brief For UTF-8 strings only, points to the UTF-8 key string if this is a member of a JSON object. Otherwise, NULL. */
     union{
         u32_phrase* spString; ///< \brief Pointer to the string value if uiId = JSON_ID_STRING
         json_number* spNumber; ///< \brief Pointer to the number value if uiId = JSON_ID_NUMBER
@@ -115,8 +119,81 @@ typedef struct json_value_tag {
             aint uiChildCount; /**< \brief The number of child values if uiId is JSON_ID_OBJECT or JSON_ID_ARRAY. */
         };
     };
+    u8_phrase* spString8; ///< \brief For UTF-8 strings only, pointer to the UTF-8 string value if uiId = JSON_ID_STRING. Otherwise, NULL.
 } json_value;
 
+/** \typedef pfnJsonContainerCallback
+ * \brief Defines the function type that is called at the beginning and end of an object or array value.
+ *
+ * \param uiDepth The tree depth of the object or array value. The root value is at depth zero.
+ * \param uiCount For the end of an object or array, the number of members or values it contained.
+ * Always zero for the beginning of an object or array.
+ * \param vpUserData The user's private data, or NULL if none.
+ * This private data pointer is set in the functions \ref vJsonSetObjectBeginCallback(), etc.
+ */
+typedef void (*pfnJsonContainerCallback)(aint uiDepth, aint uiCount, void* vpUserData);
+
+/** \typedef pfnJsonStringCallback
+ * \brief Defines the function type that is called for an object member's key and for a string value.
+ *
+ * Note that the string is valid only for the duration of the called function.
+ * Applications must copy data to their own storage space if needed beyond the scope of this function call.
+ * \param spString The key or string value as an array of 32-bit Unicode code points.
+ * \param uiDepth The tree depth of the string value or, for a key, of the member value that it names.
+ * \param vpUserData The user's private data, or NULL if none.
+ * This private data pointer is set in the functions \ref vJsonSetKeyCallback() and \ref vJsonSetStringCallback().
+ */
+typedef void (*pfnJsonStringCallback)(u32_phrase* spString, aint uiDepth, void* vpUserData);
+
+/** \typedef pfnJsonNumberCallback
+ * \brief Defines the function type that is called for a number value.
+ *
+ * Note that the number is valid only for the duration of the called function.
+ * \param spNumber The number value.
+ * \param uiDepth The tree depth of the number value.
+ * \param vpUserData The user's private data, or NULL if none.
+ * This private data pointer is set in the function \ref vJsonSetNumberCallback().
+ */
+typedef void (*pfnJsonNumberCallback)(json_number* spNumber, aint uiDepth, void* vpUserData);
+
+/** \typedef pfnJsonLiteralCallback
+ * \brief Defines the function type that is called for a true, false or null value.
+ *
+ * \param uiId The literal value identifier, JSON_ID_TRUE, JSON_ID_FALSE or JSON_ID_NULL.
+ * \param uiDepth The tree depth of the literal value.
+ * \param vpUserData The user's private data, or NULL if none.
+ * This private data pointer is set in the function \ref vJsonSetLiteralCallback().
+ */
+typedef void (*pfnJsonLiteralCallback)(aint uiId, aint uiDepth, void* vpUserData);
+
+/** @name JSON Lines Flags
+ * Flags for the JSON Lines readers, luiJsonLinesBuffer() and luiJsonLinesFile(). They may be or'ed together.
+ */
+///@{
+#define JSON_LINES_ORDERED      1 ///< \brief The records are reported in input order, all on the calling thread.
+#define JSON_LINES_LAZY         2 ///< \brief The records are read with the lazy reader, as with vpJsonReadArrayLazy().
+///@}
+
+/** \def JSON_LINES_MAX_THREADS
+ * \brief The maximum number of threads the JSON Lines readers will use.
+ */
+#define JSON_LINES_MAX_THREADS 64
+
+/** \typedef pfnJsonLineCallback
+ * \brief Defines the function type that is called for each record read by the JSON Lines readers.
+ *
+ * The record's value tree belongs to a JSON object of the reader's own. It may be read with any of the
+ * JSON object functions, iterators, spJsonMemberA(), etc., using `vpJsonCtx`. Iterators made here should be destroyed here.
+ * The tree and the object are valid only for the duration of the called function.
+ * Applications must copy data to their own storage space if needed beyond the scope of this function call.
+ * \param vpJsonCtx Pointer to the JSON object that read the record.
+ * \param spRoot The root value of the record.
+ * \param luiOffset The offset in the input to the first byte of the record's line.
+ * \param vpUserData The user's private data, or NULL if none.
+ * \return True to continue reading records, false to stop.
+ */
+typedef abool (*pfnJsonLineCallback)(void* vpJsonCtx, json_value* spRoot, luint luiOffset, void* vpUserData);
+
 // constructor/destructor
 /** @name Construction and Destruction*/
 ///@{
@@ -133,7 +210,38 @@ abool bJsonValidate(void* vpCtx);
 ///@{
 void* vpJsonReadFile(void *vpCtx, const char *cpFileName);
 void* vpJsonReadArray(void *vpCtx, uint8_t *ucpData, aint uiDataLen);
+void* vpJsonReadFileLazy(void *vpCtx, const char *cpFileName);
+void* vpJsonReadArrayLazy(void *vpCtx, uint8_t *ucpData, aint uiDataLen);
+void vJsonSetUtf8Strings(void* vpCtx, abool bUtf8);
 uint8_t* ucpJsonWrite(void* vpCtx, json_value* spValue, aint* uipCount);
+uint8_t* ucpJsonWriteUtf8(void* vpCtx, json_value* spValue, aint uiIndent, aint* uipCount);
+void vJsonWriteStream(void* vpCtx, json_value* spValue, aint uiIndent, FILE* spOut);
+///@}
+
+/** @name JSON Lines
+ * Reads newline-delimited JSON, one document per line, on a pool of worker threads.
+ * */
+///@{
+luint luiJsonLinesBuffer(void* vpCtx, const uint8_t* ucpBuffer, luint luiLength, aint uiThreads, aint uiFlags,
+        pfnJsonLineCallback pfnRecord, void* vpUserData);
+luint luiJsonLinesFile(void* vpCtx, const char* cpFileName, aint uiThreads, aint uiFlags,
+        pfnJsonLineCallback pfnRecord, void* vpUserData);
+///@}
+
+/** @name Parsing Events
+ * Callback functions called by the parser as each value is recognized, in document order.
+ * Optionally, the value tree need not be built at all.
+ * */
+///@{
+void vJsonSetTreeBuilding(void* vpCtx, abool bBuild);
+void vJsonSetObjectBeginCallback(void* vpCtx, pfnJsonContainerCallback pfnCallback, void* vpUserData);
+void vJsonSetObjectEndCallback(void* vpCtx, pfnJsonContainerCallback pfnCallback, void* vpUserData);
+void vJsonSetArrayBeginCallback(void* vpCtx, pfnJsonContainerCallback pfnCallback, void* vpUserData);
+void vJsonSetArrayEndCallback(void* vpCtx, pfnJsonContainerCallback pfnCallback, void* vpUserData);
+void vJsonSetKeyCallback(void* vpCtx, pfnJsonStringCallback pfnCallback, void* vpUserData);
+void vJsonSetStringCallback(void* vpCtx, pfnJsonStringCallback pfnCallback, void* vpUserData);
+void vJsonSetNumberCallback(void* vpCtx, pfnJsonNumberCallback pfnCallback, void* vpUserData);
+void vJsonSetLiteralCallback(void* vpCtx, pfnJsonLiteralCallback pfnCallback, void* vpUserData);
 ///@}
 
 /** @name Accessing JSON Tree Nodes
@@ -144,6 +252,10 @@ void* vpJsonFindKeyA(void *vpCtx, const char *cpKey, json_value* spValue);
 void* vpJsonFindKeyU(void *vpCtx, const uint32_t *uipKey, aint uiLength, json_value* spValue);
 void* vpJsonTree(void* vpCtx, json_value* spValue);
 void* vpJsonChildren(void* vpCtx, json_value* spValue);
+json_value* spJsonValueU(void* vpCtx, json_value* spValue);
+json_value* spJsonMemberA(void* vpCtx, json_value* spObject, const char* cpKey);
+json_value* spJsonMemberU(void* vpCtx, json_value* spObject, const uint32_t* uipKey, aint uiLength);
+void vJsonSetKeyIndexing(void* vpCtx, abool bAll);
 ///@}
 
 /** @name Value Iterators
@@ -280,6 +392,57 @@ The parser will return an iterator which will walk the tree from value to value
 [depth-first](https://en.wikipedia.org/wiki/Tree_traversal#Depth-first_search_of_binary_tree) fashion.
 Additionally, iterators can be generated which will walk any value node as the root of a sub-tree,
 or walk horizontally across all siblings of an object or array parent value node.
+
+### Parsing Events
+For large documents where only a few fields are of interest, the application can instead, or additionally,
+receive the values as the parser recognizes them, in document order. Callback functions can be set for
+the beginning and end of objects and arrays, for member keys and for string, number and literal values.
+See, for example, vJsonSetKeyCallback().
+If the value tree is not needed, vJsonSetTreeBuilding() will turn its construction off.
+Then, apart from the input itself, the memory used while parsing depends only on the tree depth
+and the longest string, not on the size of the document.
+
+### Lazy Reading
+For very large documents of which only a fraction of the values will be read,
+vpJsonReadFileLazy() and vpJsonReadArrayLazy() build the value tree without the grammar parser.
+The tree structure is found with a fast scan for structural characters and the keys, strings and numbers
+are decoded only as the iterators return them. The lazy readers check the document structure but are not validating.
+
+### UTF-8 Strings
+By default, keys and string values are decoded to arrays of 32-bit Unicode code points, four bytes for every character.
+With vJsonSetUtf8Strings() they are instead UTF-8 byte strings, spKey8 and spString8 in \ref json_value_tag.
+Strings without escaped characters point directly into the copy of the input held by the JSON object.
+Only strings with escaped characters are decoded to separate storage.
+The 32-bit strings, spKey and spString, are produced only on request with spJsonValueU().
+
+### Object Members
+vpJsonFindKeyA() and vpJsonFindKeyU() search a whole sub-tree and return an iterator over all values with the key.
+To get a single member of a known object, spJsonMemberA() and spJsonMemberU() return the member value directly.
+Objects with more than a few members are given a hashed index of their keys on the first lookup,
+so that repeated lookups in large objects take constant time.
+vJsonSetKeyIndexing() will build the indexes of all objects as each document is read.
+
+### JSON Lines
+Newline-delimited JSON (NDJSON, JSON Lines) files hold one complete document on each line.
+luiJsonLinesFile() maps the file into memory and luiJsonLinesBuffer() reads a buffer already in memory.
+The input is divided into chunks at line boundaries and the chunks are shared among a pool of worker threads,
+each with JSON objects of its own. The root value of each record is passed to a callback function,
+either as soon as it has been read or, with \ref JSON_LINES_ORDERED, in input order on the calling thread.
+
+### Numbers
+Numbers are converted as soon as they are recognized, by the grammar parser, or when first accessed, by the lazy readers.
+The grammar's number rule is matched and converted in a single pass by its callback function,
+rather than character by character by its component rules.
+The digits are converted eight at a time and most floating point numbers are converted exactly
+without the C library, with Clinger's fast path or the Eisel-Lemire algorithm.
+Only numbers with more than 19 significant digits and a few rare cases fall back to `strtod()`.
+
+### Fast Writing
+ucpJsonWriteUtf8() and vJsonWriteStream() write a value tree directly as UTF-8 bytes,
+to a growable buffer or to an open file, with no intermediate array of 32-bit code points.
+UTF-8 strings are copied as they are, with only the characters that must be escaped found eight bytes at a time.
+Floating point numbers are written with the fewest digits that read back to the same double.
+The output may be compact, with no white space, or indented by any number of spaces per level.
 <br>
 <br>
 <br>
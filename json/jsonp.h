@@ -55,6 +55,9 @@
 typedef struct {
     aint uiCharsOffset; ///< The offset from the vector base of 32-bit character codes to the first character in the string.
     aint uiLength; ///< The number of characters in the string.
+    aint uiUtf8Offset; ///< For UTF-8 strings, the offset to the first byte in the input or, if bInput is false, in the vector of decoded UTF-8 bytes.
+    aint uiUtf8Length; ///< For UTF-8 strings, the number of bytes in the string.
+    abool bInput; ///< For UTF-8 strings, true if the string has no escaped characters and is taken directly from the input.
 } string_r;
 
 /** \struct value_r
@@ -86,9 +89,58 @@ typedef struct {
     aint uiNextKey; ///< Used to keep track of the next available key offset to be used by an object member.
     aint uiValue; /**< \brief Index to the value represented by this frame. */
     aint uiString; /**< \brief Offset to the string or key string for this value. */
+    aint uiChildCount; /**< \brief The number of child values of an object or array found so far. */
     void* vpVecIndexes; /** \brief A vector of child value indexes for objects and arrays. */
 } frame;
 
+/** \struct lazy_value
+ * \brief The location in the input of a value read with the structural index and its decoded data, if any.
+ *
+ * There is one of these for each value of the tree, in the same depth-first order.
+ */
+typedef struct {
+    aint uiOffset; ///< \brief The offset in the input to the first character of the value.
+    aint uiKeyOffset; ///< \brief The offset in the input to the opening quote of the value's key. APG_UNDEFINED if the value is not an object member.
+    aint uiNext; ///< \brief The index of the first value following this value's sub-tree.
+    abool bDecoded; ///< \brief True if the key and string or number have been decoded.
+    u32_phrase sKey; ///< \brief The decoded key.
+    u8_phrase sKey8; ///< \brief The decoded UTF-8 key, for UTF-8 strings.
+    union{
+        struct{
+            u32_phrase sString; ///< \brief The decoded string if JSON_ID_STRING.
+            u8_phrase sString8; ///< \brief The decoded UTF-8 string if JSON_ID_STRING, for UTF-8 strings.
+        };
+        json_number sNumber; ///< \brief The decoded number if JSON_ID_NUMBER.
+    }; ///< \brief Space-saving union &ndash; only one of this is needed at a time, depending on the id.
+} lazy_value;
+
+/** \struct lazy_frame
+ * \brief The object or array being read in the structural index's second pass.
+ */
+typedef struct {
+    aint uiValue; ///< \brief The index of the object or array value.
+    aint uiCount; ///< \brief The number of members or values found so far.
+    abool bObject; ///< \brief True for an object, false for an array.
+} lazy_frame;
+
+/** \struct key_index
+ * \brief The location of an object's hash table of member keys.
+ *
+ * There is one of these for each value of the tree. Only objects with enough members have a table.
+ */
+typedef struct {
+    aint uiOffset; ///< \brief The offset to the first slot of the table in the vector of slots.
+    aint uiSize; ///< \brief The number of slots in the table, a power of two. Zero if the table has not been built.
+} key_index;
+
+/** \struct key_slot
+ * \brief A single slot of an object's hash table of member keys.
+ */
+typedef struct {
+    aint uiMember; ///< \brief One plus the index of the member in the object's list of children. Zero if the slot is empty.
+    uint32_t uiHash; ///< \brief The hash of the member's key.
+} key_slot;
+
 /** \struct json
  * \brief The object context. For intenrnal use only.
  */
@@ -116,9 +168,13 @@ typedef struct {
     void* vpVecStrings; ///< \brief A vector of Unicode strings.
     u32_phrase* spStrings; /**< \brief An array of absolute strings. */
     aint uiStringCount; /**< \brief The number of strings in the array. */
+    void* vpVecUtf8; ///< \brief For UTF-8 strings, the decoded bytes of all strings with escaped characters.
+    void* vpVecStrings8; ///< \brief For UTF-8 strings, a vector of UTF-8 strings.
+    u8_phrase* spStrings8; /**< \brief For UTF-8 strings, an array of absolute UTF-8 strings, parallel to spStrings. */
     void* vpVecNumbers; /** \brief A vector of number objects. */
     void* vpVecChildIndexes; /**< \brief A single vector of relative child indexes to values. */
     void* vpVecFrames; /**< \brief Frame stack of values to keep track of the current value in the parse tree. */
+    void* vpVecFrameIndexes; /**< \brief Child index vectors, one per frame stack depth, reused from value to value and parse to parse. */
     void* vpVecChildPointers; //< \brief A vector of pointers to object and array children.
     struct json_value_tag** sppChildPointers; /**< \brief An array of absolute child value pointers. */
 
@@ -126,8 +182,46 @@ typedef struct {
     frame* spCurrentFrame; /**< \brief Points to the current stack frame. */
     uint32_t uiChar; /**< \brief A working value to hold the value of a single character.
                             Higher level rules will move it to vpVecChars. Gets overwritten by each Char rule. */
-    abool bHasFrac; /**< \brief A working value signaling presence of fractional value for a number value. */
-    abool bHasMinus; /**< \brief A working value signaling a minus sign for a number value. */
+    abool bKey; /**< \brief A working value signaling that the string being parsed is a member key. */
+    abool bTree; /**< \brief If true (default) the value tree is built. If false, values are only reported to the event callbacks. */
+    abool bUtf8; /**< \brief If true, keys and strings of the next value tree read are UTF-8. If false (default), 32-bit code points. */
+    abool bUtf8Tree; /**< \brief True if the keys and strings of the current value tree are UTF-8. */
+
+    // event callbacks
+    pfnJsonContainerCallback pfnObjectBegin; ///< \brief Pointer to the user's callback function for the beginning of an object.
+    void* vpObjectBeginData; ///< \brief An opaque pointer available for user's use.
+    pfnJsonContainerCallback pfnObjectEnd; ///< \brief Pointer to the user's callback function for the end of an object.
+    void* vpObjectEndData; ///< \brief An opaque pointer available for user's use.
+    pfnJsonContainerCallback pfnArrayBegin; ///< \brief Pointer to the user's callback function for the beginning of an array.
+    void* vpArrayBeginData; ///< \brief An opaque pointer available for user's use.
+    pfnJsonContainerCallback pfnArrayEnd; ///< \brief Pointer to the user's callback function for the end of an array.
+    void* vpArrayEndData; ///< \brief An opaque pointer available for user's use.
+    pfnJsonStringCallback pfnKey; ///< \brief Pointer to the user's callback function for object member keys.
+    void* vpKeyData; ///< \brief An opaque pointer available for user's use.
+    pfnJsonStringCallback pfnString; ///< \brief Pointer to the user's callback function for string values.
+    void* vpStringData; ///< \brief An opaque pointer available for user's use.
+    pfnJsonNumberCallback pfnNumber; ///< \brief Pointer to the user's callback function for number values.
+    void* vpNumberData; ///< \brief An opaque pointer available for user's use.
+    pfnJsonLiteralCallback pfnLiteral; ///< \brief Pointer to the user's callback function for true, false and null values.
+    void* vpLiteralData; ///< \brief An opaque pointer available for user's use.
+
+    // the lazy, structural index reader
+    abool bLazy; ///< \brief True if the current value tree was read with the structural index and its values are decoded on demand.
+    void* vpVecStructural; ///< \brief The structural index. Offsets of all brackets, colons, commas and string, number and literal beginnings.
+    void* vpVecLazy; ///< \brief A vector of lazy_value, one for each value.
+    void* vpVecLazyFrames; ///< \brief The stack of objects and arrays being read.
+    void* vpVecArena; ///< \brief The list of blocks of storage for decoded strings. Used by both readers, released for each new document.
+    uint32_t* uipArenaNext; ///< \brief The next free code point in the current block.
+    aint uiArenaFree; ///< \brief The number of free code points remaining in the current block.
+
+    // hashed key indexes for direct member lookup
+    abool bKeyIndexAll; ///< \brief If true, the key indexes of all objects are built as each document is read.
+    void* vpVecKeyIndex; ///< \brief A vector of key_index, one for each value, once any member has been looked up.
+    void* vpVecKeySlots; ///< \brief A vector of key_slot, the hash tables of all indexed objects.
+
+    // the JSON Lines file reader
+    void* vpLinesMap; ///< \brief The memory-mapped JSON Lines file, if any. Maintained here so that it can be unmapped in the destructor if necessary.
+    luint luiLinesMapLength; ///< \brief The length of the mapped file.
 
     // pointer lists for returning values to user
     void* vpVecTreeList; ///< \brief Vector of pointers to sub_tree tree. Value pointers are in the order of a depth-first traversal.
@@ -141,10 +235,11 @@ typedef struct {
     // display and writer helpers
     FILE* spIn; /**< \brief File I/O handle for the input file.
     Maintained here so that it can be closed in the destructor if necessary */
-    void* vpParser; ///< \brief Pointer to the parser context if exception thrown during parsing.
-    achar* acpInput; ///< \brief Buffer to hold the input converted from uint8_t to achar units.
+    void* vpParser; ///< \brief Pointer to the JSON grammar parser context, constructed on the first parse and reused thereafter.
+    void* vpVecAchars; ///< \brief Vector to hold the input converted from uint8_t to achar units, if sizeof(achar) > 1.
     void* vpFmt; ///< \brief Pointer to a hexdump-style formatter object.
     void* vpVecOutput; ///< \brief Vector of 32-bit code points for generating output of value tree to JSON-text.
+    void* vpVecWrite8; ///< \brief Vector of UTF-8 bytes for the direct output of value tree to JSON-text.
     void* vpConv; ///< \brief Context pointer for a conversion object.
     abool bFirstNode; ///< \brief Set to true before each call to sJsonWrite() to prevent writing a key for the first node of a sub-tree.
     aint uiCurrentDepth; ///< \brief Used to keep track of the current tree depth for display of the tree of values.
@@ -168,7 +263,21 @@ typedef struct{
  * Private but required across source files.*/
 ///@{
 void vJsonGrammarRuleCallbacks(void* vpParserCtx);
+void* vpJsonLines(json* spJson);
+void vJsonLazyParse(json* spJson);
+void vJsonLazyClear(json* spJson);
+json_value* spJsonLazyValue(json* spJson, json_value* spValue);
+abool bJsonLazyKeyComp(json* spJson, json_value* spValue, const uint32_t* uipKey, aint uiLength);
+json_value* spJsonUtf32Value(json* spJson, json_value* spValue);
+abool bJsonKeyComp(json* spJson, json_value* spValue, const uint32_t* uipKey, aint uiLength);
+void vJsonKeyIndexClear(json* spJson);
+void vJsonKeyIndexAll(json* spJson);
+json_value* spJsonKeyIndexFind(json* spJson, json_value* spObject, const uint32_t* uipKey, aint uiLength);
+abool bJsonUtf8KeyComp(u8_phrase* spKey, const uint32_t* uipKey, aint uiLength);
 json_iterator* spJsonIteratorCtor(json* spJson);
+json_value* spJsonReadRecord(json* spJson, const uint8_t* ucpData, aint uiDataLen, abool bLazy);
+void vJsonReadFileInput(json* spJson, const char* cpFileName);
+void vJsonLinesUnmap(json* spJson);
 #define JSON_UTF16_MATCH  0
 #define JSON_UTF16_NOMATCH  1
 #define JSON_UTF16_BAD_HIGH  2
@@ -178,6 +287,12 @@ aint uiUtf16_2(char* cpHex, uint32_t* uipChar);
 uint32_t uiUtf8_2byte(char* cpBytes);
 uint32_t uiUtf8_3byte(char* cpBytes);
 uint32_t uiUtf8_4byte(char* cpBytes);
+aint uiUtf8Encode(uint32_t uiChar, uint8_t* ucpBytes);
+aint uiUtf8Decode(const uint8_t* ucpBytes, uint32_t* uipChar);
+#define JSON_NUMBER_OK  0
+#define JSON_NUMBER_SIGNED_RANGE  1
+#define JSON_NUMBER_UNSIGNED_RANGE  2
+aint uiJsonNumberDecode(json* spJson, const uint8_t* ucpNumber, aint uiLength, json_number* spNumber);
 ///@}
 
 #endif /* JSONP_H_ */
@@ -0,0 +1,220 @@
+/*  *************************************************************************************
+    Copyright (c) 2021, Lowell D. Thomas
+    All rights reserved.
+
+    This file is part of APG Version 7.0.
+    APG Version 7.0 may be used under the terms of the BSD 2-Clause License.
+
+    Redistribution and use in source and binary forms, with or without
+    modification, are permitted provided that the following conditions are met:
+
+    1. Redistributions of source code must retain the above copyright notice, this
+       list of conditions and the following disclaimer.
+
+    2. Redistributions in binary form must reproduce the above copyright notice,
+       this list of conditions and the following disclaimer in the documentation
+       and/or other materials provided with the distribution.
+
+    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+    AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+    IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+    DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+    FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+    DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+    SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+    CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+    OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+    OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+*   *************************************************************************************/
+/** \file json/keyindex.c
+ * \brief For internal object use only. Hashed key indexes for direct lookup of object members.
+ *
+ * Each object with enough members to make it worthwhile gets its own open-addressed hash table
+ * of its members' keys. The tables are built on the first lookup of a member of the object
+ * or, optionally, for all objects as the document is read. They are discarded with each new document.
+ *
+ * The hash is of the keys' code points, so 32-bit, UTF-8 and lazily read keys all hash alike.
+ * Linear probing with no deletions means that the first matching member found is always
+ * the first, in document order, of any duplicate keys.
+ */
+
+#include "./json.h"
+#include "./jsonp.h"
+
+/** \def KEY_INDEX_MIN
+ * \brief Objects with fewer members than this are searched linearly, without a hash table.
+ */
+#define KEY_INDEX_MIN 8
+
+// the 32-bit FNV-1a hash constants
+#define FNV_BASIS   2166136261U
+#define FNV_PRIME   16777619U
+
+static uint32_t uiHashU32(const uint32_t* uipKey, aint uiLength){
+    uint32_t uiHash = FNV_BASIS;
+    aint ui = 0;
+    for(; ui < uiLength; ui++){
+        uiHash = (uiHash ^ uipKey[ui]) * FNV_PRIME;
+    }
+    return uiHash;
+}
+static uint32_t uiHashU8(const u8_phrase* spKey){
+    uint32_t uiHash = FNV_BASIS;
+    uint32_t uiChar;
+    const uint8_t* ucpChar = spKey->ucpPhrase;
+    const uint8_t* ucpEnd = ucpChar + spKey->uiLength;
+    while(ucpChar < ucpEnd){
+        ucpChar += uiUtf8Decode(ucpChar, &uiChar);
+        uiHash = (uiHash ^ uiChar) * FNV_PRIME;
+    }
+    return uiHash;
+}
+
+/* Hash the key of an object member. Lazily read members are decoded first.
+ */
+static uint32_t uiMemberHash(json* spJson, json_value* spMember){
+    spJsonLazyValue(spJson, spMember);
+    if(spMember->spKey){
+        return uiHashU32(spMember->spKey->uipPhrase, (aint)spMember->spKey->uiLength);
+    }
+    if(spMember->spKey8){
+        return uiHashU8(spMember->spKey8);
+    }
+    return FNV_BASIS;
+}
+
+static key_index* spKeyIndex(json* spJson, json_value* spObject){
+    aint uiCount = uiVecLen(spJson->vpVecKeyIndex);
+    if(uiCount < spJson->uiValueCount){
+        // the index entries for a new document - none built yet
+        key_index* spIndex = (key_index*)vpVecPushn(spJson->vpVecKeyIndex, NULL, (spJson->uiValueCount - uiCount));
+        memset((void*)spIndex, 0, (sizeof(key_index) * (spJson->uiValueCount - uiCount)));
+    }
+    return (key_index*)vpVecAt(spJson->vpVecKeyIndex, (aint)(spObject - spJson->spValues));
+}
+
+static void vBuildIndex(json* spJson, json_value* spObject, key_index* spIndex){
+    aint uiSize = 16;
+    aint uiMask, ui, uiSlot;
+    key_slot* spSlots;
+    while(uiSize < (2 * spObject->uiChildCount)){
+        uiSize <<= 1;
+    }
+    uiMask = uiSize - 1;
+    spIndex->uiOffset = uiVecLen(spJson->vpVecKeySlots);
+    spSlots = (key_slot*)vpVecPushn(spJson->vpVecKeySlots, NULL, uiSize);
+    memset((void*)spSlots, 0, (sizeof(key_slot) * uiSize));
+    for(ui = 0; ui < spObject->uiChildCount; ui++){
+        uint32_t uiHash = uiMemberHash(spJson, spObject->sppChildren[ui]);
+        uiSlot = (aint)uiHash & uiMask;
+        while(spSlots[uiSlot].uiMember){
+            uiSlot = (uiSlot + 1) & uiMask;
+        }
+        spSlots[uiSlot].uiHash = uiHash;
+        spSlots[uiSlot].uiMember = ui + 1;
+    }
+    spIndex->uiSize = uiSize;
+}
+
+static abool bIndexed(json* spJson, json_value* spObject){
+    return (spObject->uiChildCount >= KEY_INDEX_MIN) && spJson->spValues
+            && (spObject >= spJson->spValues) && (spObject < (spJson->spValues + spJson->uiValueCount));
+}
+
+/** @name Private Key Index Functions
+ * For internal object use only. Never called by the application.*/
+///@{
+/** \brief Compare the key of a value, in whatever form it has, to a search key.
+ *
+ * \param spJson Pointer to the JSON object context.
+ * \param spValue Pointer to the value.
+ * \param uipKey The search key.
+ * \param uiLength The number of code points in the search key.
+ * \return True if the value has a key equal to the search key, false otherwise.
+ */
+abool bJsonKeyComp(json* spJson, json_value* spValue, const uint32_t* uipKey, aint uiLength){
+    if(spValue->spKey){
+        if(spValue->spKey->uiLength != uiLength){
+            return APG_FALSE;
+        }
+        return (uiLength == 0) || !memcmp(spValue->spKey->uipPhrase, uipKey, (sizeof(uint32_t) * (size_t)uiLength));
+    }
+    if(spValue->spKey8){
+        // compare a UTF-8 key without converting it
+        return bJsonUtf8KeyComp(spValue->spKey8, uipKey, uiLength);
+    }
+    if(spJson->bLazy){
+        // compare the key, if any, directly with the input without decoding it
+        return bJsonLazyKeyComp(spJson, spValue, uipKey, uiLength);
+    }
+    return APG_FALSE;
+}
+
+/** \brief Discard the key indexes of the previous document.
+ *
+ * \param spJson Pointer to the JSON object context.
+ */
+void vJsonKeyIndexClear(json* spJson){
+    vVecClear(spJson->vpVecKeyIndex);
+    vVecClear(spJson->vpVecKeySlots);
+}
+
+/** \brief Build the key indexes of all objects of the current document.
+ *
+ * \param spJson Pointer to the JSON object context.
+ */
+void vJsonKeyIndexAll(json* spJson){
+    aint ui = 0;
+    for(; ui < spJson->uiValueCount; ui++){
+        json_value* spValue = &spJson->spValues[ui];
+        if((spValue->uiId == JSON_ID_OBJECT) && bIndexed(spJson, spValue)){
+            key_index* spIndex = spKeyIndex(spJson, spValue);
+            if(!spIndex->uiSize){
+                vBuildIndex(spJson, spValue, spIndex);
+            }
+        }
+    }
+}
+
+/** \brief Find the member of an object with the given key.
+ *
+ * \param spJson Pointer to the JSON object context.
+ * \param spObject Pointer to the object value.
+ * \param uipKey The key.
+ * \param uiLength The number of code points in the key.
+ * \return Pointer to the first member value with the key. NULL if none, or if spObject is not an object.
+ */
+json_value* spJsonKeyIndexFind(json* spJson, json_value* spObject, const uint32_t* uipKey, aint uiLength){
+    aint ui;
+    if(spObject->uiId != JSON_ID_OBJECT){
+        return NULL;
+    }
+    if(!bIndexed(spJson, spObject)){
+        for(ui = 0; ui < spObject->uiChildCount; ui++){
+            if(bJsonKeyComp(spJson, spObject->sppChildren[ui], uipKey, uiLength)){
+                return spJsonLazyValue(spJson, spObject->sppChildren[ui]);
+            }
+        }
+        return NULL;
+    }
+    key_index* spIndex = spKeyIndex(spJson, spObject);
+    if(!spIndex->uiSize){
+        vBuildIndex(spJson, spObject, spIndex);
+    }
+    key_slot* spSlots = (key_slot*)vpVecAt(spJson->vpVecKeySlots, spIndex->uiOffset);
+    aint uiMask = spIndex->uiSize - 1;
+    uint32_t uiHash = uiHashU32(uipKey, uiLength);
+    aint uiSlot = (aint)uiHash & uiMask;
+    while(spSlots[uiSlot].uiMember){
+        if(spSlots[uiSlot].uiHash == uiHash){
+            json_value* spMember = spObject->sppChildren[spSlots[uiSlot].uiMember - 1];
+            if(bJsonKeyComp(spJson, spMember, uipKey, uiLength)){
+                return spMember;
+            }
+        }
+        uiSlot = (uiSlot + 1) & uiMask;
+    }
+    return NULL;
+}
+///@}
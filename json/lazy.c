@@ -0,0 +1,785 @@
+/*  *************************************************************************************
+    Copyright (c) 2021, Lowell D. Thomas
+    All rights reserved.
+
+    This file is part of APG Version 7.0.
+    APG Version 7.0 may be used under the terms of the BSD 2-Clause License.
+
+    Redistribution and use in source and binary forms, with or without
+    modification, are permitted provided that the following conditions are met:
+
+    1. Redistributions of source code must retain the above copyright notice, this
+       list of conditions and the following disclaimer.
+
+    2. Redistributions in binary form must reproduce the above copyright notice,
+       this list of conditions and the following disclaimer in the documentation
+       and/or other materials provided with the distribution.
+
+    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+    AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+    IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+    DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+    FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+    DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+    SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+    CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+    OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+    OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+*   *************************************************************************************/
+/** \file json/lazy.c
+ * \brief For internal object use only. The lazy, structural index reader of JSON text and the on-demand decoding of strings.
+ *
+ * An alternative to the APG grammar parser for very large documents of which only a small fraction is ever read.
+ * The input is read in two fast passes.
+ *  - The first pass builds a structural index &ndash; the offsets of all of the brackets, colons and commas
+ * and of the first character of every string, number and literal. The insides of strings are skipped eight bytes at a time.
+ *  - The second pass walks the structural index, checks that the brackets, colons and commas are properly placed
+ * and builds the tree of values in the same depth-first order as the grammar parser.
+ *
+ * Only the tree structure is built. Keys, strings and numbers are left in the UTF-8 input
+ * and are decoded when their value is first accessed with an iterator, displayed or written.
+ * Keys are compared to search keys directly from the input without decoding.
+ *
+ * For UTF-8 strings, keys and strings are decoded to UTF-8 rather than 32-bit code points.
+ * Strings without escaped characters are left in place in the input.
+ * The 32-bit strings are converted from the UTF-8 strings only on request, for both the lazy and the grammar readers.
+ *
+ * This reader checks the structure of the document but is not a validating parser.
+ * Errors in strings and numbers are only detected when the values are decoded.
+ * The APG grammar parser, vpJsonReadFile() and vpJsonReadArray(), remains the validating reference.
+ */
+
+#include "./json.h"
+#include "./jsonp.h"
+
+/** \def THROW_ERROR(msg, off)
+ * \brief A specialized exception thrower for the lazy reader functions.
+ */
+#define THROW_ERROR(msg, off) vThrowError(spJson, (msg), (off), __FILE__, __func__, __LINE__)
+
+/** \def ARENA_BLOCK
+ * \brief The minimum number of 32-bit code points in a block of decoded string storage.
+ */
+#define ARENA_BLOCK 16384
+
+// character classes for the structural index
+#define CLASS_ATOM      0
+#define CLASS_WS        1
+#define CLASS_STRUCT    2
+#define CLASS_QUOTE     3
+
+// the SWAR (SIMD within a register) constants
+#define SWAR_ONES       0x0101010101010101ULL
+#define SWAR_HIGHS      0x8080808080808080ULL
+#define SWAR_QUOTES     (SWAR_ONES * 0x22)
+#define SWAR_SOLIDI     (SWAR_ONES * 0x5C)
+#define SWAR_CONTROLS   (SWAR_ONES * 0x20)
+
+// the character class of each byte, CLASS_ATOM unless listed
+static const uint8_t s_ucaClass[256] = {
+        [0x20] = CLASS_WS, [0x09] = CLASS_WS, [0x0A] = CLASS_WS, [0x0D] = CLASS_WS,
+        [0x7B] = CLASS_STRUCT, [0x7D] = CLASS_STRUCT, [0x5B] = CLASS_STRUCT, [0x5D] = CLASS_STRUCT,
+        [0x3A] = CLASS_STRUCT, [0x2C] = CLASS_STRUCT,
+        [0x22] = CLASS_QUOTE,
+};
+
+static void vThrowError(json* spJson, const char* cpMsg, aint uiOffset,
+        const char* cpFile, const char* cpFunc, unsigned int uiCodeLine){
+    aint uiLine, uiRelOffset;
+    char caBuf[1024];
+    if(bLinesFindLine(vpJsonLines(spJson), uiOffset, &uiLine, &uiRelOffset)){
+        snprintf(caBuf, 1024,
+                "%s: near: line: %"PRIuMAX": character: %"PRIuMAX" (0x%"PRIXMAX")",
+                cpMsg, (luint)uiLine, (luint)uiRelOffset, (luint)uiRelOffset);
+    }else{
+        snprintf(caBuf, 1024,
+                "%s: character offset out of range: %"PRIuMAX" (0x%"PRIXMAX")",
+                cpMsg, (luint)uiOffset, (luint)uiOffset);
+    }
+    vExThrow(spJson->spException, caBuf, uiCodeLine, cpFile, cpFunc);
+}
+/* Skip over the characters of a string.
+ * ucpChar points to the first character following the opening quote.
+ * Returns a pointer to the closing quote. Throws an exception if the string is not terminated.
+ * Eight bytes at a time are tested for a quote, a reverse solidus or a control character.
+ */
+static const uint8_t* ucpSkipString(json* spJson, const uint8_t* ucpBeg, const uint8_t* ucpChar, const uint8_t* ucpEnd){
+    while(APG_TRUE){
+        while((ucpEnd - ucpChar) >= 8){
+            uint64_t uiWord, uiQuotes, uiSolidi;
+            memcpy(&uiWord, ucpChar, 8);
+            uiQuotes = uiWord ^ SWAR_QUOTES;
+            uiSolidi = uiWord ^ SWAR_SOLIDI;
+            if((((uiQuotes - SWAR_ONES) & ~uiQuotes)
+                    | ((uiSolidi - SWAR_ONES) & ~uiSolidi)
+                    | ((uiWord - SWAR_CONTROLS) & ~uiWord)) & SWAR_HIGHS){
+                break;
+            }
+            ucpChar += 8;
+        }
+        for(; ucpChar < ucpEnd; ucpChar++){
+            if(*ucpChar == 0x22){
+                return ucpChar;
+            }
+            if(*ucpChar == 0x5C){
+                break;
+            }
+            if(*ucpChar < 0x20){
+                THROW_ERROR("control characters not allowed in strings", (aint)(ucpChar - ucpBeg));
+            }
+        }
+        if(ucpChar >= ucpEnd){
+            break;
+        }
+        // skip the reverse solidus and the escaped character
+        ucpChar += 2;
+    }
+    THROW_ERROR("Expected close of string not found.", (aint)(ucpEnd - ucpBeg));
+    return NULL;
+}
+
+/* The first pass. Find the offsets of all structural characters, string beginnings and atom (number and literal) beginnings.
+ */
+static void vStructuralIndex(json* spJson, const uint8_t* ucpBeg, aint uiLength){
+    const uint8_t* ucpChar = ucpBeg;
+    const uint8_t* ucpEnd = ucpBeg + uiLength;
+    aint uiOffset;
+    vVecClear(spJson->vpVecStructural);
+    while(ucpChar < ucpEnd){
+        switch(s_ucaClass[*ucpChar]){
+        case CLASS_WS:
+            ucpChar++;
+            break;
+        case CLASS_STRUCT:
+            uiOffset = (aint)(ucpChar - ucpBeg);
+            vpVecPush(spJson->vpVecStructural, &uiOffset);
+            ucpChar++;
+            break;
+        case CLASS_QUOTE:
+            uiOffset = (aint)(ucpChar - ucpBeg);
+            vpVecPush(spJson->vpVecStructural, &uiOffset);
+            ucpChar = ucpSkipString(spJson, ucpBeg, ucpChar + 1, ucpEnd) + 1;
+            break;
+        default:
+            uiOffset = (aint)(ucpChar - ucpBeg);
+            vpVecPush(spJson->vpVecStructural, &uiOffset);
+            ucpChar++;
+            while((ucpChar < ucpEnd) && (s_ucaClass[*ucpChar] == CLASS_ATOM)){
+                ucpChar++;
+            }
+            break;
+        }
+    }
+}
+
+static aint uiPushValue(json* spJson, aint uiId, aint uiOffset, aint uiKeyOffset){
+    aint uiIndex = uiVecLen(spJson->vpVecValues);
+    json_value* spValue = (json_value*)vpVecPush(spJson->vpVecValues, NULL);
+    memset((void*)spValue, 0, sizeof(json_value));
+    spValue->uiId = uiId;
+    lazy_value* spLazy = (lazy_value*)vpVecPush(spJson->vpVecLazy, NULL);
+    memset((void*)spLazy, 0, sizeof(lazy_value));
+    spLazy->uiOffset = uiOffset;
+    spLazy->uiKeyOffset = uiKeyOffset;
+    spLazy->uiNext = uiIndex + 1;
+    return uiIndex;
+}
+static abool bAtomIs(const uint8_t* ucpInput, aint uiOffset, aint uiLength, const char* cpLiteral){
+    aint uiLen = (aint)strlen(cpLiteral);
+    if(((uiOffset + uiLen) > uiLength) || memcmp(&ucpInput[uiOffset], cpLiteral, (size_t)uiLen)){
+        return APG_FALSE;
+    }
+    // the literal must not run on into other atom characters, e.g. "nullx"
+    return ((uiOffset + uiLen) == uiLength) || (s_ucaClass[ucpInput[uiOffset + uiLen]] != CLASS_ATOM);
+}
+
+static void vCloseFrame(json* spJson){
+    lazy_frame* spFrame = (lazy_frame*)vpVecPop(spJson->vpVecLazyFrames);
+    json_value* spValue = (json_value*)vpVecAt(spJson->vpVecValues, spFrame->uiValue);
+    lazy_value* spLazy = (lazy_value*)vpVecAt(spJson->vpVecLazy, spFrame->uiValue);
+    spValue->uiChildCount = spFrame->uiCount;
+    spLazy->uiNext = uiVecLen(spJson->vpVecValues);
+}
+static aint uiMemberKey(json* spJson, const uint8_t* ucpInput, aint uiLength, const aint* uipIndex, aint uiCount, aint* uipNext){
+    aint ui = *uipNext;
+    aint uiKeyOffset;
+    if((ui >= uiCount) || (ucpInput[uipIndex[ui]] != 0x22)){
+        THROW_ERROR("expected object member key not found", (ui < uiCount) ? uipIndex[ui] : uiLength);
+    }
+    uiKeyOffset = uipIndex[ui++];
+    if((ui >= uiCount) || (ucpInput[uipIndex[ui]] != 0x3A)){
+        THROW_ERROR("Expected key/value name separator (:) not found", (ui < uiCount) ? uipIndex[ui] : uiLength);
+    }
+    *uipNext = ui + 1;
+    return uiKeyOffset;
+}
+
+/* The second pass. Walk the structural index and build the tree of values.
+ */
+static void vStructuralTree(json* spJson, const uint8_t* ucpInput, aint uiLength){
+    const aint* uipIndex = (const aint*)vpVecFirst(spJson->vpVecStructural);
+    aint uiCount = uiVecLen(spJson->vpVecStructural);
+    aint ui = 0;
+    aint uiOffset, uiValue, uiKeyOffset = APG_UNDEFINED;
+    lazy_frame* spFrame;
+    uint8_t ucChar, ucClose;
+    vVecClear(spJson->vpVecValues);
+    vVecClear(spJson->vpVecLazy);
+    vVecClear(spJson->vpVecLazyFrames);
+    if(!uiCount){
+        THROW_ERROR("JSON text is empty", 0);
+    }
+    while(APG_TRUE){
+        // expect a value
+        if(ui >= uiCount){
+            THROW_ERROR("expected value not found", uiLength);
+        }
+        uiOffset = uipIndex[ui++];
+        ucChar = ucpInput[uiOffset];
+        switch(ucChar){
+        case 0x7B:
+        case 0x5B:
+            uiValue = uiPushValue(spJson, (ucChar == 0x7B) ? JSON_ID_OBJECT : JSON_ID_ARRAY, uiOffset, uiKeyOffset);
+            spFrame = (lazy_frame*)vpVecPush(spJson->vpVecLazyFrames, NULL);
+            spFrame->uiValue = uiValue;
+            spFrame->uiCount = 0;
+            spFrame->bObject = (ucChar == 0x7B);
+            ucClose = spFrame->bObject ? 0x7D : 0x5D;
+            if((ui < uiCount) && (ucpInput[uipIndex[ui]] == ucClose)){
+                // an empty object or array is a complete value
+                ui++;
+                vCloseFrame(spJson);
+                break;
+            }
+            if(spFrame->bObject){
+                uiKeyOffset = uiMemberKey(spJson, ucpInput, uiLength, uipIndex, uiCount, &ui);
+            }else{
+                uiKeyOffset = APG_UNDEFINED;
+            }
+            continue;
+        case 0x22:
+            uiPushValue(spJson, JSON_ID_STRING, uiOffset, uiKeyOffset);
+            break;
+        case 0x74:
+            if(!bAtomIs(ucpInput, uiOffset, uiLength, "true")){
+                THROW_ERROR("invalid literal value", uiOffset);
+            }
+            uiPushValue(spJson, JSON_ID_TRUE, uiOffset, uiKeyOffset);
+            break;
+        case 0x66:
+            if(!bAtomIs(ucpInput, uiOffset, uiLength, "false")){
+                THROW_ERROR("invalid literal value", uiOffset);
+            }
+            uiPushValue(spJson, JSON_ID_FALSE, uiOffset, uiKeyOffset);
+            break;
+        case 0x6E:
+            if(!bAtomIs(ucpInput, uiOffset, uiLength, "null")){
+                THROW_ERROR("invalid literal value", uiOffset);
+            }
+            uiPushValue(spJson, JSON_ID_NULL, uiOffset, uiKeyOffset);
+            break;
+        default:
+            if((ucChar != 0x2D) && ((ucChar < 0x30) || (ucChar > 0x39))){
+                THROW_ERROR("expected value not found", uiOffset);
+            }
+            uiPushValue(spJson, JSON_ID_NUMBER, uiOffset, uiKeyOffset);
+            break;
+        }
+
+        // a value is complete - count it and close the objects and arrays that end with it
+        while(APG_TRUE){
+            spFrame = (lazy_frame*)vpVecLast(spJson->vpVecLazyFrames);
+            if(!spFrame){
+                if(ui < uiCount){
+                    THROW_ERROR("JSON text has characters following the value", uipIndex[ui]);
+                }
+                return;
+            }
+            spFrame->uiCount++;
+            ucClose = spFrame->bObject ? 0x7D : 0x5D;
+            if((ui >= uiCount) || ((ucpInput[uipIndex[ui]] != 0x2C) && (ucpInput[uipIndex[ui]] != ucClose))){
+                THROW_ERROR(spFrame->bObject ? "Expected closing object bracket '}' not found."
+                        : "Expected closing array bracket ']' not found.", (ui < uiCount) ? uipIndex[ui] : uiLength);
+            }
+            uiOffset = uipIndex[ui++];
+            if(ucpInput[uiOffset] == 0x2C){
+                break;
+            }
+            vCloseFrame(spJson);
+        }
+
+        // a value separator
+        if((ui < uiCount) && (ucpInput[uipIndex[ui]] == ucClose)){
+            THROW_ERROR(spFrame->bObject ? "Trailing comma not allowed in objects (REF8259)"
+                    : "Trailing comma not allowed in arrays (REF8259)", uiOffset);
+        }
+        if(spFrame->bObject){
+            uiKeyOffset = uiMemberKey(spJson, ucpInput, uiLength, uipIndex, uiCount, &ui);
+        }else{
+            uiKeyOffset = APG_UNDEFINED;
+        }
+    }
+}
+
+/* Convert the child counts and sub-tree sizes of the objects and arrays into lists of child value pointers.
+ */
+static void vChildPointers(json* spJson){
+    json_value* spValues = (json_value*)vpVecFirst(spJson->vpVecValues);
+    lazy_value* spLazy = (lazy_value*)vpVecFirst(spJson->vpVecLazy);
+    aint uiCount = uiVecLen(spJson->vpVecValues);
+    aint ui, uiChild, uiNext;
+    json_value** sppChildren = NULL;
+    vVecClear(spJson->vpVecChildPointers);
+    if(uiCount > 1){
+        // every value but the root is the child of one object or array
+        sppChildren = (json_value**)vpVecPushn(spJson->vpVecChildPointers, NULL, (uiCount - 1));
+    }
+    for(ui = 0; ui < uiCount; ui++){
+        json_value* spValue = &spValues[ui];
+        if(spValue->uiChildCount){
+            spValue->sppChildren = sppChildren;
+            uiNext = ui + 1;
+            for(uiChild = 0; uiChild < spValue->uiChildCount; uiChild++){
+                *sppChildren++ = &spValues[uiNext];
+                uiNext = spLazy[uiNext].uiNext;
+            }
+        }
+    }
+    spJson->spValues = spValues;
+    spJson->uiValueCount = uiCount;
+    spJson->sppChildPointers = (struct json_value_tag**)vpVecFirst(spJson->vpVecChildPointers);
+}
+
+/* Get stable storage for decoded strings. The storage is released for each new document.
+ */
+static uint32_t* uipArenaAlloc(json* spJson, aint uiCount){
+    if(uiCount > spJson->uiArenaFree){
+        aint uiBlock = (uiCount > ARENA_BLOCK) ? uiCount : ARENA_BLOCK;
+        uint32_t* uipBlock = (uint32_t*)vpMemAlloc(spJson->vpMem, (aint)(sizeof(uint32_t) * uiBlock));
+        vpVecPush(spJson->vpVecArena, &uipBlock);
+        spJson->uipArenaNext = uipBlock;
+        spJson->uiArenaFree = uiBlock;
+    }
+    uint32_t* uipReturn = spJson->uipArenaNext;
+    spJson->uipArenaNext += uiCount;
+    spJson->uiArenaFree -= uiCount;
+    return uipReturn;
+}
+static uint8_t* ucpArenaAlloc(json* spJson, aint uiCount){
+    return (uint8_t*)uipArenaAlloc(spJson, (uiCount + 3) / 4);
+}
+
+static abool bHexDigits(const uint8_t* ucpChar, uint32_t* uipValue){
+    uint32_t uiValue = 0;
+    int i = 0;
+    for(; i < 4; i++){
+        uint8_t ucChar = ucpChar[i];
+        uiValue <<= 4;
+        if(ucChar >= 0x30 && ucChar <= 0x39){
+            uiValue += (uint32_t)(ucChar - 0x30);
+        }else if(ucChar >= 0x41 && ucChar <= 0x46){
+            uiValue += (uint32_t)(ucChar - 0x41 + 10);
+        }else if(ucChar >= 0x61 && ucChar <= 0x66){
+            uiValue += (uint32_t)(ucChar - 0x61 + 10);
+        }else{
+            return APG_FALSE;
+        }
+    }
+    *uipValue = uiValue;
+    return APG_TRUE;
+}
+
+/* Decode the next character of a string. *ucppChar points to the character in the input.
+ * Returns false if the character is the closing quote, otherwise the code point is returned in *uipChar
+ * and *ucppChar is advanced to the next character.
+ * The first pass guarantees that the string is terminated. Since every byte is tested before the next is examined,
+ * no decoding can run past the closing quote.
+ */
+static abool bNextChar(json* spJson, const uint8_t** ucppChar, uint32_t* uipChar){
+    const uint8_t* ucpInput = (const uint8_t*)vpVecFirst(spJson->vpVecInput);
+    const uint8_t* ucpChar = *ucppChar;
+    uint32_t uiChar = *ucpChar;
+    uint32_t uiLow = 0;
+    aint uiTrail = 0;
+    if(uiChar == 0x22){
+        return APG_FALSE;
+    }
+    if(uiChar == 0x5C){
+        switch(ucpChar[1]){
+        case 0x22: uiChar = 0x22; break;
+        case 0x5C: uiChar = 0x5C; break;
+        case 0x2F: uiChar = 0x2F; break;
+        case 0x62: uiChar = 0x08; break;
+        case 0x66: uiChar = 0x0C; break;
+        case 0x6E: uiChar = 0x0A; break;
+        case 0x72: uiChar = 0x0D; break;
+        case 0x74: uiChar = 0x09; break;
+        case 0x75:
+            if(!bHexDigits(&ucpChar[2], &uiChar)){
+                THROW_ERROR("UTF-16 encoding error - expected four hexadecimal digits", (aint)(ucpChar - ucpInput));
+            }
+            if(uiChar >= 0xD800 && uiChar < 0xDC00){
+                if(ucpChar[6] != 0x5C || ucpChar[7] != 0x75 || !bHexDigits(&ucpChar[8], &uiLow)
+                        || uiLow < 0xDC00 || uiLow >= 0xE000){
+                    THROW_ERROR("UTF-16 encoding error - high surrogate not followed by low surrogate", (aint)(ucpChar - ucpInput));
+                }
+                uiChar = 0x10000 + ((uiChar - 0xD800) << 10) + (uiLow - 0xDC00);
+                ucpChar += 6;
+            }else if(uiChar >= 0xDC00 && uiChar < 0xE000){
+                THROW_ERROR("UTF-16 encoding error - low surrogate not preceded by high surrogate", (aint)(ucpChar - ucpInput));
+            }
+            ucpChar += 4;
+            break;
+        default:
+            THROW_ERROR("invalid escaped character", (aint)(ucpChar - ucpInput));
+            break;
+        }
+        *ucppChar = ucpChar + 2;
+        *uipChar = uiChar;
+        return APG_TRUE;
+    }
+    if(uiChar < 0x80){
+        *ucppChar = ucpChar + 1;
+        *uipChar = uiChar;
+        return APG_TRUE;
+    }
+    // multi-byte UTF-8
+    if(uiChar >= 0xC2 && uiChar <= 0xDF){
+        uiTrail = 1;
+        uiChar &= 0x1F;
+    }else if(uiChar >= 0xE0 && uiChar <= 0xEF){
+        uiTrail = 2;
+        uiChar &= 0x0F;
+    }else if(uiChar >= 0xF0 && uiChar <= 0xF4){
+        uiTrail = 3;
+        uiChar &= 0x07;
+    }else{
+        THROW_ERROR("invalid character detected - probably mal-formed UTF-8", (aint)(ucpChar - ucpInput));
+    }
+    aint ui = 1;
+    for(; ui <= uiTrail; ui++){
+        if((ucpChar[ui] & 0xC0) != 0x80){
+            THROW_ERROR("invalid character detected - probably mal-formed UTF-8", (aint)(ucpChar - ucpInput));
+        }
+        uiChar = (uiChar << 6) | (uint32_t)(ucpChar[ui] & 0x3F);
+    }
+    if((uiTrail == 2 && uiChar < 0x800) || (uiTrail == 3 && uiChar < 0x10000)
+            || (uiChar >= 0xD800 && uiChar < 0xE000) || (uiChar > 0x10FFFF)){
+        THROW_ERROR("invalid character detected - probably mal-formed UTF-8", (aint)(ucpChar - ucpInput));
+    }
+    *ucppChar = ucpChar + uiTrail + 1;
+    *uipChar = uiChar;
+    return APG_TRUE;
+}
+
+static void vDecodeString(json* spJson, aint uiOffset, u32_phrase* spString){
+    static const uint32_t uiEmpty = 0;
+    const uint8_t* ucpInput = (const uint8_t*)vpVecFirst(spJson->vpVecInput);
+    const uint8_t* ucpChar = ucpInput + uiOffset + 1;
+    const uint8_t* ucpEnd = ucpSkipString(spJson, ucpInput, ucpChar, ucpInput + uiVecLen(spJson->vpVecInput));
+    uint32_t* uipChars;
+    aint uiMax = (aint)(ucpEnd - ucpChar);
+    aint uiCount = 0;
+    spString->uipPhrase = &uiEmpty;
+    spString->uiLength = 0;
+    if(!uiMax){
+        return;
+    }
+    // there are never more code points than bytes - decode in place and return the unused storage
+    uipChars = uipArenaAlloc(spJson, uiMax);
+    while(bNextChar(spJson, &ucpChar, &uipChars[uiCount])){
+        uiCount++;
+    }
+    spJson->uipArenaNext -= (uiMax - uiCount);
+    spJson->uiArenaFree += (uiMax - uiCount);
+    spString->uipPhrase = uipChars;
+    spString->uiLength = (uint32_t)uiCount;
+}
+
+/* Decode a string as UTF-8. A string without escaped characters is left in place in the input.
+ */
+static void vDecodeUtf8(json* spJson, aint uiOffset, u8_phrase* spString){
+    const uint8_t* ucpBeg = (const uint8_t*)vpVecFirst(spJson->vpVecInput) + uiOffset + 1;
+    const uint8_t* ucpChar = ucpBeg;
+    uint32_t uiChar;
+    abool bEscaped = APG_FALSE;
+    while(APG_TRUE){
+        if(*ucpChar == 0x5C){
+            bEscaped = APG_TRUE;
+        }
+        if(!bNextChar(spJson, &ucpChar, &uiChar)){
+            break;
+        }
+    }
+    spString->uiLength = (aint)(ucpChar - ucpBeg);
+    spString->ucpPhrase = ucpBeg;
+    if(bEscaped){
+        // an escaped character never has more UTF-8 bytes than its escape sequence
+        uint8_t* ucpBytes = ucpArenaAlloc(spJson, spString->uiLength);
+        uint8_t* ucpNext = ucpBytes;
+        ucpChar = ucpBeg;
+        while(bNextChar(spJson, &ucpChar, &uiChar)){
+            ucpNext += uiUtf8Encode(uiChar, ucpNext);
+        }
+        spString->uiLength = (aint)(ucpNext - ucpBytes);
+        spString->ucpPhrase = ucpBytes;
+    }
+}
+
+/* Convert a UTF-8 string to 32-bit code points. The UTF-8 has been validated and has no escaped characters.
+ */
+static void vUtf8ToUtf32(json* spJson, u8_phrase* spString8, u32_phrase* spString){
+    static const uint32_t uiEmpty = 0;
+    const uint8_t* ucpChar = spString8->ucpPhrase;
+    const uint8_t* ucpEnd = ucpChar + spString8->uiLength;
+    uint32_t* uipChars;
+    aint uiCount = 0;
+    spString->uipPhrase = &uiEmpty;
+    spString->uiLength = 0;
+    if(!spString8->uiLength){
+        return;
+    }
+    // there are never more code points than bytes
+    uipChars = uipArenaAlloc(spJson, spString8->uiLength);
+    while(ucpChar < ucpEnd){
+        ucpChar += uiUtf8Decode(ucpChar, &uipChars[uiCount++]);
+    }
+    spString->uipPhrase = uipChars;
+    spString->uiLength = (uint32_t)uiCount;
+}
+
+/* Find the storage for the 32-bit version of a UTF-8 key or string.
+ */
+static u32_phrase* spUtf32Storage(json* spJson, json_value* spValue, abool bKey){
+    if(spJson->bLazy && (spValue >= spJson->spValues) && (spValue < (spJson->spValues + spJson->uiValueCount))){
+        lazy_value* spLazy = (lazy_value*)vpVecFirst(spJson->vpVecLazy) + (spValue - spJson->spValues);
+        return bKey ? &spLazy->sKey : &spLazy->sString;
+    }
+    u8_phrase* spString8 = bKey ? spValue->spKey8 : spValue->spString8;
+    if(spJson->spStrings8 && (spString8 >= spJson->spStrings8) && (spString8 < (spJson->spStrings8 + spJson->uiStringCount))){
+        return &spJson->spStrings[spString8 - spJson->spStrings8];
+    }
+    return NULL;
+}
+
+static void vDecodeNumber(json* spJson, aint uiOffset, json_number* spNumber){
+    const uint8_t* ucpInput = (const uint8_t*)vpVecFirst(spJson->vpVecInput);
+    aint uiLength = uiVecLen(spJson->vpVecInput);
+    aint uiEnd = uiOffset;
+    aint uiDigits;
+    char caBuf[128];
+    while((uiEnd < uiLength) && (s_ucaClass[ucpInput[uiEnd]] == CLASS_ATOM)){
+        uiEnd++;
+    }
+    // check the RFC 8259 number syntax: [ minus ] int [ frac ] [ exp ]
+    aint ui = uiOffset;
+    if(ucpInput[ui] == 0x2D){
+        ui++;
+    }
+    if((ui < uiEnd) && (ucpInput[ui] == 0x30)){
+        ui++;
+    }else{
+        for(uiDigits = 0; (ui < uiEnd) && (ucpInput[ui] >= 0x30) && (ucpInput[ui] <= 0x39); ui++, uiDigits++){}
+        if(!uiDigits){
+            THROW_ERROR("invalid number", uiOffset);
+        }
+    }
+    if((ui < uiEnd) && (ucpInput[ui] == 0x2E)){
+        for(ui++, uiDigits = 0; (ui < uiEnd) && (ucpInput[ui] >= 0x30) && (ucpInput[ui] <= 0x39); ui++, uiDigits++){}
+        if(!uiDigits){
+            THROW_ERROR("A decimal point must be followed by one or more digits (REF8259)", uiOffset);
+        }
+    }
+    if((ui < uiEnd) && ((ucpInput[ui] == 0x65) || (ucpInput[ui] == 0x45))){
+        ui++;
+        if((ui < uiEnd) && ((ucpInput[ui] == 0x2D) || (ucpInput[ui] == 0x2B))){
+            ui++;
+        }
+        for(uiDigits = 0; (ui < uiEnd) && (ucpInput[ui] >= 0x30) && (ucpInput[ui] <= 0x39); ui++, uiDigits++){}
+        if(!uiDigits){
+            THROW_ERROR("an exponent must have one or more digits", uiOffset);
+        }
+    }
+    if(ui != uiEnd){
+        THROW_ERROR("invalid number", uiOffset);
+    }
+
+    // convert the number
+    switch(uiJsonNumberDecode(spJson, &ucpInput[uiOffset], (uiEnd - uiOffset), spNumber)){
+    case JSON_NUMBER_SIGNED_RANGE:
+        snprintf(caBuf, 128, "Integer value too large to convert to int: %.*s",
+                (int)(uiEnd - uiOffset), (const char*)&ucpInput[uiOffset]);
+        THROW_ERROR(caBuf, uiOffset);
+        break;
+    case JSON_NUMBER_UNSIGNED_RANGE:
+        snprintf(caBuf, 128, "Integer value too large to convert to unsigned int: %.*s",
+                (int)(uiEnd - uiOffset), (const char*)&ucpInput[uiOffset]);
+        THROW_ERROR(caBuf, uiOffset);
+        break;
+    }
+}
+
+/** @name Private Lazy Reader Functions
+ * For internal object use only. Never called by the application.*/
+///@{
+/** \brief Read the JSON input with the structural index and build the (undecoded) tree of values.
+ *
+ * \param spJson Pointer to the JSON object context. The UTF-8 input, BOM removed, is in spJson->vpVecInput.
+ */
+void vJsonLazyParse(json* spJson){
+    const uint8_t* ucpInput = (const uint8_t*)vpVecFirst(spJson->vpVecInput);
+    aint uiLength = uiVecLen(spJson->vpVecInput);
+    vJsonLazyClear(spJson);
+    vJsonKeyIndexClear(spJson);
+    spJson->spValues = NULL;
+    spJson->uiValueCount = 0;
+    spJson->spStrings = NULL;
+    spJson->uiStringCount = 0;
+    if(!uiLength){
+        XTHROW(spJson->spException, "JSON text is empty");
+    }
+    vStructuralIndex(spJson, ucpInput, uiLength);
+    vStructuralTree(spJson, ucpInput, uiLength);
+    vChildPointers(spJson);
+    spJson->bUtf8Tree = spJson->bUtf8;
+    spJson->bLazy = APG_TRUE;
+    if(spJson->bKeyIndexAll){
+        vJsonKeyIndexAll(spJson);
+    }
+}
+
+/** \brief Release the storage of the decoded strings, if any, from the previous lazy read.
+ *
+ * \param spJson Pointer to the JSON object context.
+ */
+void vJsonLazyClear(json* spJson){
+    uint32_t** uippBlock = (uint32_t**)vpVecFirst(spJson->vpVecArena);
+    uint32_t** uippEnd = uippBlock + uiVecLen(spJson->vpVecArena);
+    for(; uippBlock < uippEnd; uippBlock++){
+        vMemFree(spJson->vpMem, *uippBlock);
+    }
+    vVecClear(spJson->vpVecArena);
+    spJson->uipArenaNext = NULL;
+    spJson->uiArenaFree = 0;
+    spJson->bLazy = APG_FALSE;
+}
+
+/** \brief Decode the key and the string or number of a value from a lazy read, if not already decoded.
+ *
+ * \param spJson Pointer to the JSON object context.
+ * \param spValue Pointer to a value. If the current document was not read lazily,
+ * or if the value is not one of its values (e.g. a builder value), it is returned unchanged.
+ * \return The value, spValue.
+ */
+json_value* spJsonLazyValue(json* spJson, json_value* spValue){
+    if(spJson->bLazy && spValue && (spValue >= spJson->spValues) && (spValue < (spJson->spValues + spJson->uiValueCount))){
+        lazy_value* spLazy = (lazy_value*)vpVecFirst(spJson->vpVecLazy) + (spValue - spJson->spValues);
+        if(!spLazy->bDecoded){
+            if(spLazy->uiKeyOffset != APG_UNDEFINED){
+                if(spJson->bUtf8Tree){
+                    vDecodeUtf8(spJson, spLazy->uiKeyOffset, &spLazy->sKey8);
+                    spValue->spKey8 = &spLazy->sKey8;
+                }else{
+                    vDecodeString(spJson, spLazy->uiKeyOffset, &spLazy->sKey);
+                    spValue->spKey = &spLazy->sKey;
+                }
+            }
+            if(spValue->uiId == JSON_ID_STRING){
+                if(spJson->bUtf8Tree){
+                    vDecodeUtf8(spJson, spLazy->uiOffset, &spLazy->sString8);
+                    spValue->spString8 = &spLazy->sString8;
+                }else{
+                    vDecodeString(spJson, spLazy->uiOffset, &spLazy->sString);
+                    spValue->spString = &spLazy->sString;
+                }
+            }else if(spValue->uiId == JSON_ID_NUMBER){
+                vDecodeNumber(spJson, spLazy->uiOffset, &spLazy->sNumber);
+                spValue->spNumber = &spLazy->sNumber;
+            }
+            spLazy->bDecoded = APG_TRUE;
+        }
+    }
+    return spValue;
+}
+
+/** \brief Make the 32-bit key and string of a value available.
+ *
+ * Values of a lazy read are first decoded. For UTF-8 strings, the 32-bit key and string
+ * are converted from the UTF-8 strings on the first request and kept for the life of the document.
+ * \param spJson Pointer to the JSON object context.
+ * \param spValue Pointer to a value.
+ * \return The value, spValue.
+ */
+json_value* spJsonUtf32Value(json* spJson, json_value* spValue){
+    u32_phrase* spString;
+    spJsonLazyValue(spJson, spValue);
+    if(spValue && spJson->bUtf8Tree){
+        if(spValue->spKey8 && !spValue->spKey){
+            spString = spUtf32Storage(spJson, spValue, APG_TRUE);
+            if(spString){
+                vUtf8ToUtf32(spJson, spValue->spKey8, spString);
+                spValue->spKey = spString;
+            }
+        }
+        if((spValue->uiId == JSON_ID_STRING) && spValue->spString8 && !spValue->spString){
+            spString = spUtf32Storage(spJson, spValue, APG_FALSE);
+            if(spString){
+                vUtf8ToUtf32(spJson, spValue->spString8, spString);
+                spValue->spString = spString;
+            }
+        }
+    }
+    return spValue;
+}
+
+/** \brief Compare a UTF-8 key to a search key without converting it.
+ *
+ * \param spKey The UTF-8 key.
+ * \param uipKey The search key.
+ * \param uiLength The number of code points in the search key.
+ * \return True if the keys are equal, false otherwise.
+ */
+abool bJsonUtf8KeyComp(u8_phrase* spKey, const uint32_t* uipKey, aint uiLength){
+    const uint8_t* ucpChar = spKey->ucpPhrase;
+    const uint8_t* ucpEnd = ucpChar + spKey->uiLength;
+    uint32_t uiChar;
+    aint ui = 0;
+    while(ucpChar < ucpEnd){
+        ucpChar += uiUtf8Decode(ucpChar, &uiChar);
+        if((ui >= uiLength) || (uiChar != uipKey[ui])){
+            return APG_FALSE;
+        }
+        ui++;
+    }
+    return (ui == uiLength);
+}
+
+/** \brief Compare the key of a value from a lazy read to a search key, decoding the key directly from the input.
+ *
+ * \param spJson Pointer to the JSON object context.
+ * \param spValue Pointer to a value. Values not belonging to the current, lazily read document never match.
+ * \param uipKey The search key.
+ * \param uiLength The number of code points in the search key.
+ * \return True if the value has a key equal to the search key, false otherwise.
+ */
+abool bJsonLazyKeyComp(json* spJson, json_value* spValue, const uint32_t* uipKey, aint uiLength){
+    if((spValue < spJson->spValues) || (spValue >= (spJson->spValues + spJson->uiValueCount))){
+        return APG_FALSE;
+    }
+    lazy_value* spLazy = (lazy_value*)vpVecFirst(spJson->vpVecLazy) + (spValue - spJson->spValues);
+    if(spLazy->uiKeyOffset == APG_UNDEFINED){
+        return APG_FALSE;
+    }
+    const uint8_t* ucpChar = (const uint8_t*)vpVecFirst(spJson->vpVecInput) + spLazy->uiKeyOffset + 1;
+    uint32_t uiChar;
+    aint ui = 0;
+    while(bNextChar(spJson, &ucpChar, &uiChar)){
+        if((ui >= uiLength) || (uiChar != uipKey[ui])){
+            return APG_FALSE;
+        }
+        ui++;
+    }
+    return (ui == uiLength);
+}
+///@}
@@ -0,0 +1,578 @@
+/*  *************************************************************************************
+    Copyright (c) 2021, Lowell D. Thomas
+    All rights reserved.
+
+    This file is part of APG Version 7.0.
+    APG Version 7.0 may be used under the terms of the BSD 2-Clause License.
+
+    Redistribution and use in source and binary forms, with or without
+    modification, are permitted provided that the following conditions are met:
+
+    1. Redistributions of source code must retain the above copyright notice, this
+       list of conditions and the following disclaimer.
+
+    2. Redistributions in binary form must reproduce the above copyright notice,
+       this list of conditions and the following disclaimer in the documentation
+       and/or other materials provided with the distribution.
+
+    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+    AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+    IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+    DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+    FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+    DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+    SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+    CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+    OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+    OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+*   *************************************************************************************/
+/** \file json/ndjson.c
+ * \brief The JSON Lines (newline-delimited JSON, NDJSON) readers.
+ *
+ * The input, usually a memory-mapped file, is divided into chunks of many lines each,
+ * always ending just after a line feed. The chunks are taken in turn by a pool of worker threads.
+ * Each worker reads the records of its chunks, one line at a time, with JSON objects of its own.
+ * Nothing of the caller's JSON object is changed by the workers. Only its settings are copied.
+ *
+ * Unordered, each worker reports its records to the callback function as soon as they are read.
+ * The calling thread is worker 0.
+ * Ordered, each worker has a small ring of JSON objects. It fills them one record at a time and the calling thread
+ * reports the records in chunk order, emptying the rings as it goes. A worker with a full ring waits.
+ * Since each worker takes its chunks in order, the records of the earliest unreported chunk can always be read,
+ * whatever the other workers are holding.
+ *
+ * Each JSON object has its own exception, caught by whichever thread is using the object at the time.
+ * Errors in the workers and in the callback functions stop all of the workers and are re-thrown by the calling thread.
+ */
+
+#include <pthread.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include "./json.h"
+#include "./jsonp.h"
+
+/** \def LINES_CHUNK_MIN
+ * \brief The minimum nominal length of a chunk, in bytes.
+ */
+#define LINES_CHUNK_MIN 65536
+
+/** \def LINES_SLOTS
+ * \brief The number of JSON objects in each worker's ring for ordered reading.
+ */
+#define LINES_SLOTS 8
+
+/** \struct lines_chunk
+ * \brief For internal object use only. A chunk of whole lines.
+ */
+typedef struct{
+    luint luiBeg; ///< \brief The offset of the first byte of the chunk.
+    luint luiEnd; ///< \brief The offset of the byte following the chunk.
+    aint uiWorker; ///< \brief The index of the worker that took the chunk.
+    abool bDone; ///< \brief True when all of the chunk's records have been read.
+} lines_chunk;
+
+/** \struct lines_slot
+ * \brief For internal object use only. One of a worker's JSON objects and the record it holds.
+ */
+typedef struct{
+    exception sException; ///< \brief The JSON object's exception. Caught by the thread using the object.
+    void* vpJson; ///< \brief The JSON object. Constructed when first needed.
+    json_value* spRoot; ///< \brief The root value of the record.
+    luint luiOffset; ///< \brief The offset of the record in the input.
+    aint uiChunk; ///< \brief The index of the chunk the record is in.
+} lines_slot;
+
+/** \struct lines_scan
+ * \brief For internal object use only. The state shared by the workers and the calling thread.
+ */
+typedef struct{
+    json* spJson; ///< \brief The caller's JSON object. Only its settings are used by the workers.
+    const uint8_t* ucpBuffer; ///< \brief The input.
+    lines_chunk* spChunks; ///< \brief The chunks.
+    aint uiChunkCount; ///< \brief The number of chunks.
+    aint uiNextChunk; ///< \brief The index of the next chunk to be taken.
+    aint uiSlots; ///< \brief The number of JSON objects in each worker's ring.
+    abool bOrdered; ///< \brief True if the records are reported in input order by the calling thread.
+    abool bLazy; ///< \brief True if the records are read with the lazy reader.
+    pfnJsonLineCallback pfnRecord; ///< \brief The user's callback function.
+    void* vpUserData; ///< \brief The user's data, passed to the callback function.
+    abool bStop; ///< \brief True if reading is to stop, on error or at the request of the callback function.
+    abool bError; ///< \brief True if sError holds the first error.
+    exception sError; ///< \brief A copy of the first exception thrown.
+    pthread_mutex_t sMutex; ///< \brief Guards everything that changes.
+    pthread_cond_t sCond; ///< \brief Signaled for every change of state that a thread may be waiting for.
+} lines_scan;
+
+/** \struct lines_worker
+ * \brief For internal object use only. One worker thread.
+ */
+typedef struct{
+    lines_scan* spScan; ///< \brief The shared state.
+    lines_slot* spSlots; ///< \brief The worker's ring of JSON objects.
+    aint uiFilled; ///< \brief The number of records the worker has read into its ring.
+    aint uiReported; ///< \brief The number of the worker's records the calling thread has reported.
+    luint luiCount; ///< \brief The number of records the worker has reported itself, if unordered.
+    aint uiIndex; ///< \brief The index of the worker.
+    pthread_t sThread; ///< \brief The worker's thread.
+    abool bStarted; ///< \brief True if the worker's thread was started.
+} lines_worker;
+
+static luint luiLines(json* spJson, const uint8_t* ucpBuffer, luint luiLength, aint uiThreads, aint uiFlags,
+        pfnJsonLineCallback pfnRecord, void* vpUserData);
+static void vLinesChunks(void* vpVecChunks, const uint8_t* ucpBuffer, luint luiLength, aint uiThreads);
+static lines_chunk* spLinesNextChunk(lines_worker* spWork);
+static void* vpLinesWorker(void* vpArg);
+static abool bLinesChunk(lines_worker* spWork, lines_chunk* spChunk);
+static abool bLinesRecord(lines_worker* spWork, lines_chunk* spChunk, luint luiOffset, luint luiLength);
+static abool bLinesRead(lines_scan* spScan, lines_slot* spSlot, luint luiOffset, luint luiLength);
+static abool bLinesCall(lines_scan* spScan, lines_slot* spSlot);
+static luint luiLinesReport(lines_scan* spScan, lines_worker* spWorkers);
+static void vLinesStop(lines_scan* spScan, exception* spEx, luint luiOffset);
+
+/** \brief Read newline-delimited JSON from a buffer on a pool of worker threads.
+ *
+ * Each line of the buffer is a complete JSON document, a record. Lines may end with "\n" or "\r\n".
+ * Blank lines are skipped. The buffer is divided into chunks of lines and the chunks are shared among the workers.
+ * Each worker reads its records with JSON objects of its own, which take the UTF-8 strings
+ * and key indexing settings of `vpCtx`. The parsing event callbacks are not used.
+ *
+ * By default, the records are reported to `pfnRecord` as soon as they have been read, from the worker threads.
+ * The records of each chunk are in order, but the chunks are interleaved. The callback function must be thread safe.
+ * With \ref JSON_LINES_ORDERED, the records are reported in input order, all from the calling thread.
+ * A worker may then read at most a few records ahead of those reported.
+ * With only one thread, the records are read and reported in order on the calling thread.
+ *
+ * Records are read with the validating grammar parser or, with \ref JSON_LINES_LAZY, with the lazy reader.
+ * If a record has an error, or if `pfnRecord` returns false, no more records are reported
+ * and the workers stop at the end of the record they are reading. The error is then thrown with the offset of the record.
+ * \param vpCtx Pointer to a valid parser context previously returned from  vpJsonCtor.
+ * If invalid the application will silently exit with a \ref BAD_CONTEXT exit code.
+ * \param ucpBuffer The UTF-8 encoded buffer, for example a memory-mapped file.
+ * \param luiLength The number of bytes in the buffer.
+ * \param uiThreads The number of worker threads.
+ * If 0, the number of online processors. At most \ref JSON_LINES_MAX_THREADS.
+ * \param uiFlags Zero or more of the flags \ref JSON_LINES_ORDERED and \ref JSON_LINES_LAZY, or'ed together.
+ * \param pfnRecord The function to call for each record. See \ref pfnJsonLineCallback.
+ * \param vpUserData Pointer to user data, passed to `pfnRecord`. May be NULL.
+ * \return The number of records reported.
+ */
+luint luiJsonLinesBuffer(void* vpCtx, const uint8_t* ucpBuffer, luint luiLength, aint uiThreads, aint uiFlags,
+        pfnJsonLineCallback pfnRecord, void* vpUserData){
+    json* spJson = (json*) vpCtx;
+    if(!bJsonValidate(vpCtx)){
+        vExContext();
+    }
+    if(!ucpBuffer && luiLength){
+        XTHROW(spJson->spException, "buffer cannot be NULL");
+    }
+    return luiLines(spJson, ucpBuffer, luiLength, uiThreads, uiFlags, pfnRecord, vpUserData);
+}
+
+/** \brief Read a newline-delimited JSON file on a pool of worker threads.
+ *
+ * The file is mapped into memory and read as with luiJsonLinesBuffer().
+ * Files that can't be mapped, pipes for example, are read into the JSON object's input buffer instead.
+ * Any value tree previously read by `vpCtx` may then no longer be valid.
+ * \param vpCtx Pointer to a valid parser context previously returned from  vpJsonCtor.
+ * If invalid the application will silently exit with a \ref BAD_CONTEXT exit code.
+ * \param cpFileName The name of the file to read.
+ * \param uiThreads The number of worker threads.
+ * If 0, the number of online processors. At most \ref JSON_LINES_MAX_THREADS.
+ * \param uiFlags Zero or more of the flags \ref JSON_LINES_ORDERED and \ref JSON_LINES_LAZY, or'ed together.
+ * \param pfnRecord The function to call for each record. See \ref pfnJsonLineCallback.
+ * \param vpUserData Pointer to user data, passed to `pfnRecord`. May be NULL.
+ * \return The number of records reported.
+ */
+luint luiJsonLinesFile(void* vpCtx, const char* cpFileName, aint uiThreads, aint uiFlags,
+        pfnJsonLineCallback pfnRecord, void* vpUserData){
+    json* spJson = (json*) vpCtx;
+    const uint8_t* ucpBuffer;
+    luint luiLength;
+    luint luiCount;
+    struct stat sStat;
+    void* vpMap;
+    int iFd;
+    if(!bJsonValidate(vpCtx)){
+        vExContext();
+    }
+    if(!cpFileName || !cpFileName[0]){
+        XTHROW(spJson->spException, "file name cannot be NULL or empty");
+    }
+    vJsonLinesUnmap(spJson);
+    iFd = open(cpFileName, O_RDONLY);
+    if(iFd >= 0){
+        if((fstat(iFd, &sStat) == 0) && S_ISREG(sStat.st_mode) && (sStat.st_size > 0)){
+            vpMap = mmap(NULL, (size_t)sStat.st_size, PROT_READ, MAP_PRIVATE, iFd, 0);
+            if(vpMap != MAP_FAILED){
+                spJson->vpLinesMap = vpMap;
+                spJson->luiLinesMapLength = (luint)sStat.st_size;
+            }
+        }
+        close(iFd);
+    }
+    if(spJson->vpLinesMap){
+        ucpBuffer = (const uint8_t*)spJson->vpLinesMap;
+        luiLength = spJson->luiLinesMapLength;
+        if((luiLength >= 3) && (ucpBuffer[0] == 0xEF) && (ucpBuffer[1] == 0xBB) && (ucpBuffer[2] == 0xBF)){
+            // skip the BOM
+            ucpBuffer += 3;
+            luiLength -= 3;
+        }
+    }else{
+        // not mappable, read it the usual way
+        vJsonReadFileInput(spJson, cpFileName);
+        ucpBuffer = (const uint8_t*)vpVecFirst(spJson->vpVecInput);
+        luiLength = (luint)uiVecLen(spJson->vpVecInput);
+    }
+    luiCount = luiLines(spJson, ucpBuffer, luiLength, uiThreads, uiFlags, pfnRecord, vpUserData);
+    vJsonLinesUnmap(spJson);
+    return luiCount;
+}
+
+/** \brief Unmap the JSON Lines file, if any. For internal use only.
+ * \param spJson Pointer to the JSON object context.
+ */
+void vJsonLinesUnmap(json* spJson){
+    if(spJson->vpLinesMap){
+        munmap(spJson->vpLinesMap, (size_t)spJson->luiLinesMapLength);
+        spJson->vpLinesMap = NULL;
+        spJson->luiLinesMapLength = 0;
+    }
+}
+
+/** \brief Divide the input into chunks, run the workers and report the records.
+ *
+ * Unordered, the calling thread is worker 0.
+ * Ordered, all of the workers have threads of their own and the calling thread reports the records.
+ * If no threads can be started, the calling thread reads the records itself, in order.
+ */
+static luint luiLines(json* spJson, const uint8_t* ucpBuffer, luint luiLength, aint uiThreads, aint uiFlags,
+        pfnJsonLineCallback pfnRecord, void* vpUserData){
+    lines_scan sScan = {};
+    lines_worker* spWorkers;
+    lines_slot* spSlots;
+    void* vpVecChunks;
+    exception sEx;
+    luint luiCount = 0;
+    aint ui, uiFirst;
+    if(!pfnRecord){
+        XTHROW(spJson->spException, "record callback function cannot be NULL");
+    }
+    if(uiThreads == 0){
+        long lProcessors = sysconf(_SC_NPROCESSORS_ONLN);
+        uiThreads = (lProcessors > 0) ? (aint)lProcessors : 1;
+    }
+    if(uiThreads > JSON_LINES_MAX_THREADS){
+        uiThreads = JSON_LINES_MAX_THREADS;
+    }
+    vpVecChunks = vpVecCtor(spJson->vpMem, sizeof(lines_chunk), 256);
+    vLinesChunks(vpVecChunks, ucpBuffer, luiLength, uiThreads);
+    sScan.spJson = spJson;
+    sScan.ucpBuffer = ucpBuffer;
+    sScan.spChunks = (lines_chunk*)vpVecFirst(vpVecChunks);
+    sScan.uiChunkCount = uiVecLen(vpVecChunks);
+    sScan.bLazy = (uiFlags & JSON_LINES_LAZY) ? APG_TRUE : APG_FALSE;
+    sScan.pfnRecord = pfnRecord;
+    sScan.vpUserData = vpUserData;
+    if(uiThreads > sScan.uiChunkCount){
+        uiThreads = sScan.uiChunkCount;
+    }
+    if(uiThreads == 0){
+        vVecDtor(vpVecChunks);
+        return 0;
+    }
+    // with one worker the records are in order anyway
+    sScan.bOrdered = ((uiFlags & JSON_LINES_ORDERED) && (uiThreads > 1)) ? APG_TRUE : APG_FALSE;
+    sScan.uiSlots = sScan.bOrdered ? LINES_SLOTS : 1;
+    spWorkers = (lines_worker*)vpMemAlloc(spJson->vpMem, (aint)(sizeof(lines_worker) * uiThreads));
+    memset((void*)spWorkers, 0, (sizeof(lines_worker) * uiThreads));
+    spSlots = (lines_slot*)vpMemAlloc(spJson->vpMem, (aint)(sizeof(lines_slot) * uiThreads * sScan.uiSlots));
+    memset((void*)spSlots, 0, (sizeof(lines_slot) * uiThreads * sScan.uiSlots));
+    for(ui = 0; ui < uiThreads; ui++){
+        spWorkers[ui].spScan = &sScan;
+        spWorkers[ui].spSlots = &spSlots[ui * sScan.uiSlots];
+        spWorkers[ui].uiIndex = ui;
+    }
+    pthread_mutex_init(&sScan.sMutex, NULL);
+    pthread_cond_init(&sScan.sCond, NULL);
+    uiFirst = sScan.bOrdered ? 0 : 1;
+    for(ui = uiFirst; ui < uiThreads; ui++){
+        if(pthread_create(&spWorkers[ui].sThread, NULL, vpLinesWorker, (void*)&spWorkers[ui]) != 0){
+            break;
+        }
+        spWorkers[ui].bStarted = APG_TRUE;
+    }
+    if(sScan.bOrdered && spWorkers[0].bStarted){
+        luiCount = luiLinesReport(&sScan, spWorkers);
+    }else{
+        if(sScan.bOrdered){
+            // no threads were started, worker 0 reads them all in order
+            sScan.bOrdered = APG_FALSE;
+        }
+        vpLinesWorker((void*)&spWorkers[0]);
+    }
+    for(ui = 0; ui < uiThreads; ui++){
+        if(spWorkers[ui].bStarted){
+            pthread_join(spWorkers[ui].sThread, NULL);
+        }
+        luiCount += spWorkers[ui].luiCount;
+    }
+    pthread_cond_destroy(&sScan.sCond);
+    pthread_mutex_destroy(&sScan.sMutex);
+    for(ui = 0; ui < (uiThreads * sScan.uiSlots); ui++){
+        vJsonDtor(spSlots[ui].vpJson);
+    }
+    vMemFree(spJson->vpMem, (void*)spSlots);
+    vMemFree(spJson->vpMem, (void*)spWorkers);
+    vVecDtor(vpVecChunks);
+    if(sScan.bError){
+        sEx = sScan.sError;
+        vExRethrow(&sEx, spJson->spException);
+    }
+    return luiCount;
+}
+
+/** \brief Divide the input into chunks of whole lines.
+ *
+ * The nominal length of a chunk gives each worker several chunks, for load balancing.
+ * Each chunk is extended to end just after the next line feed.
+ */
+static void vLinesChunks(void* vpVecChunks, const uint8_t* ucpBuffer, luint luiLength, aint uiThreads){
+    const uint8_t* ucpFound;
+    lines_chunk* spChunk;
+    luint luiBeg = 0;
+    luint luiEnd;
+    luint luiSize = luiLength / ((luint)uiThreads * 4);
+    if(luiSize < LINES_CHUNK_MIN){
+        luiSize = LINES_CHUNK_MIN;
+    }
+    while(luiBeg < luiLength){
+        luiEnd = luiBeg + luiSize;
+        if(luiEnd >= luiLength){
+            luiEnd = luiLength;
+        }else{
+            ucpFound = (const uint8_t*)memchr((const void*)(ucpBuffer + luiEnd), LF, (size_t)(luiLength - luiEnd));
+            luiEnd = ucpFound ? (luint)(ucpFound - ucpBuffer) + 1 : luiLength;
+        }
+        spChunk = (lines_chunk*)vpVecPush(vpVecChunks, NULL);
+        memset((void*)spChunk, 0, sizeof(*spChunk));
+        spChunk->luiBeg = luiBeg;
+        spChunk->luiEnd = luiEnd;
+        luiBeg = luiEnd;
+    }
+}
+
+/** \brief Take the next chunk to be read.
+ * \return Pointer to the chunk. NULL if there are no more or if reading has stopped.
+ */
+static lines_chunk* spLinesNextChunk(lines_worker* spWork){
+    lines_scan* spScan = spWork->spScan;
+    lines_chunk* spChunk = NULL;
+    pthread_mutex_lock(&spScan->sMutex);
+    if(!spScan->bStop && (spScan->uiNextChunk < spScan->uiChunkCount)){
+        spChunk = &spScan->spChunks[spScan->uiNextChunk++];
+        spChunk->uiWorker = spWork->uiIndex;
+        pthread_cond_broadcast(&spScan->sCond);
+    }
+    pthread_mutex_unlock(&spScan->sMutex);
+    return spChunk;
+}
+
+/** \brief The worker thread function. Reads chunks until there are no more.
+ */
+static void* vpLinesWorker(void* vpArg){
+    lines_worker* spWork = (lines_worker*)vpArg;
+    lines_chunk* spChunk;
+    while((spChunk = spLinesNextChunk(spWork)) != NULL){
+        if(!bLinesChunk(spWork, spChunk)){
+            break;
+        }
+    }
+    return NULL;
+}
+
+/** \brief Read the records of one chunk.
+ * \return True to go on to the next chunk, false if reading has stopped.
+ */
+static abool bLinesChunk(lines_worker* spWork, lines_chunk* spChunk){
+    lines_scan* spScan = spWork->spScan;
+    const uint8_t* ucpBuffer = spScan->ucpBuffer;
+    const uint8_t* ucpFound;
+    luint luiBeg = spChunk->luiBeg;
+    luint luiEnd, luiNext;
+    abool bReturn = APG_TRUE;
+    while(luiBeg < spChunk->luiEnd){
+        ucpFound = (const uint8_t*)memchr((const void*)(ucpBuffer + luiBeg), LF, (size_t)(spChunk->luiEnd - luiBeg));
+        luiEnd = ucpFound ? (luint)(ucpFound - ucpBuffer) : spChunk->luiEnd;
+        luiNext = ucpFound ? luiEnd + 1 : luiEnd;
+        // trim trailing white space, including the CR of CRLF, and skip blank lines
+        while((luiEnd > luiBeg) && ((ucpBuffer[luiEnd - 1] == 32) || (ucpBuffer[luiEnd - 1] == TAB) || (ucpBuffer[luiEnd - 1] == CR))){
+            luiEnd--;
+        }
+        if(luiEnd > luiBeg){
+            if(!bLinesRecord(spWork, spChunk, luiBeg, luiEnd - luiBeg)){
+                bReturn = APG_FALSE;
+                break;
+            }
+        }
+        luiBeg = luiNext;
+    }
+    if(spScan->bOrdered){
+        pthread_mutex_lock(&spScan->sMutex);
+        spChunk->bDone = APG_TRUE;
+        pthread_cond_broadcast(&spScan->sCond);
+        pthread_mutex_unlock(&spScan->sMutex);
+    }
+    return bReturn;
+}
+
+/** \brief Read one record and, if unordered, report it.
+ *
+ * Ordered, the record is read into the next JSON object of the worker's ring, waiting for it to be free if necessary,
+ * and is left for the calling thread to report.
+ * \return True to go on to the next record, false if reading has stopped.
+ */
+static abool bLinesRecord(lines_worker* spWork, lines_chunk* spChunk, luint luiOffset, luint luiLength){
+    lines_scan* spScan = spWork->spScan;
+    lines_slot* spSlot;
+    abool bReturn;
+    if(spScan->bOrdered){
+        pthread_mutex_lock(&spScan->sMutex);
+        while(!spScan->bStop && ((spWork->uiFilled - spWork->uiReported) == spScan->uiSlots)){
+            pthread_cond_wait(&spScan->sCond, &spScan->sMutex);
+        }
+        bReturn = !spScan->bStop;
+        pthread_mutex_unlock(&spScan->sMutex);
+        if(!bReturn){
+            return APG_FALSE;
+        }
+    }
+    spSlot = &spWork->spSlots[spWork->uiFilled % spScan->uiSlots];
+    if(!bLinesRead(spScan, spSlot, luiOffset, luiLength)){
+        return APG_FALSE;
+    }
+    spSlot->uiChunk = (aint)(spChunk - spScan->spChunks);
+    if(spScan->bOrdered){
+        pthread_mutex_lock(&spScan->sMutex);
+        spWork->uiFilled++;
+        pthread_cond_broadcast(&spScan->sCond);
+        bReturn = !spScan->bStop;
+        pthread_mutex_unlock(&spScan->sMutex);
+        return bReturn;
+    }
+    spWork->luiCount++;
+    bReturn = bLinesCall(spScan, spSlot);
+    pthread_mutex_lock(&spScan->sMutex);
+    if(!bReturn){
+        spScan->bStop = APG_TRUE;
+    }
+    bReturn = !spScan->bStop;
+    pthread_mutex_unlock(&spScan->sMutex);
+    return bReturn;
+}
+
+/** \brief Read one record into a JSON object, constructing the object if necessary.
+ * \return True on success, false if an exception was thrown.
+ */
+static abool bLinesRead(lines_scan* spScan, lines_slot* spSlot, luint luiOffset, luint luiLength){
+    json* spJson;
+    spSlot->luiOffset = luiOffset;
+    XCTOR(spSlot->sException);
+    if(spSlot->sException.try){
+        if(!spSlot->vpJson){
+            spSlot->vpJson = vpJsonCtor(&spSlot->sException);
+            spJson = (json*)spSlot->vpJson;
+            spJson->bUtf8 = spScan->spJson->bUtf8;
+            spJson->bKeyIndexAll = spScan->spJson->bKeyIndexAll;
+        }
+        if(luiLength > (luint)APG_MAX_AINT){
+            XTHROW(&spSlot->sException, "record is too long");
+        }
+        spSlot->spRoot = spJsonReadRecord((json*)spSlot->vpJson, spScan->ucpBuffer + luiOffset, (aint)luiLength, spScan->bLazy);
+        return APG_TRUE;
+    }
+    vLinesStop(spScan, &spSlot->sException, spSlot->luiOffset);
+    return APG_FALSE;
+}
+
+/** \brief Report one record to the callback function.
+ *
+ * Errors thrown by the record's JSON object while in the callback function are caught here, by the reporting thread.
+ * \return The return of the callback function. True to continue, false to stop.
+ */
+static abool bLinesCall(lines_scan* spScan, lines_slot* spSlot){
+    XCTOR(spSlot->sException);
+    if(spSlot->sException.try){
+        return spScan->pfnRecord(spSlot->vpJson, spSlot->spRoot, spSlot->luiOffset, spScan->vpUserData);
+    }
+    vLinesStop(spScan, &spSlot->sException, spSlot->luiOffset);
+    return APG_FALSE;
+}
+
+/** \brief Report the records of an ordered read, chunk by chunk, from the workers' rings.
+ *
+ * A worker's ring holds its records in the order read, so the records of its earlier chunks come first.
+ * If the next record in the ring is from a later chunk, the current chunk is done.
+ * \return The number of records reported.
+ */
+static luint luiLinesReport(lines_scan* spScan, lines_worker* spWorkers){
+    lines_chunk* spChunk;
+    lines_worker* spWork;
+    lines_slot* spSlot;
+    luint luiCount = 0;
+    aint ui;
+    abool bContinue;
+    pthread_mutex_lock(&spScan->sMutex);
+    for(ui = 0; !spScan->bStop && (ui < spScan->uiChunkCount); ui++){
+        spChunk = &spScan->spChunks[ui];
+        while(!spScan->bStop && (ui >= spScan->uiNextChunk)){
+            // wait for a worker to take the chunk
+            pthread_cond_wait(&spScan->sCond, &spScan->sMutex);
+        }
+        spWork = &spWorkers[spChunk->uiWorker];
+        while(!spScan->bStop){
+            if(spWork->uiReported < spWork->uiFilled){
+                spSlot = &spWork->spSlots[spWork->uiReported % spScan->uiSlots];
+                if(spSlot->uiChunk == ui){
+                    pthread_mutex_unlock(&spScan->sMutex);
+                    luiCount++;
+                    bContinue = bLinesCall(spScan, spSlot);
+                    pthread_mutex_lock(&spScan->sMutex);
+                    spWork->uiReported++;
+                    if(!bContinue){
+                        spScan->bStop = APG_TRUE;
+                    }
+                    pthread_cond_broadcast(&spScan->sCond);
+                    continue;
+                }
+            }
+            if(spChunk->bDone){
+                break;
+            }
+            pthread_cond_wait(&spScan->sCond, &spScan->sMutex);
+        }
+    }
+    pthread_mutex_unlock(&spScan->sMutex);
+    return luiCount;
+}
+
+/** \brief Stop all reading on an error. Only the first error is kept, with the offset of its record.
+ */
+static void vLinesStop(lines_scan* spScan, exception* spEx, luint luiOffset){
+    char caMsg[sizeof(spEx->caMsg)];
+    pthread_mutex_lock(&spScan->sMutex);
+    if(!spScan->bError){
+        spScan->sError = *spEx;
+        // leave room for the prefix, the offset has at most 20 digits
+        snprintf(caMsg, sizeof(caMsg), "JSON Lines record at offset %"PRIuMAX": %.*s", luiOffset,
+                (int)(sizeof(caMsg) - 64), spEx->caMsg);
+        memcpy((void*)spScan->sError.caMsg, (void*)caMsg, sizeof(caMsg));
+        spScan->bError = APG_TRUE;
+    }
+    spScan->bStop = APG_TRUE;
+    pthread_cond_broadcast(&spScan->sCond);
+    pthread_mutex_unlock(&spScan->sMutex);
+}
@@ -71,6 +71,46 @@ uint32_t uiUtf8_4byte(char* cpBytes){
     uiChar += (uint32_t)cpBytes[3] & 0x3f;
     return uiChar;
 }
+aint uiUtf8Encode(uint32_t uiChar, uint8_t* ucpBytes){
+    if(uiChar < 0x80){
+        ucpBytes[0] = (uint8_t)uiChar;
+        return 1;
+    }
+    if(uiChar < 0x800){
+        ucpBytes[0] = (uint8_t)(0xC0 | (uiChar >> 6));
+        ucpBytes[1] = (uint8_t)(0x80 | (uiChar & 0x3F));
+        return 2;
+    }
+    if(uiChar < 0x10000){
+        ucpBytes[0] = (uint8_t)(0xE0 | (uiChar >> 12));
+        ucpBytes[1] = (uint8_t)(0x80 | ((uiChar >> 6) & 0x3F));
+        ucpBytes[2] = (uint8_t)(0x80 | (uiChar & 0x3F));
+        return 3;
+    }
+    ucpBytes[0] = (uint8_t)(0xF0 | (uiChar >> 18));
+    ucpBytes[1] = (uint8_t)(0x80 | ((uiChar >> 12) & 0x3F));
+    ucpBytes[2] = (uint8_t)(0x80 | ((uiChar >> 6) & 0x3F));
+    ucpBytes[3] = (uint8_t)(0x80 | (uiChar & 0x3F));
+    return 4;
+}
+aint uiUtf8Decode(const uint8_t* ucpBytes, uint32_t* uipChar){
+    uint32_t uiChar = ucpBytes[0];
+    if(uiChar < 0x80){
+        *uipChar = uiChar;
+        return 1;
+    }
+    if(uiChar < 0xE0){
+        *uipChar = ((uiChar & 0x1F) << 6) | (ucpBytes[1] & 0x3F);
+        return 2;
+    }
+    if(uiChar < 0xF0){
+        *uipChar = ((uiChar & 0x0F) << 12) | ((uint32_t)(ucpBytes[1] & 0x3F) << 6) | (ucpBytes[2] & 0x3F);
+        return 3;
+    }
+    *uipChar = ((uiChar & 0x07) << 18) | ((uint32_t)(ucpBytes[1] & 0x3F) << 12)
+            | ((uint32_t)(ucpBytes[2] & 0x3F) << 6) | (ucpBytes[3] & 0x3F);
+    return 4;
+}
 aint uiUtf16_1(char* cpHex, uint32_t* uipChar){
     char* cpPtr;
     *uipChar = (uint32_t)strtol(cpHex, &cpPtr, 16);
@@ -105,7 +145,7 @@ static void vThrowError(json* spJson, char* cpMsg, aint uiOffset,
         const char* cpFile, const char* cpFunc, unsigned int uiCodeLine){
     aint uiLine, uiRelOffset;
     char caBuf[1024];
-    if(bLinesFindLine(spJson->vpLines, uiOffset, &uiLine, &uiRelOffset)){
+    if(bLinesFindLine(vpJsonLines(spJson), uiOffset, &uiLine, &uiRelOffset)){
         snprintf(caBuf, 1024,
                 "%s: near: line: %"PRIuMAX": character: %"PRIuMAX" (0x%"PRIXMAX")",
                 cpMsg, (luint)uiLine, (luint)uiRelOffset, (luint)uiRelOffset);
@@ -122,9 +162,19 @@ static void vPushFrameAndValue(callback_data* spData){
     frame* spCurrent = (frame*)vpVecPush(spJson->vpVecFrames, NULL);
     memset((void*)spCurrent, 0, sizeof(frame));
     spCurrent->uiNextKey = APG_UNDEFINED;
-    spCurrent->vpVecIndexes = vpVecCtor(spJson->vpMem, sizeof(aint), 128);
+    // reuse the child index vector previously constructed for this stack depth, if any
+    aint uiDepth = uiVecLen(spJson->vpVecFrames) - 1;
+    void** vppIndexes = (void**)vpVecAt(spJson->vpVecFrameIndexes, uiDepth);
+    if(vppIndexes){
+        spCurrent->vpVecIndexes = *vppIndexes;
+        vVecClear(spCurrent->vpVecIndexes);
+    }else{
+        spCurrent->vpVecIndexes = vpVecCtor(spJson->vpMem, sizeof(aint), 128);
+        vpVecPush(spJson->vpVecFrameIndexes, &spCurrent->vpVecIndexes);
+    }
     spCurrent->uiValue = uiVecLen(spJson->vpVecValuesr);
     value_r* spValuer = (value_r*)vpVecPush(spJson->vpVecValuesr, NULL);
+    memset((void*)spValuer, 0, sizeof(value_r));
     if(spPrev){
         spValuer->uiKey = spPrev->uiNextKey;
     }else{
@@ -142,7 +192,6 @@ static void vPopFrame(callback_data* spData){
         if(spFrame != spJson->spCurrentFrame){
             THROW_ERROR("popped frame not same as current frame", spData->uiParserOffset);
         }
-        vVecDtor(spFrame->vpVecIndexes);
         spJson->spCurrentFrame = (frame*)vpVecLast(spJson->vpVecFrames);
     }
 }
@@ -154,93 +203,60 @@ static value_r* spFrameValue(json* spJson, frame* spFrame, aint uiOffset){
     }
     return spValuer;
 }
-static abool bMultiplyUint(uint64_t uiL, uint64_t uiR, uint64_t* uipA){
-    if(uiL == 0 || uiR == 0){
-        *uipA = 0;
-        return APG_SUCCESS;
-    }
-    uint64_t uiTest = uiL * uiR;
-    uint64_t uiCheck = uiTest / uiR;
-    if(uiCheck != uiL){
-        return APG_FAILURE;
-    }
-    *uipA = uiTest;
-    return APG_SUCCESS;
+// the tree depth of the value of the current frame, the root value is at depth zero
+static aint uiFrameDepth(json* spJson){
+    return uiVecLen(spJson->vpVecFrames) - 1;
 }
-
-static abool bSumUint(uint64_t uiL, uint64_t uiR, uint64_t* uipA){
-    uint64_t uiTest = uiL + uiR;
-    if(uiTest < uiR){
-        return APG_FAILURE;
-    }
-    uint64_t uiCheck = uiTest - uiR;
-    if(uiCheck != uiL){
-        return APG_FAILURE;
-    }
-    *uipA = uiTest;
-    return APG_SUCCESS;
-}
-static abool bMultiplyInt(int64_t iL, int64_t iR, int64_t * ipA){
-    if(iL == 0 || iR == 0){
-        *ipA = 0;
-        return APG_SUCCESS;
-    }
-    int64_t iTest = iL * iR;
-    if(iTest < 0){
-        return APG_FAILURE;
-    }
-    *ipA = iTest;
-    return APG_SUCCESS;
-}
-static abool bSumInt(int64_t iL, int64_t iR, int64_t* ipA){
-    int64_t iTest = iL + iR;
-    if(iTest < 0){
-        return APG_FAILURE;
-    }
-    *ipA = iTest;
-    return APG_SUCCESS;
-}
-static abool bStringToInt(char* cpString, int64_t* ipInt){
-    abool bReturn = APG_FAILURE;
-    *ipInt = 0;
-    while(APG_TRUE){
-        char* cpEnd = cpString + strlen(cpString);
-        int64_t iVal = *cpString++ - 48;
-        while(cpString < cpEnd){
-            if(!bMultiplyInt(iVal, 10LL, &iVal)){
-                goto fail;
-            }
-            if(!bSumInt(iVal, (int64_t)(*cpString++ - 48), &iVal)){
-                goto fail;
-            }
+/** \brief Scan a number with the grammar's `number` rule.
+ *
+ * `number = [ minus / plus ] ((int [ frac ])/ frac-only) [ exp ]`
+ *
+ * The whole rule is matched here, in a single pass, in place of its component rules.
+ * The error productions, plus, frac-only and a missing frac-digits, throw the same errors as their rule callbacks did.
+ * \return The length of the number, or zero if no number begins at the offset.
+ */
+static aint uiNumberScan(json* spJson, const uint8_t* ucpInput, aint uiLength, aint uiOffset){
+    aint ui = uiOffset;
+    aint uiDigits;
+    abool bInt = APG_FALSE;
+    if(ui < uiLength){
+        if(ucpInput[ui] == 0x2D){
+            ui++;
+        }else if(ucpInput[ui] == 0x2B){
+            THROW_ERROR("Leading plus (+) sign not allowed for decimal portion of floating point number (REF8259)", ui);
         }
-        *ipInt = iVal;
-        bReturn = APG_SUCCESS;
-        break;
-    }
-    fail:;
-    return bReturn;
-}
-static abool bStringToUint(char* cpString, uint64_t* uipInt){
-    abool bReturn = APG_FAILURE;
-    *uipInt = 0;
-    while(APG_TRUE){
-        char* cpEnd = cpString + strlen(cpString);
-        uint64_t uiVal = *cpString++ - 48;
-        while(cpString < cpEnd){
-            if(!bMultiplyUint(uiVal, 10LL, &uiVal)){
-                goto fail;
-            }
-            if(!bSumUint(uiVal, (int64_t)(*cpString++ - 48), &uiVal)){
-                goto fail;
-            }
+    }
+    if((ui < uiLength) && (ucpInput[ui] == 0x30)){
+        bInt = APG_TRUE;
+        ui++;
+    }else if((ui < uiLength) && (ucpInput[ui] >= 0x31) && (ucpInput[ui] <= 0x39)){
+        bInt = APG_TRUE;
+        for(ui++; (ui < uiLength) && (ucpInput[ui] >= 0x30) && (ucpInput[ui] <= 0x39); ui++){}
+    }
+    if((ui < uiLength) && (ucpInput[ui] == 0x2E)){
+        for(uiDigits = 0; ((ui + 1 + uiDigits) < uiLength) && (ucpInput[ui + 1 + uiDigits] >= 0x30)
+                && (ucpInput[ui + 1 + uiDigits] <= 0x39); uiDigits++){}
+        if(!uiDigits){
+            THROW_ERROR("A decimal point must be followed by one or more digits (REF8259)", (ui + 1));
+        }
+        if(!bInt){
+            THROW_ERROR("Fraction found with no leading integer. Not allowed by RFC 8259.", ui);
+        }
+        ui += 1 + uiDigits;
+    }else if(!bInt){
+        return 0;
+    }
+    if((ui < uiLength) && ((ucpInput[ui] == 0x65) || (ucpInput[ui] == 0x45))){
+        aint uiExp = ui + 1;
+        if((uiExp < uiLength) && ((ucpInput[uiExp] == 0x2D) || (ucpInput[uiExp] == 0x2B))){
+            uiExp++;
+        }
+        for(uiDigits = 0; (uiExp < uiLength) && (ucpInput[uiExp] >= 0x30) && (ucpInput[uiExp] <= 0x39); uiExp++, uiDigits++){}
+        if(uiDigits){
+            ui = uiExp;
         }
-        *uipInt = uiVal;
-        bReturn = APG_SUCCESS;
-        break;
     }
-    fail:;
-    return bReturn;
+    return ui - uiOffset;
 }
 /*********************************************************
  * helper functions
@@ -262,11 +278,21 @@ static void vJsonText(callback_data* spData){
         vVecClear(spJson->vpVecFrames);
         vVecClear(spJson->vpVecValues);
         vVecClear(spJson->vpVecStrings);
+        vVecClear(spJson->vpVecUtf8);
+        vVecClear(spJson->vpVecStrings8);
         vVecClear(spJson->vpVecChildPointers);
     }else if(spData->uiParserState == ID_MATCH){
         if(spData->uiParserPhraseLength < spData->uiStringLength){
             THROW_ERROR("parser did not match the entire document", spData->uiParserOffset);
         }
+        if(!spJson->bTree){
+            // values have only been reported to the event callbacks
+            spJson->spValues = NULL;
+            spJson->uiValueCount = 0;
+            spJson->spStrings = NULL;
+            spJson->uiStringCount = 0;
+            return;
+        }
         char caBuf[64];
         // convert relative values to absolute values
         uint32_t* uipChars = (uint32_t*)vpVecFirst(spJson->vpVecChars);
@@ -284,15 +310,37 @@ static void vJsonText(callback_data* spData){
         aint* uipChildList;
         aint ui;
 
-        // allocate the child value pointer list
-        spJson->sppChildPointers = (struct json_value_tag**)vpVecPushn(spJson->vpVecChildPointers, NULL, uiChildCount);
+        // allocate the child value pointer list (a document of a single, scalar value has none)
+        spJson->sppChildPointers = NULL;
+        if(uiChildCount){
+            spJson->sppChildPointers = (struct json_value_tag**)vpVecPushn(spJson->vpVecChildPointers, NULL, uiChildCount);
+        }
 
         // allocate the strings and convert all relative strings to absolute
-        spJson->spStrings = (u32_phrase*)vpVecPushn(spJson->vpVecStrings, NULL, spJson->uiStringCount);
+        spJson->spStrings = NULL;
+        if(spJson->uiStringCount){
+            spJson->spStrings = (u32_phrase*)vpVecPushn(spJson->vpVecStrings, NULL, spJson->uiStringCount);
+        }
         u32_phrase* spString = spJson->spStrings;
-        for(; spStringrBeg < spStringrEnd; spStringrBeg++, spString++){
-            spString->uiLength = spStringrBeg->uiLength;
-            spString->uipPhrase = uipChars + spStringrBeg->uiCharsOffset;
+        spJson->spStrings8 = NULL;
+        if(spJson->bUtf8Tree){
+            // the 32-bit strings are left empty until requested
+            const uint8_t* ucpInput = (const uint8_t*)vpVecFirst(spJson->vpVecInput);
+            const uint8_t* ucpUtf8 = (const uint8_t*)vpVecFirst(spJson->vpVecUtf8);
+            if(spJson->uiStringCount){
+                memset((void*)spJson->spStrings, 0, (sizeof(u32_phrase) * spJson->uiStringCount));
+                spJson->spStrings8 = (u8_phrase*)vpVecPushn(spJson->vpVecStrings8, NULL, spJson->uiStringCount);
+            }
+            u8_phrase* spString8 = spJson->spStrings8;
+            for(; spStringrBeg < spStringrEnd; spStringrBeg++, spString8++){
+                spString8->uiLength = spStringrBeg->uiUtf8Length;
+                spString8->ucpPhrase = (spStringrBeg->bInput ? ucpInput : ucpUtf8) + spStringrBeg->uiUtf8Offset;
+            }
+        }else{
+            for(; spStringrBeg < spStringrEnd; spStringrBeg++, spString++){
+                spString->uiLength = spStringrBeg->uiLength;
+                spString->uipPhrase = uipChars + spStringrBeg->uiCharsOffset;
+            }
         }
 
         // allocate the values and convert relative indexes to absolute pointers
@@ -304,6 +352,8 @@ static void vJsonText(callback_data* spData){
             spValue->uiId = spValuerBeg->uiId;
             if(spValuerBeg->uiKey == APG_UNDEFINED){
                 spValue->spKey = NULL;
+            }else if(spJson->bUtf8Tree){
+                spValue->spKey8 = &spJson->spStrings8[spValuerBeg->uiKey];
             }else{
                 spValue->spKey = &spJson->spStrings[spValuerBeg->uiKey];
             }
@@ -311,7 +361,11 @@ static void vJsonText(callback_data* spData){
             spValue->uiChildCount = 0;
             switch(spValuerBeg->uiId){
             case JSON_ID_STRING:
-                spValue->spString = &spJson->spStrings[spValuerBeg->uiString];
+                if(spJson->bUtf8Tree){
+                    spValue->spString8 = &spJson->spStrings8[spValuerBeg->uiString];
+                }else{
+                    spValue->spString = &spJson->spStrings[spValuerBeg->uiString];
+                }
                 break;
             case JSON_ID_TRUE:
             case JSON_ID_FALSE:
@@ -325,7 +379,7 @@ static void vJsonText(callback_data* spData){
                 // convert the array of child indexes to an array of absolute pointers
                 uipChildList = &uipChildIndexes[spValuerBeg->uiChildListOffset];
                 spValue->uiChildCount = spValuerBeg->uiChildCount;
-                spValue->sppChildren = &spJson->sppChildPointers[uiChildPointerTop];
+                spValue->sppChildren = spValue->uiChildCount ? &spJson->sppChildPointers[uiChildPointerTop] : NULL;
                 for(ui = 0; ui < spValuerBeg->uiChildCount; ui++, uipChildList++){
                     spJson->sppChildPointers[uiChildPointerTop++] = (struct json_value_tag*)(spJson->spValues + *uipChildList);
                 }
@@ -350,6 +404,24 @@ static void vValue(callback_data* spData){
         frame* spFrame = spJson->spCurrentFrame;
         aint uiValueIndex = spFrame->uiValue;
         value_r* spValue = spFrameValue(spJson, spFrame, spData->uiParserOffset);
+        if(spValue->uiId == JSON_ID_OBJECT){
+            if(spJson->pfnObjectEnd){
+                spJson->pfnObjectEnd(uiFrameDepth(spJson), spFrame->uiChildCount, spJson->vpObjectEndData);
+            }
+        }else if(spValue->uiId == JSON_ID_ARRAY){
+            if(spJson->pfnArrayEnd){
+                spJson->pfnArrayEnd(uiFrameDepth(spJson), spFrame->uiChildCount, spJson->vpArrayEndData);
+            }
+        }
+        if(!spJson->bTree){
+            // the value is complete and all of its children have already been popped
+            vPopFrame(spData);
+            vpVecPop(spJson->vpVecValuesr);
+            if(spJson->spCurrentFrame){
+                spJson->spCurrentFrame->uiChildCount++;
+            }
+            return;
+        }
         spValue->uiChildCount = uiVecLen(spFrame->vpVecIndexes);
         if(spValue->uiChildCount){
             // copy the vector of indexes
@@ -366,6 +438,7 @@ static void vValue(callback_data* spData){
         if(spJson->spCurrentFrame){
             // report this value as a child of the parent value
             vpVecPush(spJson->spCurrentFrame->vpVecIndexes, &uiValueIndex);
+            spJson->spCurrentFrame->uiChildCount++;
         }
     }else if(spData->uiParserState == ID_NOMATCH){
         // pop value and frame
@@ -391,6 +464,9 @@ static void vObjectBegin(callback_data* spData){
         frame* spFrame = spJson->spCurrentFrame;
         value_r* spValue = spFrameValue(spJson, spFrame, spData->uiParserOffset);
         spValue->uiId = JSON_ID_OBJECT;
+        if(spJson->pfnObjectBegin){
+            spJson->pfnObjectBegin(uiFrameDepth(spJson), 0, spJson->vpObjectBeginData);
+        }
     }
 }
 static void vObjectEnd(callback_data* spData){
@@ -405,6 +481,9 @@ static void vArrayBegin(callback_data* spData){
         frame* spFrame = spJson->spCurrentFrame;
         value_r* spValue = spFrameValue(spJson, spFrame, spData->uiParserOffset);
         spValue->uiId = JSON_ID_ARRAY;
+        if(spJson->pfnArrayBegin){
+            spJson->pfnArrayBegin(uiFrameDepth(spJson), 0, spJson->vpArrayBeginData);
+        }
     }
 }
 static void vArrayEnd(callback_data* spData){
@@ -419,6 +498,9 @@ static void vFalse(callback_data* spData){
         frame* spFrame = spJson->spCurrentFrame;
         value_r* spValue = spFrameValue(spJson, spFrame, spData->uiParserOffset);
         spValue->uiId = JSON_ID_FALSE;
+        if(spJson->pfnLiteral){
+            spJson->pfnLiteral(JSON_ID_FALSE, uiFrameDepth(spJson), spJson->vpLiteralData);
+        }
     }
 }
 static void vTrue(callback_data* spData){
@@ -427,6 +509,9 @@ static void vTrue(callback_data* spData){
         frame* spFrame = spJson->spCurrentFrame;
         value_r* spValue = spFrameValue(spJson, spFrame, spData->uiParserOffset);
         spValue->uiId = JSON_ID_TRUE;
+        if(spJson->pfnLiteral){
+            spJson->pfnLiteral(JSON_ID_TRUE, uiFrameDepth(spJson), spJson->vpLiteralData);
+        }
     }
 }
 static void vNull(callback_data* spData){
@@ -435,11 +520,20 @@ static void vNull(callback_data* spData){
         frame* spFrame = spJson->spCurrentFrame;
         value_r* spValue = spFrameValue(spJson, spFrame, spData->uiParserOffset);
         spValue->uiId = JSON_ID_NULL;
+        if(spJson->pfnLiteral){
+            spJson->pfnLiteral(JSON_ID_NULL, uiFrameDepth(spJson), spJson->vpLiteralData);
+        }
     }
 }
 static void vKeyBegin(callback_data* spData){
     if(spData->uiParserState == ID_MATCH){
         json* spJson = (json*)spData->vpUserData;
+        spJson->bKey = APG_TRUE;
+        if(!spJson->bTree){
+            // the previous string has already been reported
+            vVecClear(spJson->vpVecStringsr);
+            vVecClear(spJson->vpVecChars);
+        }
         spJson->spCurrentFrame->uiNextKey = uiVecLen(spJson->vpVecStringsr);
 
         // push a new string and initialize it
@@ -453,6 +547,12 @@ static void vStringBegin(callback_data* spData){
         frame* spFrame = spJson->spCurrentFrame;
         value_r* spValue = spFrameValue(spJson, spFrame, spData->uiParserOffset);
         spValue->uiId = JSON_ID_STRING;
+        spJson->bKey = APG_FALSE;
+        if(!spJson->bTree){
+            // the previous string has already been reported
+            vVecClear(spJson->vpVecStringsr);
+            vVecClear(spJson->vpVecChars);
+        }
         spValue->uiString = uiVecLen(spJson->vpVecStringsr);
 
         // push a new string and initialize it
@@ -466,11 +566,62 @@ static void vStringEnd(callback_data* spData){
         THROW_ERROR("Expected close of string not found.", spData->uiParserOffset);
     }
 }
+/* For UTF-8 strings, keep only the location of the string's UTF-8 bytes, not its 32-bit characters.
+ * A string without escaped characters is exactly the input phrase.
+ */
+static void vUtf8String(callback_data* spData, string_r* spString){
+    json* spJson = (json*)spData->vpUserData;
+    const achar* acpPhrase = &spData->acpString[spData->uiParserOffset];
+    aint ui = 0;
+    for(; ui < spData->uiParserPhraseLength; ui++){
+        if(acpPhrase[ui] == 0x5C){
+            break;
+        }
+    }
+    if(ui == spData->uiParserPhraseLength){
+        spString->bInput = APG_TRUE;
+        spString->uiUtf8Offset = spData->uiParserOffset;
+        spString->uiUtf8Length = spData->uiParserPhraseLength;
+    }else{
+        // an escaped character never has more UTF-8 bytes than its escape sequence
+        const uint32_t* uipChars = (const uint32_t*)vpVecFirst(spJson->vpVecChars) + spString->uiCharsOffset;
+        spString->bInput = APG_FALSE;
+        spString->uiUtf8Offset = uiVecLen(spJson->vpVecUtf8);
+        uint8_t* ucpBytes = (uint8_t*)vpVecPushn(spJson->vpVecUtf8, NULL, spData->uiParserPhraseLength);
+        uint8_t* ucpNext = ucpBytes;
+        for(ui = 0; ui < spString->uiLength; ui++){
+            ucpNext += uiUtf8Encode(uipChars[ui], ucpNext);
+        }
+        spString->uiUtf8Length = (aint)(ucpNext - ucpBytes);
+        vpVecPopi(spJson->vpVecUtf8, spString->uiUtf8Offset + spString->uiUtf8Length);
+    }
+
+    // the 32-bit characters are no longer needed
+    vpVecPopi(spJson->vpVecChars, spString->uiCharsOffset);
+    spString->uiLength = 0;
+}
 static void vStringContent(callback_data* spData){
     if(spData->uiParserState == ID_MATCH){
         json* spJson = (json*)spData->vpUserData;
         string_r* spString = (string_r*)vpVecLast(spJson->vpVecStringsr);
         spString->uiLength = uiVecLen(spJson->vpVecChars) - spString->uiCharsOffset;
+        pfnJsonStringCallback pfnString = spJson->bKey ? spJson->pfnKey : spJson->pfnString;
+        if(pfnString){
+            static const uint32_t uiEmpty = 0;
+            const uint32_t* uipChars = (const uint32_t*)vpVecFirst(spJson->vpVecChars);
+            u32_phrase sString;
+            sString.uipPhrase = uipChars ? (uipChars + spString->uiCharsOffset) : &uiEmpty;
+            sString.uiLength = (uint32_t)spString->uiLength;
+            if(spJson->bKey){
+                // the key names a member value one level below the object
+                pfnString(&sString, uiFrameDepth(spJson) + 1, spJson->vpKeyData);
+            }else{
+                pfnString(&sString, uiFrameDepth(spJson), spJson->vpStringData);
+            }
+        }
+        if(spJson->bTree && spJson->bUtf8Tree){
+            vUtf8String(spData, spString);
+        }
     }
 }
 static void vChar(callback_data* spData){
@@ -618,87 +769,46 @@ static void vUtf162(callback_data* spData){
         }
     }
 }
+/** \brief The `number` rule callback.
+ *
+ * The number is scanned and converted when the parser first reaches the rule, going down the tree.
+ * The parser accepts the result and skips the rule's sub-tree of component rules entirely.
+ */
 static void vNumber(callback_data* spData){
     if(spData->uiParserState == ID_ACTIVE){
-        json* spJson = (json*)spData->vpUserData;
-        spJson->bHasFrac = APG_FALSE;
-        spJson->bHasMinus = APG_FALSE;
-    }else if(spData->uiParserState == ID_MATCH){
         json* spJson = (json*)spData->vpUserData;
         char caBuf[128];
+        const uint8_t* ucpInput = (const uint8_t*)vpVecFirst(spJson->vpVecInput);
+        aint uiLength = uiNumberScan(spJson, ucpInput, uiVecLen(spJson->vpVecInput), spData->uiParserOffset);
+        if(!uiLength){
+            spData->uiCallbackState = ID_NOMATCH;
+            return;
+        }
         value_r* spValue = spFrameValue(spJson, spJson->spCurrentFrame, spData->uiParserOffset);
         spValue->uiId = JSON_ID_NUMBER;
-        spValue->uiNumber = uiVecLen(spJson->vpVecNumbers);
-        json_number* spNumber = (json_number*)vpVecPush(spJson->vpVecNumbers, NULL);
-        // use the top of vpVecAscii as a working string
-        aint uiTop = uiVecLen(spJson->vpVecAscii);
-        char* cpNumber = (char*)vpVecPushn(spJson->vpVecAscii, NULL, (spData->uiParserPhraseLength + 1));
-        aint ui = 0;
-        char* cpPtr;
-        const achar* acpParsed = &spData->acpString[spData->uiParserOffset];
-        for(;ui < spData->uiParserPhraseLength; ui++){
-            cpNumber[ui] = (char)acpParsed[ui];
-        }
-        cpNumber[ui] = 0;
-        while(APG_TRUE){
-            if(spJson->bHasFrac){
-                spNumber->dFloat = strtod(cpNumber, &cpPtr);
-                if(cpPtr > cpNumber){
-                    spNumber->uiType = JSON_ID_FLOAT;
-                    break;
-                }
-                snprintf(caBuf, 128, "Unable to convert floating point string with \"strtod()\": %s", cpNumber);
-                THROW_ERROR(caBuf, spData->uiParserOffset);
-                break;
-            }
-            if(spJson->bHasMinus){
-                if(!bStringToInt(&cpNumber[1], &spNumber->iSigned)){
-                    snprintf(caBuf, 128, "Integer value too large to convert to int: %s", cpNumber);
-                    THROW_ERROR(caBuf, spData->uiParserOffset);
-                }
-                spNumber->iSigned = -spNumber->iSigned;
-                spNumber->uiType = JSON_ID_SIGNED;
-                break;
-            }
-            if(!bStringToUint(cpNumber, &spNumber->uiUnsigned)){
-                snprintf(caBuf, 128, "Integer value too large to convert to unsigned int: %s", cpNumber);
-                THROW_ERROR(caBuf, spData->uiParserOffset);
-            }
-            spNumber->uiType = JSON_ID_UNSIGNED;
+        json_number sNumber;
+        json_number* spNumber = &sNumber;
+        if(spJson->bTree){
+            spValue->uiNumber = uiVecLen(spJson->vpVecNumbers);
+            spNumber = (json_number*)vpVecPush(spJson->vpVecNumbers, NULL);
+        }
+        switch(uiJsonNumberDecode(spJson, &ucpInput[spData->uiParserOffset], uiLength, spNumber)){
+        case JSON_NUMBER_SIGNED_RANGE:
+            snprintf(caBuf, 128, "Integer value too large to convert to int: %.*s",
+                    (int)uiLength, (const char*)&ucpInput[spData->uiParserOffset]);
+            THROW_ERROR(caBuf, spData->uiParserOffset);
+            break;
+        case JSON_NUMBER_UNSIGNED_RANGE:
+            snprintf(caBuf, 128, "Integer value too large to convert to unsigned int: %.*s",
+                    (int)uiLength, (const char*)&ucpInput[spData->uiParserOffset]);
+            THROW_ERROR(caBuf, spData->uiParserOffset);
             break;
         }
-        // pop off the working string
-        vpVecPopi(spJson->vpVecAscii, uiTop);
-    }
-}
-static void vFracOnly(callback_data* spData){
-    if(spData->uiParserState == ID_MATCH){
-        json* spJson = (json*)spData->vpUserData;
-        THROW_ERROR("Fraction found with no leading integer. Not allowed by RFC 8259.", spData->uiParserOffset);
-    }
-}
-static void vFrac(callback_data* spData){
-    if(spData->uiParserState == ID_MATCH){
-        json* spJson = (json*)spData->vpUserData;
-        spJson->bHasFrac= APG_TRUE;
-    }
-}
-static void vFracDigits(callback_data* spData){
-    if(spData->uiParserState == ID_NOMATCH){
-        json* spJson = (json*)spData->vpUserData;
-        THROW_ERROR("A decimal point must be followed by one or more digits (REF8259)", spData->uiParserOffset);
-    }
-}
-static void vMinus(callback_data* spData){
-    if(spData->uiParserState == ID_MATCH){
-        json* spJson = (json*)spData->vpUserData;
-        spJson->bHasMinus = APG_TRUE;
-    }
-}
-static void vPlus(callback_data* spData){
-    if(spData->uiParserState == ID_MATCH){
-        json* spJson = (json*)spData->vpUserData;
-        THROW_ERROR("Leading plus (+) sign not allowed for decimal portion of floating point number (REF8259)", spData->uiParserOffset);
+        if(spJson->pfnNumber){
+            spJson->pfnNumber(spNumber, uiFrameDepth(spJson), spJson->vpNumberData);
+        }
+        spData->uiCallbackState = ID_MATCH;
+        spData->uiCallbackPhraseLength = uiLength;
     }
 }
 static void vNameSeparator(callback_data* spData){
@@ -731,17 +841,12 @@ void vJsonGrammarRuleCallbacks(void* vpParserCtx){
     cb[JSON_GRAMMAR_END_VALUE_SEPARATOR] = vEndValueSep;
     cb[JSON_GRAMMAR_FALSE] = vFalse;
     cb[JSON_GRAMMAR_FORM_FEED] = vFormFeed;
-    cb[JSON_GRAMMAR_FRAC] = vFrac;
-    cb[JSON_GRAMMAR_FRAC_DIGITS] = vFracDigits;
-    cb[JSON_GRAMMAR_FRAC_ONLY] = vFracOnly;
     cb[JSON_GRAMMAR_JSON_TEXT] = vJsonText;
     cb[JSON_GRAMMAR_KEY_BEGIN] = vKeyBegin;
     cb[JSON_GRAMMAR_LINE_FEED] = vLineFeed;
-    cb[JSON_GRAMMAR_MINUS] = vMinus;
     cb[JSON_GRAMMAR_NAME_SEPARATOR] = vNameSeparator;
     cb[JSON_GRAMMAR_NULL] = vNull;
     cb[JSON_GRAMMAR_NUMBER] = vNumber;
-    cb[JSON_GRAMMAR_PLUS] = vPlus;
     cb[JSON_GRAMMAR_QUOTE] = vQuote;
     cb[JSON_GRAMMAR_R_SOLIDUS] = vRSolidus;
     cb[JSON_GRAMMAR_SOLIDUS] = vSolidus;
@@ -0,0 +1,717 @@
+/*  *************************************************************************************
+    Copyright (c) 2021, Lowell D. Thomas
+    All rights reserved.
+
+    This file is part of APG Version 7.0.
+    APG Version 7.0 may be used under the terms of the BSD 2-Clause License.
+
+    Redistribution and use in source and binary forms, with or without
+    modification, are permitted provided that the following conditions are met:
+
+    1. Redistributions of source code must retain the above copyright notice, this
+       list of conditions and the following disclaimer.
+
+    2. Redistributions in binary form must reproduce the above copyright notice,
+       this list of conditions and the following disclaimer in the documentation
+       and/or other materials provided with the distribution.
+
+    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+    AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+    IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+    DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+    FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+    DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+    SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+    CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+    OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+    OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+*   *************************************************************************************/
+/** \file json/writer.c
+ * \brief The direct UTF-8 writer of value trees to JSON text.
+ *
+ * ucpJsonWrite() builds its output as 32-bit code points and then converts it to UTF-8.
+ * This writer instead writes UTF-8 bytes directly to a small staging buffer, which is flushed
+ * to the JSON object's growable output buffer or to an open file as it fills.
+ *
+ * Strings are scanned eight bytes at a time for the quotes, reverse solidi and control characters
+ * that need escaping and the runs between them are copied as is. A table gives the escape, if any, of each byte.
+ * UTF-8 keys and strings are written as they are, 32-bit keys and strings are encoded as they are written.
+ *
+ * Floating point numbers are written with the fewest digits that read back to the same double,
+ * with the Grisu2 algorithm of Florian Loitsch,
+ * "Printing Floating-Point Numbers Quickly and Accurately with Integers" (PLDI 2010).
+ */
+
+#include <math.h>
+#include "./json.h"
+#include "./jsonp.h"
+
+/** \def WRITE_BUF
+ * \brief The size of the staging buffer, in bytes.
+ */
+#define WRITE_BUF 16384
+
+// the SWAR (SIMD within a register) constants
+#define SWAR_ONES       0x0101010101010101ULL
+#define SWAR_HIGHS      0x8080808080808080ULL
+#define SWAR_QUOTES     (SWAR_ONES * 0x22)
+#define SWAR_SOLIDI     (SWAR_ONES * 0x5C)
+#define SWAR_CONTROLS   (SWAR_ONES * 0x20)
+
+/** \struct write_sink
+ * \brief For internal object use only. The state of the writer.
+ */
+typedef struct{
+    json* spJson; ///< \brief The JSON object.
+    FILE* spOut; ///< \brief The file to write to. If NULL, the JSON object's output buffer.
+    aint uiIndent; ///< \brief The number of spaces to indent each level. If zero, the output is compact.
+    aint uiDepth; ///< \brief The current depth of the value tree.
+    aint uiLen; ///< \brief The number of bytes in the staging buffer.
+    uint8_t ucaBuf[WRITE_BUF]; ///< \brief The staging buffer.
+} write_sink;
+
+/** \struct diy_fp
+ * \brief For internal object use only. A floating point number with a 64-bit significand, f * 2^e.
+ */
+typedef struct{
+    uint64_t uiF; ///< \brief The significand.
+    int iE; ///< \brief The binary exponent.
+} diy_fp;
+
+// the escape of each byte, zero if none
+static const uint8_t s_ucaEscape[256] = {
+        'u', 'u', 'u', 'u', 'u', 'u', 'u', 'u', 'b', 't', 'n', 'u', 'f', 'r', 'u', 'u',
+        'u', 'u', 'u', 'u', 'u', 'u', 'u', 'u', 'u', 'u', 'u', 'u', 'u', 'u', 'u', 'u',
+        0, 0, '"', 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+        0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+        0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+        0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, '\\', 0, 0, 0,
+};
+static const char s_caHex[] = "0123456789ABCDEF";
+static const char s_caDigits[] =
+        "00010203040506070809101112131415161718192021222324252627282930313233343536373839"
+        "40414243444546474849505152535455565758596061626364656667686970717273747576777879"
+        "8081828384858687888990919293949596979899";
+static const uint64_t s_uiaPow10[] = {
+        1ULL, 10ULL, 100ULL, 1000ULL, 10000ULL, 100000ULL, 1000000ULL, 10000000ULL, 100000000ULL,
+        1000000000ULL, 10000000000ULL, 100000000000ULL, 1000000000000ULL, 10000000000000ULL,
+        100000000000000ULL, 1000000000000000ULL, 10000000000000000ULL, 100000000000000000ULL,
+        1000000000000000000ULL, 10000000000000000000ULL
+};
+
+// the cached powers of ten, 10^-348, 10^-340, ..., 10^340, normalized to 64-bit significands
+static const uint64_t s_uiaCachedF[] = {
+        0xFA8FD5A0081C0288ULL, 0xBAAEE17FA23EBF76ULL, 0x8B16FB203055AC76ULL,
+        0xCF42894A5DCE35EAULL, 0x9A6BB0AA55653B2DULL, 0xE61ACF033D1A45DFULL,
+        0xAB70FE17C79AC6CAULL, 0xFF77B1FCBEBCDC4FULL, 0xBE5691EF416BD60CULL,
+        0x8DD01FAD907FFC3CULL, 0xD3515C2831559A83ULL, 0x9D71AC8FADA6C9B5ULL,
+        0xEA9C227723EE8BCBULL, 0xAECC49914078536DULL, 0x823C12795DB6CE57ULL,
+        0xC21094364DFB5637ULL, 0x9096EA6F3848984FULL, 0xD77485CB25823AC7ULL,
+        0xA086CFCD97BF97F4ULL, 0xEF340A98172AACE5ULL, 0xB23867FB2A35B28EULL,
+        0x84C8D4DFD2C63F3BULL, 0xC5DD44271AD3CDBAULL, 0x936B9FCEBB25C996ULL,
+        0xDBAC6C247D62A584ULL, 0xA3AB66580D5FDAF6ULL, 0xF3E2F893DEC3F126ULL,
+        0xB5B5ADA8AAFF80B8ULL, 0x87625F056C7C4A8BULL, 0xC9BCFF6034C13053ULL,
+        0x964E858C91BA2655ULL, 0xDFF9772470297EBDULL, 0xA6DFBD9FB8E5B88FULL,
+        0xF8A95FCF88747D94ULL, 0xB94470938FA89BCFULL, 0x8A08F0F8BF0F156BULL,
+        0xCDB02555653131B6ULL, 0x993FE2C6D07B7FACULL, 0xE45C10C42A2B3B06ULL,
+        0xAA242499697392D3ULL, 0xFD87B5F28300CA0EULL, 0xBCE5086492111AEBULL,
+        0x8CBCCC096F5088CCULL, 0xD1B71758E219652CULL, 0x9C40000000000000ULL,
+        0xE8D4A51000000000ULL, 0xAD78EBC5AC620000ULL, 0x813F3978F8940984ULL,
+        0xC097CE7BC90715B3ULL, 0x8F7E32CE7BEA5C70ULL, 0xD5D238A4ABE98068ULL,
+        0x9F4F2726179A2245ULL, 0xED63A231D4C4FB27ULL, 0xB0DE65388CC8ADA8ULL,
+        0x83C7088E1AAB65DBULL, 0xC45D1DF942711D9AULL, 0x924D692CA61BE758ULL,
+        0xDA01EE641A708DEAULL, 0xA26DA3999AEF774AULL, 0xF209787BB47D6B85ULL,
+        0xB454E4A179DD1877ULL, 0x865B86925B9BC5C2ULL, 0xC83553C5C8965D3DULL,
+        0x952AB45CFA97A0B3ULL, 0xDE469FBD99A05FE3ULL, 0xA59BC234DB398C25ULL,
+        0xF6C69A72A3989F5CULL, 0xB7DCBF5354E9BECEULL, 0x88FCF317F22241E2ULL,
+        0xCC20CE9BD35C78A5ULL, 0x98165AF37B2153DFULL, 0xE2A0B5DC971F303AULL,
+        0xA8D9D1535CE3B396ULL, 0xFB9B7CD9A4A7443CULL, 0xBB764C4CA7A44410ULL,
+        0x8BAB8EEFB6409C1AULL, 0xD01FEF10A657842CULL, 0x9B10A4E5E9913129ULL,
+        0xE7109BFBA19C0C9DULL, 0xAC2820D9623BF429ULL, 0x80444B5E7AA7CF85ULL,
+        0xBF21E44003ACDD2DULL, 0x8E679C2F5E44FF8FULL, 0xD433179D9C8CB841ULL,
+        0x9E19DB92B4E31BA9ULL, 0xEB96BF6EBADF77D9ULL, 0xAF87023B9BF0EE6BULL,
+};
+static const int16_t s_iaCachedE[] = {
+        -1220, -1193, -1166, -1140, -1113, -1087, -1060, -1034, -1007, -980,
+        -954, -927, -901, -874, -847, -821, -794, -768, -741, -715,
+        -688, -661, -635, -608, -582, -555, -529, -502, -475, -449,
+        -422, -396, -369, -343, -316, -289, -263, -236, -210, -183,
+        -157, -130, -103, -77, -50, -24, 3, 30, 56, 83,
+        109, 136, 162, 189, 216, 242, 269, 295, 322, 348,
+        375, 402, 428, 455, 481, 508, 534, 561, 588, 614,
+        641, 667, 694, 720, 747, 774, 800, 827, 853, 880,
+        907, 933, 960, 986, 1013, 1039, 1066,
+};
+
+static void vWriteValue(write_sink* spSink, json_value* spValue, abool bMember);
+static void vWriteContainer(write_sink* spSink, json_value* spValue, abool bObject);
+static void vWriteIndent(write_sink* spSink);
+static void vWriteString8(write_sink* spSink, const uint8_t* ucpChar, aint uiLength);
+static void vWriteString32(write_sink* spSink, const uint32_t* uipChar, aint uiLength);
+static void vWriteEscape(write_sink* spSink, uint8_t ucChar);
+static void vWriteNumber(write_sink* spSink, json_number* spNumber);
+static aint uiWriteUnsigned(uint64_t uiValue, uint8_t* ucpBuf);
+static aint uiWriteDouble(double dValue, uint8_t* ucpBuf);
+static void vWriteBytes(write_sink* spSink, const uint8_t* ucpBytes, aint uiLength);
+static void vFlush(write_sink* spSink);
+static void vSinkInit(write_sink* spSink, json* spJson, json_value* spValue, aint uiIndent, FILE* spOut);
+
+/** \brief Make room in the staging buffer.
+ * \param spSink The writer state.
+ * \param uiBytes The number of bytes needed. Never more than \ref WRITE_BUF.
+ * \return Pointer to the first free byte of the staging buffer.
+ */
+static inline uint8_t* ucpReserve(write_sink* spSink, aint uiBytes){
+    if((spSink->uiLen + uiBytes) > WRITE_BUF){
+        vFlush(spSink);
+    }
+    return &spSink->ucaBuf[spSink->uiLen];
+}
+
+/** \brief Write a sub-tree of values as UTF-8 JSON text, directly, without the 32-bit code point stage of ucpJsonWrite().
+ *
+ * Keys and strings are written as they are, UTF-8 or 32-bit, with only the quote, reverse solidus
+ * and control characters escaped. Floating point numbers are written with the fewest digits that read back
+ * to the same double. Integral values are given a fraction, "2.0", so that they read back as floating point numbers.
+ * Infinities and NaNs, which JSON can't represent, are written as null.
+ *
+ * With `uiIndent` zero, the output is compact, with no white space at all.
+ * Otherwise, each member or value is on its own line, indented  spaces for each level,
+ * and each key is followed by a colon and a space. Empty objects and arrays are written as {} and [].
+ * The key, if any, of the sub-tree root is not written.
+ * \param vpCtx Pointer to a valid parser context previously returned from  vpJsonCtor.
+ * If invalid the application will silently exit with a \ref BAD_CONTEXT exit code.
+ * \param spValue The root node of the sub-tree to write.
+ * spValue can be any value, including the root value, of an existing value tree.
+ * \param uiIndent The number of spaces to indent each level. Zero for compact output.
+ * \param uipCount Pointer to an unsigned integer.
+ * On completion the number of bytes in the output JSON text is written here.
+ * \return Returns a pointer to the JSON text byte stream. The pointer is valid until another call to this function.
+ */
+uint8_t* ucpJsonWriteUtf8(void* vpCtx, json_value* spValue, aint uiIndent, aint* uipCount){
+    json* spJson = (json*) vpCtx;
+    write_sink sSink;
+    if(!bJsonValidate(vpCtx)){
+        vExContext();
+    }
+    if(!uipCount){
+        XTHROW(spJson->spException, "pointer for return count cannot be NULL");
+    }
+    *uipCount = 0;
+    vSinkInit(&sSink, spJson, spValue, uiIndent, NULL);
+    vVecClear(spJson->vpVecWrite8);
+    vWriteValue(&sSink, spValue, APG_FALSE);
+    vFlush(&sSink);
+    *uipCount = uiVecLen(spJson->vpVecWrite8);
+    return (uint8_t*)vpVecFirst(spJson->vpVecWrite8);
+}
+
+/** \brief Write a sub-tree of values as UTF-8 JSON text to an open file.
+ *
+ * The same as ucpJsonWriteUtf8(), but the output is written to the file as it is made.
+ * No memory is used for the output beyond a small, fixed staging buffer.
+ * \param vpCtx Pointer to a valid parser context previously returned from  vpJsonCtor.
+ * If invalid the application will silently exit with a \ref BAD_CONTEXT exit code.
+ * \param spValue The root node of the sub-tree to write.
+ * \param uiIndent The number of spaces to indent each level. Zero for compact output.
+ * \param spOut The file to write to, open for writing, stdout for example. It is not closed.
+ */
+void vJsonWriteStream(void* vpCtx, json_value* spValue, aint uiIndent, FILE* spOut){
+    json* spJson = (json*) vpCtx;
+    write_sink sSink;
+    if(!bJsonValidate(vpCtx)){
+        vExContext();
+    }
+    if(!spOut){
+        XTHROW(spJson->spException, "output file cannot be NULL");
+    }
+    vSinkInit(&sSink, spJson, spValue, uiIndent, spOut);
+    vWriteValue(&sSink, spValue, APG_FALSE);
+    vFlush(&sSink);
+}
+
+static void vSinkInit(write_sink* spSink, json* spJson, json_value* spValue, aint uiIndent, FILE* spOut){
+    if(!spValue){
+        XTHROW(spJson->spException, "value pointer cannot be NULL");
+    }
+    spSink->spJson = spJson;
+    spSink->spOut = spOut;
+    spSink->uiIndent = uiIndent;
+    spSink->uiDepth = 0;
+    spSink->uiLen = 0;
+}
+
+static void vWriteValue(write_sink* spSink, json_value* spValue, abool bMember){
+    uint8_t* ucpBuf;
+    // lazily read values are decoded first
+    spJsonLazyValue(spSink->spJson, spValue);
+    if(bMember){
+        if(spValue->spKey8){
+            vWriteString8(spSink, spValue->spKey8->ucpPhrase, spValue->spKey8->uiLength);
+        }else if(spValue->spKey){
+            vWriteString32(spSink, spValue->spKey->uipPhrase, spValue->spKey->uiLength);
+        }else{
+            XTHROW(spSink->spJson->spException, "object member has no key");
+        }
+        ucpBuf = ucpReserve(spSink, 2);
+        ucpBuf[0] = ':';
+        ucpBuf[1] = ' ';
+        spSink->uiLen += spSink->uiIndent ? 2 : 1;
+    }
+    switch(spValue->uiId){
+    case JSON_ID_OBJECT:
+        vWriteContainer(spSink, spValue, APG_TRUE);
+        break;
+    case JSON_ID_ARRAY:
+        vWriteContainer(spSink, spValue, APG_FALSE);
+        break;
+    case JSON_ID_STRING:
+        if(spValue->spString8){
+            vWriteString8(spSink, spValue->spString8->ucpPhrase, spValue->spString8->uiLength);
+        }else{
+            vWriteString32(spSink, spValue->spString->uipPhrase, spValue->spString->uiLength);
+        }
+        break;
+    case JSON_ID_NUMBER:
+        vWriteNumber(spSink, spValue->spNumber);
+        break;
+    case JSON_ID_TRUE:
+        vWriteBytes(spSink, (const uint8_t*)"true", 4);
+        break;
+    case JSON_ID_FALSE:
+        vWriteBytes(spSink, (const uint8_t*)"false", 5);
+        break;
+    case JSON_ID_NULL:
+        vWriteBytes(spSink, (const uint8_t*)"null", 4);
+        break;
+    default:
+        XTHROW(spSink->spJson->spException, "unrecognized value type");
+        break;
+    }
+}
+
+static void vWriteContainer(write_sink* spSink, json_value* spValue, abool bObject){
+    aint ui;
+    *ucpReserve(spSink, 1) = bObject ? '{' : '[';
+    spSink->uiLen++;
+    if(spValue->uiChildCount){
+        spSink->uiDepth++;
+        for(ui = 0; ui < spValue->uiChildCount; ui++){
+            if(ui){
+                *ucpReserve(spSink, 1) = ',';
+                spSink->uiLen++;
+            }
+            vWriteIndent(spSink);
+            vWriteValue(spSink, spValue->sppChildren[ui], bObject);
+        }
+        spSink->uiDepth--;
+        vWriteIndent(spSink);
+    }
+    *ucpReserve(spSink, 1) = bObject ? '}' : ']';
+    spSink->uiLen++;
+}
+
+static void vWriteIndent(write_sink* spSink){
+    uint8_t* ucpBuf;
+    aint uiSpaces, uiCount;
+    if(spSink->uiIndent){
+        *ucpReserve(spSink, 1) = LF;
+        spSink->uiLen++;
+        uiSpaces = spSink->uiIndent * spSink->uiDepth;
+        while(uiSpaces){
+            uiCount = (uiSpaces < 256) ? uiSpaces : 256;
+            ucpBuf = ucpReserve(spSink, uiCount);
+            memset((void*)ucpBuf, 32, (size_t)uiCount);
+            spSink->uiLen += uiCount;
+            uiSpaces -= uiCount;
+        }
+    }
+}
+
+/** \brief Write a UTF-8 string, escaping only the characters that must be.
+ *
+ * The string is scanned eight bytes at a time for characters to escape
+ * and the runs of characters between them are copied as they are.
+ */
+static void vWriteString8(write_sink* spSink, const uint8_t* ucpChar, aint uiLength){
+    const uint8_t* ucpEnd = ucpChar + uiLength;
+    const uint8_t* ucpRun;
+    uint64_t uiWord, uiQuotes, uiSolidi;
+    *ucpReserve(spSink, 1) = '"';
+    spSink->uiLen++;
+    while(ucpChar < ucpEnd){
+        ucpRun = ucpChar;
+        while((ucpEnd - ucpChar) >= 8){
+            memcpy((void*)&uiWord, (const void*)ucpChar, 8);
+            uiQuotes = uiWord ^ SWAR_QUOTES;
+            uiSolidi = uiWord ^ SWAR_SOLIDI;
+            if((((uiQuotes - SWAR_ONES) & ~uiQuotes)
+                    | ((uiSolidi - SWAR_ONES) & ~uiSolidi)
+                    | ((uiWord - SWAR_CONTROLS) & ~uiWord)) & SWAR_HIGHS){
+                break;
+            }
+            ucpChar += 8;
+        }
+        while((ucpChar < ucpEnd) && !s_ucaEscape[*ucpChar]){
+            ucpChar++;
+        }
+        if(ucpChar > ucpRun){
+            vWriteBytes(spSink, ucpRun, (aint)(ucpChar - ucpRun));
+        }
+        if(ucpChar < ucpEnd){
+            vWriteEscape(spSink, *ucpChar++);
+        }
+    }
+    *ucpReserve(spSink, 1) = '"';
+    spSink->uiLen++;
+}
+
+/** \brief Write a string of 32-bit code points, encoding them to UTF-8 as they are written.
+ */
+static void vWriteString32(write_sink* spSink, const uint32_t* uipChar, aint uiLength){
+    const uint32_t* uipEnd = uipChar + uiLength;
+    uint32_t uiChar;
+    uint8_t* ucpBuf;
+    *ucpReserve(spSink, 1) = '"';
+    spSink->uiLen++;
+    for(; uipChar < uipEnd; uipChar++){
+        uiChar = *uipChar;
+        if(uiChar < 0x80){
+            if(s_ucaEscape[uiChar]){
+                vWriteEscape(spSink, (uint8_t)uiChar);
+            }else{
+                *ucpReserve(spSink, 1) = (uint8_t)uiChar;
+                spSink->uiLen++;
+            }
+        }else if((uiChar >= 0xD800) && (uiChar <= 0xDFFF)){
+            XTHROW(spSink->spJson->spException, "string has code point value in surrogate pair range ([0xD800 - 0xDFFF])");
+        }else if(uiChar > 0x10FFFF){
+            XTHROW(spSink->spJson->spException, "string has code point out of range (<0x10FFFF)");
+        }else{
+            ucpBuf = ucpReserve(spSink, 4);
+            spSink->uiLen += uiUtf8Encode(uiChar, ucpBuf);
+        }
+    }
+    *ucpReserve(spSink, 1) = '"';
+    spSink->uiLen++;
+}
+
+static void vWriteEscape(write_sink* spSink, uint8_t ucChar){
+    uint8_t ucEscape = s_ucaEscape[ucChar];
+    uint8_t* ucpBuf = ucpReserve(spSink, 6);
+    ucpBuf[0] = '\\';
+    ucpBuf[1] = ucEscape;
+    if(ucEscape == 'u'){
+        ucpBuf[2] = '0';
+        ucpBuf[3] = '0';
+        ucpBuf[4] = (uint8_t)s_caHex[ucChar >> 4];
+        ucpBuf[5] = (uint8_t)s_caHex[ucChar & 0xF];
+        spSink->uiLen += 6;
+    }else{
+        spSink->uiLen += 2;
+    }
+}
+
+static void vWriteNumber(write_sink* spSink, json_number* spNumber){
+    uint8_t* ucpBuf = ucpReserve(spSink, 32);
+    switch(spNumber->uiType){
+    case JSON_ID_FLOAT:
+        spSink->uiLen += uiWriteDouble(spNumber->dFloat, ucpBuf);
+        break;
+    case JSON_ID_UNSIGNED:
+        spSink->uiLen += uiWriteUnsigned(spNumber->uiUnsigned, ucpBuf);
+        break;
+    case JSON_ID_SIGNED:
+        if(spNumber->iSigned < 0){
+            ucpBuf[0] = '-';
+            spSink->uiLen += 1 + uiWriteUnsigned((uint64_t)0 - (uint64_t)spNumber->iSigned, &ucpBuf[1]);
+        }else{
+            spSink->uiLen += uiWriteUnsigned((uint64_t)spNumber->iSigned, ucpBuf);
+        }
+        break;
+    default:
+        XTHROW(spSink->spJson->spException, "unrecognized number type");
+        break;
+    }
+}
+
+/** \brief Write an unsigned integer, two digits at a time.
+ * \return The number of digits written.
+ */
+static aint uiWriteUnsigned(uint64_t uiValue, uint8_t* ucpBuf){
+    uint8_t ucaDigits[24];
+    uint8_t* ucpDigit = &ucaDigits[24];
+    aint uiLen;
+    aint uiPair;
+    while(uiValue >= 100){
+        uiPair = (aint)(uiValue % 100) * 2;
+        uiValue /= 100;
+        *--ucpDigit = (uint8_t)s_caDigits[uiPair + 1];
+        *--ucpDigit = (uint8_t)s_caDigits[uiPair];
+    }
+    if(uiValue >= 10){
+        uiPair = (aint)uiValue * 2;
+        *--ucpDigit = (uint8_t)s_caDigits[uiPair + 1];
+        *--ucpDigit = (uint8_t)s_caDigits[uiPair];
+    }else{
+        *--ucpDigit = (uint8_t)('0' + uiValue);
+    }
+    uiLen = (aint)(&ucaDigits[24] - ucpDigit);
+    memcpy((void*)ucpBuf, (void*)ucpDigit, (size_t)uiLen);
+    return uiLen;
+}
+
+// Grisu2
+static diy_fp sDiyMul(diy_fp sX, diy_fp sY){
+    const uint64_t uiM32 = 0xFFFFFFFFULL;
+    uint64_t uiA = sX.uiF >> 32;
+    uint64_t uiB = sX.uiF & uiM32;
+    uint64_t uiC = sY.uiF >> 32;
+    uint64_t uiD = sY.uiF & uiM32;
+    uint64_t uiAC = uiA * uiC;
+    uint64_t uiBC = uiB * uiC;
+    uint64_t uiAD = uiA * uiD;
+    uint64_t uiBD = uiB * uiD;
+    uint64_t uiTmp = (uiBD >> 32) + (uiAD & uiM32) + (uiBC & uiM32);
+    diy_fp sR;
+    uiTmp += 1ULL << 31; // round
+    sR.uiF = uiAC + (uiAD >> 32) + (uiBC >> 32) + (uiTmp >> 32);
+    sR.iE = sX.iE + sY.iE + 64;
+    return sR;
+}
+static diy_fp sDiyNormalize(diy_fp sX){
+    while(!(sX.uiF & 0x8000000000000000ULL)){
+        sX.uiF <<= 1;
+        sX.iE--;
+    }
+    return sX;
+}
+static void vGrisuRound(uint8_t* ucpBuf, aint uiLen, uint64_t uiDelta, uint64_t uiRest, uint64_t uiTenKappa, uint64_t uiWpW){
+    while((uiRest < uiWpW) && ((uiDelta - uiRest) >= uiTenKappa)
+            && (((uiRest + uiTenKappa) < uiWpW) || ((uiWpW - uiRest) > (uiRest + uiTenKappa - uiWpW)))){
+        ucpBuf[uiLen - 1]--;
+        uiRest += uiTenKappa;
+    }
+}
+static aint uiDigitGen(diy_fp sW, diy_fp sMp, uint64_t uiDelta, uint8_t* ucpBuf, int* ipK){
+    diy_fp sOne;
+    uint64_t uiWpW = sMp.uiF - sW.uiF;
+    uint64_t uiP1, uiP2, uiTmp;
+    uint64_t uiDigit;
+    aint uiLen = 0;
+    int iKappa = 1;
+    sOne.uiF = 1ULL << -sMp.iE;
+    sOne.iE = sMp.iE;
+    uiP1 = sMp.uiF >> -sOne.iE;
+    uiP2 = sMp.uiF & (sOne.uiF - 1);
+    while((iKappa < 10) && (uiP1 >= s_uiaPow10[iKappa])){
+        iKappa++;
+    }
+    while(iKappa > 0){
+        uiDigit = uiP1 / s_uiaPow10[iKappa - 1];
+        uiP1 %= s_uiaPow10[iKappa - 1];
+        if(uiDigit || uiLen){
+            ucpBuf[uiLen++] = (uint8_t)('0' + uiDigit);
+        }
+        iKappa--;
+        uiTmp = (uiP1 << -sOne.iE) + uiP2;
+        if(uiTmp <= uiDelta){
+            *ipK += iKappa;
+            vGrisuRound(ucpBuf, uiLen, uiDelta, uiTmp, s_uiaPow10[iKappa] << -sOne.iE, uiWpW);
+            return uiLen;
+        }
+    }
+    while(APG_TRUE){
+        uiP2 *= 10;
+        uiDelta *= 10;
+        uiDigit = uiP2 >> -sOne.iE;
+        if(uiDigit || uiLen){
+            ucpBuf[uiLen++] = (uint8_t)('0' + uiDigit);
+        }
+        uiP2 &= sOne.uiF - 1;
+        iKappa--;
+        if(uiP2 < uiDelta){
+            *ipK += iKappa;
+            vGrisuRound(ucpBuf, uiLen, uiDelta, uiP2, sOne.uiF, uiWpW * ((-iKappa < 20) ? s_uiaPow10[-iKappa] : 0));
+            return uiLen;
+        }
+    }
+}
+
+/** \brief The shortest digits of a positive, finite double.
+ * \param dValue The value.
+ * \param ucpBuf Buffer for at least 17 digits.
+ * \param ipK The decimal exponent is returned here. The value is the digits times 10^K.
+ * \return The number of digits.
+ */
+static aint uiGrisu2(double dValue, uint8_t* ucpBuf, int* ipK){
+    diy_fp sV, sPlus, sMinus, sC, sW, sWp, sWm;
+    uint64_t uiBits;
+    int iBiased;
+    double dK;
+    int iK;
+    aint uiIndex;
+    memcpy((void*)&uiBits, (void*)&dValue, 8);
+    iBiased = (int)((uiBits >> 52) & 0x7FF);
+    sV.uiF = uiBits & 0x000FFFFFFFFFFFFFULL;
+    if(iBiased){
+        sV.uiF |= 0x0010000000000000ULL;
+        sV.iE = iBiased - 1075;
+    }else{
+        sV.iE = 1 - 1075;
+    }
+
+    // the boundaries, halfway to the neighboring doubles
+    sPlus.uiF = (sV.uiF << 1) + 1;
+    sPlus.iE = sV.iE - 1;
+    sPlus = sDiyNormalize(sPlus);
+    if(sV.uiF == 0x0010000000000000ULL){
+        // the lower neighbor is closer
+        sMinus.uiF = (sV.uiF << 2) - 1;
+        sMinus.iE = sV.iE - 2;
+    }else{
+        sMinus.uiF = (sV.uiF << 1) - 1;
+        sMinus.iE = sV.iE - 1;
+    }
+    sMinus.uiF <<= sMinus.iE - sPlus.iE;
+    sMinus.iE = sPlus.iE;
+
+    // the cached power of ten that brings the boundaries' exponent into range
+    dK = (double)(-61 - sPlus.iE) * 0.30102999566398114 + 347;
+    iK = (int)dK;
+    if((dK - iK) > 0.0){
+        iK++;
+    }
+    uiIndex = (aint)((iK >> 3) + 1);
+    *ipK = -(-348 + (int)(uiIndex << 3));
+    sC.uiF = s_uiaCachedF[uiIndex];
+    sC.iE = s_iaCachedE[uiIndex];
+
+    sW = sDiyMul(sDiyNormalize(sV), sC);
+    sWp = sDiyMul(sPlus, sC);
+    sWm = sDiyMul(sMinus, sC);
+    sWm.uiF++;
+    sWp.uiF--;
+    return uiDigitGen(sW, sWp, sWp.uiF - sWm.uiF, ucpBuf, ipK);
+}
+
+static aint uiWriteExponent(int iK, uint8_t* ucpBuf){
+    aint uiLen = 0;
+    if(iK < 0){
+        ucpBuf[uiLen++] = '-';
+        iK = -iK;
+    }
+    if(iK >= 100){
+        ucpBuf[uiLen++] = (uint8_t)('0' + iK / 100);
+        iK %= 100;
+        ucpBuf[uiLen++] = (uint8_t)s_caDigits[iK * 2];
+        ucpBuf[uiLen++] = (uint8_t)s_caDigits[iK * 2 + 1];
+    }else if(iK >= 10){
+        ucpBuf[uiLen++] = (uint8_t)s_caDigits[iK * 2];
+        ucpBuf[uiLen++] = (uint8_t)s_caDigits[iK * 2 + 1];
+    }else{
+        ucpBuf[uiLen++] = (uint8_t)('0' + iK);
+    }
+    return uiLen;
+}
+
+/** \brief Place the decimal point, or an exponent, in the digits of a double.
+ * \param ucpBuf The digits. Room for at least 26 bytes.
+ * \param uiLen The number of digits.
+ * \param iK The decimal exponent. The value is the digits times 10^K.
+ * \return The number of bytes of the formatted number.
+ */
+static aint uiPrettify(uint8_t* ucpBuf, aint uiLen, int iK){
+    int iKK = (int)uiLen + iK; // 10^(kk-1) <= value < 10^kk
+    int i;
+    if((iK >= 0) && (iKK <= 21)){
+        // dddd00.0
+        for(i = (int)uiLen; i < iKK; i++){
+            ucpBuf[i] = '0';
+        }
+        ucpBuf[iKK] = '.';
+        ucpBuf[iKK + 1] = '0';
+        return (aint)(iKK + 2);
+    }
+    if((iKK > 0) && (iKK <= 21)){
+        // dd.dddd
+        memmove((void*)&ucpBuf[iKK + 1], (void*)&ucpBuf[iKK], (size_t)((int)uiLen - iKK));
+        ucpBuf[iKK] = '.';
+        return uiLen + 1;
+    }
+    if((iKK > -6) && (iKK <= 0)){
+        // 0.00dddd
+        i = 2 - iKK;
+        memmove((void*)&ucpBuf[i], (void*)&ucpBuf[0], (size_t)uiLen);
+        ucpBuf[0] = '0';
+        ucpBuf[1] = '.';
+        memset((void*)&ucpBuf[2], '0', (size_t)(i - 2));
+        return uiLen + (aint)i;
+    }
+    if(uiLen == 1){
+        // de-ddd
+        ucpBuf[1] = 'e';
+        return 2 + uiWriteExponent(iKK - 1, &ucpBuf[2]);
+    }
+    // d.ddde-ddd
+    memmove((void*)&ucpBuf[2], (void*)&ucpBuf[1], (size_t)(uiLen - 1));
+    ucpBuf[1] = '.';
+    ucpBuf[uiLen + 1] = 'e';
+    return uiLen + 2 + uiWriteExponent(iKK - 1, &ucpBuf[uiLen + 2]);
+}
+
+/** \brief Write a double with the fewest digits that read back to the same value.
+ * \param dValue The value.
+ * \param ucpBuf Room for at least 32 bytes.
+ * \return The number of bytes written.
+ */
+static aint uiWriteDouble(double dValue, uint8_t* ucpBuf){
+    aint uiSign = 0;
+    aint uiLen;
+    int iK = 0;
+    if(!isfinite(dValue)){
+        memcpy((void*)ucpBuf, "null", 4);
+        return 4;
+    }
+    if(signbit(dValue)){
+        ucpBuf[uiSign++] = '-';
+        dValue = -dValue;
+    }
+    if(dValue == 0.0){
+        memcpy((void*)&ucpBuf[uiSign], "0.0", 3);
+        return uiSign + 3;
+    }
+    uiLen = uiGrisu2(dValue, &ucpBuf[uiSign], &iK);
+    return uiSign + uiPrettify(&ucpBuf[uiSign], uiLen, iK);
+}
+
+static void vWriteBytes(write_sink* spSink, const uint8_t* ucpBytes, aint uiLength){
+    aint uiCount;
+    while(uiLength){
+        if(spSink->uiLen == WRITE_BUF){
+            vFlush(spSink);
+        }
+        uiCount = WRITE_BUF - spSink->uiLen;
+        if(uiCount > uiLength){
+            uiCount = uiLength;
+        }
+        memcpy((void*)&spSink->ucaBuf[spSink->uiLen], (void*)ucpBytes, (size_t)uiCount);
+        spSink->uiLen += uiCount;
+        ucpBytes += uiCount;
+        uiLength -= uiCount;
+    }
+}
+
+static void vFlush(write_sink* spSink){
+    if(spSink->uiLen){
+        if(spSink->spOut){
+            if(fwrite((void*)spSink->ucaBuf, 1, (size_t)spSink->uiLen, spSink->spOut) != (size_t)spSink->uiLen){
+                XTHROW(spSink->spJson->spException, "file write error");
+            }
+        }else{
+            vpVecPushn(spSink->spJson->vpVecWrite8, (void*)spSink->ucaBuf, spSink->uiLen);
+        }
+        spSink->uiLen = 0;
+    }
+}
@@ -53,6 +53,8 @@
  *  - APG_AST - must be defined to generate an Abstract Syntax Tree
  *  - APG-BKR - must be defined if the grammar has any back referencing operators (i.e. \rulename)
  *  - APG_NO_PPPT - if defined, no Partially-Predictive Parsing Tables are generated
+ *  - APG_NO_PPPT2 - if defined, no second-level (two-character) PPPT maps are generated or used
+ *  - APG_NO_LEAN_OPERATORS - if defined, no lean (uninstrumented) operator set is compiled (see \ref APG_LEAN_OPERATORS)
  *  - APG_STRICT_ABNF - if defined, the grammar must adhere strictly to the RFC5234 & RFC7405 standard
  *  - APG_MEM_STATS - must be defined to generate memory object statistics
  *  - APG_VEC_STATS - must be defined to generate vector object statistics.
@@ -188,8 +190,12 @@ typedef uint8_t abool;
 ///@{
 #ifdef APG_STATS
 #define STATS_HIT(x, o, s) if((x))vStatsHit((x), (o), (s))
+#define STATS_OPEN(x, o) if((x))vStatsOpen((x), (o))
+#define STATS_BEGIN(x) if((x))vStatsBegin((x))
 #else
 #define STATS_HIT(x, o, s)
+#define STATS_OPEN(x, o)
+#define STATS_BEGIN(x)
 #endif /* APG_STATS */
 ///@}
 
@@ -263,6 +269,21 @@ typedef uint8_t abool;
 #endif /* APG_AST */
 ///@}
 
+/**@name Lean Operator Control.
+ * If any of the instrumentation options, APG_TRACE, APG_STATS, APG_AST or APG_BKR, are defined,
+ * every operator must test for the presence of each of the trace, statistics, AST and back referencing objects at every node.
+ * To avoid this cost when none of them are attached, a second, lean set of operator functions, with all of the
+ * instrumentation macros empty, is compiled (see operators-lean.c).
+ * The parser swaps its operator function table to the instrumented set when any of these objects is attached
+ * and back to the lean set when none are.
+ * Define APG_NO_LEAN_OPERATORS to exclude the lean set from the build.
+ */
+///@{
+#if (defined(APG_TRACE) || defined(APG_STATS) || defined(APG_AST) || defined(APG_BKR)) && !defined(APG_NO_LEAN_OPERATORS)
+#define APG_LEAN_OPERATORS 1
+#endif
+///@}
+
 /**@name Partially-Predictive Parsing Table (PPPT) Control.
  * The parser uses these macros to call the generate the PPPT.
  * If APG_NO_PPPT is *not* defined, these are the functions that are called to evaluate the PPPT values.
@@ -74,6 +74,7 @@ void* vpAstCtor(void* vpParserCtx){
     // success
     spCtx->spParser = spParser;
     spParser->vpAst = (void*)spCtx;
+    vParserSelectOperators(spParser);
     spCtx->vpValidate = s_vpMagicNumber;
     return (void*)spCtx;
 }
@@ -90,6 +91,7 @@ void vAstDtor(void* vpCtx){
         vVecDtor(spCtx->vpVecOpenStack);
         vVecDtor(spCtx->vpVecRecords);
         spCtx->spParser->vpAst = NULL;
+        vParserSelectOperators(spCtx->spParser);
         memset((void*)spCtx, 0, sizeof(ast));
         vMemFree(vpMem, spCtx);
     }else{
@@ -75,6 +75,18 @@ typedef struct{
     uint32_t uiLength; ///< \brief The number of integers in the array.
 } u32_phrase;
 
+/** \struct u8_phrase
+ * \brief Defines a pointer to an array of 8-bit unsigned integers plus its length. Typically a UTF-8 encoded string.
+ *
+ * The UTF-8 counterpart of u32_phrase. Since the array may hold bytes of all possible values,
+ * including zero, it can not be treated as a C-language string. Therefore,
+ * the structure includes the array length.
+ */
+typedef struct{
+    const uint8_t* ucpPhrase; ///< \brief Pointer to an array of 8-bit unsigned integers.
+    aint uiLength; ///< \brief The number of integers in the array.
+} u8_phrase;
+
 #include "./exception.h"
 #include "./memory.h"
 #include "./vector.h"
@@ -221,7 +233,9 @@ typedef struct{
  * ### Statistics
  * `stats.h, statsp.h & stats.c`<br>
  * This facility, enabled with the `APG_STATS` macro, collects node-hit statistics. These can be useful when
- * optimizing a grammar or parser.
+ * optimizing a grammar or parser. Optionally, the rule and UDT nodes can also be timed (vStatsTiming())
+ * to see where the parsing time is being spent.
+ * The statistics can be exported in CSV or JSON format for further analysis.
  *
  * ### Miscellaneous Tools
  * `tools.h, tools.c`<br>
@@ -36,6 +36,7 @@
  * the macro is empty - it defines no code at all. Depending on the operator these would be:<br>
  * pre-parsing
  *  - TRACE_DOWN()
+    - STATS_OPEN() (RNM only)
     - AST_OP_OPEN()
     - BKRU_OP_OPEN()
     - BKRP_OP_OPEN()
@@ -67,10 +68,12 @@ void vAlt(parser* spCtx, const opcode* spOp) {
     const aint* uipChildBeg;
     const aint* uipChildEnd;
     const opcode* spChildOp;
+    PARSER_LIMIT(spCtx);
     spCtx->sState.uiHitCount++;
     spCtx->uiTreeDepth++;
     if(spCtx->uiTreeDepth > spCtx->sState.uiMaxTreeDepth){
         spCtx->sState.uiMaxTreeDepth = spCtx->uiTreeDepth;
+        PARSER_DEPTH(spCtx);
     }
     // note: don't need AST_OP_OPEN & AST_OP_CLOSE because all of the
     //       ALT children do this on the syntax tree node immediately below
@@ -103,10 +106,12 @@ void vCat(parser* spCtx, const opcode* spOp) {
     const aint* uipChildBeg;
     const aint* uipChildEnd;
     const opcode* spChildOp;
+    PARSER_LIMIT(spCtx);
     spCtx->sState.uiHitCount++;
     spCtx->uiTreeDepth++;
     if(spCtx->uiTreeDepth > spCtx->sState.uiMaxTreeDepth){
         spCtx->sState.uiMaxTreeDepth = spCtx->uiTreeDepth;
+        PARSER_DEPTH(spCtx);
     }
     TRACE_DOWN(spCtx->vpTrace, spOp, spCtx->uiOffset);
     AST_OP_OPEN(spCtx->vpAst, spCtx->uiInLookaround);
@@ -149,10 +154,12 @@ void vRep(parser* spCtx, const opcode* spOp) {
     aint uiMatchCount = 0;
     aint uiPhraseLength = 0;
     aint uiOffset = spCtx->uiOffset;
+    PARSER_LIMIT(spCtx);
     spCtx->sState.uiHitCount++;
     spCtx->uiTreeDepth++;
     if(spCtx->uiTreeDepth > spCtx->sState.uiMaxTreeDepth){
         spCtx->sState.uiMaxTreeDepth = spCtx->uiTreeDepth;
+        PARSER_DEPTH(spCtx);
     }
     TRACE_DOWN(spCtx->vpTrace, spOp, spCtx->uiOffset);
     AST_OP_OPEN(spCtx->vpAst, spCtx->uiInLookaround);
@@ -246,12 +253,15 @@ void vRnm(parser* spCtx, const opcode* spOp) {
     rule* spRule = spOp->sRnm.spRule;
     parser_callback pfnCallback = spRule->pfnCallback;
     aint uiOffset = spCtx->uiOffset;
+    PARSER_LIMIT(spCtx);
     spCtx->sState.uiHitCount++;
     spCtx->uiTreeDepth++;
     if(spCtx->uiTreeDepth > spCtx->sState.uiMaxTreeDepth){
         spCtx->sState.uiMaxTreeDepth = spCtx->uiTreeDepth;
+        PARSER_DEPTH(spCtx);
     }
     TRACE_DOWN(spCtx->vpTrace, spOp, spCtx->uiOffset);
+    STATS_OPEN(spCtx->vpStats, spOp);
     AST_RULE_OPEN(spCtx->vpAst, spCtx->uiInLookaround, spRule->uiRuleIndex, spCtx->uiOffset);
     BKRU_RULE_OPEN(spCtx->vpBkru, spRule->uiRuleIndex);
     BKRP_RULE_OPEN(spCtx->vpBkrp, spRule->uiRuleIndex);
@@ -321,10 +331,12 @@ void vRnm(parser* spCtx, const opcode* spOp) {
 }
 
 void vTrg(parser* spCtx, const opcode* spOp) {
+    PARSER_LIMIT(spCtx);
     spCtx->sState.uiHitCount++;
     spCtx->uiTreeDepth++;
     if(spCtx->uiTreeDepth > spCtx->sState.uiMaxTreeDepth){
         spCtx->sState.uiMaxTreeDepth = spCtx->uiTreeDepth;
+        PARSER_DEPTH(spCtx);
     }
     TRACE_DOWN(spCtx->vpTrace, spOp, spCtx->uiOffset);
     PPPT_OPEN(spCtx, spOp, spCtx->uiOffset);
@@ -338,6 +350,9 @@ void vTrg(parser* spCtx, const opcode* spOp) {
             spCtx->uiPhraseLength = 1;
         }
     }
+    if(spCtx->uiOpState == ID_NOMATCH){
+        PARSER_FAIL(spCtx, spOp);
+    }
     PPPT_CLOSE;
     TRACE_UP(spCtx->vpTrace, spOp, spCtx->uiOpState, (spCtx->uiOffset - spCtx->uiPhraseLength), spCtx->uiPhraseLength);
     STATS_HIT(spCtx->vpStats, spOp, spCtx->uiOpState);
@@ -345,10 +360,12 @@ void vTrg(parser* spCtx, const opcode* spOp) {
 }
 
 void vTls(parser* spCtx, const opcode* spOp) {
+    PARSER_LIMIT(spCtx);
     spCtx->sState.uiHitCount++;
     spCtx->uiTreeDepth++;
     if(spCtx->uiTreeDepth > spCtx->sState.uiMaxTreeDepth){
         spCtx->sState.uiMaxTreeDepth = spCtx->uiTreeDepth;
+        PARSER_DEPTH(spCtx);
     }
     TRACE_DOWN(spCtx->vpTrace, spOp, spCtx->uiOffset);
     PPPT_OPEN(spCtx, spOp, spCtx->uiOffset);
@@ -377,6 +394,9 @@ void vTls(parser* spCtx, const opcode* spOp) {
             spCtx->uiPhraseLength = spOp->sTls.uiStrLen;
         }
     }
+    if(spCtx->uiOpState == ID_NOMATCH){
+        PARSER_FAIL(spCtx, spOp);
+    }
     PPPT_CLOSE;
     TRACE_UP(spCtx->vpTrace, spOp, spCtx->uiOpState, (spCtx->uiOffset - spCtx->uiPhraseLength), spCtx->uiPhraseLength);
     STATS_HIT(spCtx->vpStats, spOp, spCtx->uiOpState);
@@ -384,10 +404,12 @@ void vTls(parser* spCtx, const opcode* spOp) {
 }
 
 void vTbs(parser* spCtx, const opcode* spOp) {
+    PARSER_LIMIT(spCtx);
     spCtx->sState.uiHitCount++;
     spCtx->uiTreeDepth++;
     if(spCtx->uiTreeDepth > spCtx->sState.uiMaxTreeDepth){
         spCtx->sState.uiMaxTreeDepth = spCtx->uiTreeDepth;
+        PARSER_DEPTH(spCtx);
     }
     TRACE_DOWN(spCtx->vpTrace, spOp, spCtx->uiOffset);
     PPPT_OPEN(spCtx, spOp, spCtx->uiOffset);
@@ -412,6 +434,9 @@ void vTbs(parser* spCtx, const opcode* spOp) {
             spCtx->uiPhraseLength = spOp->sTbs.uiStrLen;
         }
     }
+    if(spCtx->uiOpState == ID_NOMATCH){
+        PARSER_FAIL(spCtx, spOp);
+    }
     PPPT_CLOSE;
     TRACE_UP(spCtx->vpTrace, spOp, spCtx->uiOpState, (spCtx->uiOffset - spCtx->uiPhraseLength), spCtx->uiPhraseLength);
     STATS_HIT(spCtx->vpStats, spOp, spCtx->uiOpState);
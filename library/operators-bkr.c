@@ -49,10 +49,12 @@ static aint uiIMatch(parser* spCtx, aint uiOffset, aint uiPhraseOffset, aint uiP
 static aint uiSMatch(parser* spCtx, aint uiOffset, aint uiPhraseOffset, aint uiPhraseLength);
 
 void vBkr(parser* spCtx, const opcode* spOp) {
+    PARSER_LIMIT(spCtx);
     spCtx->sState.uiHitCount++;
     spCtx->uiTreeDepth++;
     if(spCtx->uiTreeDepth > spCtx->sState.uiMaxTreeDepth){
         spCtx->sState.uiMaxTreeDepth = spCtx->uiTreeDepth;
+        PARSER_DEPTH(spCtx);
     }
     TRACE_DOWN(spCtx->vpTrace, spOp, spCtx->uiOffset);
     aint uiState = ID_NOMATCH;
@@ -78,6 +80,9 @@ void vBkr(parser* spCtx, const opcode* spOp) {
     spCtx->uiOpState = uiState;
     spCtx->uiPhraseLength = uiPhraseLength;
     spCtx->uiOffset += uiPhraseLength;
+    if(uiState == ID_NOMATCH){
+        PARSER_FAIL(spCtx, spOp);
+    }
     TRACE_UP(spCtx->vpTrace, spOp, spCtx->uiOpState, (spCtx->uiOffset - spCtx->uiPhraseLength), spCtx->uiPhraseLength);
     STATS_HIT(spCtx->vpStats, spOp, spCtx->uiOpState);
     spCtx->uiTreeDepth--;
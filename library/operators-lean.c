@@ -0,0 +1,104 @@
+/*  *************************************************************************************
+    Copyright (c) 2021, Lowell D. Thomas
+    All rights reserved.
+    
+    This file is part of APG Version 7.0.
+    APG Version 7.0 may be used under the terms of the BSD 2-Clause License.
+    
+    Redistribution and use in source and binary forms, with or without
+    modification, are permitted provided that the following conditions are met:
+    
+    1. Redistributions of source code must retain the above copyright notice, this
+       list of conditions and the following disclaimer.
+    
+    2. Redistributions in binary form must reproduce the above copyright notice,
+       this list of conditions and the following disclaimer in the documentation
+       and/or other materials provided with the distribution.
+    
+    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+    AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+    IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+    DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+    FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+    DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+    SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+    CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+    OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+    OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+    
+*   *************************************************************************************/
+/** \file library/operators-lean.c
+ * \brief The lean set of node operation functions.
+ *
+ * When any of the instrumentation options, `APG_TRACE`, `APG_STATS`, `APG_AST` or `APG_BKR`, are defined,
+ * the operator functions in operators-abnf.c and operators-sabnf.c test for the presence of the
+ * trace, statistics, AST and back referencing objects at every node of the parse tree.
+ * This file compiles those same operator functions a second time, renamed with the suffix "Lean",
+ * with all of the instrumentation macros defined empty.
+ * The parser uses this lean set whenever no trace, statistics, AST or back referencing object is attached.
+ * (See \ref APG_LEAN_OPERATORS and vParserSelectOperators().)
+ *
+ * These functions are for internal, parser use only. They are never to be called directly by the application.
+ */
+
+#include "./apg.h"
+#ifdef APG_LEAN_OPERATORS
+
+// empty all of the instrumentation macros
+#undef TRACE_DOWN
+#undef TRACE_UP
+#define TRACE_DOWN(x, o, f)
+#define TRACE_UP(x, o, s, f, p)
+#undef STATS_HIT
+#undef STATS_OPEN
+#define STATS_HIT(x, o, s)
+#define STATS_OPEN(x, o)
+#undef AST_RULE_OPEN
+#undef AST_RULE_CLOSE
+#undef AST_OP_OPEN
+#undef AST_OP_CLOSE
+#define AST_RULE_OPEN(x, l, i, o)
+#define AST_RULE_CLOSE(x, l, i, s, o, p)
+#define AST_OP_OPEN(x, l)
+#define AST_OP_CLOSE(x, l, s)
+#undef BKRU_RULE_OPEN
+#undef BKRU_RULE_CLOSE
+#undef BKRU_UDT_CLOSE
+#undef BKRU_OP_OPEN
+#undef BKRU_OP_CLOSE
+#undef BKRP_RULE_OPEN
+#undef BKRP_RULE_CLOSE
+#undef BKRP_UDT_CLOSE
+#undef BKRP_OP_OPEN
+#undef BKRP_OP_CLOSE
+#define BKRU_RULE_OPEN(x, i)
+#define BKRU_RULE_CLOSE(x, i, s, o, p)
+#define BKRU_UDT_CLOSE(x, i, s, o, p)
+#define BKRU_OP_OPEN(x)
+#define BKRU_OP_CLOSE(x, s)
+#define BKRP_RULE_OPEN(x, i)
+#define BKRP_RULE_CLOSE(x, i, s, o, p)
+#define BKRP_UDT_CLOSE(x, i, s, o, p)
+#define BKRP_OP_OPEN(x)
+#define BKRP_OP_CLOSE(x, s)
+
+// rename the operator functions
+#define vAlt vAltLean
+#define vCat vCatLean
+#define vRep vRepLean
+#define vRnm vRnmLean
+#define vTrg vTrgLean
+#define vTls vTlsLean
+#define vTbs vTbsLean
+#define vUdt vUdtLean
+#define vAnd vAndLean
+#define vNot vNotLean
+#define vBka vBkaLean
+#define vBkn vBknLean
+#define vAbg vAbgLean
+#define vAen vAenLean
+
+#include "./operators-abnf.c"
+#include "./operators-sabnf.c"
+
+#endif /* APG_LEAN_OPERATORS */
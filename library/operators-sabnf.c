@@ -51,12 +51,15 @@ void vUdt(parser* spCtx, const opcode* spOp) {
     parser_callback pfnCallback = spUdt->pfnCallback;
     aint uiOffset = spCtx->uiOffset;
     aint uiState;
+    PARSER_LIMIT(spCtx);
     spCtx->sState.uiHitCount++;
     spCtx->uiTreeDepth++;
     if(spCtx->uiTreeDepth > spCtx->sState.uiMaxTreeDepth){
         spCtx->sState.uiMaxTreeDepth = spCtx->uiTreeDepth;
+        PARSER_DEPTH(spCtx);
     }
     TRACE_DOWN(spCtx->vpTrace, spOp, spCtx->uiOffset);
+    STATS_OPEN(spCtx->vpStats, spOp);
     AST_RULE_OPEN(spCtx->vpAst, spCtx->uiInLookaround, (spCtx->uiRuleCount + spUdt->uiUdtIndex), spCtx->uiOffset);
 
     // call the callback
@@ -95,6 +98,9 @@ void vUdt(parser* spCtx, const opcode* spOp) {
     spCtx->uiOpState = spCtx->sCBData.uiCallbackState;
     spCtx->uiOffset = uiOffset + spCtx->sCBData.uiCallbackPhraseLength;
     spCtx->uiPhraseLength = spCtx->sCBData.uiCallbackPhraseLength;
+    if(spCtx->uiOpState == ID_NOMATCH){
+        PARSER_FAIL(spCtx, spOp);
+    }
     BKRU_UDT_CLOSE(spCtx->vpBkru, spUdt->uiUdtIndex, spCtx->uiOpState, (spCtx->uiOffset - spCtx->uiPhraseLength), spCtx->uiPhraseLength);
     BKRP_UDT_CLOSE(spCtx->vpBkrp, spUdt->uiUdtIndex, spCtx->uiOpState, (spCtx->uiOffset - spCtx->uiPhraseLength), spCtx->uiPhraseLength);
     AST_RULE_CLOSE(spCtx->vpAst, spCtx->uiInLookaround, (spCtx->uiRuleCount + spUdt->uiUdtIndex), spCtx->uiOpState, (spCtx->uiOffset - spCtx->uiPhraseLength), spCtx->uiPhraseLength);
@@ -105,10 +111,12 @@ void vUdt(parser* spCtx, const opcode* spOp) {
 
 void vAnd(parser* spCtx, const opcode* spOp) {
     aint uiOffset = spCtx->uiOffset;
+    PARSER_LIMIT(spCtx);
     spCtx->sState.uiHitCount++;
     spCtx->uiTreeDepth++;
     if(spCtx->uiTreeDepth > spCtx->sState.uiMaxTreeDepth){
         spCtx->sState.uiMaxTreeDepth = spCtx->uiTreeDepth;
+        PARSER_DEPTH(spCtx);
     }
     TRACE_DOWN(spCtx->vpTrace, spOp, spCtx->uiOffset);
     AST_OP_OPEN(spCtx->vpAst, spCtx->uiInLookaround);
@@ -129,10 +137,12 @@ void vAnd(parser* spCtx, const opcode* spOp) {
 
 void vNot(parser* spCtx, const opcode* spOp) {
     aint uiOffset = spCtx->uiOffset;
+    PARSER_LIMIT(spCtx);
     spCtx->sState.uiHitCount++;
     spCtx->uiTreeDepth++;
     if(spCtx->uiTreeDepth > spCtx->sState.uiMaxTreeDepth){
         spCtx->sState.uiMaxTreeDepth = spCtx->uiTreeDepth;
+        PARSER_DEPTH(spCtx);
     }
     TRACE_DOWN(spCtx->vpTrace, spOp, spCtx->uiOffset);
     AST_OP_OPEN(spCtx->vpAst, spCtx->uiInLookaround);
@@ -187,10 +197,12 @@ static void vLookBack(parser* spCtx, const opcode* spOp) {
  * 4. If the look-behind phrase can accept an empty string BKA will *always* succeed.
  */
 void vBka(parser* spCtx, const opcode* spOp) {
+    PARSER_LIMIT(spCtx);
     spCtx->sState.uiHitCount++;
     spCtx->uiTreeDepth++;
     if(spCtx->uiTreeDepth > spCtx->sState.uiMaxTreeDepth){
         spCtx->sState.uiMaxTreeDepth = spCtx->uiTreeDepth;
+        PARSER_DEPTH(spCtx);
     }
     TRACE_DOWN(spCtx->vpTrace, spOp, spCtx->uiOffset);
     AST_OP_OPEN(spCtx->vpAst, spCtx->uiInLookaround);
@@ -213,10 +225,12 @@ void vBka(parser* spCtx, const opcode* spOp) {
  * 4. If the look-behind phrase can accept an empty string BKN will *always* fail.
  */
 void vBkn(parser* spCtx, const opcode* spOp) {
+    PARSER_LIMIT(spCtx);
     spCtx->sState.uiHitCount++;
     spCtx->uiTreeDepth++;
     if(spCtx->uiTreeDepth > spCtx->sState.uiMaxTreeDepth){
         spCtx->sState.uiMaxTreeDepth = spCtx->uiTreeDepth;
+        PARSER_DEPTH(spCtx);
     }
     TRACE_DOWN(spCtx->vpTrace, spOp, spCtx->uiOffset);
     AST_OP_OPEN(spCtx->vpAst, spCtx->uiInLookaround);
@@ -231,10 +245,12 @@ void vBkn(parser* spCtx, const opcode* spOp) {
 }
 
 void vAbg(parser* spCtx, const opcode* spOp) {
+    PARSER_LIMIT(spCtx);
     spCtx->sState.uiHitCount++;
     spCtx->uiTreeDepth++;
     if(spCtx->uiTreeDepth > spCtx->sState.uiMaxTreeDepth){
         spCtx->sState.uiMaxTreeDepth = spCtx->uiTreeDepth;
+        PARSER_DEPTH(spCtx);
     }
     TRACE_DOWN(spCtx->vpTrace, spOp, spCtx->uiOffset);
 
@@ -247,10 +263,12 @@ void vAbg(parser* spCtx, const opcode* spOp) {
 }
 
 void vAen(parser* spCtx, const opcode* spOp) {
+    PARSER_LIMIT(spCtx);
     spCtx->sState.uiHitCount++;
     spCtx->uiTreeDepth++;
     if(spCtx->uiTreeDepth > spCtx->sState.uiMaxTreeDepth){
         spCtx->sState.uiMaxTreeDepth = spCtx->uiTreeDepth;
+        PARSER_DEPTH(spCtx);
     }
     TRACE_DOWN(spCtx->vpTrace, spOp, spCtx->uiOffset);
 
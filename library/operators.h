@@ -54,4 +54,27 @@ void vBkn(parser* spCtx, const opcode* spop);
 void vAbg(parser* spCtx, const opcode* spop);
 void vAen(parser* spCtx, const opcode* spop);
 ///@}
+
+#ifdef APG_LEAN_OPERATORS
+/** @name The Lean Node Operation Functions
+ * The same operation functions without any trace, statistics, AST or back referencing instrumentation.
+ * See operators-lean.c.
+ */
+///@{
+void vAltLean(parser* spCtx, const opcode* spop);
+void vCatLean(parser* spCtx, const opcode* spop);
+void vRepLean(parser* spCtx, const opcode* spop);
+void vRnmLean(parser* spCtx, const opcode* spop);
+void vTrgLean(parser* spCtx, const opcode* spop);
+void vTlsLean(parser* spCtx, const opcode* spop);
+void vTbsLean(parser* spCtx, const opcode* spop);
+void vUdtLean(parser* spCtx, const opcode* spop);
+void vAndLean(parser* spCtx, const opcode* spop);
+void vNotLean(parser* spCtx, const opcode* spop);
+void vBkaLean(parser* spCtx, const opcode* spop);
+void vBknLean(parser* spCtx, const opcode* spop);
+void vAbgLean(parser* spCtx, const opcode* spop);
+void vAenLean(parser* spCtx, const opcode* spop);
+///@}
+#endif /* APG_LEAN_OPERATORS */
 #endif /* LIB_OPERATORSP_H_ */
@@ -31,6 +31,7 @@
  * \brief The SABNF parser.
  */
 
+#include <time.h>
 #include "./lib.h"
 #include "./parserp.h"
 #include "./operators.h"
@@ -48,6 +49,9 @@
 #endif
 
 static const void* s_vpMagicNumber = (void*)"parser";
+static uint64_t uiParserNow(void);
+static void vParserCheck(parser* spCtx, parser_config* spConfig, parser_state* spState);
+static void vParserStart(parser* spCtx, parser_config* spConfig, parser_state* spState);
 
 //#define PARSER_DEBUG 1
 #ifdef PARSER_DEBUG
@@ -156,7 +160,12 @@ void* vpParserAllocCtor(exception* spException, void* vpParserInit, abool bAlloc
     spCtx->acAcharMax = (achar)spInitHdr->uiAcharMax;
     spCtx->uiMapSize = spInitHdr->uiMapSize;
     spCtx->uiMapCount = spInitHdr->uiMapCount;
+    if(spCtx->ucpMaps){
+        // second-level maps, if any, follow the single-character maps
+        spCtx->ucpMaps2 = spCtx->ucpMaps + (spCtx->uiMapCount * spCtx->uiMapSize);
+    }
     spCtx->vpVecInputString = vpVecCtor(vpMem, sizeof(achar), 2048);
+    spCtx->vpVecExpected = vpVecCtor(vpMem, sizeof(parser_expected), 16);
 
     // get the child list (opcode indexes for children of ALT and CAT)
     uipChildList = (aint*) vpMemAlloc(vpMem, (aint) (sizeof(aint) * spInitHdr->uiChildListLength));
@@ -180,6 +189,11 @@ void* vpParserAllocCtor(exception* spException, void* vpParserInit, abool bAlloc
     spCtx->spOpcodes = (opcode*) vpMemAlloc(vpMem, (aint) (sizeof(opcode) * spCtx->uiOpcodeCount));
     memset((void*)spCtx->spOpcodes, 0, (sizeof(opcode) * spCtx->uiOpcodeCount));
 
+    // allocate the farthest failure tracking, one extra for the start rule's RNM opcode
+    spCtx->uipFailStamps = (aint*) vpMemAlloc(vpMem, (aint) (sizeof(aint) * (spCtx->uiOpcodeCount + 1)));
+    memset((void*)spCtx->uipFailStamps, 0, (sizeof(aint) * (spCtx->uiOpcodeCount + 1)));
+    spCtx->sppFailOps = (const opcode**) vpMemAlloc(vpMem, (aint) (sizeof(opcode*) * (spCtx->uiOpcodeCount + 1)));
+
     // get the rules, UDTs, and opcodes
     vTranslateRules(spCtx, spCtx->spRules, spCtx->spOpcodes, (luipParserInit + spInitHdr->uiRulesOffset));
     vTranslateUdts(spCtx, spCtx->spUdts, (luipParserInit + spInitHdr->uiUdtsOffset));
@@ -189,39 +203,72 @@ void* vpParserAllocCtor(exception* spException, void* vpParserInit, abool bAlloc
 
     // allocate and set the array of operator function pointers
     // NOTE: ID_GEN must be greater than all other opcode IDs
-    spCtx->pfnOpFunc = (pfn_op*) vpMemAlloc(vpMem, (aint) (sizeof(pfn_op) * ID_GEN));
-    spCtx->pfnOpFunc[ID_ALT] = vAlt;
-    spCtx->pfnOpFunc[ID_CAT] = vCat;
-    spCtx->pfnOpFunc[ID_REP] = vRep;
-    spCtx->pfnOpFunc[ID_RNM] = vRnm;
-    spCtx->pfnOpFunc[ID_TRG] = vTrg;
-    spCtx->pfnOpFunc[ID_TLS] = vTls;
-    spCtx->pfnOpFunc[ID_TBS] = vTbs;
+    spCtx->pfnOpFull = (pfn_op*) vpMemAlloc(vpMem, (aint) (sizeof(pfn_op) * ID_GEN));
+    spCtx->pfnOpFull[ID_ALT] = vAlt;
+    spCtx->pfnOpFull[ID_CAT] = vCat;
+    spCtx->pfnOpFull[ID_REP] = vRep;
+    spCtx->pfnOpFull[ID_RNM] = vRnm;
+    spCtx->pfnOpFull[ID_TRG] = vTrg;
+    spCtx->pfnOpFull[ID_TLS] = vTls;
+    spCtx->pfnOpFull[ID_TBS] = vTbs;
 #ifdef APG_BKR
-    spCtx->pfnOpFunc[ID_BKR] = vBkr;
+    spCtx->pfnOpFull[ID_BKR] = vBkr;
 #else
-    spCtx->pfnOpFunc[ID_BKR] = NULL;
+    spCtx->pfnOpFull[ID_BKR] = NULL;
 #endif /* APG_BKR */
 #ifdef APG_STRICT_ABNF
-    spCtx->pfnOpFunc[ID_UDT] = NULL;
-    spCtx->pfnOpFunc[ID_AND] = NULL;
-    spCtx->pfnOpFunc[ID_NOT] = NULL;
-    spCtx->pfnOpFunc[ID_BKA] = NULL;
-    spCtx->pfnOpFunc[ID_BKN] = NULL;
-    spCtx->pfnOpFunc[ID_ABG] = NULL;
-    spCtx->pfnOpFunc[ID_AEN] = NULL;
+    spCtx->pfnOpFull[ID_UDT] = NULL;
+    spCtx->pfnOpFull[ID_AND] = NULL;
+    spCtx->pfnOpFull[ID_NOT] = NULL;
+    spCtx->pfnOpFull[ID_BKA] = NULL;
+    spCtx->pfnOpFull[ID_BKN] = NULL;
+    spCtx->pfnOpFull[ID_ABG] = NULL;
+    spCtx->pfnOpFull[ID_AEN] = NULL;
+#else
+    spCtx->pfnOpFull[ID_UDT] = vUdt;
+    spCtx->pfnOpFull[ID_AND] = vAnd;
+    spCtx->pfnOpFull[ID_NOT] = vNot;
+    spCtx->pfnOpFull[ID_BKA] = vBka;
+    spCtx->pfnOpFull[ID_BKN] = vBkn;
+    spCtx->pfnOpFull[ID_ABG] = vAbg;
+    spCtx->pfnOpFull[ID_AEN] = vAen;
+#endif /* APG_STRICT_ABNF */
+
+#ifdef APG_LEAN_OPERATORS
+    // the lean operators (no trace, stats, AST or back referencing instrumentation)
+    spCtx->pfnOpLean = (pfn_op*) vpMemAlloc(vpMem, (aint) (sizeof(pfn_op) * ID_GEN));
+    spCtx->pfnOpLean[ID_ALT] = vAltLean;
+    spCtx->pfnOpLean[ID_CAT] = vCatLean;
+    spCtx->pfnOpLean[ID_REP] = vRepLean;
+    spCtx->pfnOpLean[ID_RNM] = vRnmLean;
+    spCtx->pfnOpLean[ID_TRG] = vTrgLean;
+    spCtx->pfnOpLean[ID_TLS] = vTlsLean;
+    spCtx->pfnOpLean[ID_TBS] = vTbsLean;
+    // the lean set is only used if there are no back references in the grammar
+    spCtx->pfnOpLean[ID_BKR] = spCtx->pfnOpFull[ID_BKR];
+#ifdef APG_STRICT_ABNF
+    spCtx->pfnOpLean[ID_UDT] = NULL;
+    spCtx->pfnOpLean[ID_AND] = NULL;
+    spCtx->pfnOpLean[ID_NOT] = NULL;
+    spCtx->pfnOpLean[ID_BKA] = NULL;
+    spCtx->pfnOpLean[ID_BKN] = NULL;
+    spCtx->pfnOpLean[ID_ABG] = NULL;
+    spCtx->pfnOpLean[ID_AEN] = NULL;
 #else
-    spCtx->pfnOpFunc[ID_UDT] = vUdt;
-    spCtx->pfnOpFunc[ID_AND] = vAnd;
-    spCtx->pfnOpFunc[ID_NOT] = vNot;
-    spCtx->pfnOpFunc[ID_BKA] = vBka;
-    spCtx->pfnOpFunc[ID_BKN] = vBkn;
-    spCtx->pfnOpFunc[ID_ABG] = vAbg;
-    spCtx->pfnOpFunc[ID_AEN] = vAen;
+    spCtx->pfnOpLean[ID_UDT] = vUdtLean;
+    spCtx->pfnOpLean[ID_AND] = vAndLean;
+    spCtx->pfnOpLean[ID_NOT] = vNotLean;
+    spCtx->pfnOpLean[ID_BKA] = vBkaLean;
+    spCtx->pfnOpLean[ID_BKN] = vBknLean;
+    spCtx->pfnOpLean[ID_ABG] = vAbgLean;
+    spCtx->pfnOpLean[ID_AEN] = vAenLean;
 #endif /* APG_STRICT_ABNF */
+#endif /* APG_LEAN_OPERATORS */
 
     spCtx->vpBkru = BKRU_CTOR(spCtx);
     spCtx->vpBkrp = BKRP_CTOR(spCtx);
+    spCtx->pfnOpFunc = spCtx->pfnOpFull;
+    vParserSelectOperators(spCtx);
 
 #ifdef PARSER_DEBUG
     printf("\n");
@@ -237,6 +284,26 @@ void* vpParserAllocCtor(exception* spException, void* vpParserInit, abool bAlloc
     return (void*) spCtx;
 }
 
+/** \brief Selects the set of node operation functions.
+ *
+ * Called by the parser constructor and whenever a trace, statistics or AST object is attached to or detached
+ * from the parser. If any of these objects or a back referencing object is present, the instrumented
+ * operator set is used. Otherwise, the lean operator set, with no per-node instrumentation tests, is used.
+ * See \ref APG_LEAN_OPERATORS. If the lean set has not been compiled, this function does nothing.
+ * \param spCtx Pointer to a valid parser context.
+ */
+void vParserSelectOperators(parser* spCtx) {
+#ifdef APG_LEAN_OPERATORS
+    if (spCtx->vpTrace || spCtx->vpStats || spCtx->vpAst || spCtx->vpBkru || spCtx->vpBkrp) {
+        spCtx->pfnOpFunc = spCtx->pfnOpFull;
+    } else {
+        spCtx->pfnOpFunc = spCtx->pfnOpLean;
+    }
+#else
+    (void)spCtx;
+#endif /* APG_LEAN_OPERATORS */
+}
+
 /** \brief Clears the parser component's context and frees all heap memory associated with this parser.
  *
  * \param vpCtx a parser context pointer previously returned from \ref vpParserCtor() or vpApiOutputParser().
@@ -267,11 +334,217 @@ void vParserDtor(void* vpCtx) {
  */
 void vParserParse(void* vpCtx, parser_config* spConfig, parser_state* spState) {
     parser* spCtx = (parser*) vpCtx;
-    aint ui;
     if(!vpCtx || (spCtx->vpValidate != s_vpMagicNumber)){
         vExContext();
         return; // should never return
     }
+    vParserCheck(spCtx, spConfig, spState);
+
+    // keep a copy of the input string
+    vVecClear(spCtx->vpVecInputString);
+    spCtx->acpInputString = (achar*)vpVecPushn(spCtx->vpVecInputString, (void*)spConfig->acpInput, spConfig->uiInputLength);
+    spCtx->uiInputStringLength = spConfig->uiInputLength;
+    spCtx->acpConfigInput = spConfig->acpInput;
+    spCtx->bReparse = APG_FALSE;
+    vParserStart(spCtx, spConfig, spState);
+}
+
+/** \brief Parse the input string of the previous parse again.
+ *
+ * Identical to \ref vParserParse() except that the input string is not copied again.
+ * The parser keeps its own copy of the input string and re-enters the start rule on it.
+ * This is for applications, like pattern matching, that parse the same input string
+ * many times with different sub-string beginnings or start rules.
+ * Parsing a long input string at each of its offsets with vParserParse() would copy
+ * the entire string at each offset.
+ *
+ * \param vpCtx Pointer to a valid parser context previously returned from \ref vpParserCtor() or vpApiOutputParser().
+ * If not valid, the application will silently exit with a \ref BAD_CONTEXT exit code.
+ * \param spConfig Pointer to the configuration. See \ref parser_config.
+ * The input string, parser_config::acpInput and parser_config::uiInputLength,
+ * must be the same as for the previous call to \ref vParserParse().
+ * All other members may change.
+ * \param spState Pointer to a parser state structure. See \ref parser_state.
+ * \return The parser state is returned in the caller's state structure, spState.
+ */
+void vParserReparse(void* vpCtx, parser_config* spConfig, parser_state* spState) {
+    parser* spCtx = (parser*) vpCtx;
+    if(!vpCtx || (spCtx->vpValidate != s_vpMagicNumber)){
+        vExContext();
+        return; // should never return
+    }
+    vParserCheck(spCtx, spConfig, spState);
+    if (!spCtx->acpInputString || (spConfig->acpInput != spCtx->acpConfigInput)
+            || (spConfig->uiInputLength != spCtx->uiInputStringLength)) {
+        XTHROW(spCtx->spException, "input string is not the same as for the previous vParserParse() call");
+    }
+    spCtx->bReparse = APG_TRUE;
+    vParserStart(spCtx, spConfig, spState);
+}
+
+/** \brief Set a call back function for a specific rule.
+ *
+ * \param vpCtx Pointer to a valid parser context previously returned from \ref vpParserCtor() or vpApiOutputParser().
+ * If not valid, the application will silently exit with a \ref BAD_CONTEXT exit code.
+ * \param uiRuleId The index of the rule to set the call back function for.
+ * \param pfnCallback Pointer to the call back function.
+ */
+void vParserSetRuleCallback(void* vpCtx, aint uiRuleId, parser_callback pfnCallback) {
+    parser* spCtx = (parser*) vpCtx;
+    if (vpCtx && (spCtx->vpValidate == s_vpMagicNumber)) {
+        if (uiRuleId < spCtx->uiRuleCount) {
+            spCtx->spRules[uiRuleId].pfnCallback = pfnCallback;
+        }
+    }else{
+        vExContext();
+    }
+}
+
+/** \brief Set a call back function for a specific UDT.
+ *
+ * Note that the parser, vParserParse(), checks on initialization that
+ * all UDTs in the SABNF grammar have call back functions set.
+ *
+ * \param vpCtx Pointer to a valid parser context previously returned from \ref vpParserCtor() or vpApiOutputParser().
+ * If not valid, the application will silently exit with a \ref BAD_CONTEXT exit code.
+ * \param uiUdtId The index of the UDT to set the call back function for.
+ * \param pfnCallback Pointer to the call back function.
+ */
+void vParserSetUdtCallback(void* vpCtx, aint uiUdtId, parser_callback pfnCallback) {
+    parser* spCtx = (parser*) vpCtx;
+    if (vpCtx && (spCtx->vpValidate == s_vpMagicNumber)) {
+        if (uiUdtId < spCtx->uiUdtCount) {
+            spCtx->spUdts[uiUdtId].pfnCallback = pfnCallback;
+        }
+    }else{
+        vExContext();
+    }
+}
+
+/** \brief Get the set of operators that failed at the farthest failure offset of the last parse.
+ *
+ * The parser tracks the farthest offset at which a terminal failed to match (\ref parser_state::uiFarthestOffset)
+ * and the operators that failed there. This costs only a comparison per terminal, so the usual
+ * "expected one of ..." error report is available for every rejected input without re-parsing with a trace.
+ * \param vpCtx Pointer to a valid parser context previously returned from \ref vpParserCtor() or vpApiOutputParser().
+ * If not valid, the application will silently exit with a \ref BAD_CONTEXT exit code.
+ * \param uipCount Pointer to the number of items returned. May not be NULL.
+ * \return Pointer to an array of *uipCount items, valid until the next parse. NULL if there are none.
+ */
+const parser_expected* spParserExpected(void* vpCtx, aint* uipCount){
+    parser* spCtx = (parser*) vpCtx;
+    if (!vpCtx || (spCtx->vpValidate != s_vpMagicNumber)) {
+        vExContext();
+    }
+    if(!uipCount){
+        XTHROW(spCtx->spException, "expected item count pointer cannot be NULL");
+    }
+    const opcode** spOps = spCtx->sppFailOps;
+    aint uiCount = spCtx->uiFailCount;
+    aint ui, uj;
+    vVecClear(spCtx->vpVecExpected);
+    for(ui = 0; ui < uiCount; ui++){
+        const opcode* spOp = spOps[ui];
+        parser_expected* spItem = (parser_expected*)vpVecPushn(spCtx->vpVecExpected, NULL, 1);
+        memset((void*)spItem, 0, sizeof(*spItem));
+        spItem->uiId = spOp->sGen.uiId;
+        spItem->uiRuleIndex = APG_UNDEFINED;
+        spItem->uiTargetIndex = APG_UNDEFINED;
+        for(uj = 0; uj < spCtx->uiRuleCount; uj++){
+            const opcode* spFirst = spCtx->spRules[uj].spOp;
+            if((spOp >= spFirst) && (spOp < (spFirst + spCtx->spRules[uj].uiOpcodeCount))){
+                spItem->uiRuleIndex = uj;
+                break;
+            }
+        }
+        switch(spItem->uiId){
+        case ID_RNM:
+            spItem->uiTargetIndex = spOp->sRnm.spRule->uiRuleIndex;
+            break;
+        case ID_UDT:
+            spItem->uiTargetIndex = spOp->sUdt.spUdt->uiUdtIndex;
+            break;
+        case ID_TRG:
+            spItem->acMin = spOp->sTrg.acMin;
+            spItem->acMax = spOp->sTrg.acMax;
+            break;
+        case ID_TLS:
+            spItem->acpString = spOp->sTls.acpStrTbl;
+            spItem->uiStringLength = spOp->sTls.uiStrLen;
+            break;
+        case ID_TBS:
+            spItem->acpString = spOp->sTbs.acpStrTbl;
+            spItem->uiStringLength = spOp->sTbs.uiStrLen;
+            break;
+        }
+    }
+    *uipCount = uiCount;
+    return uiCount ? (const parser_expected*)vpVecFirst(spCtx->vpVecExpected) : NULL;
+}
+
+/** \brief Advance the farthest failure offset to the current offset.
+ *
+ * Called only through the macro \ref PARSER_FAIL, which records the failed opcode itself.
+ * \param spCtx Pointer to the parser context.
+ */
+void vParserFail(parser* spCtx){
+    spCtx->uiFailOffset = spCtx->uiOffset;
+    spCtx->uiFailCount = 0;
+    vParserFailGeneration(spCtx);
+}
+
+/** \brief Check the parse limits.
+ *
+ * Called only through the macro \ref PARSER_LIMIT when the hit count has reached
+ * the point where a limit may have been exceeded or the clock is due to be checked.
+ * \param spCtx Pointer to the parser context.
+ * \return True if a limit has been exceeded and the node is to fail immediately, false otherwise.
+ */
+abool bParserLimit(parser* spCtx){
+    if(spCtx->uiLimit){
+        return APG_TRUE;
+    }
+    if(spCtx->uiMaxHits && (spCtx->sState.uiHitCount >= spCtx->uiMaxHits)){
+        spCtx->uiLimit = ID_LIMIT_HITS;
+    }else if(spCtx->uiCheckInterval && (spCtx->sState.uiHitCount >= spCtx->uiNextCheck)){
+        if(uiParserNow() >= spCtx->uiDeadline){
+            spCtx->uiLimit = ID_LIMIT_TIME;
+        }else{
+            spCtx->uiNextCheck = spCtx->sState.uiHitCount + spCtx->uiCheckInterval;
+            if(spCtx->uiNextCheck < spCtx->sState.uiHitCount){
+                spCtx->uiNextCheck = APG_MAX_AINT;
+            }
+            spCtx->uiHitLimit = spCtx->uiNextCheck;
+            if(spCtx->uiMaxHits && (spCtx->uiMaxHits < spCtx->uiHitLimit)){
+                spCtx->uiHitLimit = spCtx->uiMaxHits;
+            }
+        }
+    }
+    if(spCtx->uiLimit){
+        // every node from here on fails on entry
+        spCtx->uiHitLimit = 0;
+        return APG_TRUE;
+    }
+    return APG_FALSE;
+}
+
+/** \brief The tree depth limit has been exceeded.
+ *
+ * Called only through the macro \ref PARSER_DEPTH. The current node continues
+ * but all nodes below it, and all that follow, fail on entry.
+ * \param spCtx Pointer to the parser context.
+ */
+void vParserDepthLimit(parser* spCtx){
+    if(!spCtx->uiLimit){
+        spCtx->uiLimit = ID_LIMIT_DEPTH;
+        spCtx->uiHitLimit = 0;
+    }
+}
+
+/** \brief Validate the parser configuration and clear the parser state.
+ */
+static void vParserCheck(parser* spCtx, parser_config* spConfig, parser_state* spState){
+    aint ui;
     if(!spConfig){
         XTHROW(spMemException(spCtx->vpMem), "parser configuration pointer cannot be NULL");
         return; // should never return
@@ -298,10 +571,13 @@ void vParserParse(void* vpCtx, parser_config* spConfig, parser_state* spState) {
             }
         }
     }
+}
 
-    vVecClear(spCtx->vpVecInputString);
-    spCtx->acpInputString = (achar*)vpVecPushn(spCtx->vpVecInputString, (void*)spConfig->acpInput, spConfig->uiInputLength);
-    spCtx->uiInputStringLength = spConfig->uiInputLength;
+/** \brief Set up the parser for the input string and run the start rule.
+ *
+ * The input string has already been copied to the parser's input vector.
+ */
+static void vParserStart(parser* spCtx, parser_config* spConfig, parser_state* spState){
     spCtx->uiStartRule = spConfig->uiStartRule;
     if (spConfig->bParseSubString) {
         // set the beginning and end of the sub string
@@ -313,14 +589,14 @@ void vParserParse(void* vpCtx, parser_config* spConfig, parser_state* spState) {
             spCtx->uiSubStringEnd = spCtx->uiInputStringLength;
         } else {
             spCtx->uiSubStringEnd = spCtx->uiSubStringBeg + spConfig->uiSubStringLength;
-            if(spCtx->uiSubStringEnd > spConfig->uiInputLength){
-                spCtx->uiSubStringEnd = spConfig->uiInputLength;
+            if(spCtx->uiSubStringEnd > spCtx->uiInputStringLength){
+                spCtx->uiSubStringEnd = spCtx->uiInputStringLength;
             }
         }
     } else {
         // parse the entire string
         spCtx->uiSubStringBeg = 0;
-        spCtx->uiSubStringEnd = spConfig->uiInputLength;
+        spCtx->uiSubStringEnd = spCtx->uiInputStringLength;
     }
     spCtx->uiSubStringLength = spCtx->uiSubStringEnd - spCtx->uiSubStringBeg;
     spCtx->uiOffset = spCtx->uiSubStringBeg;
@@ -329,8 +605,24 @@ void vParserParse(void* vpCtx, parser_config* spConfig, parser_state* spState) {
     if ((spConfig->uiLookBehindLength == 0) || (spConfig->uiLookBehindLength == APG_INFINITE)) {
         spCtx->uiLookBehindLength = spCtx->uiInputStringLength;
     } else {
-        spCtx->uiLookBehindLength = spCtx->uiInputStringLength < spCtx->uiLookBehindLength ?
-                spCtx->uiInputStringLength : spCtx->uiLookBehindLength;
+        spCtx->uiLookBehindLength = spCtx->uiInputStringLength < spConfig->uiLookBehindLength ?
+                spCtx->uiInputStringLength : spConfig->uiLookBehindLength;
+    }
+
+    // set the parse limits, if any
+    spCtx->uiLimit = 0;
+    spCtx->uiMaxHits = spConfig->uiMaxHits;
+    spCtx->uiDepthLimit = spConfig->uiMaxTreeDepth ? spConfig->uiMaxTreeDepth : APG_MAX_AINT;
+    spCtx->uiCheckInterval = 0;
+    spCtx->uiNextCheck = APG_MAX_AINT;
+    if(spConfig->uiMaxMilliseconds){
+        spCtx->uiCheckInterval = spConfig->uiCheckInterval ? spConfig->uiCheckInterval : PARSER_CHECK_INTERVAL;
+        spCtx->uiNextCheck = spCtx->uiCheckInterval;
+        spCtx->uiDeadline = uiParserNow() + ((uint64_t)spConfig->uiMaxMilliseconds * 1000000);
+    }
+    spCtx->uiHitLimit = spCtx->uiNextCheck;
+    if(spCtx->uiMaxHits && (spCtx->uiMaxHits < spCtx->uiHitLimit)){
+        spCtx->uiHitLimit = spCtx->uiMaxHits;
     }
 
     // initialize the callback data (callback functions only see the substring)
@@ -348,11 +640,15 @@ void vParserParse(void* vpCtx, parser_config* spConfig, parser_state* spState) {
 
     // reset attached trace and AST if any (stats, if any, are cumulative)
     TRACE_BEGIN(spCtx->vpTrace);
+    STATS_BEGIN(spCtx->vpStats);
     AST_CLEAR(spCtx->vpAst);
 
     // create a dummy RNM opcode for the start rule and start the parser
     memset((void*)&spCtx->sState, 0, sizeof(spCtx->sState));
     spCtx->uiTreeDepth = 0;
+    spCtx->uiFailOffset = spCtx->uiSubStringBeg;
+    spCtx->uiFailCount = 0;
+    vParserFailGeneration(spCtx);
     spCtx->sStartOp.sRnm.spRule = &spCtx->spRules[spCtx->uiStartRule];
     spCtx->sStartOp.sRnm.uiId = ID_RNM;
     spCtx->sStartOp.sRnm.ucpPpptMap = spCtx->spRules[spCtx->uiStartRule].ucpPpptMap;
@@ -366,7 +662,14 @@ void vParserParse(void* vpCtx, parser_config* spConfig, parser_state* spState) {
     spCtx->sState.uiPhraseLength =
             spCtx->uiOffset > spCtx->uiSubStringBeg ? spCtx->uiOffset - spCtx->uiSubStringBeg : 0;
     spCtx->sState.uiStringLength = spCtx->uiSubStringLength;
-    if (spCtx->sState.uiState == ID_NOMATCH) {
+    spCtx->sState.uiFarthestOffset = spCtx->uiFailOffset - spCtx->uiSubStringBeg;
+    if (spCtx->uiLimit) {
+        // the parse was abandoned, the unwound state is meaningless
+        spCtx->sState.uiState = ID_LIMIT;
+        spCtx->sState.uiLimit = spCtx->uiLimit;
+        spCtx->sState.uiPhraseLength = 0;
+        spCtx->sState.uiSuccess = APG_FALSE;
+    } else if (spCtx->sState.uiState == ID_NOMATCH) {
         spCtx->sState.uiSuccess = APG_FALSE;
     } else if (spCtx->sState.uiPhraseLength == spCtx->sState.uiStringLength) {
         spCtx->sState.uiSuccess = APG_TRUE;
@@ -376,42 +679,26 @@ void vParserParse(void* vpCtx, parser_config* spConfig, parser_state* spState) {
     memcpy((void*) spState, (void*) &spCtx->sState, sizeof(*spState));
 }
 
-/** \brief Set a call back function for a specific rule.
- *
- * \param vpCtx Pointer to a valid parser context previously returned from \ref vpParserCtor() or vpApiOutputParser().
- * If not valid, the application will silently exit with a \ref BAD_CONTEXT exit code.
- * \param uiRuleId The index of the rule to set the call back function for.
- * \param pfnCallback Pointer to the call back function.
- */
-void vParserSetRuleCallback(void* vpCtx, aint uiRuleId, parser_callback pfnCallback) {
-    parser* spCtx = (parser*) vpCtx;
-    if (vpCtx && (spCtx->vpValidate == s_vpMagicNumber)) {
-        if (uiRuleId < spCtx->uiRuleCount) {
-            spCtx->spRules[uiRuleId].pfnCallback = pfnCallback;
-        }
-    }else{
-        vExContext();
-    }
+static uint64_t uiParserNow(void){
+    struct timespec sTime;
+#ifdef CLOCK_MONOTONIC
+    clock_gettime(CLOCK_MONOTONIC, &sTime);
+#else
+    timespec_get(&sTime, TIME_UTC);
+#endif /* CLOCK_MONOTONIC */
+    return ((uint64_t) sTime.tv_sec * 1000000000) + (uint64_t) sTime.tv_nsec;
 }
 
-/** \brief Set a call back function for a specific UDT.
+/** \brief Start a new generation of failed opcodes.
  *
- * Note that the parser, vParserParse(), checks on initialization that
- * all UDTs in the SABNF grammar have call back functions set.
- *
- * \param vpCtx Pointer to a valid parser context previously returned from \ref vpParserCtor() or vpApiOutputParser().
- * If not valid, the application will silently exit with a \ref BAD_CONTEXT exit code.
- * \param uiUdtId The index of the UDT to set the call back function for.
- * \param pfnCallback Pointer to the call back function.
+ * On the (very) rare wrap-around of the generation counter all stamps are cleared.
+ * \param spCtx Pointer to the parser context.
  */
-void vParserSetUdtCallback(void* vpCtx, aint uiUdtId, parser_callback pfnCallback) {
-    parser* spCtx = (parser*) vpCtx;
-    if (vpCtx && (spCtx->vpValidate == s_vpMagicNumber)) {
-        if (uiUdtId < spCtx->uiUdtCount) {
-            spCtx->spUdts[uiUdtId].pfnCallback = pfnCallback;
-        }
-    }else{
-        vExContext();
+void vParserFailGeneration(parser* spCtx){
+    spCtx->uiFailGeneration++;
+    if(spCtx->uiFailGeneration == 0){
+        memset((void*)spCtx->uipFailStamps, 0, sizeof(aint) * (spCtx->uiOpcodeCount + 1));
+        spCtx->uiFailGeneration = 1;
     }
 }
 
@@ -530,11 +817,13 @@ static void vPrintMap(achar acMin, achar acMax, const uint8_t* ucpMap){
  * \param spCtx Pointer to a parser context.
  * \param spOp Pointer to an opcode.
  * \param uiOffset Offset into the input string of the alphabet character to check the PPPT state of.
+ * \param uipPhraseLength Pointer to receive the phrase length of a deterministic match.
  * \return The state that the PPPT maps this opcode and character to.
  */
-aint uiPpptState(parser* spCtx, const opcode* spOp, aint uiOffset){
+aint uiPpptState(parser* spCtx, const opcode* spOp, aint uiOffset, aint* uipPhraseLength){
     achar acChar;
     uint8_t ucVal;
+    *uipPhraseLength = 0;
     if(!spCtx->ucpMaps){
         return ID_ACTIVE;
     }
@@ -561,6 +850,21 @@ aint uiPpptState(parser* spCtx, const opcode* spOp, aint uiOffset){
             return ID_NOMATCH;
         }
         ucVal = spOp->sGen.ucpPpptMap[acChar - spCtx->acAcharMin];
+#ifndef APG_NO_PPPT2
+        if(ucVal >= ID_PPPT_MAP2){
+            // look up the following character in the second-level map
+            const uint8_t* ucpMap2 = spCtx->ucpMaps2 + ((aint)(ucVal - ID_PPPT_MAP2) * spCtx->uiMapSize);
+            if((uiOffset + 1) >= spCtx->uiSubStringEnd){
+                ucVal = ucpMap2[spCtx->acAcharMax + 1 - spCtx->acAcharMin];
+            }else{
+                acChar = spCtx->acpInputString[uiOffset + 1];
+                if(acChar < spCtx->acAcharMin || acChar > spCtx->acAcharMax){
+                    return ID_ACTIVE;
+                }
+                ucVal = ucpMap2[acChar - spCtx->acAcharMin];
+            }
+        }
+#endif /* APG_NO_PPPT2 */
     }
 #ifdef PARSER_EVAL_DEBUG
     printf("%s: ", cpOpName(spOp->sGen.uiId));
@@ -575,6 +879,11 @@ aint uiPpptState(parser* spCtx, const opcode* spOp, aint uiOffset){
         return ID_EMPTY;
     }
     if(ucVal == ID_PPPT_MATCH){
+        *uipPhraseLength = 1;
+        return ID_MATCH;
+    }
+    if(ucVal == ID_PPPT_MATCH2){
+        *uipPhraseLength = 2;
         return ID_MATCH;
     }
     return ID_ACTIVE;
@@ -588,11 +897,16 @@ aint uiPpptState(parser* spCtx, const opcode* spOp, aint uiOffset){
  * \return Ture if the state is deterministic, false otherwise
  */
 abool bPpptEval(parser* spCtx, const opcode* spOp, aint uiOffset){
-    aint uiState = uiPpptState(spCtx, spOp, uiOffset);
+    aint uiPhraseLength;
+    aint uiState = uiPpptState(spCtx, spOp, uiOffset, &uiPhraseLength);
     switch(uiState){
     case ID_NOMATCH:
         spCtx->uiOpState = ID_NOMATCH;
         spCtx->uiPhraseLength = 0;
+        if(spOp->sGen.uiId < ID_AND){
+            // look around operators do not consume input, they are not "expected" phrases
+            PARSER_FAIL(spCtx, spOp);
+        }
         return APG_TRUE;
     case ID_EMPTY:
         spCtx->uiOpState = ID_MATCH;
@@ -600,8 +914,8 @@ abool bPpptEval(parser* spCtx, const opcode* spOp, aint uiOffset){
         return APG_TRUE;
     case ID_MATCH:
         spCtx->uiOpState = ID_MATCH;
-        spCtx->uiPhraseLength = 1;
-        spCtx->uiOffset++;
+        spCtx->uiPhraseLength = uiPhraseLength;
+        spCtx->uiOffset += uiPhraseLength;
         return APG_TRUE;
     }
     return APG_FALSE;
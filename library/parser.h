@@ -73,9 +73,11 @@ One or more arrays may be created of size ID_GEN and data for all other opcodes
 #define ID_MATCH                21 /**< \brief indicates a matched phrase parser state on return from parse tree below this node */
 #define ID_NOMATCH              22 /**< \brief indicates that no phrase was matched on return from parse tree below this node */
 #define ID_EMPTY                23 /**< \brief indicates a matched empty phrase parser state on return from parse tree below this node */
+#define ID_LIMIT                24 /**< \brief indicates that the parse was abandoned because a \ref parser_config limit was exceeded */
 /// \}
 /** \name PPPT Map Values
  * These are the four possible values for a single character in a Partially-Predictive Parsing Table map.
+ * Second-level maps, keyed on the character following an ACTIVE character, may also have the value \ref ID_PPPT_MATCH2.
  */
 /// \{
 #define ID_PPPT_NOMATCH         0 /**< \brief deterministic NOMATCH &ndash; there is no chance of a phrase match with this leading character */
@@ -83,6 +85,19 @@ One or more arrays may be created of size ID_GEN and data for all other opcodes
 #define ID_PPPT_EMPTY           2 /**< \brief deterministic EMTPY &ndash; this is an empty string match, the parse succeeds but the phrase length is 0 */
 #define ID_PPPT_ACTIVE          3 /**< \brief non-deterministic &ndash; it is not possible to determine a match or not based on this character
                                      &ndash; the parser will have to do a full, normal parse to find out */
+#define ID_PPPT_MATCH2          4 /**< \brief deterministic MATCH &ndash; (second-level maps only) the two characters constitute a phrase match of length 2 */
+#define ID_PPPT_MAP2            5 /**< \brief non-deterministic, but with a second-level map &ndash; a map value of ID_PPPT_MAP2 + i
+                                     is ACTIVE and the following character is to be looked up in the i-th second-level map */
+#define PPPT_MAP2_MAX           (256 - ID_PPPT_MAP2) /**< \brief The maximum number of second-level maps. */
+/// \}
+/** \name Parse Limits
+ * When the parser state is \ref ID_LIMIT these identify the \ref parser_config limit that was exceeded.
+ */
+/// \{
+#define ID_LIMIT_HITS           25 /**< \brief the node hit count reached \ref parser_config::uiMaxHits */
+#define ID_LIMIT_DEPTH          26 /**< \brief the parse tree depth exceeded \ref parser_config::uiMaxTreeDepth */
+#define ID_LIMIT_TIME           27 /**< \brief the parse time reached \ref parser_config::uiMaxMilliseconds */
+#define PARSER_CHECK_INTERVAL   4096 /**< \brief The default number of nodes between clock checks. */
 /// \}
 /** \name Asymetric Syntax Tree (AST) States and Return Codes
  * These identifiers are used for the traversal direction and return codes in AST call back functions.
@@ -182,15 +197,40 @@ typedef void (*parser_callback)(callback_data* spData);
  */
 typedef struct{
     aint uiSuccess; /**< \brief True (>0) if the input string was matched *in its entirety*, false (0) otherwise. */
-    aint uiState; /**< \brief One of \ref ID_EMPTY, \ref ID_MATCH or \ref ID_NOMATCH.
+    aint uiState; /**< \brief One of \ref ID_EMPTY, \ref ID_MATCH, \ref ID_NOMATCH or \ref ID_LIMIT.
                 Note that it is possible for the parser to match a phrase without matching the entire input string.
                 In this case the state would be ID_MATCH or ID_EMPTY but uiSuccess would be false. */
     aint uiPhraseLength; /**< \brief Length of the matched phrase. */
     aint uiStringLength; /**< \brief Length of the input string. */
     aint uiMaxTreeDepth; /**< \brief The maximum tree depth reached during the parse. */
     aint uiHitCount; /**< \brief The number of nodes visited during the traversal of the parse tree. */
+    aint uiLimit; /**< \brief If the state is \ref ID_LIMIT, the limit that was exceeded:
+                \ref ID_LIMIT_HITS, \ref ID_LIMIT_DEPTH or \ref ID_LIMIT_TIME. Otherwise 0. */
+    aint uiFarthestOffset; /**< \brief The farthest offset, relative to the beginning of the sub-string, at which
+                a terminal (or an operator rejected by the PPPT) failed to match, outside of look around.
+                Call \ref spParserExpected() for the operators that failed there. */
 } parser_state;
 
+/** \struct parser_expected
+ * \brief One of the operators that failed to match at the farthest failure offset.
+ *
+ * Together they form the set of what the parser "expected" to find at that point in the input string.
+ * Retrieved with \ref spParserExpected().
+ */
+typedef struct{
+    aint uiId; /**< \brief The operator type, \ref ID_TRG, \ref ID_TLS, \ref ID_TBS, \ref ID_UDT or \ref ID_BKR.
+                With PPPT it may also be any operator rejected by its PPPT map, e.g. \ref ID_RNM. */
+    aint uiRuleIndex; /**< \brief Index of the rule whose definition contains the operator.
+                APG_UNDEFINED for the start rule's RNM operator. */
+    aint uiTargetIndex; /**< \brief For \ref ID_RNM the index of the rule referenced, for \ref ID_UDT the UDT index,
+                otherwise APG_UNDEFINED. */
+    const achar* acpString; /**< \brief For \ref ID_TLS and \ref ID_TBS the string, otherwise NULL.
+                TLS strings are in lower case. */
+    aint uiStringLength; /**< \brief The number of characters in acpString. */
+    achar acMin; /**< \brief For \ref ID_TRG the minimum character of the range. */
+    achar acMax; /**< \brief For \ref ID_TRG the maximum character of the range. */
+} parser_expected;
+
 /** \struct parser_config
  * \brief Defines the input string and other configuration parameters for the parser,
  *
@@ -210,17 +250,25 @@ typedef struct {
     void* vpUserData; /**< \brief Pointer to user data, if any.
                         Not examined or used by the parser in any way.
                         Presented to the user's callback functions. */
+    aint uiMaxHits; /**< \brief If non-zero, abandon the parse when the node hit count reaches this number. */
+    aint uiMaxTreeDepth; /**< \brief If non-zero, abandon the parse when the parse tree grows deeper than this.
+                        The first node beyond the limit is entered but all of its children fail. */
+    aint uiMaxMilliseconds; /**< \brief If non-zero, abandon the parse when it has run for this many milliseconds. */
+    aint uiCheckInterval; /**< \brief The number of nodes between clock checks for uiMaxMilliseconds.
+                        If 0, \ref PARSER_CHECK_INTERVAL is used. */
 } parser_config;
 
 void* vpParserCtor(exception* spException, void* vpParserInit);
 void vParserDtor(void* vpCtx);
 abool bParserValidate(void* vpCtx);
 void vParserParse(void* vpCtx, parser_config* spConfig, parser_state* spState);
+void vParserReparse(void* vpCtx, parser_config* spConfig, parser_state* spState);
 aint uiParserRuleLookup(void* vpCtx, const char* cpRuleName);
 aint uiParserUdtLookup(void* vpCtx, const char* cpUdtName);
 const char* cpParserRuleName(void* vpCtx, aint uiRuleIndex);
 const char* cpParserUdtName(void* vpCtx, aint uiUdtIndex);
 void vParserSetRuleCallback(void* vpCtx, aint uiRuleId, parser_callback pfnCallback);
 void vParserSetUdtCallback(void* vpCtx, aint uiUdtId, parser_callback pfnCallback);
+const parser_expected* spParserExpected(void* vpCtx, aint* uipCount);
 
 #endif /* LIB_PARSER_H_ */
@@ -329,6 +329,8 @@ typedef struct parser_tag {
     void* vpBkru; /**< \brief Pointer to the universal-mode back reference object context, if any. See \ref vpBkruCtor(). */
     void* vpBkrp; /**< \brief Pointer to the parent-mode back reference object context, if any. See \ref vpBkrpCtor(). */
     pfn_op* pfnOpFunc; /**< \brief  Pointer to the current node operation function. */
+    pfn_op* pfnOpFull; /**< \brief  The instrumented set of node operation functions. */
+    pfn_op* pfnOpLean; /**< \brief  The lean set of node operation functions, if any. See \ref APG_LEAN_OPERATORS. */
 
     // grammar data
     const char* cpStringTable; /**< \brief  Pointer to the ASCII string table with rule and UDT names. */
@@ -346,6 +348,8 @@ typedef struct parser_tag {
     void* vpVecInputString; /**< \brief  Vector to keep a copy of the input string. */
     const achar* acpInputString; /**< \brief  Pointer to the input string. */
     aint uiInputStringLength; /**< \brief  Number of characters in the input string. */
+    const achar* acpConfigInput; /**< \brief  The caller's input string pointer, used to validate \ref vParserReparse(). */
+    abool bReparse; /**< \brief  True if the input string has not changed since the previous parse. */
     aint uiSubStringBeg; /**< \brief  The offset to the first character of the sub-string to parse. */
     aint uiSubStringEnd; /**< \brief  The offset to the first character beyond the end of the sub-string to parse. */
     aint uiSubStringLength; /**< \brief The number of characters in the substring to parse.*/
@@ -356,6 +360,7 @@ typedef struct parser_tag {
 
     // PPPT
     const uint8_t* ucpMaps; /**< \brief  Pointer to the PPPT maps. */
+    const uint8_t* ucpMaps2; /**< \brief  Pointer to the second-level (two-character) PPPT maps, if any. */
     aint uiMapSize; /**< \brief  Number of bytes in a single PPPT map. */
     aint uiMapCount; /**< \brief  Number of maps in the PPPT. */
     achar acAcharMin; /**< \brief  The minimum alphabet character referenced by the SABNF grammar. */
@@ -374,6 +379,23 @@ typedef struct parser_tag {
 
     // parsing state
     parser_state sState; /**< \brief The final state of the parser. */
+
+    // parse limits
+    aint uiHitLimit; /**< \brief The hit count at which \ref bParserLimit() must be called. */
+    aint uiDepthLimit; /**< \brief The configured maximum tree depth, APG_MAX_AINT if none. */
+    aint uiMaxHits; /**< \brief The configured maximum hit count, 0 if none. */
+    aint uiCheckInterval; /**< \brief The number of nodes between clock checks, 0 if there is no time limit. */
+    aint uiNextCheck; /**< \brief The hit count at the next clock check. */
+    uint64_t uiDeadline; /**< \brief The clock time, in nanoseconds, at which the parse is abandoned. */
+    aint uiLimit; /**< \brief The limit exceeded, \ref ID_LIMIT_HITS, etc., or 0 if none. */
+
+    // farthest failure
+    aint uiFailOffset; /**< \brief The farthest offset at which an operator has failed. */
+    aint uiFailGeneration; /**< \brief Incremented each time uiFailOffset advances. */
+    aint* uipFailStamps; /**< \brief For each opcode (plus the start rule's RNM), the generation it last failed in. */
+    const union opcode_tag** sppFailOps; /**< \brief The opcodes that failed at uiFailOffset, each at most once. */
+    aint uiFailCount; /**< \brief The number of opcodes in sppFailOps. */
+    void* vpVecExpected; /**< \brief The \ref parser_expected list built from sppFailOps on request. */
 } parser;
 
 void* vpParserAllocCtor(exception* spException, void* vpParserInit, abool bAllocateTables);
@@ -384,11 +406,52 @@ void vTranslateRules(parser* spCtx, rule* spRules, opcode* spOpcodes, luint* lui
 void vTranslateUdts(parser* spCtx, udt* spUdts, luint* luipData);
 void vTranslateOpcodes(parser* spCtx, rule* spRules, udt* spUdts, opcode* spOpcodes, luint* luipData);
 uint8_t ucGetMapVal(const uint8_t* ucpMap, luint luiOffset, luint luiChar);
+void vParserSelectOperators(parser* spCtx);
+void vParserFail(parser* spCtx);
+void vParserFailGeneration(parser* spCtx);
+abool bParserLimit(parser* spCtx);
+void vParserDepthLimit(parser* spCtx);
+
+/** \def PARSER_LIMIT
+ * \brief Abandon the node if a parse limit has been exceeded.
+ *
+ * Called on entry to every node operation. A single comparison unless a limit
+ * or a clock check is due. Once a limit has been exceeded every node fails immediately,
+ * unwinding the parse without an exception.
+ */
+#define PARSER_LIMIT(x) if(((x)->sState.uiHitCount >= (x)->uiHitLimit) && bParserLimit(x)){\
+    (x)->uiOpState = ID_NOMATCH; (x)->uiPhraseLength = 0; return;}
+
+/** \def PARSER_DEPTH
+ * \brief Check the tree depth limit.
+ *
+ * Called only when the tree depth reaches a new maximum, so it costs nothing in the steady state.
+ * If the limit is exceeded all nodes below this one fail on entry.
+ */
+#define PARSER_DEPTH(x) if((x)->uiTreeDepth > (x)->uiDepthLimit){vParserDepthLimit(x);}
+
+/** \def PARSER_FAIL
+ * \brief Record a failed terminal if it is at or beyond the farthest failure so far.
+ *
+ * Called by the terminal operators after a NOMATCH and by the PPPT when it rejects an operator.
+ * Only a comparison or two unless the failure is at the farthest offset.
+ * There the opcode's generation stamp rejects duplicates without a search.
+ * Failures in look around are ignored.
+ */
+#define PARSER_FAIL(x, o) if(((x)->uiOffset >= (x)->uiFailOffset) && !(x)->uiInLookaround){\
+    aint uiFailIndex_;\
+    if((x)->uiOffset > (x)->uiFailOffset){vParserFail((x));}\
+    uiFailIndex_ = ((o) == &(x)->sStartOp) ? (x)->uiOpcodeCount : (aint)((o) - (x)->spOpcodes);\
+    if((x)->uipFailStamps[uiFailIndex_] != (x)->uiFailGeneration){\
+        (x)->uipFailStamps[uiFailIndex_] = (x)->uiFailGeneration;\
+        (x)->sppFailOps[(x)->uiFailCount++] = (o);\
+    }\
+}
 
 #ifndef APG_NO_PPPT
 void vDisplayMap();
 abool bPpptEval(parser* spCtx, const opcode* spOp, aint uiOffset);
-aint uiPpptState(parser* spCtx, const opcode* spOp, aint uiOffset);
+aint uiPpptState(parser* spCtx, const opcode* spOp, aint uiOffset, aint* uipPhraseLength);
 #endif /* APG_NO_PPPT */
 
 #endif /* LIB_PARSERP_H_ */
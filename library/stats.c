@@ -34,6 +34,28 @@
  * Hit counts are kept for each individual operator node type and each hit type (\ref ID_MATCH, \ref ID_NOMATCH).
  * For the rule name (RNM) and User-Defined Terminal (UDT) nodes, the hit counts are further refined
  * by rule/UDT name.
+ *
+ * Optionally, (see vStatsTiming()) the RNM and UDT nodes are also timed.
+ * For each rule and UDT the inclusive time (time spent in the node and all of its descendants),
+ * the exclusive time (time spent in the node less the time spent in its RNM/UDT descendants)
+ * and the maximum recursion depth (the largest number of simultaneously open nodes for the same rule) are recorded.
+ * Inclusive time is only accumulated for the outermost of recursive calls to the same rule so that it is not counted twice.
+ * The times are in nanoseconds, measured with the monotonic clock, if available.
+ * Timing adds two clock reads to each RNM and UDT node and should only be used for profiling.
+ *
+ * Optionally, (see vStatsBacktracking()) the wasted work due to backtracking is also profiled.
+ * For each rule and UDT, the number of re-entries (visits to the rule at an offset where it has been visited before
+ * in the same parse) and the number of wasted characters (characters matched by the rule but
+ * later discarded because a parent node failed) are counted. Matches inside look-around operators never
+ * consume input and are not counted as wasted.
+ * Additionally, for the most recent parse, the number of node visits at each input string offset is kept.
+ * Note that the re-entry bookkeeping requires one bit for each rule/UDT and input string character.
+ *
+ * Optionally, (see vStatsCallStacks()) the RNM/UDT call stacks are recorded as a tree.
+ * Each node visit is counted against the rule/UDT call stack that is current at the time.
+ * If timing is also enabled, the exclusive rule/UDT times are accumulated for each call stack as well.
+ * The call stacks can be exported with vStatsToFolded() in the "folded stack" format
+ * used by the standard flame graph tools.
  */
 
 #include "./apg.h"
@@ -54,8 +76,44 @@ typedef struct {
     aint uiHits; ///< \brief Total number of hits.
     aint uiMatch; ///< \brief Number of matched hits.
     aint uiNomatch; ///< \brief Number of not matched hits.
+    uint64_t uiInclusive; ///< \brief Inclusive time, in nanoseconds (timing mode only).
+    uint64_t uiExclusive; ///< \brief Exclusive time, in nanoseconds (timing mode only).
+    aint uiMaxDepth; ///< \brief Maximum recursion depth (timing mode only).
+    aint uiActive; ///< \brief Number of currently open nodes for this rule/UDT (timing mode only).
+    aint uiReentries; ///< \brief Number of visits at previously visited offsets (backtracking mode only).
+    aint uiWasted; ///< \brief Number of matched characters later discarded (backtracking mode only).
 } node_stat;
 
+/** \struct match_record
+ * \brief A rule/UDT phrase that may yet be discarded by a parent node failure.
+ */
+typedef struct {
+    node_stat* spStat; ///< \brief The rule/UDT statistics for the matched node.
+    aint uiOffset; ///< \brief The offset of the matched phrase.
+    aint uiLength; ///< \brief The length of the matched phrase.
+} match_record;
+
+/** \struct stack_node
+ * \brief A node in the tree of RNM/UDT call stacks.
+ */
+typedef struct {
+    aint uiId; ///< \brief The rule index or, for UDTs, the rule count plus the UDT index.
+    aint uiParent; ///< \brief Index of the parent (calling) stack node.
+    aint uiChild; ///< \brief Index of the first child stack node, if any.
+    aint uiSibling; ///< \brief Index of the next sibling stack node, if any.
+    aint uiHits; ///< \brief The number of node hits with this call stack current.
+    uint64_t uiTime; ///< \brief The exclusive time, in nanoseconds, spent with this call stack current (timing mode only).
+} stack_node;
+
+/** \struct timing_frame
+ * \brief Timing information for an open RNM or UDT node.
+ */
+typedef struct {
+    node_stat* spStat; ///< \brief The rule/UDT statistics for this node.
+    uint64_t uiStart; ///< \brief The time at which the node was opened.
+    uint64_t uiChildren; ///< \brief The accumulated inclusive time of all RNM/UDT child nodes.
+} timing_frame;
+
 /** \struct stats
  * \brief The totality of all node statistics.
  */
@@ -91,6 +149,21 @@ typedef struct {
     exception* spException; ///< \brief Pointer to the exception structure for
                             /// reporting fatal errors back to the parser's catch block scope.
     stats sStats; ///< \brief The totality of all node statistics.
+    void* vpVecFrames; ///< \brief Stack of open RNM/UDT nodes for timing.
+    abool bTiming; ///< \brief True if RNM/UDT node timing is enabled.
+    abool bTimingParse; ///< \brief True if RNM/UDT node timing is enabled for the current parse.
+    abool bTimed; ///< \brief True if any timing data has been collected.
+    void* vpVecMatches; ///< \brief Stack of rule/UDT matches that may yet be discarded.
+    void* vpVecVisited; ///< \brief Bit map of the rule/UDT offsets visited in the current parse.
+    void* vpVecVisits; ///< \brief The number of node visits at each input string offset of the current parse.
+    aint uiOffsets; ///< \brief The number of offsets in the visits histogram (input string length + 1).
+    abool bBacktracking; ///< \brief True if the backtracking profile is enabled.
+    abool bBacktrackingParse; ///< \brief True if the backtracking profile is enabled for the current parse.
+    abool bBacktracked; ///< \brief True if any backtracking data has been collected.
+    void* vpVecStacks; ///< \brief The tree of RNM/UDT call stacks. The first node is the root (no rule).
+    aint uiStack; ///< \brief Index of the current call stack node.
+    abool bStacks; ///< \brief True if the call stacks are recorded.
+    abool bStacksParse; ///< \brief True if the call stacks are recorded for the current parse.
 } stats_ctx;
 
 static char* s_cpPageHeader;
@@ -99,6 +172,20 @@ static char s_cHits = 'h';
 static char s_cAlpha = 'a';
 static int compareNames(const void* l, const void* r);
 static int compareHits(const void* l, const void* r);
+static int compareTimes(const void* l, const void* r);
+static uint64_t uiNow(void);
+static void vBacktrack(stats_ctx* spCtx, const opcode* spOp, aint uiState, node_stat* spRuleStat);
+static int compareWasted(const void* l, const void* r);
+static void vBacktrackingToAscii(FILE* spOut, node_stat* spNodes, aint uiCount, char cMode, const char* cpName);
+static void vBacktrackingToHtml(FILE* spOut, node_stat* spNodes, aint uiCount, const char* cpName);
+static void vHeatColor(char* cpBuf, aint uiValue, aint uiMax);
+static aint uiStackPush(stats_ctx* spCtx, const opcode* spOp);
+static void vStackToFolded(stats_ctx* spCtx, FILE* spOut, aint* uipFrames, abool bTime);
+static node_stat* spTimedStat(stats* spStats, const opcode* spOp);
+static void vTimingToAscii(FILE* spOut, node_stat* spNodes, aint uiCount, char cMode, const char* cpName);
+static void vTimingToHtml(FILE* spOut, node_stat* spNodes, aint uiCount, char cMode, const char* cpName);
+static void vTimingToCsv(FILE* spOut, node_stat* spNodes, aint uiCount, const char* cpType);
+static void vTimingToJson(FILE* spOut, node_stat* spNodes, aint uiCount);
 
 /** \brief The statistics object constructor.
  *
@@ -138,12 +225,147 @@ void* vpStatsCtor(void* vpParserCtx) {
         }
     }
 
+    spCtx->vpVecFrames = vpVecCtor(spParserCtx->vpMem, (aint) sizeof(timing_frame), 128);
+    spCtx->vpVecMatches = vpVecCtor(spParserCtx->vpMem, (aint) sizeof(match_record), 512);
+    spCtx->vpVecVisited = vpVecCtor(spParserCtx->vpMem, (aint) sizeof(uint8_t), 1024);
+    spCtx->vpVecVisits = vpVecCtor(spParserCtx->vpMem, (aint) sizeof(aint), 1024);
+    spCtx->vpVecStacks = vpVecCtor(spParserCtx->vpMem, (aint) sizeof(stack_node), 512);
+    stack_node* spRoot = (stack_node*) vpVecPush(spCtx->vpVecStacks, NULL);
+    memset((void*) spRoot, 0, sizeof(stack_node));
+    spRoot->uiId = APG_UNDEFINED;
+    spRoot->uiParent = APG_UNDEFINED;
+    spRoot->uiChild = APG_UNDEFINED;
+    spRoot->uiSibling = APG_UNDEFINED;
+
     // success
     spParserCtx->vpStats = (void*) spCtx;
+    vParserSelectOperators(spParserCtx);
     spCtx->vpValidate = s_vpMagicNumber;
     return (void*) spCtx;
 }
 
+/** \brief Turns the RNM/UDT node timing on or off.
+ *
+ * Timing is off by default. When on, each RNM and UDT node is timed and the
+ * inclusive time, exclusive time and maximum recursion depth are accumulated for each rule and UDT.
+ * Like the hit counts, the times accumulate over all parses.
+ * The switch takes effect at the beginning of the next parse.
+ * \param vpCtx Pointer to a valid statistics context returned from vpStatsCtor()
+ * If not valid the application will silently exit with a \ref BAD_CONTEXT exit code.
+ * \param bEnable If true, timing is turned on, otherwise it is turned off.
+ */
+void vStatsTiming(void* vpCtx, abool bEnable) {
+    stats_ctx* spCtx = (stats_ctx*) vpCtx;
+    if(!spCtx || (spCtx->vpValidate != s_vpMagicNumber)){
+        vExContext();
+        return; // should never return
+    }
+    spCtx->bTiming = bEnable ? APG_TRUE : APG_FALSE;
+}
+
+/** \brief Turns the backtracking profile on or off.
+ *
+ * The backtracking profile is off by default. When on, the re-entries and wasted characters are
+ * accumulated for each rule and UDT and the node visits are counted for each offset of the input string.
+ * The rule/UDT counts accumulate over all parses. The offset histogram is for the most recent parse only.
+ * The switch takes effect at the beginning of the next parse.
+ * \param vpCtx Pointer to a valid statistics context returned from vpStatsCtor()
+ * If not valid the application will silently exit with a \ref BAD_CONTEXT exit code.
+ * \param bEnable If true, the backtracking profile is turned on, otherwise it is turned off.
+ */
+void vStatsBacktracking(void* vpCtx, abool bEnable) {
+    stats_ctx* spCtx = (stats_ctx*) vpCtx;
+    if(!spCtx || (spCtx->vpValidate != s_vpMagicNumber)){
+        vExContext();
+        return; // should never return
+    }
+    spCtx->bBacktracking = bEnable ? APG_TRUE : APG_FALSE;
+}
+
+/** \brief Turns the recording of the RNM/UDT call stacks on or off.
+ *
+ * Call stack recording is off by default. When on, each node hit is counted against the
+ * current stack of open RNM and UDT nodes. If timing (vStatsTiming()) is also on, the exclusive
+ * times of the RNM and UDT nodes are accumulated for each call stack.
+ * The call stacks accumulate over all parses. Use vStatsToFolded() to export them for a flame graph.
+ * The switch takes effect at the beginning of the next parse.
+ * \param vpCtx Pointer to a valid statistics context returned from vpStatsCtor()
+ * If not valid the application will silently exit with a \ref BAD_CONTEXT exit code.
+ * \param bEnable If true, the call stacks are recorded, otherwise not.
+ */
+void vStatsCallStacks(void* vpCtx, abool bEnable) {
+    stats_ctx* spCtx = (stats_ctx*) vpCtx;
+    if(!spCtx || (spCtx->vpValidate != s_vpMagicNumber)){
+        vExContext();
+        return; // should never return
+    }
+    spCtx->bStacks = bEnable ? APG_TRUE : APG_FALSE;
+}
+
+/** \brief Prepares the statistics object for a new parse.
+ *
+ * This function is called only by the parent parser via the macro \ref STATS_BEGIN.
+ * The statistics are cumulative. Only the timing stack is reset, in case a previous parse
+ * was aborted with an exception.
+ * \param vpCtx Pointer to a valid statistics context returned from vpStatsCtor()
+ */
+void vStatsBegin(void* vpCtx) {
+    stats_ctx* spCtx = (stats_ctx*) vpCtx;
+    stats* spStats = &spCtx->sStats;
+    aint ui;
+    spCtx->bTimingParse = spCtx->bTiming;
+    vVecClear(spCtx->vpVecFrames);
+    for (ui = 0; ui < spStats->uiRuleCount; ui += 1) {
+        spStats->spRuleStats[ui].uiActive = 0;
+    }
+    for (ui = 0; ui < spStats->uiUdtCount; ui += 1) {
+        spStats->spUdtStats[ui].uiActive = 0;
+    }
+    spCtx->bStacksParse = spCtx->bStacks;
+    spCtx->uiStack = 0;
+    spCtx->bBacktrackingParse = spCtx->bBacktracking;
+    if (spCtx->bBacktrackingParse) {
+        parser* spParser = spCtx->spParserCtx;
+        aint uiBits;
+        void* vpData;
+        spCtx->uiOffsets = spParser->uiInputStringLength + 1;
+        uiBits = (spStats->uiRuleCount + spStats->uiUdtCount) * spCtx->uiOffsets;
+        vVecClear(spCtx->vpVecMatches);
+        vVecClear(spCtx->vpVecVisited);
+        vpData = vpVecPushn(spCtx->vpVecVisited, NULL, ((uiBits + 7) / 8));
+        memset(vpData, 0, (size_t) ((uiBits + 7) / 8));
+        vVecClear(spCtx->vpVecVisits);
+        vpData = vpVecPushn(spCtx->vpVecVisits, NULL, spCtx->uiOffsets);
+        memset(vpData, 0, (size_t) spCtx->uiOffsets * sizeof(aint));
+        spCtx->bBacktracked = APG_TRUE;
+    }
+}
+
+/** \brief Opens the timer for an RNM or UDT node.
+ *
+ * This function is called only by the parent parser via the macro \ref STATS_OPEN.
+ * The timer is closed by vStatsHit().
+ * \param vpCtx Pointer to a valid statistics context returned from vpStatsCtor()
+ * \param spOp Pointer to the opcode of the current node.
+ */
+void vStatsOpen(void* vpCtx, const opcode* spOp) {
+    stats_ctx* spCtx = (stats_ctx*) vpCtx;
+    if (spCtx->bTimingParse) {
+        timing_frame* spFrame = (timing_frame*) vpVecPush(spCtx->vpVecFrames, NULL);
+        spFrame->spStat = spTimedStat(&spCtx->sStats, spOp);
+        spFrame->spStat->uiActive++;
+        if (spFrame->spStat->uiActive > spFrame->spStat->uiMaxDepth) {
+            spFrame->spStat->uiMaxDepth = spFrame->spStat->uiActive;
+        }
+        spFrame->uiChildren = 0;
+        spCtx->bTimed = APG_TRUE;
+        spFrame->uiStart = uiNow();
+    }
+    if (spCtx->bStacksParse) {
+        spCtx->uiStack = uiStackPush(spCtx, spOp);
+    }
+}
+
 /** \brief Collects the statistics for a single node hit.
  *
  * This function is called only by the parent parser via the macro \ref STATS_HIT.
@@ -224,6 +446,7 @@ void vStatsHit(void* vpCtx, const opcode* spOp, aint uiState) {
     } else {
         spNodeStat->uiNomatch++;
     }
+    uint64_t uiSelf = 0;
     if (spRuleStat) {
         spRuleStat->uiHits++;
         if (uiState == ID_MATCH) {
@@ -231,6 +454,39 @@ void vStatsHit(void* vpCtx, const opcode* spOp, aint uiState) {
         } else {
             spRuleStat->uiNomatch++;
         }
+        if (spCtx->bTimingParse) {
+            // close the node timer
+            timing_frame* spFrame = (timing_frame*) vpVecPop(spCtx->vpVecFrames);
+            if (spFrame && (spFrame->spStat == spRuleStat)) {
+                uint64_t uiElapsed = uiNow() - spFrame->uiStart;
+                if (uiElapsed > spFrame->uiChildren) {
+                    uiSelf = uiElapsed - spFrame->uiChildren;
+                    spRuleStat->uiExclusive += uiSelf;
+                }
+                if (spRuleStat->uiActive == 1) {
+                    spRuleStat->uiInclusive += uiElapsed;
+                }
+                spRuleStat->uiActive--;
+                spFrame = (timing_frame*) vpVecLast(spCtx->vpVecFrames);
+                if (spFrame) {
+                    spFrame->uiChildren += uiElapsed;
+                }
+            }
+        }
+    }
+    if (spCtx->bStacksParse) {
+        stack_node* spStack = (stack_node*) vpVecAt(spCtx->vpVecStacks, spCtx->uiStack);
+        spStack->uiHits++;
+        if (spRuleStat) {
+            // close the RNM/UDT call stack frame
+            spStack->uiTime += uiSelf;
+            if (spStack->uiParent != APG_UNDEFINED) {
+                spCtx->uiStack = spStack->uiParent;
+            }
+        }
+    }
+    if (spCtx->bBacktrackingParse) {
+        vBacktrack(spCtx, spOp, uiState, spRuleStat);
     }
 }
 
@@ -274,62 +530,62 @@ void vStatsToHtml(void* vpCtx, const char* cpMode, const char* cpFileName) {
     }
     // output the page header
     fprintf(spOut, "%s", s_cpPageHeader);
-    fprintf(spOut, "<h3>Node Statistics<h3/>\n");
+    fprintf(spOut, "<h3>Node Statistics</h3>\n");
 
     // open the operators table
     fprintf(spOut, "%s", "<table class=\"apg-stats\">\n");
-    fprintf(spOut, "<caption>Operators<caption/>\n");
-    fprintf(spOut, "<tr><th>name</th><th>hits</th><th>match</th><th>no match</th><tr>\n");
+    fprintf(spOut, "<caption>Operators</caption>\n");
+    fprintf(spOut, "<tr><th>name</th><th>hits</th><th>match</th><th>no match</th></tr>\n");
     spNode = &spStats->sAlt;
     fprintf(spOut,
-            "<tr><td><span class=\"apg-remainder\">non-<br>terminals</span></td><td></td><td></td><td></td><tr>\n");
-    fprintf(spOut, "<tr><td>ALT</td><td>%"PRIuMAX"</td><td>%"PRIuMAX"</td><td>%"PRIuMAX"</td><tr>\n", (luint) spNode->uiHits,
+            "<tr><td><span class=\"apg-remainder\">non-<br>terminals</span></td><td></td><td></td><td></td></tr>\n");
+    fprintf(spOut, "<tr><td>ALT</td><td>%"PRIuMAX"</td><td>%"PRIuMAX"</td><td>%"PRIuMAX"</td></tr>\n", (luint) spNode->uiHits,
             (luint) spNode->uiMatch, (luint) spNode->uiNomatch);
     spNode = &spStats->sCat;
-    fprintf(spOut, "<tr><td>CAT</td><td>%"PRIuMAX"</td><td>%"PRIuMAX"</td><td>%"PRIuMAX"</td><tr>\n", (luint) spNode->uiHits,
+    fprintf(spOut, "<tr><td>CAT</td><td>%"PRIuMAX"</td><td>%"PRIuMAX"</td><td>%"PRIuMAX"</td></tr>\n", (luint) spNode->uiHits,
             (luint) spNode->uiMatch, (luint) spNode->uiNomatch);
     spNode = &spStats->sRep;
-    fprintf(spOut, "<tr><td>REP</td><td>%"PRIuMAX"</td><td>%"PRIuMAX"</td><td>%"PRIuMAX"</td><tr>\n", (luint) spNode->uiHits,
+    fprintf(spOut, "<tr><td>REP</td><td>%"PRIuMAX"</td><td>%"PRIuMAX"</td><td>%"PRIuMAX"</td></tr>\n", (luint) spNode->uiHits,
             (luint) spNode->uiMatch, (luint) spNode->uiNomatch);
     spNode = &spStats->sRnm;
-    fprintf(spOut, "<tr><td>RNM</td><td>%"PRIuMAX"</td><td>%"PRIuMAX"</td><td>%"PRIuMAX"</td><tr>\n", (luint) spNode->uiHits,
+    fprintf(spOut, "<tr><td>RNM</td><td>%"PRIuMAX"</td><td>%"PRIuMAX"</td><td>%"PRIuMAX"</td></tr>\n", (luint) spNode->uiHits,
             (luint) spNode->uiMatch, (luint) spNode->uiNomatch);
     spNode = &spStats->sAnd;
-    fprintf(spOut, "<tr><td>AND</td><td>%"PRIuMAX"</td><td>%"PRIuMAX"</td><td>%"PRIuMAX"</td><tr>\n", (luint) spNode->uiHits,
+    fprintf(spOut, "<tr><td>AND</td><td>%"PRIuMAX"</td><td>%"PRIuMAX"</td><td>%"PRIuMAX"</td></tr>\n", (luint) spNode->uiHits,
             (luint) spNode->uiMatch, (luint) spNode->uiNomatch);
     spNode = &spStats->sNot;
-    fprintf(spOut, "<tr><td>NOT</td><td>%"PRIuMAX"</td><td>%"PRIuMAX"</td><td>%"PRIuMAX"</td><tr>\n", (luint) spNode->uiHits,
+    fprintf(spOut, "<tr><td>NOT</td><td>%"PRIuMAX"</td><td>%"PRIuMAX"</td><td>%"PRIuMAX"</td></tr>\n", (luint) spNode->uiHits,
             (luint) spNode->uiMatch, (luint) spNode->uiNomatch);
     spNode = &spStats->sBka;
-    fprintf(spOut, "<tr><td>BKA</td><td>%"PRIuMAX"</td><td>%"PRIuMAX"</td><td>%"PRIuMAX"</td><tr>\n", (luint) spNode->uiHits,
+    fprintf(spOut, "<tr><td>BKA</td><td>%"PRIuMAX"</td><td>%"PRIuMAX"</td><td>%"PRIuMAX"</td></tr>\n", (luint) spNode->uiHits,
             (luint) spNode->uiMatch, (luint) spNode->uiNomatch);
     spNode = &spStats->sBkn;
-    fprintf(spOut, "<tr><td>BKN</td><td>%"PRIuMAX"</td><td>%"PRIuMAX"</td><td>%"PRIuMAX"</td><tr>\n", (luint) spNode->uiHits,
+    fprintf(spOut, "<tr><td>BKN</td><td>%"PRIuMAX"</td><td>%"PRIuMAX"</td><td>%"PRIuMAX"</td></tr>\n", (luint) spNode->uiHits,
             (luint) spNode->uiMatch, (luint) spNode->uiNomatch);
-    fprintf(spOut, "<tr><td><span class=\"apg-remainder\">terminals</span></td><td></td><td></td><td></td><tr>\n");
+    fprintf(spOut, "<tr><td><span class=\"apg-remainder\">terminals</span></td><td></td><td></td><td></td></tr>\n");
     spNode = &spStats->sTls;
-    fprintf(spOut, "<tr><td>TLS</td><td>%"PRIuMAX"</td><td>%"PRIuMAX"</td><td>%"PRIuMAX"</td><tr>\n", (luint) spNode->uiHits,
+    fprintf(spOut, "<tr><td>TLS</td><td>%"PRIuMAX"</td><td>%"PRIuMAX"</td><td>%"PRIuMAX"</td></tr>\n", (luint) spNode->uiHits,
             (luint) spNode->uiMatch, (luint) spNode->uiNomatch);
     spNode = &spStats->sTbs;
-    fprintf(spOut, "<tr><td>TBS</td><td>%"PRIuMAX"</td><td>%"PRIuMAX"</td><td>%"PRIuMAX"</td><tr>\n", (luint) spNode->uiHits,
+    fprintf(spOut, "<tr><td>TBS</td><td>%"PRIuMAX"</td><td>%"PRIuMAX"</td><td>%"PRIuMAX"</td></tr>\n", (luint) spNode->uiHits,
             (luint) spNode->uiMatch, (luint) spNode->uiNomatch);
     spNode = &spStats->sTrg;
-    fprintf(spOut, "<tr><td>TRG</td><td>%"PRIuMAX"</td><td>%"PRIuMAX"</td><td>%"PRIuMAX"</td><tr>\n", (luint) spNode->uiHits,
+    fprintf(spOut, "<tr><td>TRG</td><td>%"PRIuMAX"</td><td>%"PRIuMAX"</td><td>%"PRIuMAX"</td></tr>\n", (luint) spNode->uiHits,
             (luint) spNode->uiMatch, (luint) spNode->uiNomatch);
     spNode = &spStats->sUdt;
-    fprintf(spOut, "<tr><td>UDT</td><td>%"PRIuMAX"</td><td>%"PRIuMAX"</td><td>%"PRIuMAX"</td><tr>\n", (luint) spNode->uiHits,
+    fprintf(spOut, "<tr><td>UDT</td><td>%"PRIuMAX"</td><td>%"PRIuMAX"</td><td>%"PRIuMAX"</td></tr>\n", (luint) spNode->uiHits,
             (luint) spNode->uiMatch, (luint) spNode->uiNomatch);
     spNode = &spStats->sBkr;
-    fprintf(spOut, "<tr><td>BKR</td><td>%"PRIuMAX"</td><td>%"PRIuMAX"</td><td>%"PRIuMAX"</td><tr>\n", (luint) spNode->uiHits,
+    fprintf(spOut, "<tr><td>BKR</td><td>%"PRIuMAX"</td><td>%"PRIuMAX"</td><td>%"PRIuMAX"</td></tr>\n", (luint) spNode->uiHits,
             (luint) spNode->uiMatch, (luint) spNode->uiNomatch);
     spNode = &spStats->sAbg;
-    fprintf(spOut, "<tr><td>ABG</td><td>%"PRIuMAX"</td><td>%"PRIuMAX"</td><td>%"PRIuMAX"</td><tr>\n", (luint) spNode->uiHits,
+    fprintf(spOut, "<tr><td>ABG</td><td>%"PRIuMAX"</td><td>%"PRIuMAX"</td><td>%"PRIuMAX"</td></tr>\n", (luint) spNode->uiHits,
             (luint) spNode->uiMatch, (luint) spNode->uiNomatch);
     spNode = &spStats->sAen;
-    fprintf(spOut, "<tr><td>AEN</td><td>%"PRIuMAX"</td><td>%"PRIuMAX"</td><td>%"PRIuMAX"</td><tr>\n", (luint) spNode->uiHits,
+    fprintf(spOut, "<tr><td>AEN</td><td>%"PRIuMAX"</td><td>%"PRIuMAX"</td><td>%"PRIuMAX"</td></tr>\n", (luint) spNode->uiHits,
             (luint) spNode->uiMatch, (luint) spNode->uiNomatch);
     spNode = &spStats->sTotal;
-    fprintf(spOut, "<tr><td>total</td><td>%"PRIuMAX"</td><td>%"PRIuMAX"</td><td>%"PRIuMAX"</td><tr>\n", (luint) spNode->uiHits,
+    fprintf(spOut, "<tr><td>total</td><td>%"PRIuMAX"</td><td>%"PRIuMAX"</td><td>%"PRIuMAX"</td></tr>\n", (luint) spNode->uiHits,
             (luint) spNode->uiMatch, (luint) spNode->uiNomatch);
 
     // close the operators table
@@ -347,12 +603,12 @@ void vStatsToHtml(void* vpCtx, const char* cpMode, const char* cpFileName) {
     // open the rules table
     fprintf(spOut, "<br/>\n");
     fprintf(spOut, "%s", "<table class=\"apg-stats\">\n");
-    fprintf(spOut, "<caption>Rules: %s<caption/>\n", cpModeName);
-    fprintf(spOut, "<tr><th>name</th><th>hits</th><th>match</th><th>no match</th><tr>\n");
+    fprintf(spOut, "<caption>Rules: %s</caption>\n", cpModeName);
+    fprintf(spOut, "<tr><th>name</th><th>hits</th><th>match</th><th>no match</th></tr>\n");
     for (ui = 0; ui < spStats->uiRuleCount; ui += 1) {
         spNode = &sRuleStats[ui];
         if (spNode->uiHits) {
-            fprintf(spOut, "<tr><td>%s</td><td>%"PRIuMAX"</td><td>%"PRIuMAX"</td><td>%"PRIuMAX"</td><tr>\n", spNode->cpName,
+            fprintf(spOut, "<tr><td>%s</td><td>%"PRIuMAX"</td><td>%"PRIuMAX"</td><td>%"PRIuMAX"</td></tr>\n", spNode->cpName,
                     (luint) spNode->uiHits, (luint) spNode->uiMatch, (luint) spNode->uiNomatch);
         }
     }
@@ -373,12 +629,12 @@ void vStatsToHtml(void* vpCtx, const char* cpMode, const char* cpFileName) {
         // open the UDT table
         fprintf(spOut, "<br/>\n");
         fprintf(spOut, "%s", "<table class=\"apg-stats\">\n");
-        fprintf(spOut, "<caption>UDTs: %s<caption/>\n", cpModeName);
-        fprintf(spOut, "<tr><th>name</th><th>hits</th><th>match</th><th>no match</th><tr>\n");
+        fprintf(spOut, "<caption>UDTs: %s</caption>\n", cpModeName);
+        fprintf(spOut, "<tr><th>name</th><th>hits</th><th>match</th><th>no match</th></tr>\n");
         for (ui = 0; ui < spStats->uiUdtCount; ui += 1) {
             spNode = &sUdtStats[ui];
             if (spNode->uiHits) {
-                fprintf(spOut, "<tr><td>%s</td><td>%"PRIuMAX"</td><td>%"PRIuMAX"</td><td>%"PRIuMAX"</td><tr>\n", spNode->cpName,
+                fprintf(spOut, "<tr><td>%s</td><td>%"PRIuMAX"</td><td>%"PRIuMAX"</td><td>%"PRIuMAX"</td></tr>\n", spNode->cpName,
                         (luint) spNode->uiHits, (luint) spNode->uiMatch, (luint) spNode->uiNomatch);
             }
         }
@@ -387,6 +643,12 @@ void vStatsToHtml(void* vpCtx, const char* cpMode, const char* cpFileName) {
         fprintf(spOut, "%s", "</table>\n");
 
     }
+    if (spCtx->bTimed) {
+        vTimingToHtml(spOut, spStats->spRuleStats, spStats->uiRuleCount, cMode, "Rules");
+        if (spStats->uiUdtCount) {
+            vTimingToHtml(spOut, spStats->spUdtStats, spStats->uiUdtCount, cMode, "UDTs");
+        }
+    }
 
     // output the page footer
     time_t tTime = time(NULL);
@@ -544,6 +806,18 @@ void vStatsToAscii(void* vpCtx, const char* cpMode, const char* cpFileName) {
             }
         }
     }
+    if (spCtx->bTimed) {
+        vTimingToAscii(spOut, spStats->spRuleStats, spStats->uiRuleCount, cMode, "Rules");
+        if (spStats->uiUdtCount) {
+            vTimingToAscii(spOut, spStats->spUdtStats, spStats->uiUdtCount, cMode, "UDTs");
+        }
+    }
+    if (spCtx->bBacktracked) {
+        vBacktrackingToAscii(spOut, spStats->spRuleStats, spStats->uiRuleCount, cMode, "Rules");
+        if (spStats->uiUdtCount) {
+            vBacktrackingToAscii(spOut, spStats->spUdtStats, spStats->uiUdtCount, cMode, "UDTs");
+        }
+    }
     time_t tTime = time(NULL);
     if (tTime != (time_t)-1) {
         fprintf(spOut, "\n");
@@ -554,6 +828,548 @@ void vStatsToAscii(void* vpCtx, const char* cpMode, const char* cpFileName) {
     }
 }
 
+/** \brief Export the rule and UDT statistics in CSV format.
+ *
+ * One line is written for each rule and UDT that has been hit.
+ * The columns are: type (rule or udt), name, hits, match, nomatch, inclusive time (ns), exclusive time (ns),
+ * maximum recursion depth, re-entries and wasted characters.
+ * The time and depth columns are zero if timing has not been enabled with vStatsTiming().
+ * The re-entry and wasted character columns are zero if the backtracking profile has not been enabled
+ * with vStatsBacktracking().
+ * \param vpCtx Pointer to a valid statistics context returned from vpStatsCtor()
+ * If not valid the application will silently exit with a \ref BAD_CONTEXT exit code.
+ * \param cpFileName Name of the file to write the CSV data to. If NULL, writes to stdout.
+ */
+void vStatsToCsv(void* vpCtx, const char* cpFileName) {
+    stats_ctx* spCtx = (stats_ctx*) vpCtx;
+    if(!spCtx || (spCtx->vpValidate != s_vpMagicNumber)){
+        vExContext();
+        return; // should never return
+    }
+    stats* spStats = &spCtx->sStats;
+    FILE* spOut = stdout;
+    if (cpFileName) {
+        spOut = fopen(cpFileName, "wb");
+        if(!spOut){
+            XTHROW(spCtx->spException, "stats to CSV, can't open output file");
+        }
+    }
+    fprintf(spOut, "type,name,hits,match,nomatch,inclusive_ns,exclusive_ns,max_depth,reentries,wasted_chars\n");
+    vTimingToCsv(spOut, spStats->spRuleStats, spStats->uiRuleCount, "rule");
+    vTimingToCsv(spOut, spStats->spUdtStats, spStats->uiUdtCount, "udt");
+    fflush(spOut);
+    if (spOut != stdout) {
+        fclose(spOut);
+    }
+}
+
+/** \brief Export the rule and UDT statistics in JSON format.
+ *
+ * The output is a single JSON object of the form
+ * <pre>
+ * {"timed": true, "backtracking": true, "rules": [{"name": "rule", "hits": 0, "match": 0, "nomatch": 0,
+ *     "inclusive_ns": 0, "exclusive_ns": 0, "max_depth": 0, "reentries": 0, "wasted_chars": 0}, ...], "udts": [...]}
+ * </pre>
+ * Only rules and UDTs that have been hit are listed.
+ * The time and depth values are zero if timing has not been enabled with vStatsTiming().
+ * The re-entry and wasted character values are zero if the backtracking profile has not been enabled
+ * with vStatsBacktracking().
+ * \param vpCtx Pointer to a valid statistics context returned from vpStatsCtor()
+ * If not valid the application will silently exit with a \ref BAD_CONTEXT exit code.
+ * \param cpFileName Name of the file to write the JSON data to. If NULL, writes to stdout.
+ */
+void vStatsToJson(void* vpCtx, const char* cpFileName) {
+    stats_ctx* spCtx = (stats_ctx*) vpCtx;
+    if(!spCtx || (spCtx->vpValidate != s_vpMagicNumber)){
+        vExContext();
+        return; // should never return
+    }
+    stats* spStats = &spCtx->sStats;
+    FILE* spOut = stdout;
+    if (cpFileName) {
+        spOut = fopen(cpFileName, "wb");
+        if(!spOut){
+            XTHROW(spCtx->spException, "stats to JSON, can't open output file");
+        }
+    }
+    fprintf(spOut, "{\n\"timed\": %s,\n\"backtracking\": %s,\n\"rules\": [", (spCtx->bTimed ? "true" : "false"),
+            (spCtx->bBacktracked ? "true" : "false"));
+    vTimingToJson(spOut, spStats->spRuleStats, spStats->uiRuleCount);
+    fprintf(spOut, "],\n\"udts\": [");
+    vTimingToJson(spOut, spStats->spUdtStats, spStats->uiUdtCount);
+    fprintf(spOut, "]\n}\n");
+    fflush(spOut);
+    if (spOut != stdout) {
+        fclose(spOut);
+    }
+}
+
+/** \brief Export the input string offset visit histogram of the most recent parse in CSV format.
+ *
+ * One line is written for each input string offset.
+ * The columns are: offset, character code and number of node visits.
+ * The final offset, equal to the input string length, has an empty character code.
+ * Requires that the backtracking profile has been enabled with vStatsBacktracking().
+ * \param vpCtx Pointer to a valid statistics context returned from vpStatsCtor()
+ * If not valid the application will silently exit with a \ref BAD_CONTEXT exit code.
+ * \param cpFileName Name of the file to write the CSV data to. If NULL, writes to stdout.
+ */
+void vStatsVisitsToCsv(void* vpCtx, const char* cpFileName) {
+    stats_ctx* spCtx = (stats_ctx*) vpCtx;
+    if(!spCtx || (spCtx->vpValidate != s_vpMagicNumber)){
+        vExContext();
+        return; // should never return
+    }
+    if (!spCtx->bBacktracked) {
+        XTHROW(spCtx->spException, "stats visits to CSV: backtracking profile has not been enabled");
+    }
+    parser* spParser = spCtx->spParserCtx;
+    aint* uipVisits = (aint*) vpVecFirst(spCtx->vpVecVisits);
+    FILE* spOut = stdout;
+    aint ui;
+    if (cpFileName) {
+        spOut = fopen(cpFileName, "wb");
+        if(!spOut){
+            XTHROW(spCtx->spException, "stats visits to CSV, can't open output file");
+        }
+    }
+    fprintf(spOut, "offset,char,visits\n");
+    for (ui = 0; ui < spCtx->uiOffsets; ui += 1) {
+        if (ui < spParser->uiInputStringLength) {
+            fprintf(spOut, "%"PRIuMAX",%"PRIuMAX",%"PRIuMAX"\n", (luint) ui, (luint) spParser->acpInputString[ui],
+                    (luint) uipVisits[ui]);
+        } else {
+            fprintf(spOut, "%"PRIuMAX",,%"PRIuMAX"\n", (luint) ui, (luint) uipVisits[ui]);
+        }
+    }
+    fflush(spOut);
+    if (spOut != stdout) {
+        fclose(spOut);
+    }
+}
+
+/** \brief Generates an HTML page displaying the backtracking profile as heat maps.
+ *
+ * The rule and UDT tables list the hits, re-entries and wasted characters, sorted on the wasted characters,
+ * with the cells shaded in proportion to their values.
+ * The input string of the most recent parse is displayed with each character shaded in proportion
+ * to the number of node visits at its offset. Hover over a character to see its offset and visit count.
+ * Requires that the backtracking profile has been enabled with vStatsBacktracking().
+ * \param vpCtx Pointer to a valid statistics context returned from vpStatsCtor()
+ * If not valid the application will silently exit with a \ref BAD_CONTEXT exit code.
+ * \param cpFileName Name of the file to write the HTML page to. If NULL, writes to stdout.
+ */
+void vStatsHeatMapToHtml(void* vpCtx, const char* cpFileName) {
+    stats_ctx* spCtx = (stats_ctx*) vpCtx;
+    if(!spCtx || (spCtx->vpValidate != s_vpMagicNumber)){
+        vExContext();
+        return; // should never return
+    }
+    if (!spCtx->bBacktracked) {
+        XTHROW(spCtx->spException, "stats heat map to HTML: backtracking profile has not been enabled");
+    }
+    stats* spStats = &spCtx->sStats;
+    parser* spParser = spCtx->spParserCtx;
+    aint* uipVisits = (aint*) vpVecFirst(spCtx->vpVecVisits);
+    FILE* spOut = stdout;
+    char caColor[32];
+    aint ui, uiMax, uiChar;
+    if (cpFileName) {
+        spOut = fopen(cpFileName, "wb");
+        if(!spOut){
+            XTHROW(spCtx->spException, "stats heat map to HTML unable to open output file");
+        }
+    }
+    fprintf(spOut, "%s", s_cpPageHeader);
+    fprintf(spOut, "<h3>Backtracking Profile</h3>\n");
+    vBacktrackingToHtml(spOut, spStats->spRuleStats, spStats->uiRuleCount, "Rules");
+    if (spStats->uiUdtCount) {
+        vBacktrackingToHtml(spOut, spStats->spUdtStats, spStats->uiUdtCount, "UDTs");
+    }
+
+    // the input string offset heat map
+    uiMax = 0;
+    for (ui = 0; ui < spCtx->uiOffsets; ui += 1) {
+        if (uipVisits[ui] > uiMax) {
+            uiMax = uipVisits[ui];
+        }
+    }
+    fprintf(spOut, "<br/>\n");
+    fprintf(spOut, "<h4>Node visits by input string offset (most recent parse, maximum %"PRIuMAX")</h4>\n", (luint) uiMax);
+    fprintf(spOut, "<pre class=\"apg-mono\">\n");
+    for (ui = 0; ui < spCtx->uiOffsets; ui += 1) {
+        vHeatColor(caColor, uipVisits[ui], uiMax);
+        fprintf(spOut, "<span style=\"background-color: %s\" title=\"offset %"PRIuMAX": %"PRIuMAX" visits\">", caColor,
+                (luint) ui, (luint) uipVisits[ui]);
+        if (ui == spParser->uiInputStringLength) {
+            fprintf(spOut, "<span class=\"apg-ctrl-char\">EOS</span>");
+        } else {
+            uiChar = (aint) spParser->acpInputString[ui];
+            if (uiChar == 38) {
+                fprintf(spOut, "&amp;");
+            } else if (uiChar == 60) {
+                fprintf(spOut, "&lt;");
+            } else if (uiChar == 62) {
+                fprintf(spOut, "&gt;");
+            } else if (uiChar >= 32 && uiChar < 127) {
+                fprintf(spOut, "%c", (char) uiChar);
+            } else if (uiChar == 9) {
+                fprintf(spOut, "<span class=\"apg-ctrl-char\">TAB</span>");
+            } else if (uiChar == 10) {
+                fprintf(spOut, "<span class=\"apg-ctrl-char\">LF</span>");
+            } else if (uiChar == 13) {
+                fprintf(spOut, "<span class=\"apg-ctrl-char\">CR</span>");
+            } else {
+                fprintf(spOut, "<span class=\"apg-ctrl-char\">x%02"PRIXMAX"</span>", (luint) uiChar);
+            }
+        }
+        fprintf(spOut, "</span>");
+        if ((ui < spParser->uiInputStringLength) && (spParser->acpInputString[ui] == 10)) {
+            fprintf(spOut, "\n");
+        }
+    }
+    fprintf(spOut, "\n</pre>\n");
+
+    // output the page footer
+    time_t tTime = time(NULL);
+    if (tTime != (time_t)-1) {
+        fprintf(spOut, "<h5>%s</h5>\n", asctime(gmtime(&tTime)));
+    }
+    fprintf(spOut, "%s", s_cpPageFooter);
+    fflush(spOut);
+    if (spOut != stdout) {
+        fclose(spOut);
+    }
+}
+
+/** \brief Export the RNM/UDT call stacks in the folded stack format for flame graphs.
+ *
+ * One line is written for each recorded call stack, with the rule/UDT names from the outermost (start rule)
+ * to the innermost separated by semicolons, followed by a space and the count. e.g.
+ * <pre>
+ * SIP-message;Request;Request-Line;Method 42
+ * </pre>
+ * This is the input format of the standard flame graph tools (e.g. flamegraph.pl).
+ * Requires that call stack recording has been enabled with vStatsCallStacks().
+ * \param vpCtx Pointer to a valid statistics context returned from vpStatsCtor()
+ * If not valid the application will silently exit with a \ref BAD_CONTEXT exit code.
+ * \param cpMode Name of the count to use.
+ * - "time" (or any string beginning with "t" or "T"), the exclusive time in nanoseconds.
+ * Requires that timing has also been enabled with vStatsTiming().
+ * - "hit count" (or any string beginning with "h" or "H"), the number of node hits.
+ * - defaults to "hit count" if mode is NULL or unrecognized as either of above.
+ * \param cpFileName Name of the file to write the folded stacks to. If NULL, writes to stdout.
+ */
+void vStatsToFolded(void* vpCtx, const char* cpMode, const char* cpFileName) {
+    stats_ctx* spCtx = (stats_ctx*) vpCtx;
+    if(!spCtx || (spCtx->vpValidate != s_vpMagicNumber)){
+        vExContext();
+        return; // should never return
+    }
+    abool bTime = APG_FALSE;
+    FILE* spOut = stdout;
+    if(cpMode){
+        if (*cpMode == 't' || *cpMode == 'T') {
+            if (!spCtx->bTimed) {
+                XTHROW(spCtx->spException, "stats to folded: time mode requested but timing has not been enabled");
+            }
+            bTime = APG_TRUE;
+        }
+    }
+    if (cpFileName) {
+        spOut = fopen(cpFileName, "wb");
+        if(!spOut){
+            XTHROW(spCtx->spException, "stats to folded, can't open output file");
+        }
+    }
+    aint* uipFrames = (aint*) vpMemAlloc(spCtx->spParserCtx->vpMem,
+            (aint) (uiVecLen(spCtx->vpVecStacks) * (aint) sizeof(aint)));
+    vStackToFolded(spCtx, spOut, uipFrames, bTime);
+    vMemFree(spCtx->spParserCtx->vpMem, uipFrames);
+    fflush(spOut);
+    if (spOut != stdout) {
+        fclose(spOut);
+    }
+}
+
+static uint64_t uiNow(void) {
+    struct timespec sTime;
+#ifdef CLOCK_MONOTONIC
+    clock_gettime(CLOCK_MONOTONIC, &sTime);
+#else
+    timespec_get(&sTime, TIME_UTC);
+#endif /* CLOCK_MONOTONIC */
+    return ((uint64_t) sTime.tv_sec * 1000000000) + (uint64_t) sTime.tv_nsec;
+}
+static void vBacktrack(stats_ctx* spCtx, const opcode* spOp, aint uiState, node_stat* spRuleStat) {
+    parser* spParser = spCtx->spParserCtx;
+    aint uiOffset = spParser->uiOffset;
+    match_record* spRecord;
+    if (uiState == ID_MATCH) {
+        uiOffset -= spParser->uiPhraseLength;
+    }
+    if (uiOffset < spCtx->uiOffsets) {
+        ((aint*) vpVecFirst(spCtx->vpVecVisits))[uiOffset]++;
+        if (spRuleStat) {
+            // check for re-entry at this offset
+            uint8_t* ucpVisited = (uint8_t*) vpVecFirst(spCtx->vpVecVisited);
+            aint uiIndex = (spOp->sGen.uiId == ID_RNM) ? spOp->sRnm.spRule->uiRuleIndex :
+                    (spCtx->sStats.uiRuleCount + spOp->sUdt.spUdt->uiUdtIndex);
+            aint uiBit = (uiIndex * spCtx->uiOffsets) + uiOffset;
+            uint8_t ucMask = (uint8_t) (1 << (uiBit % 8));
+            if (ucpVisited[uiBit / 8] & ucMask) {
+                spRuleStat->uiReentries++;
+            } else {
+                ucpVisited[uiBit / 8] |= ucMask;
+            }
+        }
+    }
+    if (spParser->uiInLookaround) {
+        // look-around phrases never consume input
+        return;
+    }
+    if (uiState == ID_MATCH) {
+        if (spRuleStat && spParser->uiPhraseLength) {
+            // the phrase may still be discarded by a parent node failure
+            spRecord = (match_record*) vpVecPush(spCtx->vpVecMatches, NULL);
+            spRecord->spStat = spRuleStat;
+            spRecord->uiOffset = uiOffset;
+            spRecord->uiLength = spParser->uiPhraseLength;
+        }
+    } else {
+        // discard all phrases matched by this failed node
+        while ((spRecord = (match_record*) vpVecLast(spCtx->vpVecMatches)) && (spRecord->uiOffset >= uiOffset)) {
+            spRecord->spStat->uiWasted += spRecord->uiLength;
+            vpVecPop(spCtx->vpVecMatches);
+        }
+    }
+}
+static void vHeatColor(char* cpBuf, aint uiValue, aint uiMax) {
+    unsigned int uiShade = 255;
+    if (uiMax) {
+        uiShade = (unsigned int) (255 - ((uiValue * 200) / uiMax));
+    }
+    snprintf(cpBuf, 32, "#FF%02X%02X", uiShade, uiShade);
+}
+static void vBacktrackingToAscii(FILE* spOut, node_stat* spNodes, aint uiCount, char cMode, const char* cpName){
+    node_stat sStats[uiCount];
+    node_stat* spNode;
+    aint ui;
+    for (ui = 0; ui < uiCount; ui += 1) {
+        sStats[ui] = spNodes[ui];
+    }
+    qsort((void*) sStats, (size_t) uiCount, sizeof(node_stat), compareNames);
+    if (cMode == s_cHits) {
+        qsort((void*) sStats, (size_t) uiCount, sizeof(node_stat), compareWasted);
+    }
+    fprintf(spOut, "\n");
+    fprintf(spOut, "%s: backtracking, %s\n", cpName, (cMode == s_cHits) ? "wasted characters" : "alphabetical");
+    fprintf(spOut, "| %7s | %9s | %9s | %s\n", "hits", "reentries", "wasted", "name");
+    for (ui = 0; ui < uiCount; ui += 1) {
+        spNode = &sStats[ui];
+        if (spNode->uiHits) {
+            fprintf(spOut, "| %7"PRIuMAX" | %9"PRIuMAX" | %9"PRIuMAX" | %s\n", (luint) spNode->uiHits,
+                    (luint) spNode->uiReentries, (luint) spNode->uiWasted, spNode->cpName);
+        }
+    }
+}
+static void vBacktrackingToHtml(FILE* spOut, node_stat* spNodes, aint uiCount, const char* cpName){
+    node_stat sStats[uiCount];
+    node_stat* spNode;
+    char caReentries[32];
+    char caWasted[32];
+    aint ui, uiMaxReentries = 0, uiMaxWasted = 0;
+    for (ui = 0; ui < uiCount; ui += 1) {
+        sStats[ui] = spNodes[ui];
+        if (spNodes[ui].uiReentries > uiMaxReentries) {
+            uiMaxReentries = spNodes[ui].uiReentries;
+        }
+        if (spNodes[ui].uiWasted > uiMaxWasted) {
+            uiMaxWasted = spNodes[ui].uiWasted;
+        }
+    }
+    qsort((void*) sStats, (size_t) uiCount, sizeof(node_stat), compareNames);
+    qsort((void*) sStats, (size_t) uiCount, sizeof(node_stat), compareWasted);
+    fprintf(spOut, "<br/>\n");
+    fprintf(spOut, "%s", "<table class=\"apg-stats\">\n");
+    fprintf(spOut, "<caption>%s: backtracking, wasted characters</caption>\n", cpName);
+    fprintf(spOut, "<tr><th>name</th><th>hits</th><th>re-entries</th><th>wasted</th></tr>\n");
+    for (ui = 0; ui < uiCount; ui += 1) {
+        spNode = &sStats[ui];
+        if (spNode->uiHits) {
+            vHeatColor(caReentries, spNode->uiReentries, uiMaxReentries);
+            vHeatColor(caWasted, spNode->uiWasted, uiMaxWasted);
+            fprintf(spOut, "<tr><td>%s</td><td>%"PRIuMAX"</td><td style=\"background-color: %s\">%"PRIuMAX
+                    "</td><td style=\"background-color: %s\">%"PRIuMAX"</td></tr>\n", spNode->cpName, (luint) spNode->uiHits,
+                    caReentries, (luint) spNode->uiReentries, caWasted, (luint) spNode->uiWasted);
+        }
+    }
+    fprintf(spOut, "%s", "</table>\n");
+}
+static aint uiStackPush(stats_ctx* spCtx, const opcode* spOp) {
+    stack_node* spStack;
+    aint uiId = (spOp->sGen.uiId == ID_RNM) ? spOp->sRnm.spRule->uiRuleIndex :
+            (spCtx->sStats.uiRuleCount + spOp->sUdt.spUdt->uiUdtIndex);
+    aint uiChild = ((stack_node*) vpVecAt(spCtx->vpVecStacks, spCtx->uiStack))->uiChild;
+    while (uiChild != APG_UNDEFINED) {
+        spStack = (stack_node*) vpVecAt(spCtx->vpVecStacks, uiChild);
+        if (spStack->uiId == uiId) {
+            return uiChild;
+        }
+        uiChild = spStack->uiSibling;
+    }
+    // first call to this rule/UDT from the current call stack
+    uiChild = uiVecLen(spCtx->vpVecStacks);
+    spStack = (stack_node*) vpVecPush(spCtx->vpVecStacks, NULL);
+    spStack->uiId = uiId;
+    spStack->uiParent = spCtx->uiStack;
+    spStack->uiChild = APG_UNDEFINED;
+    spStack->uiHits = 0;
+    spStack->uiTime = 0;
+    // vector may have been reallocated
+    stack_node* spParent = (stack_node*) vpVecAt(spCtx->vpVecStacks, spCtx->uiStack);
+    spStack->uiSibling = spParent->uiChild;
+    spParent->uiChild = uiChild;
+    return uiChild;
+}
+static void vStackToFolded(stats_ctx* spCtx, FILE* spOut, aint* uipFrames, abool bTime) {
+    stats* spStats = &spCtx->sStats;
+    stack_node* spStack;
+    stack_node* spFrame;
+    aint uiNode, uiDepth, ui;
+    // depth-first traversal of the call stack tree, skipping the root
+    uiNode = ((stack_node*) vpVecFirst(spCtx->vpVecStacks))->uiChild;
+    while (uiNode != APG_UNDEFINED) {
+        spStack = (stack_node*) vpVecAt(spCtx->vpVecStacks, uiNode);
+        if (bTime ? (spStack->uiTime > 0) : (spStack->uiHits > 0)) {
+            // collect the frames from the innermost to the outermost
+            uiDepth = 0;
+            spFrame = spStack;
+            while (spFrame->uiId != APG_UNDEFINED) {
+                uipFrames[uiDepth++] = spFrame->uiId;
+                spFrame = (stack_node*) vpVecAt(spCtx->vpVecStacks, spFrame->uiParent);
+            }
+            for (ui = uiDepth; ui > 0; ui -= 1) {
+                fprintf(spOut, "%s%s", (ui == uiDepth) ? "" : ";",
+                        (uipFrames[ui - 1] < spStats->uiRuleCount) ? spStats->spRuleStats[uipFrames[ui - 1]].cpName :
+                                spStats->spUdtStats[uipFrames[ui - 1] - spStats->uiRuleCount].cpName);
+            }
+            fprintf(spOut, " %"PRIuMAX"\n", bTime ? (luint) spStack->uiTime : (luint) spStack->uiHits);
+        }
+        if (spStack->uiChild != APG_UNDEFINED) {
+            uiNode = spStack->uiChild;
+            continue;
+        }
+        while ((spStack->uiSibling == APG_UNDEFINED) && (spStack->uiParent != APG_UNDEFINED)) {
+            spStack = (stack_node*) vpVecAt(spCtx->vpVecStacks, spStack->uiParent);
+        }
+        uiNode = spStack->uiSibling;
+    }
+}
+static node_stat* spTimedStat(stats* spStats, const opcode* spOp) {
+    if (spOp->sGen.uiId == ID_RNM) {
+        return &spStats->spRuleStats[spOp->sRnm.spRule->uiRuleIndex];
+    }
+    return &spStats->spUdtStats[spOp->sUdt.spUdt->uiUdtIndex];
+}
+static void vTimingToAscii(FILE* spOut, node_stat* spNodes, aint uiCount, char cMode, const char* cpName){
+    node_stat sStats[uiCount];
+    node_stat* spNode;
+    aint ui;
+    for (ui = 0; ui < uiCount; ui += 1) {
+        sStats[ui] = spNodes[ui];
+    }
+    qsort((void*) sStats, (size_t) uiCount, sizeof(node_stat), compareNames);
+    if (cMode == s_cHits) {
+        qsort((void*) sStats, (size_t) uiCount, sizeof(node_stat), compareTimes);
+    }
+    fprintf(spOut, "\n");
+    fprintf(spOut, "%s: timing (ns), %s\n", cpName, (cMode == s_cHits) ? "exclusive time" : "alphabetical");
+    fprintf(spOut, "| %7s | %12s | %12s | %5s | %s\n", "calls", "inclusive", "exclusive", "depth", "name");
+    for (ui = 0; ui < uiCount; ui += 1) {
+        spNode = &sStats[ui];
+        if (spNode->uiHits) {
+            fprintf(spOut, "| %7"PRIuMAX" | %12"PRIuMAX" | %12"PRIuMAX" | %5"PRIuMAX" | %s\n", (luint) spNode->uiHits,
+                    (luint) spNode->uiInclusive, (luint) spNode->uiExclusive, (luint) spNode->uiMaxDepth, spNode->cpName);
+        }
+    }
+}
+static void vTimingToHtml(FILE* spOut, node_stat* spNodes, aint uiCount, char cMode, const char* cpName){
+    node_stat sStats[uiCount];
+    node_stat* spNode;
+    aint ui;
+    for (ui = 0; ui < uiCount; ui += 1) {
+        sStats[ui] = spNodes[ui];
+    }
+    qsort((void*) sStats, (size_t) uiCount, sizeof(node_stat), compareNames);
+    if (cMode == s_cHits) {
+        qsort((void*) sStats, (size_t) uiCount, sizeof(node_stat), compareTimes);
+    }
+    fprintf(spOut, "<br/>\n");
+    fprintf(spOut, "%s", "<table class=\"apg-stats\">\n");
+    fprintf(spOut, "<caption>%s: timing (ns), %s</caption>\n", cpName,
+            (cMode == s_cHits) ? "exclusive time" : "alphabetical");
+    fprintf(spOut, "<tr><th>name</th><th>calls</th><th>inclusive</th><th>exclusive</th><th>depth</th></tr>\n");
+    for (ui = 0; ui < uiCount; ui += 1) {
+        spNode = &sStats[ui];
+        if (spNode->uiHits) {
+            fprintf(spOut, "<tr><td>%s</td><td>%"PRIuMAX"</td><td>%"PRIuMAX"</td><td>%"PRIuMAX"</td><td>%"PRIuMAX"</td></tr>\n",
+                    spNode->cpName, (luint) spNode->uiHits, (luint) spNode->uiInclusive, (luint) spNode->uiExclusive,
+                    (luint) spNode->uiMaxDepth);
+        }
+    }
+    fprintf(spOut, "%s", "</table>\n");
+}
+static void vTimingToCsv(FILE* spOut, node_stat* spNodes, aint uiCount, const char* cpType){
+    aint ui;
+    for (ui = 0; ui < uiCount; ui += 1) {
+        if (spNodes[ui].uiHits) {
+            fprintf(spOut, "%s,%s,%"PRIuMAX",%"PRIuMAX",%"PRIuMAX",%"PRIuMAX",%"PRIuMAX",%"PRIuMAX",%"PRIuMAX",%"PRIuMAX"\n",
+                    cpType, spNodes[ui].cpName, (luint) spNodes[ui].uiHits, (luint) spNodes[ui].uiMatch,
+                    (luint) spNodes[ui].uiNomatch, (luint) spNodes[ui].uiInclusive,
+                    (luint) spNodes[ui].uiExclusive, (luint) spNodes[ui].uiMaxDepth,
+                    (luint) spNodes[ui].uiReentries, (luint) spNodes[ui].uiWasted);
+        }
+    }
+}
+static void vTimingToJson(FILE* spOut, node_stat* spNodes, aint uiCount){
+    aint ui;
+    const char* cpSep = "\n";
+    for (ui = 0; ui < uiCount; ui += 1) {
+        if (spNodes[ui].uiHits) {
+            fprintf(spOut, "%s{\"name\": \"%s\", \"hits\": %"PRIuMAX", \"match\": %"PRIuMAX", \"nomatch\": %"PRIuMAX
+                    ", \"inclusive_ns\": %"PRIuMAX", \"exclusive_ns\": %"PRIuMAX", \"max_depth\": %"PRIuMAX
+                    ", \"reentries\": %"PRIuMAX", \"wasted_chars\": %"PRIuMAX"}", cpSep,
+                    spNodes[ui].cpName, (luint) spNodes[ui].uiHits, (luint) spNodes[ui].uiMatch,
+                    (luint) spNodes[ui].uiNomatch, (luint) spNodes[ui].uiInclusive,
+                    (luint) spNodes[ui].uiExclusive, (luint) spNodes[ui].uiMaxDepth,
+                    (luint) spNodes[ui].uiReentries, (luint) spNodes[ui].uiWasted);
+            cpSep = ",\n";
+        }
+    }
+}
+static int compareTimes(const void* l, const void* r) {
+    node_stat* spL = (node_stat*) l;
+    node_stat* spR = (node_stat*) r;
+    if (spL->uiExclusive < spR->uiExclusive) {
+        return 1;
+    }
+    if (spL->uiExclusive > spR->uiExclusive) {
+        return -1;
+    }
+    return 0;
+}
+static int compareWasted(const void* l, const void* r) {
+    node_stat* spL = (node_stat*) l;
+    node_stat* spR = (node_stat*) r;
+    if (spL->uiWasted < spR->uiWasted) {
+        return 1;
+    }
+    if (spL->uiWasted > spR->uiWasted) {
+        return -1;
+    }
+    return 0;
+}
 static int compareNames(const void* l, const void* r) {
     node_stat* spL = (node_stat*) l;
     node_stat* spR = (node_stat*) r;
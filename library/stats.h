@@ -38,6 +38,14 @@
 void* vpStatsCtor(void* vpParserCtx);
 void vStatsToHtml(void* vpCtx, const char* cpMode, const char* cpFileName);
 void vStatsToAscii(void* vpCtx, const char* cpMode, const char* cpFileName);
+void vStatsTiming(void* vpCtx, abool bEnable);
+void vStatsToCsv(void* vpCtx, const char* cpFileName);
+void vStatsToJson(void* vpCtx, const char* cpFileName);
+void vStatsBacktracking(void* vpCtx, abool bEnable);
+void vStatsVisitsToCsv(void* vpCtx, const char* cpFileName);
+void vStatsHeatMapToHtml(void* vpCtx, const char* cpFileName);
+void vStatsCallStacks(void* vpCtx, abool bEnable);
+void vStatsToFolded(void* vpCtx, const char* cpMode, const char* cpFileName);
 
 #endif /* APG_STATS */
 #endif /* LIB_STATS_H_ */
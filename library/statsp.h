@@ -33,14 +33,16 @@
 #ifndef LIB_STATSP_H_
 #define LIB_STATSP_H_
 
-#ifdef APG_TRACE
+#ifdef APG_STATS
 
 /** @name Private Statistics Function
- * Called only by the parent parser object via the macro \ref STATS_HIT.
+ * Called only by the parent parser object via the macros \ref STATS_HIT, \ref STATS_OPEN and \ref STATS_BEGIN.
  */
 ///@{
 void vStatsHit(void* spCtx, const opcode* spOp, aint uiState);
+void vStatsOpen(void* spCtx, const opcode* spOp);
+void vStatsBegin(void* spCtx);
 ///@}
 
-#endif /* APG_TRACE */
+#endif /* APG_STATS */
 #endif /* LIB_STATSP_H_ */
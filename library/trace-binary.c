@@ -0,0 +1,363 @@
+/*  *************************************************************************************
+    Copyright (c) 2021, Lowell D. Thomas
+    All rights reserved.
+    
+    This file is part of APG Version 7.0.
+    APG Version 7.0 may be used under the terms of the BSD 2-Clause License.
+    
+    Redistribution and use in source and binary forms, with or without
+    modification, are permitted provided that the following conditions are met:
+    
+    1. Redistributions of source code must retain the above copyright notice, this
+       list of conditions and the following disclaimer.
+    
+    2. Redistributions in binary form must reproduce the above copyright notice,
+       this list of conditions and the following disclaimer in the documentation
+       and/or other materials provided with the distribution.
+    
+    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+    AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+    IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+    DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+    FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+    DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+    SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+    CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+    OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+    OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+    
+*   *************************************************************************************/
+/** \file trace-binary.c
+ * \brief The binary trace sink and its offline decoder.
+ *
+ * With the output type \ref TRACE_BINARY the trace object writes one fixed-size \ref trace_binary_record
+ * for each header, record, separator and footer that it would otherwise have displayed.
+ * The records are buffered in memory and written to the output file in large blocks with no formatting.
+ * Since the trace configuration filters are applied before a record is ever displayed,
+ * they apply to the binary records as well.
+ *
+ * The input string is written once for each parse, or only a short marker if it is unchanged.
+ * \ref vTraceDecode() reads the file back and replays it through the ASCII or HTML display functions.
+ * The decoding trace object must belong to a parser generated from the same SABNF grammar.
+ */
+
+#include "./apg.h"
+#ifdef APG_TRACE
+#include "../utilities/utilities.h"
+#include "./parserp.h"
+#include "./tracep.h"
+
+/** \brief The binary records are written to the output file when the buffer exceeds this size. */
+#define BINARY_FLUSH_SIZE   65536
+
+/** \brief The binary file header, identifying the file and the grammar it was recorded from. */
+typedef struct {
+    char caMagic[8]; ///< \brief Always "APGTRACE".
+    uint32_t uiVersion; ///< \brief The binary format version.
+    uint32_t uiRecordSize; ///< \brief sizeof(\ref trace_binary_record).
+    uint32_t uiAcharSize; ///< \brief sizeof(achar).
+    uint32_t uiRuleCount; ///< \brief The number of rules in the grammar.
+    uint32_t uiUdtCount; ///< \brief The number of UDTs in the grammar.
+    uint32_t uiOpcodeCount; ///< \brief The number of opcodes in the grammar.
+} binary_header;
+
+static const char s_caMagic[8] = {'A', 'P', 'G', 'T', 'R', 'A', 'C', 'E'};
+static const uint32_t s_uiVersion = 1;
+static const achar s_acEmpty[1] = {0};
+
+static void vBinaryHeaderInit(trace* spCtx, binary_header* spHdr);
+static void vBinaryWrite(trace* spCtx, const void* vpData, aint uiSize);
+static void vBinaryRead(trace* spCtx, void* vpData, aint uiSize, abool bEofOk, abool* bpEof);
+static void vBinaryDecode(trace* spCtx, const char* cpBinaryFile);
+
+/** \brief Write the input string for the parse that is about to begin.
+ *
+ * Called by \ref vTraceBegin() when the output type is \ref TRACE_BINARY.
+ * If the input string is unchanged from the previous parse (e.g. repeated apgex attempts)
+ * only the record is written.
+ */
+void vBinaryInput(trace* spCtx){
+    parser* spParser = spCtx->spParserCtx;
+    trace_binary_record sRec = {};
+    aint uiLen = spParser->uiInputStringLength;
+    if(!spCtx->bBinaryHeader){
+        // first parse in this file, force the input string to be written
+        vVecClear(spCtx->vpVecBinaryInput);
+    }
+    sRec.ucKind = TRACE_BIN_INPUT;
+    sRec.uiRecord = (uint64_t)spParser->uiSubStringBeg;
+    sRec.uiOffset = (uint64_t)uiLen;
+    sRec.uiPhraseLength = (uint64_t)spParser->uiSubStringEnd;
+    sRec.uiOpIndex = (uint32_t)spParser->uiStartRule;
+    if(spCtx->bBinaryHeader && (uiVecLen(spCtx->vpVecBinaryInput) == uiLen)
+            && (!uiLen || spParser->bReparse || !memcmp(vpVecFirst(spCtx->vpVecBinaryInput), spParser->acpInputString, uiLen * sizeof(achar)))){
+        sRec.ucState = 1;
+        vBinaryWrite(spCtx, &sRec, (aint)sizeof(sRec));
+    }else{
+        vBinaryWrite(spCtx, &sRec, (aint)sizeof(sRec));
+        vBinaryWrite(spCtx, spParser->acpInputString, (aint)(uiLen * sizeof(achar)));
+        vVecClear(spCtx->vpVecBinaryInput);
+        if(uiLen){
+            vpVecPushn(spCtx->vpVecBinaryInput, (void*)spParser->acpInputString, uiLen);
+        }
+    }
+}
+
+/** \brief Write one trace record in binary form.
+ *
+ * Called by \ref vDisplayRecord() when the output type is \ref TRACE_BINARY.
+ */
+void vBinaryRecord(trace* spCtx, trace_record* spRec, abool bIsMatchedPppt){
+    parser* spParser = spCtx->spParserCtx;
+    trace_binary_record sRec = {};
+    sRec.ucKind = (spCtx->sConfig.bPppt && bIsMatchedPppt) ? TRACE_BIN_RECORD_PPPT : TRACE_BIN_RECORD;
+    sRec.ucState = (uint8_t)spRec->uiState;
+    sRec.uiRecord = (uint64_t)spRec->uiThisRecord;
+    sRec.uiOffset = (uint64_t)spRec->uiOffset;
+    sRec.uiPhraseLength = (uint64_t)spRec->uiPhraseLength;
+    sRec.uiTreeDepth = (uint32_t)spRec->uiTreeDepth;
+    sRec.iTraceDepth = (int32_t)spRec->iTraceDepth;
+    if(spRec->spOpcode == &spParser->sStartOp){
+        sRec.uiOpIndex = TRACE_BIN_START_RULE;
+    }else{
+        sRec.uiOpIndex = (uint32_t)(spRec->spOpcode - spParser->spOpcodes);
+    }
+    vBinaryWrite(spCtx, &sRec, (aint)sizeof(sRec));
+}
+
+/** \brief Write a header, separator or footer event.
+ *
+ * Called by the display functions when the output type is \ref TRACE_BINARY.
+ * The footer also writes any buffered records to the output file.
+ * \param spCtx The trace object context.
+ * \param uiKind One of \ref TRACE_BIN_HEADER, \ref TRACE_BIN_SEPARATOR or \ref TRACE_BIN_FOOTER.
+ * \param uiValue The last index for a separator, otherwise ignored.
+ */
+void vBinaryEvent(trace* spCtx, aint uiKind, aint uiValue){
+    trace_binary_record sRec = {};
+    sRec.ucKind = (uint8_t)uiKind;
+    sRec.uiOffset = (uint64_t)uiValue;
+    vBinaryWrite(spCtx, &sRec, (aint)sizeof(sRec));
+    if(uiKind == TRACE_BIN_FOOTER){
+        vBinaryFlush(spCtx);
+    }
+}
+
+/** \brief Write all buffered binary records to the output file.
+ *
+ * Called on the footer, when the output file changes and by the trace object destructor.
+ */
+void vBinaryFlush(trace* spCtx){
+    aint uiLen = uiVecLen(spCtx->vpVecBinary);
+    if(uiLen && spCtx->spOut){
+        fwrite(vpVecFirst(spCtx->vpVecBinary), 1, uiLen, spCtx->spOut);
+        fflush(spCtx->spOut);
+    }
+    vVecClear(spCtx->vpVecBinary);
+}
+
+/** \brief Decode a binary trace file.
+ *
+ * Reads a file of binary records previously written with the output type \ref TRACE_BINARY
+ * and displays them in the trace object's current output type and output file.
+ * The output is identical to what would have been displayed had the parse been traced directly.
+ * \param vpCtx Pointer to a valid trace object context returned from vpTraceCtor().
+ * If not valid the application will silently exit with a \ref BAD_CONTEXT exit code.
+ * The trace object's parser must have been generated from the same SABNF grammar
+ * that recorded the binary file and the output type must be \ref TRACE_ASCII or \ref TRACE_HTML.
+ * Exceptions are thrown if the file cannot be read or does not match the grammar.
+ * \param cpBinaryFile Name of the binary trace file.
+ */
+void vTraceDecode(void* vpCtx, const char* cpBinaryFile){
+    trace* spCtx = (trace*) vpCtx;
+    if(!bParserValidate(spCtx->spParserCtx)){
+        vExContext();
+    }
+    parser* spParser = spCtx->spParserCtx;
+    char caBuf[1024];
+    if(!((spCtx->sConfig.uiOutputType == TRACE_ASCII) || (spCtx->sConfig.uiOutputType == TRACE_HTML))){
+        XTHROW(spCtx->spException, "binary trace decoding requires output type TRACE_ASCII or TRACE_HTML");
+    }
+    if(!cpBinaryFile){
+        XTHROW(spCtx->spException, "binary trace file name cannot be NULL");
+    }
+    if(spCtx->spOpenFile){
+        fclose(spCtx->spOpenFile);
+    }
+    spCtx->spOpenFile = fopen(cpBinaryFile, "rb");
+    if(!spCtx->spOpenFile){
+        snprintf(caBuf, sizeof(caBuf), "can't open binary trace file %s for reading", cpBinaryFile);
+        XTHROW(spCtx->spException, caBuf);
+    }
+
+    // the display functions find the input string through the parser
+    const achar* acpSaveInput = spParser->acpInputString;
+    aint uiSaveLength = spParser->uiInputStringLength;
+    aint uiSaveBeg = spParser->uiSubStringBeg;
+    aint uiSaveEnd = spParser->uiSubStringEnd;
+    abool bSavePppt = spCtx->sConfig.bPppt;
+    exception* spSaveException = spCtx->spException;
+    exception sEx;
+    XCTOR(sEx);
+    if(sEx.try){
+        // errors in the file are caught here so that the states can be restored before rethrowing
+        spCtx->spException = &sEx;
+        vBinaryDecode(spCtx, cpBinaryFile);
+    }
+
+    // restore the parser and trace states
+    spCtx->spException = spSaveException;
+    spParser->acpInputString = acpSaveInput;
+    spParser->uiInputStringLength = uiSaveLength;
+    spParser->uiSubStringBeg = uiSaveBeg;
+    spParser->uiSubStringEnd = uiSaveEnd;
+    spCtx->sConfig.bPppt = bSavePppt;
+    vVecClear(spCtx->vpVecBinaryInput);
+    fclose(spCtx->spOpenFile);
+    spCtx->spOpenFile = NULL;
+    fflush(spCtx->spOut);
+    if(!sEx.try){
+        vExRethrow(&sEx, spCtx->spException);
+    }
+}
+
+/** \brief Validate the open binary trace file and display its records.
+ *
+ * The caller saves and restores the parser's input string and the trace configuration.
+ * \param spCtx Pointer to the trace object context with an open binary trace file.
+ * \param cpBinaryFile Name of the binary trace file, for error messages.
+ */
+static void vBinaryDecode(trace* spCtx, const char* cpBinaryFile){
+    parser* spParser = spCtx->spParserCtx;
+    char caBuf[1024];
+    binary_header sHdr, sExpected;
+    trace_binary_record sBin;
+    trace_record sRec;
+    opcode sStartOp;
+    abool bEof = APG_FALSE;
+
+    // validate the file against this parser's grammar
+    vBinaryRead(spCtx, &sHdr, (aint)sizeof(sHdr), APG_FALSE, NULL);
+    vBinaryHeaderInit(spCtx, &sExpected);
+    if(memcmp(sHdr.caMagic, sExpected.caMagic, sizeof(sHdr.caMagic)) || (sHdr.uiVersion != sExpected.uiVersion)){
+        snprintf(caBuf, sizeof(caBuf), "%s is not an APG binary trace file", cpBinaryFile);
+        XTHROW(spCtx->spException, caBuf);
+    }
+    if(memcmp(&sHdr, &sExpected, sizeof(sHdr))){
+        snprintf(caBuf, sizeof(caBuf),
+                "binary trace file %s was not recorded with this grammar or with this achar size", cpBinaryFile);
+        XTHROW(spCtx->spException, caBuf);
+    }
+
+    // the display functions find the input string through the parser
+    spCtx->sConfig.bPppt = APG_TRUE;
+    spParser->acpInputString = s_acEmpty;
+    spParser->uiInputStringLength = 0;
+    spParser->uiSubStringBeg = 0;
+    spParser->uiSubStringEnd = 0;
+    vVecClear(spCtx->vpVecBinaryInput);
+    memset(&sStartOp, 0, sizeof(sStartOp));
+    sStartOp.sRnm.uiId = ID_RNM;
+    sStartOp.sRnm.spRule = &spParser->spRules[0];
+    while(APG_TRUE){
+        vBinaryRead(spCtx, &sBin, (aint)sizeof(sBin), APG_TRUE, &bEof);
+        if(bEof){
+            break;
+        }
+        switch(sBin.ucKind){
+        case TRACE_BIN_INPUT:
+            if(!sBin.ucState){
+                aint uiLen = (aint)sBin.uiOffset;
+                vVecClear(spCtx->vpVecBinaryInput);
+                if(uiLen){
+                    void* vpInput = vpVecPushn(spCtx->vpVecBinaryInput, NULL, uiLen);
+                    vBinaryRead(spCtx, vpInput, (aint)(uiLen * sizeof(achar)), APG_FALSE, NULL);
+                }
+            }
+            if((sBin.uiOffset != (uint64_t)uiVecLen(spCtx->vpVecBinaryInput))
+                    || (sBin.uiPhraseLength > sBin.uiOffset) || (sBin.uiOpIndex >= spParser->uiRuleCount)){
+                XTHROW(spCtx->spException, "binary trace file has a corrupted input string record");
+            }
+            spParser->acpInputString = uiVecLen(spCtx->vpVecBinaryInput) ?
+                    (const achar*)vpVecFirst(spCtx->vpVecBinaryInput) : s_acEmpty;
+            spParser->uiInputStringLength = (aint)sBin.uiOffset;
+            spParser->uiSubStringBeg = (aint)sBin.uiRecord;
+            spParser->uiSubStringEnd = (aint)sBin.uiPhraseLength;
+            sStartOp.sRnm.spRule = &spParser->spRules[sBin.uiOpIndex];
+            sStartOp.sRnm.ucpPpptMap = sStartOp.sRnm.spRule->ucpPpptMap;
+            break;
+        case TRACE_BIN_HEADER:
+            vDisplayHeader(spCtx);
+            break;
+        case TRACE_BIN_RECORD:
+        case TRACE_BIN_RECORD_PPPT:
+            if(sBin.uiOpIndex == TRACE_BIN_START_RULE){
+                sRec.spOpcode = &sStartOp;
+            }else if(sBin.uiOpIndex < spParser->uiOpcodeCount){
+                sRec.spOpcode = &spParser->spOpcodes[sBin.uiOpIndex];
+            }else{
+                XTHROW(spCtx->spException, "binary trace file has an opcode index out of range");
+            }
+            if(sBin.uiOffset > (uint64_t)spParser->uiInputStringLength){
+                XTHROW(spCtx->spException, "binary trace file has a phrase offset out of range");
+            }
+            sRec.uiThisRecord = (aint)sBin.uiRecord;
+            sRec.uiOffset = (aint)sBin.uiOffset;
+            sRec.uiPhraseLength = (aint)sBin.uiPhraseLength;
+            sRec.uiTreeDepth = (aint)sBin.uiTreeDepth;
+            sRec.iTraceDepth = (int)sBin.iTraceDepth;
+            sRec.uiState = (aint)sBin.ucState;
+            vDisplayRecord(spCtx, &sRec, (sBin.ucKind == TRACE_BIN_RECORD_PPPT));
+            break;
+        case TRACE_BIN_SEPARATOR:
+            vDisplaySeparator(spCtx, (aint)sBin.uiOffset);
+            break;
+        case TRACE_BIN_FOOTER:
+            vDisplayFooter(spCtx);
+            break;
+        default:
+            XTHROW(spCtx->spException, "binary trace file has an unrecognized record kind");
+            break;
+        }
+    }
+}
+
+static void vBinaryHeaderInit(trace* spCtx, binary_header* spHdr){
+    memset(spHdr, 0, sizeof(*spHdr));
+    memcpy(spHdr->caMagic, s_caMagic, sizeof(s_caMagic));
+    spHdr->uiVersion = s_uiVersion;
+    spHdr->uiRecordSize = (uint32_t)sizeof(trace_binary_record);
+    spHdr->uiAcharSize = (uint32_t)sizeof(achar);
+    spHdr->uiRuleCount = (uint32_t)spCtx->spParserCtx->uiRuleCount;
+    spHdr->uiUdtCount = (uint32_t)spCtx->spParserCtx->uiUdtCount;
+    spHdr->uiOpcodeCount = (uint32_t)spCtx->spParserCtx->uiOpcodeCount;
+}
+
+static void vBinaryWrite(trace* spCtx, const void* vpData, aint uiSize){
+    if(!spCtx->bBinaryHeader){
+        binary_header sHdr;
+        vBinaryHeaderInit(spCtx, &sHdr);
+        vpVecPushn(spCtx->vpVecBinary, &sHdr, (aint)sizeof(sHdr));
+        spCtx->bBinaryHeader = APG_TRUE;
+    }
+    if(uiSize){
+        vpVecPushn(spCtx->vpVecBinary, (void*)vpData, uiSize);
+    }
+    if(uiVecLen(spCtx->vpVecBinary) >= BINARY_FLUSH_SIZE){
+        vBinaryFlush(spCtx);
+    }
+}
+
+static void vBinaryRead(trace* spCtx, void* vpData, aint uiSize, abool bEofOk, abool* bpEof){
+    size_t uiRead = fread(vpData, 1, (size_t)uiSize, spCtx->spOpenFile);
+    if(uiRead == (size_t)uiSize){
+        return;
+    }
+    if(bEofOk && (uiRead == 0) && feof(spCtx->spOpenFile)){
+        *bpEof = APG_TRUE;
+        return;
+    }
+    XTHROW(spCtx->spException, "binary trace file is truncated or unreadable");
+}
+
+#endif /* APG_TRACE */
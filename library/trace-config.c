@@ -82,10 +82,10 @@ void vSetDefaultConfig(trace* spTrace) {
 
 /** \brief Set the trace record display type.
  *
- * Choose between ASCII and HTML output mode.
+ * Choose between ASCII, HTML and binary output mode.
  * \param vpCtx Pointer to a valid trace object context returned from vpTraceCtor().
  * If not valid the application will silently exit with a \ref BAD_CONTEXT exit code.
- * \param uiType One of \ref TRACE_ASCII or \ref TRACE_HTML.
+ * \param uiType One of \ref TRACE_ASCII, \ref TRACE_HTML or \ref TRACE_BINARY.
  */
 void vTraceOutputType(void* vpCtx, aint uiType){
     trace* spCtx = (trace*) vpCtx;
@@ -94,7 +94,7 @@ void vTraceOutputType(void* vpCtx, aint uiType){
     }
     char caBuf[128];
     char* cpFormat = "trace output type %"PRIuMAX" not recognized\n"
-            "must be TRACE_ASCII or TRACE_HTML";
+            "must be TRACE_ASCII, TRACE_HTML or TRACE_BINARY";
     spCtx->sConfig.uiOutputType = TRACE_ASCII;
     switch(uiType){
     case TRACE_ASCII:
@@ -103,6 +103,9 @@ void vTraceOutputType(void* vpCtx, aint uiType){
     case TRACE_HTML:
         spCtx->sConfig.uiOutputType = TRACE_HTML;
         break;
+    case TRACE_BINARY:
+        spCtx->sConfig.uiOutputType = TRACE_BINARY;
+        break;
     default:
         snprintf(caBuf, 128, cpFormat, (luint)uiType);
         XTHROW(spCtx->spException, caBuf);
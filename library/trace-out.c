@@ -96,10 +96,16 @@ static abool bAsciiStringAscii(display_info* spInfo);
  *
  */
 void vDisplayHeader(trace* spCtx){
+    if(spCtx->spRing){
+        // flight-recorder mode, header is displayed only when the ring is dumped
+        return;
+    }
     if(spCtx->sConfig.uiOutputType == TRACE_HTML){
         vHtmlHeader(spCtx);
     }else if(spCtx->sConfig.uiOutputType == TRACE_ASCII){
         vAsciiHeader(spCtx);
+    }else if(spCtx->sConfig.uiOutputType == TRACE_BINARY){
+        vBinaryEvent(spCtx, TRACE_BIN_HEADER, 0);
     }
     // no header for APGEX
 }
@@ -108,6 +114,10 @@ void vDisplayHeader(trace* spCtx){
  *
  */
 void vDisplayRecord(trace* spCtx, trace_record* spRec, abool bIsMatchedPppt){
+    if(spCtx->spRing){
+        vRingRecord(spCtx, spRec, (spCtx->sConfig.bPppt && bIsMatchedPppt) ? TRACE_BIN_RECORD_PPPT : TRACE_BIN_RECORD);
+        return;
+    }
     if(spCtx->sConfig.uiOutputType == TRACE_HTML){
         if(spCtx->sConfig.bPppt && bIsMatchedPppt){
             vHtmlPpptRecord(spCtx, spRec);
@@ -120,6 +130,8 @@ void vDisplayRecord(trace* spCtx, trace_record* spRec, abool bIsMatchedPppt){
         }else{
             vAsciiRecord(spCtx, spRec);
         }
+    }else if(spCtx->sConfig.uiOutputType == TRACE_BINARY){
+        vBinaryRecord(spCtx, spRec, bIsMatchedPppt);
     }
 }
 
@@ -127,10 +139,18 @@ void vDisplayRecord(trace* spCtx, trace_record* spRec, abool bIsMatchedPppt){
  *
  */
 void vDisplaySeparator(trace* spCtx, aint uiLastIndex){
+    if(spCtx->spRing){
+        trace_record sRecord = {};
+        sRecord.uiOffset = uiLastIndex;
+        vRingRecord(spCtx, &sRecord, TRACE_BIN_SEPARATOR);
+        return;
+    }
     if(spCtx->sConfig.uiOutputType == TRACE_HTML){
         vHtmlSeparator(spCtx, uiLastIndex);
     }else if(spCtx->sConfig.uiOutputType == TRACE_ASCII){
         vAsciiSeparator(spCtx, uiLastIndex);
+    }else if(spCtx->sConfig.uiOutputType == TRACE_BINARY){
+        vBinaryEvent(spCtx, TRACE_BIN_SEPARATOR, uiLastIndex);
     }
     // no header for APGEX
 }
@@ -139,10 +159,15 @@ void vDisplaySeparator(trace* spCtx, aint uiLastIndex){
  *
  */
 void vDisplayFooter(trace* spCtx){
+    if(spCtx->spRing){
+        return;
+    }
     if(spCtx->sConfig.uiOutputType == TRACE_HTML){
         vHtmlFooter(spCtx);
     }else if(spCtx->sConfig.uiOutputType == TRACE_ASCII){
         vAsciiFooter(spCtx);
+    }else if(spCtx->sConfig.uiOutputType == TRACE_BINARY){
+        vBinaryEvent(spCtx, TRACE_BIN_FOOTER, 0);
     }
     // no footer for APGEX
 }
@@ -0,0 +1,138 @@
+/*  *************************************************************************************
+    Copyright (c) 2021, Lowell D. Thomas
+    All rights reserved.
+    
+    This file is part of APG Version 7.0.
+    APG Version 7.0 may be used under the terms of the BSD 2-Clause License.
+    
+    Redistribution and use in source and binary forms, with or without
+    modification, are permitted provided that the following conditions are met:
+    
+    1. Redistributions of source code must retain the above copyright notice, this
+       list of conditions and the following disclaimer.
+    
+    2. Redistributions in binary form must reproduce the above copyright notice,
+       this list of conditions and the following disclaimer in the documentation
+       and/or other materials provided with the distribution.
+    
+    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+    AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+    IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+    DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+    FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+    DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+    SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+    CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+    OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+    OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+    
+*   *************************************************************************************/
+/** \file trace-ring.c
+ * \brief The flight-recorder trace.
+ *
+ * In flight-recorder mode the trace object keeps only the last N trace records
+ * in a fixed-size ring buffer in memory. Nothing is formatted and there is no I/O during the parse.
+ * The application decides after the parse whether the records are worth looking at,
+ * for example when the parse fails or the hit count exceeds a threshold,
+ * and dumps them through the normal display functions with \ref vTraceRingDump().
+ *
+ * The trace configuration filters apply to the records kept in the ring just as they do for a normal trace.
+ */
+
+#include "./apg.h"
+#ifdef APG_TRACE
+#include "../utilities/utilities.h"
+#include "./parserp.h"
+#include "./tracep.h"
+
+/** \brief Turn flight-recorder mode on or off.
+ *
+ * \param vpCtx Pointer to a valid trace object context returned from vpTraceCtor().
+ * If not valid the application will silently exit with a \ref BAD_CONTEXT exit code.
+ * \param uiRecords The number of records to keep. The ring buffer is allocated here, not during the parse.
+ * If 0, flight-recorder mode is turned off and the trace displays records as they occur.
+ */
+void vTraceRing(void* vpCtx, aint uiRecords){
+    trace* spCtx = (trace*) vpCtx;
+    if(!bParserValidate(spCtx->spParserCtx)){
+        vExContext();
+    }
+    if(spCtx->spRing){
+        vMemFree(spCtx->vpMem, spCtx->spRing);
+        spCtx->spRing = NULL;
+    }
+    spCtx->uiRingSize = 0;
+    spCtx->uiRingNext = 0;
+    spCtx->uiRingCount = 0;
+    if(uiRecords){
+        spCtx->spRing = (trace_ring_record*)vpMemAlloc(spCtx->vpMem, (aint)(sizeof(trace_ring_record) * uiRecords));
+        spCtx->uiRingSize = uiRecords;
+    }
+}
+
+/** \brief Display the records saved in the flight-recorder ring buffer.
+ *
+ * The records from the last parse (or all apgex attempts) are displayed, oldest first,
+ * in the current output type to the current output file, complete with header and footer.
+ * The record numbers are those of the original trace, so any records lost from the front of the
+ * ring are evident. The ring is not cleared and may be dumped again.
+ *
+ * Must be called after the parse and before the input string is changed or freed.
+ * \param vpCtx Pointer to a valid trace object context returned from vpTraceCtor().
+ * If not valid the application will silently exit with a \ref BAD_CONTEXT exit code.
+ * An exception is thrown if flight-recorder mode is not on.
+ */
+void vTraceRingDump(void* vpCtx){
+    trace* spCtx = (trace*) vpCtx;
+    if(!bParserValidate(spCtx->spParserCtx)){
+        vExContext();
+    }
+    trace_ring_record* spRing = spCtx->spRing;
+    trace_ring_record* spEntry;
+    aint ui, uiIndex;
+    if(!spRing){
+        XTHROW(spCtx->spException, "trace ring dump requested but flight-recorder mode is not on");
+    }
+
+    // display with the ring turned off
+    spCtx->spRing = NULL;
+    if(spCtx->sConfig.uiOutputType == TRACE_BINARY){
+        vBinaryInput(spCtx);
+    }
+    vDisplayHeader(spCtx);
+    uiIndex = (spCtx->uiRingCount < spCtx->uiRingSize) ? 0 : spCtx->uiRingNext;
+    for(ui = 0; ui < spCtx->uiRingCount; ui++){
+        spEntry = &spRing[uiIndex];
+        if(spEntry->uiKind == TRACE_BIN_SEPARATOR){
+            vDisplaySeparator(spCtx, spEntry->sRecord.uiOffset);
+        }else{
+            vDisplayRecord(spCtx, &spEntry->sRecord, (spEntry->uiKind == TRACE_BIN_RECORD_PPPT));
+        }
+        uiIndex++;
+        if(uiIndex == spCtx->uiRingSize){
+            uiIndex = 0;
+        }
+    }
+    vDisplayFooter(spCtx);
+    fflush(spCtx->spOut);
+    spCtx->spRing = spRing;
+}
+
+/** \brief Save one record in the ring buffer, overwriting the oldest if full.
+ *
+ * Called by the display functions in flight-recorder mode.
+ */
+void vRingRecord(trace* spCtx, trace_record* spRec, aint uiKind){
+    trace_ring_record* spEntry = &spCtx->spRing[spCtx->uiRingNext];
+    spEntry->sRecord = *spRec;
+    spEntry->uiKind = uiKind;
+    spCtx->uiRingNext++;
+    if(spCtx->uiRingNext == spCtx->uiRingSize){
+        spCtx->uiRingNext = 0;
+    }
+    if(spCtx->uiRingCount < spCtx->uiRingSize){
+        spCtx->uiRingCount++;
+    }
+}
+
+#endif /* APG_TRACE */
@@ -44,7 +44,8 @@ static void vDown(trace* spCtx, const opcode* spOp, aint uiOffset);
 static abool bTraceConfigCheck(trace* spCtx, const opcode* spOp);
 #ifndef APG_NO_PPPT
 static void vDownPppt(trace* spCtx, const opcode* spOp, aint uiOffset){
-    aint uiState = uiPpptState(spCtx->spParserCtx, spOp, uiOffset);
+    aint uiPhraseLength;
+    aint uiState = uiPpptState(spCtx->spParserCtx, spOp, uiOffset, &uiPhraseLength);
     if(uiState == ID_ACTIVE){
         vDown(spCtx, spOp, uiOffset);
     }else{
@@ -59,7 +60,7 @@ static void vDownPppt(trace* spCtx, const opcode* spOp, aint uiOffset){
             sRecord.uiThisRecord = spCtx->uiThisRecord;
             sRecord.uiState = uiState;
             sRecord.uiOffset = uiOffset;
-            sRecord.uiPhraseLength = (uiState == ID_MATCH) ? 1 : 0;
+            sRecord.uiPhraseLength = uiPhraseLength;
             sRecord.spOpcode = spOp;
             vDisplayRecord(spCtx, &sRecord, APG_TRUE);
             spCtx->uiThisRecord++;
@@ -71,7 +72,8 @@ static void vDownPppt(trace* spCtx, const opcode* spOp, aint uiOffset){
     }
 }
 static void vUpPppt(trace* spCtx, const opcode* spOp, aint uiState, aint uiOffset, aint uiPhraseLength){
-    aint uiPrevState = uiPpptState(spCtx->spParserCtx, spOp, uiOffset);
+    aint uiPrevLength;
+    aint uiPrevState = uiPpptState(spCtx->spParserCtx, spOp, uiOffset, &uiPrevLength);
     if(uiPrevState == ID_ACTIVE){
         vUp(spCtx, spOp, uiState, uiOffset, uiPhraseLength);
     }else{
@@ -109,6 +111,8 @@ void* vpTraceCtor(void* vpCtx) {
     spTrace->spOut = stdout;
     spTrace->cpFileName = NULL;
     spTrace->vpVecFileName = vpVecCtor(vpMem, sizeof(char), 1024);
+    spTrace->vpVecBinary = vpVecCtor(vpMem, sizeof(uint8_t), 4096);
+    spTrace->vpVecBinaryInput = vpVecCtor(vpMem, sizeof(achar), 1024);
 
     // lookaround stack
     spTrace->vpLookaroundStack = vpVecCtor(spTrace->vpMem, (aint) sizeof(aint), 500);
@@ -137,6 +141,7 @@ void* vpTraceCtor(void* vpCtx) {
 
     // success
     spParser->vpTrace = (void*) spTrace;
+    vParserSelectOperators(spParser);
     return (void*)spTrace;
 }
 
@@ -155,6 +160,7 @@ void vTraceDtor(void* vpCtx){
         if(!bParserValidate(spTrace->spParserCtx)){
             vExContext();
         }
+        vBinaryFlush(spTrace);
         if(spTrace->spOut && (spTrace->spOut != stdout)){
             fclose(spTrace->spOut);
             spTrace->spOut = NULL;
@@ -164,8 +170,11 @@ void vTraceDtor(void* vpCtx){
             spTrace->spOpenFile = NULL;
         }
         vVecDtor(spTrace->vpVecFileName);
+        vVecDtor(spTrace->vpVecBinary);
+        vVecDtor(spTrace->vpVecBinaryInput);
         vMsgsDtor(spTrace->vpLog);
         spTrace->spParserCtx->vpTrace = NULL;
+        vParserSelectOperators(spTrace->spParserCtx);
     }
 }
 
@@ -175,6 +184,8 @@ void vTraceSetOutput(void* vpCtx, const char* cpFileName){
         vExContext();
     }
     vVecClear(spTrace->vpVecFileName);
+    vBinaryFlush(spTrace);
+    spTrace->bBinaryHeader = APG_FALSE;
     if(spTrace->spOut && spTrace->spOut != stdout){
         fclose(spTrace->spOut);
     }
@@ -202,6 +213,8 @@ void vTraceApgexHeader(void* vpCtx){
         vExContext();
     }
     spCtx->uiThisRecord = 0;
+    spCtx->uiRingNext = 0;
+    spCtx->uiRingCount = 0;
     vDisplayHeader(spCtx);
 }
 /** \brief Only called by apgex
@@ -240,6 +253,17 @@ void vTraceBegin(void* vpCtx){
         vExContext();
     }
     spCtx->uiThisRecord = 0;
+    if(spCtx->sConfig.uiHeaderType == TRACE_HEADER_TRACE){
+        // the flight recorder keeps only the last parse (apgex keeps all attempts)
+        spCtx->uiRingNext = 0;
+        spCtx->uiRingCount = 0;
+    }
+    if(spCtx->spRing){
+        return;
+    }
+    if(spCtx->sConfig.uiOutputType == TRACE_BINARY){
+        vBinaryInput(spCtx);
+    }
     if(spCtx->sConfig.uiHeaderType == TRACE_HEADER_TRACE){
         vDisplayHeader(spCtx);
     }
@@ -253,6 +277,9 @@ void vTraceEnd(void* vpCtx){
     if(!bParserValidate(spCtx->spParserCtx)){
         vExContext();
     }
+    if(spCtx->spRing){
+        return;
+    }
     if(spCtx->sConfig.uiHeaderType == TRACE_HEADER_TRACE){
         vDisplayFooter(spCtx);
         fflush(spCtx->spOut);
@@ -43,6 +43,13 @@
  * \brief Identifier for HTML trace record format.
  */
 #define TRACE_HTML          1
+/** \def TRACE_BINARY
+ * \brief Identifier for fixed-size binary trace records.
+ *
+ * Binary records are buffered and written with no formatting.
+ * Use \ref vTraceDecode() to render them later as ASCII or HTML.
+ */
+#define TRACE_BINARY        2
 
 /** @name Public Tracing Functions
  * These functions are used by the application to construct and configure the trace object.
@@ -56,6 +63,9 @@ void vTraceConfig(void* vpCtx, const char* cpFileName);
 void vTraceConfigDisplay(void* vpCtx, const char* cpFileName);
 void vTraceConfigGen(void* vpCtx, const char* cpFileName);
 aint uiTraceGetRecordCount(void* vpCtx);
+void vTraceDecode(void* vpCtx, const char* cpBinaryFile);
+void vTraceRing(void* vpCtx, aint uiRecords);
+void vTraceRingDump(void* vpCtx);
 ///@}
 
 #endif /* LIB_TRACE_H_ */
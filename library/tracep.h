@@ -54,6 +54,43 @@
 #define TRACE_HEADER_TRACE         3
 ///@}
 
+/** @name Binary Trace Record Kinds
+ * Each binary trace record is tagged with the display event that it replays.
+ */
+///@{
+#define TRACE_BIN_INPUT         1 ///< \brief The input string for the parse that follows. The string follows the record unless unchanged.
+#define TRACE_BIN_HEADER        2 ///< \brief Replays \ref vDisplayHeader().
+#define TRACE_BIN_RECORD        3 ///< \brief Replays \ref vDisplayRecord().
+#define TRACE_BIN_RECORD_PPPT   4 ///< \brief Replays \ref vDisplayRecord() for a node matched by the PPPT.
+#define TRACE_BIN_SEPARATOR     5 ///< \brief Replays \ref vDisplaySeparator().
+#define TRACE_BIN_FOOTER        6 ///< \brief Replays \ref vDisplayFooter().
+///@}
+
+/** \def TRACE_BIN_START_RULE
+ * \brief Opcode index used for the parser's placeholder RNM operator of the start rule. */
+#define TRACE_BIN_START_RULE    0xFFFFFFFF
+
+/** \struct trace_binary_record
+ * \brief The fixed-size record written by the binary trace sink for each displayed event.
+ *
+ * Fields are written in host byte order.
+ * For \ref TRACE_BIN_INPUT records uiRecord is the sub-string beginning, uiOffset is the input string length,
+ * uiPhraseLength is the sub-string end, uiOpIndex is the start rule index and ucState is non-zero
+ * if the input string is unchanged from the previous parse.
+ * For \ref TRACE_BIN_SEPARATOR records uiOffset is the last index.
+ */
+typedef struct {
+    uint64_t uiRecord; ///< \brief The record number.
+    uint64_t uiOffset; ///< \brief The phrase offset.
+    uint64_t uiPhraseLength; ///< \brief The phrase length.
+    uint32_t uiOpIndex; ///< \brief Index of the opcode in the parser's opcode table or \ref TRACE_BIN_START_RULE.
+    uint32_t uiTreeDepth; ///< \brief The actual parse tree depth.
+    int32_t iTraceDepth; ///< \brief The partial parse tree depth.
+    uint8_t ucKind; ///< \brief The record kind, \ref TRACE_BIN_RECORD, etc.
+    uint8_t ucState; ///< \brief The parser state, \ref ID_ACTIVE, etc.
+    uint16_t usReserved; ///< \brief Unused, always zero.
+} trace_binary_record;
+
 /** \struct trace_record
  * \brief The information recorded & displayed by the trace object for each node visited.
  */
@@ -67,6 +104,14 @@ typedef struct {
     const opcode* spOpcode;  ///< \brief Pointer to the opcode for the current node.
 } trace_record;
 
+/** \struct trace_ring_record
+ * \brief One entry in the flight-recorder ring buffer.
+ */
+typedef struct {
+    trace_record sRecord; ///< \brief The trace record, unformatted.
+    aint uiKind; ///< \brief \ref TRACE_BIN_RECORD, \ref TRACE_BIN_RECORD_PPPT or \ref TRACE_BIN_SEPARATOR.
+} trace_ring_record;
+
 /** \struct trace_config
  * \brief Configuration defining the subset of nodes to display information for.
  */
@@ -108,6 +153,13 @@ typedef struct{
     char* cpBuf;  ///< \brief Pointer to a scratch buffer.
     aint uiBufSize;  ///< \brief Size of the scratch buffer.
     trace_config sConfig;  ///< \brief Pointer to the trace configuration.
+    void* vpVecBinary;  ///< \brief Buffer of binary records waiting to be written to the output file.
+    void* vpVecBinaryInput;  ///< \brief The last input string written (or read back) by the binary trace.
+    abool bBinaryHeader;  ///< \brief True if the binary file header has been written to the current output file.
+    trace_ring_record* spRing;  ///< \brief The flight-recorder ring buffer, NULL if not in flight-recorder mode.
+    aint uiRingSize;  ///< \brief The number of records the ring buffer can hold.
+    aint uiRingNext;  ///< \brief Index of the next ring buffer entry to write.
+    aint uiRingCount;  ///< \brief The number of valid ring buffer entries.
 } trace;
 
 /** @name Special Tracing Functions
@@ -134,6 +186,11 @@ void vDisplayHeader(trace* spCtx);
 void vDisplaySeparator(trace* spCtx, aint uiLastIndex);
 void vDisplayFooter(trace* spCtx);
 void vSetDefaultConfig(trace* spTrace);
+void vBinaryInput(trace* spCtx);
+void vBinaryRecord(trace* spCtx, trace_record* spRec, abool bIsMatchedPppt);
+void vBinaryEvent(trace* spCtx, aint uiKind, aint uiValue);
+void vBinaryFlush(trace* spCtx);
+void vRingRecord(trace* spCtx, trace_record* spRec, aint uiKind);
 ///@}
 
 #endif /* APG_TRACE */
@@ -717,6 +717,9 @@ static char* cpUtilParserState(aint uiState){
     case ID_EMPTY:
         cpReturn = "EMPTY";
         break;
+    case ID_LIMIT:
+        cpReturn = "LIMIT";
+        break;
     }
     return cpReturn;
 }
@@ -738,6 +741,66 @@ void vUtilPrintParserState(parser_state* spState) {
     printf("  input length: %"PRIuMAX"\n", (luint) spState->uiStringLength);
     printf("max tree depth: %"PRIuMAX"\n", (luint) spState->uiMaxTreeDepth);
     printf("     hit count: %"PRIuMAX"\n", (luint) spState->uiHitCount);
+    if(spState->uiState == ID_LIMIT){
+        const char* cpLimit = "unknown";
+        if(spState->uiLimit == ID_LIMIT_HITS){
+            cpLimit = "maximum hit count";
+        }else if(spState->uiLimit == ID_LIMIT_DEPTH){
+            cpLimit = "maximum tree depth";
+        }else if(spState->uiLimit == ID_LIMIT_TIME){
+            cpLimit = "maximum time";
+        }
+        printf("         limit: %s\n", cpLimit);
+    }
+}
+
+/** \brief Display the farthest failure offset and the operators that failed there.
+ *
+ * The usual "expected one of ..." error report, available for any parse without a trace.
+ * \param vpParser Pointer to the parser context of the last parse.
+ * \param spState Pointer to the parser's state returned from vParserParse().
+ */
+void vUtilPrintExpected(void* vpParser, parser_state* spState) {
+    aint ui, uj, uiCount = 0;
+    const parser_expected* spItems = spParserExpected(vpParser, &uiCount);
+    printf("  FARTHEST FAILURE:\n");
+    printf("        offset: %"PRIuMAX"\n", (luint) spState->uiFarthestOffset);
+    if(!uiCount){
+        printf("      expected: (none)\n");
+        return;
+    }
+    for(ui = 0; ui < uiCount; ui++){
+        const parser_expected* spItem = &spItems[ui];
+        printf("%s%s", (ui ? "                " : "      expected: "), cpUtilOpName(spItem->uiId));
+        switch(spItem->uiId){
+        case ID_RNM:
+            printf("(%s)", cpParserRuleName(vpParser, spItem->uiTargetIndex));
+            break;
+        case ID_UDT:
+            printf("(%s)", cpParserUdtName(vpParser, spItem->uiTargetIndex));
+            break;
+        case ID_TRG:
+            printf("[x%"PRIXMAX"-x%"PRIXMAX"]", (luint) spItem->acMin, (luint) spItem->acMax);
+            break;
+        case ID_TLS:
+        case ID_TBS:
+            printf("(\"");
+            for(uj = 0; uj < spItem->uiStringLength; uj++){
+                achar acChar = spItem->acpString[uj];
+                if((acChar >= 32) && (acChar <= 126) && (acChar != 34)){
+                    printf("%c", (char) acChar);
+                }else{
+                    printf("\\x%"PRIXMAX, (luint) acChar);
+                }
+            }
+            printf("\")");
+            break;
+        }
+        if(spItem->uiRuleIndex != APG_UNDEFINED){
+            printf(" in rule %s", cpParserRuleName(vpParser, spItem->uiRuleIndex));
+        }
+        printf("\n");
+    }
 }
 
 /**  \brief Display the list of messages in a message object to stdout.
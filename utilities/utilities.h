@@ -71,6 +71,7 @@ const char* cpUtilUtfTypeName(aint uiType);
 const char* cpUtilTrueFalse(luint luiTrue);
 const char* cpUtilOpName(aint uiId);
 void vUtilPrintParserState(parser_state* spState);
+void vUtilPrintExpected(void* vpParser, parser_state* spState);
 void vUtilPrintMsgs(void* vpMsgs);
 ///@}
 